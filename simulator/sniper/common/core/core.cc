@@ -25,6 +25,13 @@
 #include "thread.h"
 #include "thread_manager.h"
 #include "barrier_sync_server.h"
+#include "utils.h"
+#include "itostr.h"
+
+#include <algorithm>
+#include <memory>
+#include <sched.h>
+
 // #define TLB_SHOOTDOWN_DEBUG
 
 #if 0
@@ -92,6 +99,7 @@ Core::Core(SInt32 id)
    , m_shmem_perf(new ShmemPerf())
    , m_tlb_shootdown_total_time(SubsecondTime::Zero())
    , m_tlb_shootdown_count(0)
+   , m_tlb_shootdown_coalesced(0)
 {
    LOG_PRINT("Core ctor for: %d", id);
 
@@ -101,6 +109,10 @@ Core::Core(SInt32 id)
    registerStatsMetric("core", id, "spin_elapsed_time", &m_spin_elapsed_time);
    registerStatsMetric("core", id, "tlb_shootdown_total_time", &m_tlb_shootdown_total_time);
    registerStatsMetric("core", id, "tlb_shootdown_count", &m_tlb_shootdown_count);
+   registerStatsMetric("core", id, "tlb_shootdown_coalesced", &m_tlb_shootdown_coalesced);
+   bzero(m_tlb_shootdown_latency_hist, sizeof(m_tlb_shootdown_latency_hist));
+   for (int i = 0; i < TLB_SHOOTDOWN_LATENCY_BUCKETS; i++)
+      registerStatsMetric("core", id, "tlb_shootdown_latency_log2ns_" + itostr(i), &m_tlb_shootdown_latency_hist[i]);
 
    Sim()->getStatsManager()->logTopology("hwcontext", id, id);
 
@@ -118,7 +130,7 @@ Core::Core(SInt32 id)
    m_performance_model = PerformanceModel::create(this);
    if (Sim()->getCfg()->hasKey("migration/migration_enable")) {
       int sampling_frequency = Sim()->getCfg()->getInt("migration/sampling_frequency");
-      page_tracer = new PageTracer(sampling_frequency);
+      page_tracer = new PageTracer(sampling_frequency, id);
       ipi_initiate_latency = SubsecondTime::NS(Sim()->getCfg()->getInt("migration/ipi_initiate_latency"));
       ipi_handle_latency   = SubsecondTime::NS(Sim()->getCfg()->getInt("migration/ipi_handle_latency"));
    } else {
@@ -131,6 +143,17 @@ Core::Core(SInt32 id)
 
 Core::~Core()
 {
+   for (std::atomic<TLBShootdownRequest*> *list : { &m_tlb_shootdown_mailbox, &m_tlb_shootdown_deferred })
+   {
+      TLBShootdownRequest *request = list->exchange(nullptr);
+      while (request)
+      {
+         TLBShootdownRequest *next = request->next;
+         delete request;
+         request = next;
+      }
+   }
+
    if (m_cheetah_manager)
       delete m_cheetah_manager;
    delete m_topology_info;
@@ -743,6 +766,7 @@ void Core::networkHandleTLBShootdownAck(PrL1PrL2DramDirectoryMSI::ShmemMsg *shme
 
                // 2. Remove this core from the pending list
                it->second.pending_cores.erase(from_core);
+               it->second.remaining.store(it->second.pending_cores.size(), std::memory_order_release);
 
                // 3. Get the specific semaphore to signal
                // sem_to_signal = it->second.sem;
@@ -766,21 +790,15 @@ void Core::networkHandleTLBShootdownAck(PrL1PrL2DramDirectoryMSI::ShmemMsg *shme
  */
 void Core::enqueueTLBShootdownRequest(std::array<IntPtr, TLB_SHOOT_DOWN_MAX_SIZE> &pages_array, std::array<IntPtr, TLB_SHOOT_DOWN_MAX_SIZE> &phy_addrs, core_id_t init_id, int app_id, int page_num)
 {
-    {
-       ScopedLock sl(m_tlb_shootdown_buffer_lock);
-
-       TLBShootdownRequest request;
-       request.addrs = pages_array;
-       request.phy_addrs = phy_addrs;
-       request.app_id = app_id;
-       request.initiator_core_id = init_id;
-       request.timestamp = getPerformanceModel()->getElapsedTime();
-       request.id = pages_array.front();
-       request.pages_num = page_num;
-
-       m_tlb_shootdown_buffer.push(request);
-       m_tlb_shootdown_pending.store(true, std::memory_order_release);
-    }
+    TLBShootdownRequest *request = new TLBShootdownRequest;
+    request->addrs = pages_array;
+    request->phy_addrs = phy_addrs;
+    request->app_id = app_id;
+    request->initiator_core_id = init_id;
+    request->timestamp = getPerformanceModel()->getElapsedTime();
+    request->id = pages_array.front();
+    request->pages_num = page_num;
+    pushTLBShootdownRequest(m_tlb_shootdown_mailbox, request);
 
     // If the target core's thread is stalled, send an IPI to wake it up 
     // to process this TLB shootdown (either as a receiver or an initiator)
@@ -801,113 +819,134 @@ void Core::enqueueTLBShootdownRequest(std::array<IntPtr, TLB_SHOOT_DOWN_MAX_SIZE
     }
 }
 
+void Core::pushTLBShootdownRequest(std::atomic<TLBShootdownRequest*> &list, TLBShootdownRequest *request)
+{
+    TLBShootdownRequest *head = list.load(std::memory_order_relaxed);
+    do {
+       request->next = head;
+    } while (!list.compare_exchange_weak(head, request, std::memory_order_release, std::memory_order_relaxed));
+}
+
 /**
- * @brief ( process - part 1 ) Processes all requests in the buffer in a loop.
+ * @brief ( process - part 1 ) Processes all requests that are in the mailbox on entry.
  *
  * This function should be called periodically by the core's main simulation loop.
+ * All remote requests taken are flushed and ACKed together (see handleRemoteTLBShootdownRequests())
+ * before any own request is broadcast: the broadcast waits for the other cores, and they may
+ * themselves be waiting for one of these ACKs.
+ * With processing_remote_only, own requests are set aside and broadcast by the next normal call.
  */
 void Core::processTLBShootdownBuffer(bool processing_remote_only)
 {
-      size_t batch_size = 0;
-      {
-         ScopedLock sl(m_tlb_shootdown_buffer_lock);
-         batch_size = m_tlb_shootdown_buffer.size();
+      // Take the whole mailbox and restore arrival order.
+      // Requests that arrive from here on are left for the next call.
+      std::vector<TLBShootdownRequest*> requests;
+      for (TLBShootdownRequest *request = m_tlb_shootdown_mailbox.exchange(nullptr, std::memory_order_acquire); request; request = request->next)
+         requests.push_back(request);
+      // Own requests set aside earlier are older than anything in the mailbox
+      if (!processing_remote_only && m_tlb_shootdown_deferred.load(std::memory_order_relaxed)) {
+         for (TLBShootdownRequest *request = m_tlb_shootdown_deferred.exchange(nullptr, std::memory_order_acquire); request; request = request->next)
+            requests.push_back(request);
       }
-      for (size_t i = 0; i < batch_size; ++i) {
-         TLBShootdownRequest request;
-         bool is_mine = false;
-         bool should_process = true;
+      if (requests.empty())
+         return;
+      std::reverse(requests.begin(), requests.end());
 
-         {
-            ScopedLock sl(m_tlb_shootdown_buffer_lock);
-            if (m_tlb_shootdown_buffer.empty())
-               break;
-
-            request = m_tlb_shootdown_buffer.front();
-            m_tlb_shootdown_buffer.pop();
+      std::vector<TLBShootdownRequest*> remote, own;
+      for (TLBShootdownRequest *request : requests)
+         (request->initiator_core_id == m_core_id ? own : remote).push_back(request);
 
-            is_mine = (request.initiator_core_id == m_core_id);
-
-            if (is_mine && processing_remote_only) {
-               m_tlb_shootdown_buffer.push(request);
-               should_process = false;
-            }
-         }
+      if (!remote.empty())
+         handleRemoteTLBShootdownRequests(remote);
 
-
-         if (should_process) {
-            if (is_mine) {
-               initiateTLBShootdownBroadcast(request);
-            } else {
-               handleRemoteTLBShootdownRequest(request);
-            }
+      for (TLBShootdownRequest *request : own) {
+         if (processing_remote_only) {
+            pushTLBShootdownRequest(m_tlb_shootdown_deferred, request);
+            continue;
          }
-      }
-
-      // Update the lock-free pending flag.
-      // New requests may have arrived during processing, so re-check under lock.
-      {
-         ScopedLock sl(m_tlb_shootdown_buffer_lock);
-         if (m_tlb_shootdown_buffer.empty())
-            m_tlb_shootdown_pending.store(false, std::memory_order_release);
+         initiateTLBShootdownBroadcast(*request);
+         delete request;
       }
 }
 
-void Core::handleRemoteTLBShootdownRequest(TLBShootdownRequest &request)
+/**
+ * @brief ( process - part 2 ) Flushes the pages of one or more remote requests and ACKs each of them.
+ *
+ * The local flush is done in a single pass over the (deduplicated) union of all pages,
+ * while the simulated cost and the ACKs stay per request, exactly as if they were handled one by one.
+ * Takes ownership of the requests.
+ */
+void Core::handleRemoteTLBShootdownRequests(std::vector<TLBShootdownRequest*> &requests)
 {
 #ifdef TLB_SHOOTDOWN_DEBUG
-      cout << "core "<< getId() << " dealing TLB shootdown request = 0x" << request.addrs.at(0) << endl;
+      cout << "core "<< getId() << " dealing " << requests.size() << " TLB shootdown request(s), first = 0x" << requests.front()->addrs.at(0) << endl;
 #endif
-   std::array<bool, TLB_SHOOT_DOWN_MAX_SIZE> flush_result{};
-
-   // 1. get m_mem_lock
-   {
-      // ScopedLock sl(m_mem_lock);
-
-      // 1a. local TLB flush
-      for(int i = 0; i < TLB_SHOOT_DOWN_SIZE; i++) {
-         IntPtr addr = request.addrs.at(i);
-         bool flushed = m_memory_manager->MMFlushTLB(request.app_id, addr, NONE, MEM_MODELED_NONE);
-         flush_result.at(i) = flushed;
+   // 1. Local TLB flush, one batch per address space
+   std::vector<IntPtr> pages;
+   std::vector<bool> page_flushed;
+   std::vector<bool> app_done(requests.size(), false);
+   for (size_t r = 0; r < requests.size(); ++r) {
+      if (app_done[r])
+         continue;
+
+      int app_id = requests[r]->app_id;
+      pages.clear();
+      for (size_t q = r; q < requests.size(); ++q) {
+         if (requests[q]->app_id == app_id)
+            pages.insert(pages.end(), requests[q]->addrs.begin(), requests[q]->addrs.begin() + requests[q]->pages_num);
       }
+      std::sort(pages.begin(), pages.end());
+      pages.erase(std::unique(pages.begin(), pages.end()), pages.end());
 
-      // 1b. Stall this core for the TLB-flush handling cost.
-      // Classified as migration idle so it appears in "Idle time" in sim.out
-      // and in per-core cpiSyncTLBShootdown for fine-grained analysis.
-      getPerformanceModel()->incrementTLBShootdownIdleTime(ipi_handle_latency);
-         getShmemPerfModel()->setElapsedTime(ShmemPerfModel::_SIM_THREAD, getPerformanceModel()->getElapsedTime());
+      std::unique_ptr<bool[]> flushed(new bool[pages.size()]());
+      m_memory_manager->MMFlushTLBBatch(app_id, pages.data(), pages.size(), flushed.get(), NONE, MEM_MODELED_NONE);
 
+      for (size_t q = r; q < requests.size(); ++q) {
+         if (requests[q]->app_id != app_id)
+            continue;
+         app_done[q] = true;
+         if (q != r)
+            m_tlb_shootdown_coalesced++;
+
+         // Only the first request to name a page sees it as flushed, as with sequential handling
+         TLBShootdownRequest *request = requests[q];
+         std::array<bool, TLB_SHOOT_DOWN_MAX_SIZE> flush_result{};
+         for (int i = 0; i < request->pages_num; i++) {
+            size_t idx = std::lower_bound(pages.begin(), pages.end(), request->addrs[i]) - pages.begin();
+            flush_result[i] = flushed[idx];
+            flushed[idx] = false;
+         }
 
-   } // m_mem_lock release
+         // 2. Stall this core for the TLB-flush handling cost.
+         // Classified as migration idle so it appears in "Idle time" in sim.out
+         // and in per-core cpiSyncTLBShootdown for fine-grained analysis.
+         getPerformanceModel()->incrementTLBShootdownIdleTime(ipi_handle_latency);
+         getShmemPerfModel()->setElapsedTime(ShmemPerfModel::_SIM_THREAD, getPerformanceModel()->getElapsedTime());
 
-   // 2. Response TLB Shootdown ACK
-   TLBShootdownAckPayload ack_payload{};
-   ack_payload.request_id = request.id;
-   ack_payload.flush_result = flush_result;
-   ack_payload.page_num = request.pages_num;
+         // 3. Response TLB Shootdown ACK
+         TLBShootdownAckPayload ack_payload{};
+         ack_payload.request_id = request->id;
+         ack_payload.flush_result = flush_result;
+         ack_payload.page_num = request->pages_num;
 #ifdef TLB_SHOOTDOWN_DEBUG
-      cout << "core "<< getId() << " send TLB shootdown reply = 0x" << request.addrs.at(0) << endl;
+         cout << "core "<< getId() << " send TLB shootdown reply = 0x" << request->addrs.at(0) << endl;
 #endif
-   getMemoryManager()->sendMsg(
-       PrL1PrL2DramDirectoryMSI::ShmemMsg::TLB_SHOOTDOWN_ACK,
-       MemComponent::CORE, MemComponent::CORE,
-       m_core_id, // Requester (of the ACK)
-       request.initiator_core_id, // Receiver (the original initiator)
-       request.id,
-       reinterpret_cast<Byte *>(&ack_payload), sizeof(ack_payload),
-       HitWhere::UNKNOWN, m_shmem_perf,
-       ShmemPerfModel::_SIM_THREAD, // send in _USER_THREAD
-       CacheBlockInfo::block_type_t::TLB_ENTRY
-   );
-}
+         getMemoryManager()->sendMsg(
+             PrL1PrL2DramDirectoryMSI::ShmemMsg::TLB_SHOOTDOWN_ACK,
+             MemComponent::CORE, MemComponent::CORE,
+             m_core_id, // Requester (of the ACK)
+             request->initiator_core_id, // Receiver (the original initiator)
+             request->id,
+             reinterpret_cast<Byte *>(&ack_payload), sizeof(ack_payload),
+             HitWhere::UNKNOWN, m_shmem_perf,
+             ShmemPerfModel::_SIM_THREAD, // send in _USER_THREAD
+             CacheBlockInfo::block_type_t::TLB_ENTRY
+         );
+      }
+   }
 
-/**
- * @brief Check if the TLB shootdown buffer has any pending remote requests.
- */
-bool Core::hasPendingTLBShootdown()
-{
-   ScopedLock sl(m_tlb_shootdown_buffer_lock);
-   return !m_tlb_shootdown_buffer.empty();
+   for (TLBShootdownRequest *request : requests)
+      delete request;
 }
 
 /**
@@ -931,12 +970,13 @@ void Core::handleIPIInterrupt()
 void Core::initiateTLBShootdownBroadcast(TLBShootdownRequest &request)
 {
       // 1.Flush local cache using physical addresses (cache coherence is physical-address based)
-       for (int i = 0; i < TLB_SHOOT_DOWN_SIZE; i++) {
+       for (int i = 0; i < request.pages_num; i++) {
           if (request.phy_addrs.at(i) != 0)
              getMemoryManager()->flushCachePage(request.phy_addrs.at(i), MemComponent::L1_DCACHE);
        }
       // getMemoryManager()->flushEntireL1DCache();
        int num_to_wait_for = 0;
+       PendingShootdown *pending_record = NULL;
 
        // 2. Create pending shootdown record
        {
@@ -947,7 +987,10 @@ void Core::initiateTLBShootdownBroadcast(TLBShootdownRequest &request)
            getPerformanceModel()->incrementTLBShootdownIdleTime(ipi_initiate_latency);
           getShmemPerfModel()->setElapsedTime(ShmemPerfModel::_SIM_THREAD, getPerformanceModel()->getElapsedTime());
 
-           PendingShootdown pending;
+           // Built in place: the map node stays put until we erase it, so the
+           // wait loop below can poll its counter without taking the lock.
+           PendingShootdown &pending = m_pending_shootdowns[request.id];
+           pending.pending_cores.clear();
            pending.max_end_time = getPerformanceModel()->getElapsedTime();
            pending.address = request.id;
 
@@ -966,8 +1009,8 @@ void Core::initiateTLBShootdownBroadcast(TLBShootdownRequest &request)
             }
 
           num_to_wait_for = pending.pending_cores.size(); // Record how many ACKs to wait for
-
-          m_pending_shootdowns[request.id] = pending;
+          pending.remaining.store(num_to_wait_for, std::memory_order_release);
+          pending_record = &pending;
        }
 
        SubsecondTime start_send_ipi = getPerformanceModel()->getElapsedTime();
@@ -993,9 +1036,9 @@ void Core::initiateTLBShootdownBroadcast(TLBShootdownRequest &request)
       }
 
        // 4. Perform local TLB flush
-       for(int i = 0; i < TLB_SHOOT_DOWN_SIZE; ++i) {
-           IntPtr addr = request.addrs.at(i);
-           m_memory_manager->MMFlushTLB(request.app_id, addr, NONE, MEM_MODELED_NONE);
+       {
+           bool flushed[TLB_SHOOT_DOWN_MAX_SIZE];
+           m_memory_manager->MMFlushTLBBatch(request.app_id, request.addrs.data(), request.pages_num, flushed, NONE, MEM_MODELED_NONE);
        }
        // Account for issuer core's own TLB flush cost.
        // Classified as migration idle so it appears in "Idle time" in sim.out
@@ -1012,27 +1055,19 @@ void Core::initiateTLBShootdownBroadcast(TLBShootdownRequest &request)
                break;
             }
 
-            // Process any self-initiated requests that are also in the buffer.
+            // ACK the remote requests that arrive meanwhile, their initiators may be waiting on us.
+            // Our own later requests are set aside, only an empty mailbox is left untouched.
             // ACKs from other cores are delivered via networkHandleTLBShootdownAck
             // (called on the SIM thread), which removes them from pending_cores.
             // IDLE cores ACK immediately in networkHandleTLBShootdownRequest,
             // so no polling is needed here.
-            processTLBShootdownBuffer(true);
-            bool done = false;
-            {
-               ScopedLock sl(m_pending_shootdowns_lock);
-               auto it = m_pending_shootdowns.find(request.id);
-               if (it != m_pending_shootdowns.end()) {
-                   if (it->second.pending_cores.empty()) {
-                      done = true;
-                   }
-                } else {
-                   done = true;
-                }
-             }
-             if (done) {
-                break;
-             }
+            if (m_tlb_shootdown_mailbox.load(std::memory_order_acquire))
+               processTLBShootdownBuffer(true);
+            if (pending_record->remaining.load(std::memory_order_acquire) == 0) {
+               break;
+            }
+            // Let the threads that deliver our ACKs run
+            sched_yield();
           }
        }
 
@@ -1046,6 +1081,10 @@ void Core::initiateTLBShootdownBroadcast(TLBShootdownRequest &request)
        SubsecondTime shootdown_duration = end_send_ipi - start_send_ipi;
        m_tlb_shootdown_total_time += shootdown_duration;
        m_tlb_shootdown_count++;
+       UInt64 duration_ns = shootdown_duration.getNS();
+       // Bucket 0 holds zero-latency shootdowns, bucket i > 0 covers [2^(i-1), 2^i) ns, the last one is open ended
+       int bucket = duration_ns ? std::min(floorLog2((UInt32)std::min<UInt64>(duration_ns, UINT32_MAX)) + 1, TLB_SHOOTDOWN_LATENCY_BUCKETS - 1) : 0;
+       m_tlb_shootdown_latency_hist[bucket]++;
 
       Sim()->getMimicOS()->DMA_migrate(request.id, getPerformanceModel()->getElapsedTime(), request.app_id);
 
@@ -41,6 +41,7 @@ void CoreNetworkCallback(void* obj, NetPacket packet);
 
 constexpr int TLB_SHOOT_DOWN_MAX_SIZE = 128;
 extern int TLB_SHOOT_DOWN_SIZE;
+constexpr int TLB_SHOOTDOWN_LATENCY_BUCKETS = 24; // log2(ns) buckets of the initiator's shootdown latency
 
 class Core
 {
@@ -172,10 +173,15 @@ class Core
          std::array<IntPtr, TLB_SHOOT_DOWN_MAX_SIZE> addrs;      // virtual addresses
          std::array<IntPtr, TLB_SHOOT_DOWN_MAX_SIZE> phy_addrs;  // physical addresses (for cache flush)
          int pages_num;
+         TLBShootdownRequest *next; // mailbox link
       };
-      std::queue<TLBShootdownRequest> m_tlb_shootdown_buffer;
-      Lock m_tlb_shootdown_buffer_lock;
-      std::atomic<bool> m_tlb_shootdown_pending{false}; // Lock-free flag for fast-path check
+      // Per-core mailbox: producers (network and migration threads) push with a CAS,
+      // the consumer takes the whole list at once, so neither side takes a lock.
+      // The list is newest-first; processTLBShootdownBuffer() restores arrival order.
+      std::atomic<TLBShootdownRequest*> m_tlb_shootdown_mailbox{nullptr};
+      // Own requests taken while only remote ones could be handled (the initiator was waiting for ACKs),
+      // kept aside so the wait loop does not take and re-push them on every pass.
+      std::atomic<TLBShootdownRequest*> m_tlb_shootdown_deferred{nullptr};
 
       // 用于跟踪等待的 shootdown 响应
       struct PendingShootdown {
@@ -183,6 +189,7 @@ class Core
          std::set<core_id_t> pending_cores;  // 等待响应的核心集合
          std::set<bool> acked_pages; // 已确认刷新页面集合
          SubsecondTime max_end_time;
+         std::atomic<int> remaining{0}; // pending_cores.size(), polled by the initiator without the lock
       };
       std::map<IntPtr, PendingShootdown> m_pending_shootdowns;
       Lock m_pending_shootdowns_lock;
@@ -206,11 +213,13 @@ class Core
 
       void initiateTLBShootdownBroadcast(TLBShootdownRequest &request);
 
+      static void pushTLBShootdownRequest(std::atomic<TLBShootdownRequest*> &list, TLBShootdownRequest *request);
       void enqueueTLBShootdownRequest(std::array<IntPtr, TLB_SHOOT_DOWN_MAX_SIZE> &pages_queue, std::array<IntPtr, TLB_SHOOT_DOWN_MAX_SIZE> &phy_addrs, core_id_t init_id, int app_id, int page_num); //向 buffer 中添加 TLB shootdown 请求
       void processTLBShootdownBuffer(bool processing_remote_only); // 处理 buffer 中的 TLB shootdown 请求
-      void handleRemoteTLBShootdownRequest(TLBShootdownRequest &request);
+      void handleRemoteTLBShootdownRequests(std::vector<TLBShootdownRequest*> &requests);
       void handleIPIInterrupt();           // Process TLB shootdown in "kernel mode" (called from Thread::wait)
-      bool hasPendingTLBShootdown();        // Check if buffer has pending remote TLB shootdown requests
+      bool hasPendingTLBShootdown()         // Check if the mailbox has pending TLB shootdown requests
+      { return m_tlb_shootdown_mailbox.load(std::memory_order_acquire) != nullptr || m_tlb_shootdown_deferred.load(std::memory_order_acquire) != nullptr; }
       void handleMsgFromOtherCore(core_id_t sender, PrL1PrL2DramDirectoryMSI::ShmemMsg *shmem_msg);
       void networkHandleTLBShootdownRequest(PrL1PrL2DramDirectoryMSI::ShmemMsg *shmem_msg);
       void networkHandleTLBShootdownAck(PrL1PrL2DramDirectoryMSI::ShmemMsg *shmem_msg);
@@ -260,6 +269,8 @@ class Core
       SubsecondTime ipi_handle_latency;
       SubsecondTime m_tlb_shootdown_total_time;
       UInt64 m_tlb_shootdown_count;
+      UInt64 m_tlb_shootdown_latency_hist[TLB_SHOOTDOWN_LATENCY_BUCKETS];
+      UInt64 m_tlb_shootdown_coalesced; // Remote requests whose flush was merged into an earlier request's pass
 
    protected:
       // Optimized version of countInstruction has direct access to m_instructions and m_instructions_callback
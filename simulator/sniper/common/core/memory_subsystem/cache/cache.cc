@@ -99,6 +99,12 @@ Cache::Cache(
 	{
 		m_pagesizes[i] = page_size[i];
 	}
+	LOG_ASSERT_ERROR(m_number_of_page_sizes <= MAX_TLB_PAGE_SIZES, "%s: at most %d page sizes per TLB are supported", name.c_str(), MAX_TLB_PAGE_SIZES);
+
+	m_tlb_last_hit.page_size_index = -1;
+	m_tlb_last_hit.set_index = 0;
+	m_tlb_last_hit.line_index = 0;
+	m_tlb_filter_hits = 0;
 
 
 	reuse_levels[0] = 5; // kanellok Fix: these thresholds should be configurable
@@ -169,6 +175,9 @@ Cache::Cache(
 		registerStatsMetric(name, core_id, String("tlb-util-") + std::to_string(i).c_str(), &tlb_util[i]);
 	}
 
+	if (m_number_of_page_sizes > 0)
+		registerStatsMetric(name, core_id, "tlb-filter-hits", &m_tlb_filter_hits);
+
 	// registerStatsMetric(name, core_id, String("average_data_reuse"), &average_data_reuse);
 	// registerStatsMetric(name, core_id, String("average_metadata_reuse"), &average_metadata_reuse);
 	// registerStatsMetric(name, core_id, String("average_tlb_reuse"), &average_tlb_reuse);
@@ -232,6 +241,26 @@ bool Cache::invalidateSingleLine(IntPtr addr)
 	return result || fake_result;
 }
 
+// Invalidate every valid line (full TLB / PWC flush), returns the number of lines dropped
+UInt32 Cache::invalidateAll()
+{
+	UInt32 invalidated = 0;
+	for (UInt32 set_index = 0; set_index < m_num_sets; set_index++)
+	{
+		for (UInt32 way = 0; way < m_associativity; way++)
+		{
+			CacheBlockInfo *block_info = m_sets[set_index]->peekBlock(way);
+			if (block_info->isValid())
+			{
+				block_info->invalidate();
+				invalidated++;
+			}
+		}
+	}
+	m_tlb_last_hit.page_size_index = -1;
+	return invalidated;
+}
+
 CacheBlockInfo *
 Cache::accessSingleLine(IntPtr addr, access_t access_type,
 						Byte *buff, UInt32 bytes, SubsecondTime now, bool update_replacement, bool tlb_entry, bool is_metadata)
@@ -412,72 +441,78 @@ CacheBlockInfo *
 Cache::accessSingleLineTLB(IntPtr addr, access_t access_type,
 						   Byte *buff, UInt32 bytes, SubsecondTime now, bool update_replacement)
 {
-	IntPtr tag;
-	UInt32 set_index;
-	UInt32 line_index = -1;
-	UInt32 block_offset;
-	CacheBlockInfo *cache_block_info = NULL;
-	CacheSet *set = NULL;
-	
-	bool found_cache_block = false;
-
-	#ifdef DEBUG_TLB
-		for (int page_size = 0; page_size < m_number_of_page_sizes; page_size++){
-				std::cout << "Testing page size = " << m_pagesizes[page_size];
-			
-		}
-		std::cout << std::endl;
-	#endif
-
+	UInt32 block_offset = 0;
 
+	// Fused probe: derive the (tag, set) candidate of every supported page size first, so the
+	// searches below do not interleave with the index computation
+	IntPtr tags[MAX_TLB_PAGE_SIZES];
+	UInt32 set_indices[MAX_TLB_PAGE_SIZES];
 	for (int page_size = 0; page_size < m_number_of_page_sizes; page_size++)
 	{ // @kanellok iterate over all possible page sizes
+		splitAddressTLB(addr, tags[page_size], set_indices[page_size], m_pagesizes[page_size]); //@kanellok provide the page size to find the index
 
 		#ifdef DEBUG_TLB
 			std::cout << m_name << " lookup: Page size = " << m_pagesizes[page_size] << " Number of page sizes = " <<  m_number_of_page_sizes <<  std::endl;
-		#endif
-		
-		splitAddressTLB(addr, tag, set_index, block_offset, m_pagesizes[page_size]); //@kanellok provide the page size to find the index
-		
-		#ifdef DEBUG_TLB
 			std::cout << "Address =  " << addr << std::endl;
-			std::cout << "Set index =  " << set_index << std::endl;
-			std::cout << "Tag =  " << tag  << std::endl;
+			std::cout << "Set index =  " << set_indices[page_size] << std::endl;
+			std::cout << "Tag =  " << tags[page_size]  << std::endl;
 			std::cout << std::endl;
 		#endif
+	}
 
-		set = m_sets[set_index];
-		cache_block_info = set->find(tag, &line_index);
-
-
-		if (cache_block_info == NULL)
-			continue;
-
-		found_cache_block = true;
-
-		if (access_type == LOAD)
+	// The smallest page size that hits wins, as with the page-size-ordered search.
+	// Consecutive translations mostly hit the same entry, so the way of the previous hit is
+	// checked before searching its set.
+	int hit_page_size = -1;
+	SInt32 line_index = -1;
+	for (int page_size = 0; page_size < m_number_of_page_sizes; page_size++)
+	{
+		CacheSet *set = m_sets[set_indices[page_size]];
+		if (page_size == m_tlb_last_hit.page_size_index
+			&& set_indices[page_size] == m_tlb_last_hit.set_index
+			&& set->peekBlock(m_tlb_last_hit.line_index)->getTag() == tags[page_size])
 		{
-			// NOTE: assumes error occurs in memory. If we want to model bus errors, insert the error into buff instead
-			if (m_fault_injector)
-				m_fault_injector->preRead(addr, set_index * m_associativity + line_index, bytes, (Byte *)m_sets[set_index]->getDataPtr(line_index, block_offset), now);
-
-			set->read_line(line_index, block_offset, buff, bytes, update_replacement);
+			line_index = m_tlb_last_hit.line_index;
+			m_tlb_filter_hits++;
 		}
 		else
 		{
-			set->write_line(line_index, block_offset, buff, bytes, update_replacement);
+			line_index = set->findWay(tags[page_size]);
+		}
 
-			if (m_fault_injector)
-				m_fault_injector->postWrite(addr, set_index * m_associativity + line_index, bytes, (Byte *)m_sets[set_index]->getDataPtr(line_index, block_offset), now);
+		if (line_index >= 0)
+		{
+			hit_page_size = page_size;
+			break;
 		}
-		break;
 	}
 
+	if (hit_page_size < 0)
+		return NULL;
+
+	UInt32 set_index = set_indices[hit_page_size];
+	CacheSet *set = m_sets[set_index];
+	m_tlb_last_hit.page_size_index = hit_page_size;
+	m_tlb_last_hit.set_index = set_index;
+	m_tlb_last_hit.line_index = line_index;
 
-	if (found_cache_block)
-		return cache_block_info;
+	if (access_type == LOAD)
+	{
+		// NOTE: assumes error occurs in memory. If we want to model bus errors, insert the error into buff instead
+		if (m_fault_injector)
+			m_fault_injector->preRead(addr, set_index * m_associativity + line_index, bytes, (Byte *)set->getDataPtr(line_index, block_offset), now);
+
+		set->read_line(line_index, block_offset, buff, bytes, update_replacement);
+	}
 	else
-		return NULL;
+	{
+		set->write_line(line_index, block_offset, buff, bytes, update_replacement);
+
+		if (m_fault_injector)
+			m_fault_injector->postWrite(addr, set_index * m_associativity + line_index, bytes, (Byte *)set->getDataPtr(line_index, block_offset), now);
+	}
+
+	return set->peekBlock(line_index);
 }
 
 void Cache::insertSingleLineTLB(IntPtr addr, Byte *fill_buff,
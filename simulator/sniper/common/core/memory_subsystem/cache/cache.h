@@ -38,6 +38,19 @@ private:
 	int m_number_of_page_sizes;
 	bool m_is_tlb;
 
+	// TLB lookups probe every supported page size; the candidates are computed up front
+	static const int MAX_TLB_PAGE_SIZES = 8;
+
+	// Last-hit filter for TLB lookups: (page size index, set, way) of the previous hit.
+	// It is only a hint, the block tag is re-checked before it is trusted.
+	struct tlb_last_hit_t
+	{
+		int page_size_index; // -1 when empty
+		UInt32 set_index;
+		UInt32 line_index;
+	} m_tlb_last_hit;
+	UInt64 m_tlb_filter_hits;
+
 	int reuse_levels[3];
 
 	float average_data_reuse;
@@ -97,6 +110,7 @@ public:
 	Lock &getSetLock(IntPtr addr);
 
 	bool invalidateSingleLine(IntPtr addr);
+	UInt32 invalidateAll();
 	CacheBlockInfo *accessSingleLine(IntPtr addr,
 									 access_t access_type, Byte *buff, UInt32 bytes, SubsecondTime now, bool update_replacement, bool tlb_entry = false, bool is_metadata = false);
 	CacheBlockInfo *accessSingleLineTLB(IntPtr addr,
@@ -5,6 +5,8 @@
 #include "log.h"
 #include "config.hpp"
 
+#include <new>
+
 const char *CacheBlockInfo::option_names[] =
     {
         "prefetch",
@@ -31,7 +33,9 @@ CacheBlockInfo::CacheBlockInfo(IntPtr tag, CacheState::cstate_t cstate, UInt64 o
                                                                                           m_options(options),
                                                                                           m_block_type(NON_PAGE_TABLE),
                                                                                           m_reuse(0),
-                                                                                          utilization(0)
+                                                                                          utilization(0),
+                                                                                          m_expiration_time(0),
+                                                                                          m_tag_mirror(NULL)
 
 {
 }
@@ -61,15 +65,55 @@ CacheBlockInfo::create(CacheBase::cache_t cache_type)
    }
 }
 
+size_t
+CacheBlockInfo::getSize(CacheBase::cache_t cache_type)
+{
+   switch (cache_type)
+   {
+   case CacheBase::PR_L1_CACHE:
+      return sizeof(PrL1CacheBlockInfo);
+
+   case CacheBase::PR_L2_CACHE:
+      return sizeof(PrL2CacheBlockInfo);
+
+   case CacheBase::SHARED_CACHE:
+      return sizeof(SharedCacheBlockInfo);
+
+   default:
+      LOG_PRINT_ERROR("Unrecognized cache type (%u)", cache_type);
+      return 0;
+   }
+}
+
+CacheBlockInfo *
+CacheBlockInfo::create(CacheBase::cache_t cache_type, void *storage)
+{
+   switch (cache_type)
+   {
+   case CacheBase::PR_L1_CACHE:
+      return new (storage) PrL1CacheBlockInfo();
+
+   case CacheBase::PR_L2_CACHE:
+      return new (storage) PrL2CacheBlockInfo();
+
+   case CacheBase::SHARED_CACHE:
+      return new (storage) SharedCacheBlockInfo();
+
+   default:
+      LOG_PRINT_ERROR("Unrecognized cache type (%u)", cache_type);
+      return NULL;
+   }
+}
+
 void CacheBlockInfo::invalidate()
 {
-   m_tag = ~0;
+   setTag(~0);
    m_cstate = CacheState::INVALID;
 }
 
 void CacheBlockInfo::clone(CacheBlockInfo *cache_block_info)
 {
-   m_tag = cache_block_info->getTag();
+   setTag(cache_block_info->getTag());
    m_cstate = cache_block_info->getCState();
    m_owner = cache_block_info->m_owner;
    m_used = cache_block_info->m_used;
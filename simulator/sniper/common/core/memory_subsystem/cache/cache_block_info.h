@@ -49,6 +49,7 @@ private:
 	int m_reuse; //@kanellok tracking reuse
 	int utilization;
 	UInt32 m_expiration_time; // SITE: expiration time for TLB entries (in logical clock units)
+	IntPtr *m_tag_mirror;	  // Slot in the owning CacheSet's tag array kept in sync with m_tag (NULL for standalone blocks)
 
 	static const char *option_names[];
 
@@ -60,6 +61,10 @@ public:
 	virtual ~CacheBlockInfo();
 
 	static CacheBlockInfo *create(CacheBase::cache_t cache_type);
+	// Placement variants used by CacheSet to lay out all blocks of a set contiguously
+	static size_t getSize(CacheBase::cache_t cache_type);
+	static CacheBlockInfo *create(CacheBase::cache_t cache_type, void *storage);
+	void bindTagMirror(IntPtr *tag_slot) { m_tag_mirror = tag_slot; *m_tag_mirror = m_tag; }
 	virtual void invalidate(void);
 	virtual void clone(CacheBlockInfo *cache_block_info);
 
@@ -70,7 +75,7 @@ public:
 
 	CacheState::cstate_t getCState() const { return m_cstate; }
 
-	void setTag(IntPtr tag) { m_tag = tag; }
+	void setTag(IntPtr tag) { m_tag = tag; if (m_tag_mirror) *m_tag_mirror = tag; }
 
 	void setCState(CacheState::cstate_t cstate) { m_cstate = cstate; }
 	void setPPN(IntPtr _ppn) { ppn = _ppn; };
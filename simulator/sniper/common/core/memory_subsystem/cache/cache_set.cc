@@ -13,14 +13,27 @@
 #include "config.h"
 #include "config.hpp"
 
+#include <cstdlib>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 CacheSet::CacheSet(CacheBase::cache_t cache_type,
       UInt32 associativity, UInt32 blocksize, bool is_tlb_set):
       m_associativity(associativity), m_blocksize(blocksize), m_is_tlb_set(is_tlb_set), inserts(0), evictions(0), invalidations(0)
 {
+   // Round the tag array up to whole host cache lines so SIMD loads never run past the end
+   size_t tags_bytes = ((m_associativity * sizeof(IntPtr) + 63) / 64) * 64;
+   m_tags = static_cast<IntPtr*>(aligned_alloc(64, tags_bytes));
+   std::fill(m_tags, m_tags + tags_bytes / sizeof(IntPtr), (IntPtr)~0);
+
+   size_t block_stride = (CacheBlockInfo::getSize(cache_type) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+   m_block_info_storage = new char[m_associativity * block_stride];
    m_cache_block_info_array = new CacheBlockInfo*[m_associativity];
    for (UInt32 i = 0; i < m_associativity; i++)
    {
-      m_cache_block_info_array[i] = CacheBlockInfo::create(cache_type);
+      m_cache_block_info_array[i] = CacheBlockInfo::create(cache_type, m_block_info_storage + i * block_stride);
+      m_cache_block_info_array[i]->bindTagMirror(&m_tags[i]);
    }
 
    if (Sim()->getFaultinjectionManager())
@@ -35,8 +48,10 @@ CacheSet::CacheSet(CacheBase::cache_t cache_type,
 CacheSet::~CacheSet()
 {
    for (UInt32 i = 0; i < m_associativity; i++)
-      delete m_cache_block_info_array[i];
+      m_cache_block_info_array[i]->~CacheBlockInfo();
    delete [] m_cache_block_info_array;
+   delete [] m_block_info_storage;
+   free(m_tags);
    delete [] m_blocks;
 }
 
@@ -66,34 +81,57 @@ CacheSet::write_line(UInt32 line_index, UInt32 offset, Byte *in_buff, UInt32 byt
       updateReplacementIndex(line_index);
 }
 
-CacheBlockInfo*
-CacheSet::find(IntPtr tag, UInt32* line_index)
+// Returns the highest way holding tag, or -1
+SInt32
+CacheSet::findWay(IntPtr tag) const
 {
-   for (SInt32 index = m_associativity-1; index >= 0; index--)
+#if defined(__SSE2__)
+   if (sizeof(IntPtr) == 8 && m_associativity >= 4 && m_associativity <= 32)
    {
-      if (m_cache_block_info_array[index]->getTag() == tag)
+      // Compare two tags per step: 32-bit equality on both halves, then AND the halves together
+      const __m128i key = _mm_set1_epi64x(tag);
+      UInt32 match = 0;
+      for (UInt32 way = 0; way < m_associativity; way += 2)
       {
-         if (line_index != NULL)
-            *line_index = index;
-         return (m_cache_block_info_array[index]);
+         __m128i eq = _mm_cmpeq_epi32(_mm_load_si128((const __m128i*)&m_tags[way]), key);
+         eq = _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+         match |= _mm_movemask_pd(_mm_castsi128_pd(eq)) << way;
       }
+      // An odd associativity compares one padding slot past the end; drop it
+      match &= (m_associativity == 32) ? ~0U : ((1U << m_associativity) - 1);
+      return match ? 31 - __builtin_clz(match) : -1;
    }
-   return NULL;
+#endif
+   for (SInt32 index = m_associativity-1; index >= 0; index--)
+   {
+      if (m_tags[index] == tag)
+         return index;
+   }
+   return -1;
+}
+
+CacheBlockInfo*
+CacheSet::find(IntPtr tag, UInt32* line_index)
+{
+   SInt32 index = findWay(tag);
+   if (index < 0)
+      return NULL;
+
+   if (line_index != NULL)
+      *line_index = index;
+   return (m_cache_block_info_array[index]);
 }
 
 bool
 CacheSet::invalidate(IntPtr& tag)
 {
-   for (SInt32 index = m_associativity-1; index >= 0; index--)
-   {
-      if (m_cache_block_info_array[index]->getTag() == tag)
-      {
-         m_cache_block_info_array[index]->invalidate();
-         return true;
-         invalidations++;
-      }
-   }
-   return false;
+   SInt32 index = findWay(tag);
+   if (index < 0)
+      return false;
+
+   m_cache_block_info_array[index]->invalidate();
+   invalidations++;
+   return true;
 }
 
 void
@@ -30,6 +30,11 @@ class CacheSet
 
    protected:
 
+      // Tags are kept in their own contiguous array (mirrored by each CacheBlockInfo) so find()
+      // only touches assoc*8 bytes; the remaining per-block state lives in one contiguous
+      // buffer that m_cache_block_info_array points into.
+      IntPtr* m_tags;
+      char* m_block_info_storage;
       CacheBlockInfo** m_cache_block_info_array;
       char* m_blocks;
       UInt32 m_associativity;
@@ -58,6 +63,7 @@ class CacheSet
       void insert(CacheBlockInfo* cache_block_info, Byte* fill_buff, bool* eviction, CacheBlockInfo* evict_block_info, Byte* evict_buff, CacheCntlr *cntlr = NULL);
 
       CacheBlockInfo* peekBlock(UInt32 way) const { return m_cache_block_info_array[way]; }
+      SInt32 findWay(IntPtr tag) const;
 
       char* getDataPtr(UInt32 line_index, UInt32 offset = 0);
       UInt32 getBlockSize(void) const { return m_blocksize; }
@@ -115,6 +115,12 @@ public:
    bool getPageMigrationEnable(){return page_migration_enable;}
    void setPageMigrationEnable(){page_migration_enable = true;}
    virtual bool MMFlushTLB(int appid, IntPtr address, Core::lock_signal_t lock, bool modeled){ return false; }
+   // Flush a batch of pages from the TLBs, flushed[i] tells whether addresses[i] was present
+   virtual void MMFlushTLBBatch(int appid, const IntPtr *addresses, int count, bool *flushed, Core::lock_signal_t lock, bool modeled)
+   {
+      for (int i = 0; i < count; i++)
+         flushed[i] = MMFlushTLB(appid, addresses[i], lock, modeled);
+   }
    virtual void flushCachePage(IntPtr page_address, MemComponent::component_t cache_level) {}
    virtual void flushEntireL1DCache() {}
 };
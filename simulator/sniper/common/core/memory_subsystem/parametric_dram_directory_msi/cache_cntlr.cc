@@ -204,6 +204,7 @@ namespace ParametricDramDirectoryMSI
 													   m_prefetch_on_prefetch_hit(false),
 													   m_l1_mshr(cache_params.outstanding_misses > 0),
 													   m_l1_metadata_mshr(cache_params.outstanding_misses > 0),
+													   m_cache_usage_enabled(Sim()->getCfg()->getBool("perf_model/cache_usage/enabled")),
 													   m_core_id(core_id),
 													   m_cache_block_size(cache_block_size),
 													   m_cache_writethrough(cache_params.writethrough),
@@ -777,7 +778,7 @@ namespace ParametricDramDirectoryMSI
 				//  }
 
 				// Change Sim()->getConfig()->hasCacheEfficiencyCallbacks()
-				if (modeled && m_next_cache_cntlr && !m_perfect && Sim()->getCfg()->getBool("perf_model/cache_usage/enabled"))
+				if (modeled && m_next_cache_cntlr && !m_perfect && m_cache_usage_enabled)
 				{
 					bool new_bits = cache_block_info->updateUsage(offset, data_length);
 					if (new_bits)
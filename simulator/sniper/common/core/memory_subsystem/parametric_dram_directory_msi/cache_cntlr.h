@@ -214,6 +214,7 @@ namespace ParametricDramDirectoryMSI
          bool m_prefetch_on_prefetch_hit;
          bool m_l1_mshr;
          bool m_l1_metadata_mshr;
+         bool m_cache_usage_enabled; // perf_model/cache_usage/enabled, checked on every hit
          int mshr_size;
 
 
@@ -79,6 +79,7 @@ namespace ParametricDramDirectoryMSI
 		ComponentLatency dram_directory_cache_access_time(global_domain, 0);
 
 		current_nuca_stamp = 0;
+		m_mmu_is_midgard = false;
 
 		try
 		{
@@ -88,10 +89,12 @@ namespace ParametricDramDirectoryMSI
 
 			m_native_environment = Sim()->getCfg()->getBool("general/native_environment");
 			m_virtualized_environment = Sim()->getCfg()->getBool("general/virtualized_environment");
+			m_translation_enabled = Sim()->getCfg()->getBool("general/translation_enabled");
 
 
 			if(m_native_environment){
 				mmu_type = Sim()->getCfg()->getString("perf_model/mmu/type");
+				m_mmu_is_midgard = (mmu_type == "midgard");
 				m_mmu = MMUFactory::createMemoryManagementUnit(mmu_type, core, this, shmem_perf_model, "mmu");
 			}
 			else if (m_virtualized_environment) {
@@ -486,21 +489,16 @@ namespace ParametricDramDirectoryMSI
 		Core::MemModeled modeled)
 	{
 
-		bool translation_enabled;
-
 		bool count = (modeled == Core::MEM_MODELED_NONE) ? false : true;
 
 		#ifdef DEBUG_MEM_MANAGER
 			log_file_mmu << "Memory Access: " << address << " Initiating Translation at time " << getShmemPerfModel()->getElapsedTime(ShmemPerfModel::_USER_THREAD).getNS() << std::endl;
 		#endif
 
-		// Check if translation is enabled
-		translation_enabled = Sim()->getCfg()->getBool("general/translation_enabled");
-
 		bool skip_translation = false;
 
 		// We skip translation for mimicOS as we assume that the addresses are already physical
-		if (Sim()->getCoreManager()->getCoreFromID(getCore()->getId())->getThread()->m_os_info.m_virtuos_app || translation_enabled == false)
+		if (getCore()->getThread()->m_os_info.m_virtuos_app || m_translation_enabled == false)
 		{
 			skip_translation = true;
 		}
@@ -515,7 +513,7 @@ namespace ParametricDramDirectoryMSI
 		SubsecondTime t_start_translation = getShmemPerfModel()->getElapsedTime(ShmemPerfModel::_USER_THREAD);
 		// In the case of [Gupta et al. Midgard ISCA 2021], we need to perform the translation in two steps
 		// The first step is to perform the translation in the frontend from the virtual address to the intermediate address
-		if (mmu_type == "midgard" && !skip_translation)
+		if (m_mmu_is_midgard && !skip_translation)
 		{
 			translation_result = m_mmu->performAddressTranslationFrontend(eip, address,
 																		  is_instruction,
@@ -634,7 +632,7 @@ namespace ParametricDramDirectoryMSI
 	
 
 		// If the memory access is a page table access, we need to update the translation stats
-		if (mmu_type == "midgard")
+		if (m_mmu_is_midgard)
 		{
 
 			if (result == HitWhere::where_t::DRAM || result == HitWhere::where_t::DRAM_CACHE || result == HitWhere::where_t::DRAM_LOCAL || result == HitWhere::where_t::DRAM_REMOTE)
@@ -872,6 +870,12 @@ namespace ParametricDramDirectoryMSI
 				modeled == Core::MEM_MODELED_NONE ? false : true);
 	}
 
+	void MemoryManager::MMFlushTLBBatch(int appid, const IntPtr *addresses, int count, bool *flushed, Core::lock_signal_t lock, bool modeled) {
+		m_mmu->MMUFlushTLBBatch(appid, addresses, count, flushed, lock,
+			modeled == Core::MEM_MODELED_NONE || modeled == Core::MEM_MODELED_COUNT ? false : true,
+				modeled == Core::MEM_MODELED_NONE ? false : true);
+	}
+
 	void MemoryManager::flushCachePage(IntPtr page_address, MemComponent::component_t cache_level) {
 		UInt32 page_size = 4096; // 4KB
 		UInt32 num_cache_lines = page_size / m_cache_block_size;
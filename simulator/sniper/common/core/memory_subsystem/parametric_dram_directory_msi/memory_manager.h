@@ -47,6 +47,7 @@ namespace ParametricDramDirectoryMSI
 
 		MemoryManagementUnitBase *m_mmu; //	Responsible for handling address translation
 		String mmu_type; // MMU type (Default, Range, Midgard, POMTLB, Utopia)
+		bool m_mmu_is_midgard; // mmu_type == "midgard", resolved once so the access path does not compare strings
 		bool m_native_environment; // Native execution
 		bool m_virtualized_environment; // We are running in a virtualized environment
 
@@ -65,7 +66,7 @@ namespace ParametricDramDirectoryMSI
 		UInt32 m_cache_block_size;
 		MemComponent::component_t m_last_level_cache;
 		bool m_enabled;
-		bool m_translation_enabled;
+		bool m_translation_enabled; // general/translation_enabled, read once at construction
 		ShmemPerf m_dummy_shmem_perf;
 
 		// Performance Models
@@ -165,6 +166,7 @@ namespace ParametricDramDirectoryMSI
 		void incrElapsedTime(SubsecondTime latency, ShmemPerfModel::Thread_t thread_num = ShmemPerfModel::NUM_CORE_THREADS);
 		void incrElapsedTime(MemComponent::component_t mem_component, CachePerfModel::CacheAccess_t access_type, ShmemPerfModel::Thread_t thread_num = ShmemPerfModel::NUM_CORE_THREADS);
 		bool MMFlushTLB(int appid, IntPtr address, Core::lock_signal_t lock, bool modeled) override;
+		void MMFlushTLBBatch(int appid, const IntPtr *addresses, int count, bool *flushed, Core::lock_signal_t lock, bool modeled) override;
 		void flushCachePage(IntPtr page_address, MemComponent::component_t cache_level) override;
 		void flushEntireL1DCache() override;
 	};
@@ -141,10 +141,10 @@ namespace ParametricDramDirectoryMSI
 	 * @param lock The lock signal for the core.
 	 * @return SubsecondTime The total latency incurred during the page table walk.
 	 */
-	SubsecondTime MemoryManagementUnitBase::calculatePTWCycles(PTWResult ptw_result, bool count, bool modeled, IntPtr eip, Core::lock_signal_t lock)
+	SubsecondTime MemoryManagementUnitBase::calculatePTWCycles(const PTWResult &ptw_result, bool count, bool modeled, IntPtr eip, Core::lock_signal_t lock)
 	{
 
-		accessedAddresses accesses = get<1>(ptw_result);
+		const accessedAddresses &accesses = get<1>(ptw_result);
 
 		translationPacket packet;
 		packet.eip = eip; 
@@ -346,29 +346,26 @@ namespace ParametricDramDirectoryMSI
 			log_file_mmu << std::endl;
 			log_file_mmu << "[MMU_BASE]-------------- Starting PTW for address: " << address << std::endl;
 #endif
-			auto ptw_result = page_table->initializeWalk(address, count, is_prefetch, restart_walk);
+			PTWResult ptw_result;
+			page_table->initializeWalk(address, count, ptw_result, is_prefetch, restart_walk);
 
 			
 
 			// We will filter out the re-walked addresses which anyways either hit in the PWC or are redundant
-			accessedAddresses visited_pts = get<1>(ptw_result);
+			accessedAddresses &visited_pts = get<1>(ptw_result);
 			std::sort(visited_pts.begin(), visited_pts.end());
 			visited_pts.erase(std::unique(visited_pts.begin(), visited_pts.end()), visited_pts.end());
 
-
-			ptw_result = make_tuple(get<0>(ptw_result), visited_pts, get<2>(ptw_result), get<3>(ptw_result), get<4>(ptw_result), get<5> (ptw_result), get<6>(ptw_result));
-
 			// Filter the PTW result based on the page table type
 			// This filtering is necessary to remove any redundant accesses that may hit in the PWC
 
-			if ((page_table->getType() == "radix") && (nested_mmu == nullptr))
+			if (page_table->isRadix() && (nested_mmu == nullptr))
 			{
-				ptw_result = filterPTWResult(ptw_result, page_table, count);
+				filterPTWResult(ptw_result, page_table, count);
 			}
 
 #ifdef DEBUG_MMU
 			log_file_mmu << "[MMU_BASE] We accessed " << get<1>(ptw_result).size() << " addresses" << std::endl;
-			visited_pts = get<1>(ptw_result);
 			for (UInt32 i = 0; i < visited_pts.size(); i++)
 			{
 				log_file_mmu << "[MMU_BASE] Address: " << get<2>(visited_pts[i]) << " Level: " << get<1>(visited_pts[i]) << " Table: " << get<0>(visited_pts[i]) << " Correct Translation: " << get<3>(visited_pts[i]) << std::endl;
@@ -379,9 +376,10 @@ namespace ParametricDramDirectoryMSI
 			IntPtr ppn_result = get<2>(ptw_result);
 			bool is_pagefault = get<4>(ptw_result);
 			pageFaultType pfReason = get<5>(ptw_result);
-			PTWResult retry_result = ptw_result;
+			SubsecondTime t_last_DMA_finish = get<6>(ptw_result);
 			if (is_pagefault && pfReason == PF_MOVING) {
 				pf_cause_by_moving = true;
+				PTWResult retry_result;
 				while (pfReason == PF_MOVING) {
 					// spin here
 					if (!Sim()->isRunning()) {
@@ -389,15 +387,15 @@ namespace ParametricDramDirectoryMSI
 					}
 					getCore()->processTLBShootdownBuffer(false);
 					sched_yield(); 
-					retry_result = page_table->initializeWalk(address, false, is_prefetch, restart_walk);
+					page_table->initializeWalk(address, false, retry_result, is_prefetch, restart_walk);
 					pfReason = get<5>(retry_result);
+					t_last_DMA_finish = get<6>(retry_result);
 				}
 				is_pagefault = false;
 			}
 			
 			SubsecondTime ptw_cycles = calculatePTWCycles(ptw_result, count, modeled, eip, lock);
 
-			SubsecondTime t_last_DMA_finish = get<6>(retry_result);
 			SubsecondTime t_now = getCore()->getPerformanceModel()->getElapsedTime();
 			if (t_last_DMA_finish > SubsecondTime::Zero()) {
 				if (t_now < t_last_DMA_finish) {
@@ -66,7 +66,7 @@ namespace ParametricDramDirectoryMSI
 		void instantiatePageTableWalker();
 		void instantiateTLBSubsystem();
 		virtual void registerMMUStats() = 0;
-		accessedAddresses getAccessesForNest(){
+		const accessedAddresses& getAccessesForNest(){
 
 			return accesses_for_nest;
 		}
@@ -79,16 +79,21 @@ namespace ParametricDramDirectoryMSI
 		virtual IntPtr performAddressTranslationFrontend(IntPtr eip, IntPtr address, bool instruction, Core::lock_signal_t lock, bool modeled, bool count){ return IntPtr(0); };
 		virtual IntPtr performAddressTranslationBackend(IntPtr eip, IntPtr address, bool instruction, Core::lock_signal_t lock, bool modeled, bool count){ return IntPtr(0); };
 		virtual SubsecondTime accessCache(translationPacket packet, SubsecondTime t_start = SubsecondTime::Zero(),bool is_prefetch = false);
-		virtual PTWResult filterPTWResult(PTWResult ptw_result, PageTable *page_table, bool count) = 0;
+		virtual void filterPTWResult(PTWResult &ptw_result, PageTable *page_table, bool count) = 0; // Drops, in place, the accesses that are served by the translation caches
 		virtual void discoverVMAs() = 0;
 
 		int getDramAccessesDuringLastWalk() { return dram_accesses_during_last_walk; }
 		virtual tuple<SubsecondTime, bool, IntPtr, int> performPTW(IntPtr address, bool modeled, bool count, bool is_prefetch, IntPtr eip, Core::lock_signal_t lock, PageTable *page_table, bool restart_walk);
-		pair<SubsecondTime, SubsecondTime> calculatePFCycles(PTWResult ptw_result, bool count, bool modeled, IntPtr eip, Core::lock_signal_t lock);
-		SubsecondTime calculatePTWCycles(PTWResult ptw_result, bool count, bool modeled, IntPtr eip, Core::lock_signal_t lock);
+		pair<SubsecondTime, SubsecondTime> calculatePFCycles(const PTWResult &ptw_result, bool count, bool modeled, IntPtr eip, Core::lock_signal_t lock);
+		SubsecondTime calculatePTWCycles(const PTWResult &ptw_result, bool count, bool modeled, IntPtr eip, Core::lock_signal_t lock);
 		Core* getCore() { return core; }
 		String getName() { return name; }
 		virtual bool MMUFlushTLB(int appid, IntPtr address, Core::lock_signal_t lock, bool modeled, bool count) {return false;}
+		virtual void MMUFlushTLBBatch(int appid, const IntPtr *addresses, int num_addresses, bool *flushed, Core::lock_signal_t lock, bool modeled, bool count)
+		{
+			for (int i = 0; i < num_addresses; i++)
+				flushed[i] = MMUFlushTLB(appid, addresses[i], lock, modeled, count);
+		}
 		virtual void addPageMigrationWaitTime(SubsecondTime time) {}
 	};
 }
\ No newline at end of file
@@ -12,6 +12,7 @@
 #include "core.h"
 #include "thread.h"
 #include "site_clock.h"
+#include "translation_trace.h"
 #include <iostream>
 #include <fstream>
 #include <algorithm>
@@ -29,7 +30,7 @@ namespace ParametricDramDirectoryMSI
 {
 
 	MemoryManagementUnit::MemoryManagementUnit(Core *_core, MemoryManager *_memory_manager, ShmemPerfModel *_shmem_perf_model, String _name, MemoryManagementUnitBase *_nested_mmu)
-	: MemoryManagementUnitBase(_core, _memory_manager, _shmem_perf_model, _name, _nested_mmu), memory_manager(_memory_manager)
+	: MemoryManagementUnitBase(_core, _memory_manager, _shmem_perf_model, _name, _nested_mmu), memory_manager(_memory_manager), pwc(NULL), m_pwc_enabled(false), m_cheetah(NULL)
 	{
 		std::cout << std::endl;
 		std::cout << "[MMU] Initializing MMU for core " << core->getId() << std::endl;
@@ -43,6 +44,18 @@ namespace ParametricDramDirectoryMSI
 		instantiateTLBSubsystem(); // This instantiates the TLB hierarchy
 		registerMMUStats(); // This instantiates the MMU stats
 
+		if (Sim()->getCfg()->hasKey("perf_model/" + name + "/cheetah/enabled") && Sim()->getCfg()->getBool("perf_model/" + name + "/cheetah/enabled"))
+		{
+			MimicOS *os = Sim()->getMimicOS();
+			m_cheetah = new TranslationCheetah(name, "perf_model/" + name + "/cheetah", core->getId(), os->getNumberOfPageSizes(), os->getPageSizeList(), m_pwc_enabled ? max_pwc_level : 0);
+			std::cout << "[MMU] Single-pass TLB/PWC geometry exploration (cheetah) is enabled" << std::endl;
+		}
+
+		if (Sim()->getCfg()->hasKey("migration/tlb_full_flush_threshold"))
+			m_full_flush_threshold = Sim()->getCfg()->getInt("migration/tlb_full_flush_threshold");
+		else
+			m_full_flush_threshold = 0;
+
 		// SITE: read config
 		if (Sim()->getCfg()->hasKey("site/enabled"))
 			m_site_enabled = Sim()->getCfg()->getBool("site/enabled");
@@ -91,6 +104,7 @@ namespace ParametricDramDirectoryMSI
 		log_file.close();
 		delete tlb_subsystem;
 		delete pt_walkers;
+		delete m_cheetah;
 		delete[] translation_stats.tlb_latency_per_level;
 		delete[] translation_stats.tlb_hit_page_sizes;
 	}
@@ -158,6 +172,7 @@ namespace ParametricDramDirectoryMSI
 		registerStatsMetric(name, core->getId(), "total_translation_latency", &translation_stats.total_translation_latency);
 		registerStatsMetric(name, core->getId(), "total_fault_latency", &translation_stats.total_fault_latency);
 		registerStatsMetric(name, core->getId(), "page_migration_wait_time", &translation_stats.page_migration_wait_time);
+		registerStatsMetric(name, core->getId(), "tlb_full_flush", &translation_stats.tlb_full_flush);
 
 		// SITE stats
 		registerStatsMetric(name, core->getId(), "site_expired_misses", &translation_stats.site_expired_misses);
@@ -211,7 +226,7 @@ namespace ParametricDramDirectoryMSI
 		if (count)
 			translation_stats.num_translations++;
 
-		TLBSubsystem tlbs = tlb_subsystem->getTLBSubsystem(); // Get the TLB hierarchy
+		const TLBSubsystem *tlbs = &tlb_subsystem->getTLBSubsystem(); // Get the TLB hierarchy (by pointer, the nested vectors are not copied per translation)
 
 		//  This is the time we start the translation process 
 		// If there is a metadata table, we need to walk it to get the metadata information
@@ -228,14 +243,14 @@ namespace ParametricDramDirectoryMSI
 
 		IntPtr ppn_result = 0;
 		// We iterate through the TLB hierarchy to find if there is a TLB hit
-		for (UInt32 i = 0; i < tlbs.size(); i++)
+		for (UInt32 i = 0; i < tlbs->size(); i++)
 		{
 #ifdef DEBUG_MMU
 			log_file << "[MMU] Searching TLB at level: " << i << std::endl;
 #endif
-			for (UInt32 j = 0; j < tlbs[i].size(); j++)
+			for (UInt32 j = 0; j < (*tlbs)[i].size(); j++)
 			{
-				bool tlb_stores_instructions = (tlbs[i][j]->getType() == TLBtype::Instruction) || (tlbs[i][j]->getType() == TLBtype::Unified);
+				bool tlb_stores_instructions = ((*tlbs)[i][j]->getType() == TLBtype::Instruction) || ((*tlbs)[i][j]->getType() == TLBtype::Unified);
 
 				// If the TLB stores instructions, we need to check if the address is an instruction address
 				if (tlb_stores_instructions && instruction)
@@ -243,26 +258,26 @@ namespace ParametricDramDirectoryMSI
 					// @kanellok: Passing the page table to the TLB lookup function is a legacy from the old TLB implementation. 
 					// It is not used in the current implementation.
 
-					tlb_block_info = tlbs[i][j]->lookup(address, time, count, lock, eip, modeled, count, NULL);
+					tlb_block_info = (*tlbs)[i][j]->lookup(address, time, count, lock, eip, modeled, count, NULL);
 
 					if (tlb_block_info != NULL) // If we have a hit in TLB
 					{
 						tlb_block_info_hit = tlb_block_info;
-						hit_tlb = tlbs[i][j]; // Keep track of the TLB that hit
+						hit_tlb = (*tlbs)[i][j]; // Keep track of the TLB that hit
 						hit_level = i; // Keep track of the level of the TLB that hit
 						hit = true; // We have a hit
 					}
 				}
 				else if (!instruction)
 				{
-					bool tlb_stores_data = !(tlbs[i][j]->getType() == TLBtype::Instruction);
+					bool tlb_stores_data = !((*tlbs)[i][j]->getType() == TLBtype::Instruction);
 					if (tlb_stores_data)
 					{
-						tlb_block_info = tlbs[i][j]->lookup(address, time, count, lock, eip, modeled, count, NULL);
+						tlb_block_info = (*tlbs)[i][j]->lookup(address, time, count, lock, eip, modeled, count, NULL);
 						if (tlb_block_info != NULL)
 						{
 							tlb_block_info_hit = tlb_block_info;
-							hit_tlb = tlbs[i][j];
+							hit_tlb = (*tlbs)[i][j];
 							hit_level = i;
 							hit = true;
 						}
@@ -291,18 +306,18 @@ namespace ParametricDramDirectoryMSI
 			#endif
 			
 			if (instruction)
-				tlbs = tlb_subsystem->getInstructionPath(); // Get the TLB path for instructions
+				tlbs = &tlb_subsystem->getInstructionPath(); // Get the TLB path for instructions
 			else
-				tlbs = tlb_subsystem->getDataPath(); // Get the TLB path for data
+				tlbs = &tlb_subsystem->getDataPath(); // Get the TLB path for data
 
 			SubsecondTime tlb_latency[hit_level + 1]; // We need to keep track of the latency of the TLBs at each level of the hierarchy
 
 			// We iterate through the TLBs to find the slowest component at each level of the hierarchy until the level where we had a hit
 			for (int i = 0; i < hit_level; i++) 
 			{
-				for (UInt32 j = 0; j < tlbs[i].size(); j++) 
+				for (UInt32 j = 0; j < (*tlbs)[i].size(); j++) 
 				{
-					tlb_latency[i] = max(tlbs[i][j]->getLatency(), tlb_latency[i]);
+					tlb_latency[i] = max((*tlbs)[i][j]->getLatency(), tlb_latency[i]);
 				}
 #ifdef DEBUG_MMU
 				log_file << "[MMU] Charging TLB Latency: " << tlb_latency[i] << " at level: " << i << std::endl;
@@ -312,9 +327,9 @@ namespace ParametricDramDirectoryMSI
 				charged_tlb_latency += tlb_latency[i];
 			}
 
-			for (UInt32 j = 0; j < tlbs[hit_level].size(); j++) // We iterate through the TLBs in the level where we had a hit
+			for (UInt32 j = 0; j < (*tlbs)[hit_level].size(); j++) // We iterate through the TLBs in the level where we had a hit
 			{ 
-				if (tlbs[hit_level][j] == hit_tlb) // We find the TLB that hit
+				if ((*tlbs)[hit_level][j] == hit_tlb) // We find the TLB that hit
 				{
 					translation_stats.total_tlb_latency += hit_tlb->getLatency(); // We charge the latency of the TLB that hit
 					charged_tlb_latency += hit_tlb->getLatency();
@@ -339,7 +354,7 @@ namespace ParametricDramDirectoryMSI
 		// If we have a TLB miss, we need to charge the TLB latency based on the slowest component 
 		// at each level of the hierarchy
 		
-		SubsecondTime tlb_latency[tlbs.size()];
+		SubsecondTime tlb_latency[tlbs->size()];
 
 
 		// If we have a TLB miss, we need to charge the TLB latency based on the slowest component	
@@ -351,11 +366,11 @@ namespace ParametricDramDirectoryMSI
 #ifdef DEBUG_MMU
 			log_file << "[MMU] TLB Miss" << std::endl;
 #endif
-			for (UInt32 i = 0; i < tlbs.size(); i++) 
+			for (UInt32 i = 0; i < tlbs->size(); i++) 
 			{
-				for (UInt32 j = 0; j < tlbs[i].size(); j++)
+				for (UInt32 j = 0; j < (*tlbs)[i].size(); j++)
 				{
-					tlb_latency[i] = max(tlbs[i][j]->getLatency(), tlb_latency[i]);
+					tlb_latency[i] = max((*tlbs)[i][j]->getLatency(), tlb_latency[i]);
 				}
 #ifdef DEBUG_MMU
 				log_file << "[MMU] Charging TLB Latency: " << tlb_latency[i] << " at level: " << i << std::endl;
@@ -432,6 +447,7 @@ namespace ParametricDramDirectoryMSI
 				Sim()->getMimicOS()->handle_page_fault(address, app_id, max_level);
 				
 				SubsecondTime m_page_fault_latency = Sim()->getMimicOS()->getPageFaultLatency();	
+				TTRACE(core->getId(), TranslationTrace::PAGE_FAULT, time, address, 0, m_page_fault_latency);
 				if (count)
 				{
 					translation_stats.page_faults++;
@@ -511,19 +527,19 @@ namespace ParametricDramDirectoryMSI
 		// instruction path: follows the instruction TLB path
 		// data path: follows the data TLB path
 		if (instruction)
-			tlbs = tlb_subsystem->getInstructionPath();
+			tlbs = &tlb_subsystem->getInstructionPath();
 		else
-			tlbs = tlb_subsystem->getDataPath();
+			tlbs = &tlb_subsystem->getDataPath();
 
 		std::map<int, vector<tuple<IntPtr,IntPtr,int>>> evicted_translations;
 
 		// We need to allocate the entry in every "allocate on miss" TLB
 
-		int tlb_levels = tlbs.size();
+		int tlb_levels = tlbs->size();
 
 		if (tlb_subsystem->isPrefetchEnabled())
 		{
-			tlb_levels = tlbs.size() - 1;
+			tlb_levels = tlbs->size() - 1;
 #ifdef DEBUG_MMU
 			log_file << "[MMU] Prefetching is enabled" << std::endl;
 #endif
@@ -533,7 +549,7 @@ namespace ParametricDramDirectoryMSI
 		{
 			// We will check where we need to allocate the page
 
-			for (UInt32 j = 0; j < tlbs[i].size(); j++)
+			for (UInt32 j = 0; j < (*tlbs)[i].size(); j++)
 			{
 				// We need to check if there are any evicted translations from the previous level and allocate them
 				if ((i > 0) && (evicted_translations[i - 1].size() != 0))
@@ -549,13 +565,13 @@ namespace ParametricDramDirectoryMSI
 						log_file << "[MMU] Evicted Translation: " << get<0>(evicted_translations[i - 1][k]) << std::endl;
 #endif
 						// We need to check if the TLB supports the page size of the evicted translation
-						if (tlbs[i][j]->supportsPageSize(get<2>(evicted_translations[i - 1][k])))
+						if ((*tlbs)[i][j]->supportsPageSize(get<2>(evicted_translations[i - 1][k])))
 						{
 #ifdef DEBUG_MMU
 							log_file << "[MMU] Allocating evicted entry in TLB: Level = " << i << " Index =  " << j << std::endl;
 #endif
 
-							auto result = tlbs[i][j]->allocate(get<0>(evicted_translations[i - 1][k]), time, count, lock, get<2>(evicted_translations[i - 1][k]), get<1>(evicted_translations[i - 1][k]));
+							auto result = (*tlbs)[i][j]->allocate(get<0>(evicted_translations[i - 1][k]), time, count, lock, get<2>(evicted_translations[i - 1][k]), get<1>(evicted_translations[i - 1][k]));
 
 							// If the allocation was successful and we have an evicted translation, 
 							// we need to add it to the evicted translations vector for
@@ -573,15 +589,15 @@ namespace ParametricDramDirectoryMSI
 				// 2) The TLB is an "allocate on miss" TLB
 				// 3) There was a TLB miss or the TLB hit was at a higher level and you need to allocate the translation in the current level
 				
-				if (tlbs[i][j]->supportsPageSize(page_size) && tlbs[i][j]->getAllocateOnMiss() && (!hit || (hit && hit_level > i)))
+				if ((*tlbs)[i][j]->supportsPageSize(page_size) && (*tlbs)[i][j]->getAllocateOnMiss() && (!hit || (hit && hit_level > i)))
 				{
 					
 #ifdef DEBUG_MMU
-					log_file << "[MMU] " << tlbs[i][j]->getName() << " supports page size: " << page_size << std::endl;
+					log_file << "[MMU] " << (*tlbs)[i][j]->getName() << " supports page size: " << page_size << std::endl;
 					log_file << "[MMU] Allocating in TLB: Level = " << i << " Index = " << j << " with page size: " << page_size << " and VPN: " << (address >> page_size) << std::endl;
 #endif
 
-					auto result = tlbs[i][j]->allocate(address, time, count, lock, page_size, ppn_result);
+					auto result = (*tlbs)[i][j]->allocate(address, time, count, lock, page_size, ppn_result);
 
 					if (get<0>(result) == true)
 					{
@@ -623,6 +639,12 @@ namespace ParametricDramDirectoryMSI
 #endif
 		IntPtr final_physical_address = (ppn_result * base_page_size_in_bytes) + (address % page_size_in_bytes);
 
+		if (m_cheetah && count)
+			m_cheetah->accessTLB(address, page_size);
+
+		TTRACE(core->getId(), hit ? TranslationTrace::TLB_HIT : TranslationTrace::TLB_MISS, time, address, ppn_result,
+		       charged_tlb_latency + total_walk_latency, hit_level, page_size);
+
 		#ifdef DEBUG_MMU
 			log_file << "[MMU] Multiplication factor: " << page_size_in_bytes << std::endl;
 			log_file << "[MMU] Offset: " << (address % page_size_in_bytes) << std::endl;
@@ -637,15 +659,15 @@ namespace ParametricDramDirectoryMSI
 		return final_physical_address;
 	}
 
-	PTWResult MemoryManagementUnit::filterPTWResult(PTWResult ptw_result, PageTable *page_table, bool count)
+	void MemoryManagementUnit::filterPTWResult(PTWResult &ptw_result, PageTable *page_table, bool count)
 	{
-		accessedAddresses ptw_accesses;
+		accessedAddresses &ptw_accesses = get<1>(ptw_result);
+		UInt32 kept = 0; // Accesses that miss in the PWC are compacted to the front of the list
 
 		if (m_pwc_enabled)
 		{
-			accessedAddresses original_ptw_accesses = get<1>(ptw_result);
 			// We need to filter based on the page walk caches
-			for (UInt32 i = 0; i < get<1>(ptw_result).size(); i++)
+			for (UInt32 i = 0; i < ptw_accesses.size(); i++)
 			{
 				bool pwc_hit = false;
 
@@ -654,13 +676,15 @@ namespace ParametricDramDirectoryMSI
 					// If it is not, we need to add it to the PTW result
 					// Only check page walk caches if the level is not the first one
 
-					int level = get<1>(original_ptw_accesses[i]);
+					int level = get<1>(ptw_accesses[i]);
 
-					IntPtr pwc_address = get<2>(original_ptw_accesses[i]);
+					IntPtr pwc_address = get<2>(ptw_accesses[i]);
 #ifdef DEBUG_MMU
 					log_file << "[MMU] Checking PWC for address: " << pwc_address << " at level: " << level << std::endl;
 #endif
 					if (level < max_pwc_level){
+						if (m_cheetah && count)
+							m_cheetah->accessPWC(pwc_address, level);
 						pwc_hit = pwc->lookup(pwc_address, SubsecondTime::Zero(), true, level, count);
 					}
 					
@@ -676,12 +700,12 @@ namespace ParametricDramDirectoryMSI
 						// The offset is the index of the entry in the frame
 						// The size of the entry is 8 bytes
 						// The physical address of the entry is: current_frame->emulated_ppn * 4096 + offset*8
-						ptw_accesses.push_back(get<1>(ptw_result)[i]);
+						ptw_accesses[kept++] = ptw_accesses[i];
 					}
 			}
 		}
 
-		return PTWResult(get<0>(ptw_result), ptw_accesses, get<2>(ptw_result), get<3>(ptw_result), get<4>(ptw_result), get<5>(ptw_result), get<6>(ptw_result));
+		ptw_accesses.erase(ptw_accesses.begin() + kept, ptw_accesses.end());
 	}
 
 	void MemoryManagementUnit::setMaxPWCLevel(int max_pwc_level_)
@@ -706,7 +730,7 @@ namespace ParametricDramDirectoryMSI
 {
    // Get the TLB hierarchy structure
    // tlbs[i] represents Level i, tlbs[i][j] represents the j-th component at Level i
-   TLBSubsystem tlbs = tlb_subsystem->getTLBSubsystem();
+   const TLBSubsystem &tlbs = tlb_subsystem->getTLBSubsystem();
 
    bool entry_found_anywhere = false;
 
@@ -751,4 +775,29 @@ namespace ParametricDramDirectoryMSI
    return entry_found_anywhere;
 }
 
+	void MemoryManagementUnit::MMUFlushTLBBatch(int appid, const IntPtr *addresses, int num_addresses, bool *flushed, Core::lock_signal_t lock, bool modeled, bool count)
+{
+   if (m_full_flush_threshold <= 0 || num_addresses < m_full_flush_threshold)
+   {
+      for (int i = 0; i < num_addresses; i++)
+         flushed[i] = MMUFlushTLB(appid, addresses[i], lock, modeled, count);
+      return;
+   }
+
+   // Large batch: dropping everything is cheaper than probing every level for every page.
+   // Like a CR3 reload this also clears the page walk caches.
+   const TLBSubsystem &tlbs = tlb_subsystem->getTLBSubsystem();
+   for (UInt32 i = 0; i < tlbs.size(); i++)
+      for (UInt32 j = 0; j < tlbs[i].size(); j++)
+         tlbs[i][j]->flushAll();
+   if (pwc)
+      pwc->flushAll();
+
+   // Per-page presence is unknown after a full flush, report every page as flushed
+   for (int i = 0; i < num_addresses; i++)
+      flushed[i] = true;
+
+   translation_stats.tlb_full_flush++;
+}
+
 }
\ No newline at end of file
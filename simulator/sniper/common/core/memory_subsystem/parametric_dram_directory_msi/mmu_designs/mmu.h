@@ -10,6 +10,7 @@
 #include "tlb_subsystem.h"
 #include "mmu_base.h"
 #include "ptmshrs.h"
+#include "translation_cheetah.h"
 
 namespace ParametricDramDirectoryMSI
 {
@@ -26,6 +27,7 @@ namespace ParametricDramDirectoryMSI
 		PWC *pwc; // Only used for radix page tables
 		bool m_pwc_enabled;
 		int max_pwc_level;
+		TranslationCheetah *m_cheetah; // Hit-rate curves of all TLB/PWC geometries, NULL unless cheetah/enabled
 
 		//For the log
 		std::ofstream log_file;
@@ -33,6 +35,10 @@ namespace ParametricDramDirectoryMSI
 
 		bool m_site_enabled; // SITE: Self-Invalidating TLB Entries
 
+		// Shootdown batches of at least this many pages flush the TLBs and PWC entirely
+		// instead of page by page (cf. Linux's tlb_single_page_flush_ceiling). 0 = never.
+		int m_full_flush_threshold;
+
 		struct
 		{
 			UInt64 num_translations;
@@ -47,6 +53,7 @@ namespace ParametricDramDirectoryMSI
 			SubsecondTime tlb_flush_latency;
 			UInt64 *tlb_hit_page_sizes;
 			UInt64 tlb_flush;
+			UInt64 tlb_full_flush;
 
 			SubsecondTime page_migration_wait_time;
 
@@ -65,13 +72,14 @@ namespace ParametricDramDirectoryMSI
 		void registerMMUStats();
 		void discoverVMAs();
 
-		PTWResult filterPTWResult(PTWResult ptw_result, PageTable *page_table, bool count);
+		void filterPTWResult(PTWResult &ptw_result, PageTable *page_table, bool count);
 		IntPtr performAddressTranslation(IntPtr eip, IntPtr address, bool instruction, Core::lock_signal_t lock, bool modeled, bool count);
 		PageTable* getPageTable();
 		void setMaxPWCLevel(int max_pwc_level_);
 		int getMaxPWCLevel();
 
 		bool MMUFlushTLB(int appid, IntPtr address, Core::lock_signal_t lock, bool modeled, bool count) override;
+		void MMUFlushTLBBatch(int appid, const IntPtr *addresses, int num_addresses, bool *flushed, Core::lock_signal_t lock, bool modeled, bool count) override;
 		void addPageMigrationWaitTime(SubsecondTime time) override { translation_stats.page_migration_wait_time += time; }
 	};
 
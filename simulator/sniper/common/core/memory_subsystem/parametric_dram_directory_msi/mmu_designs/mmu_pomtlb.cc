@@ -812,21 +812,21 @@ namespace ParametricDramDirectoryMSI
 	 *   - If m_pwc_enabled is true, it checks each PT walk-level address. If found in PWC, we skip it.
 	 *   - This can reduce the number of memory accesses needed by the final PTW result.
 	 */
-	PTWResult MemoryManagementUnitPOMTLB::filterPTWResult(PTWResult ptw_result,
-	                                                      PageTable *page_table,
-	                                                      bool count)
+	void MemoryManagementUnitPOMTLB::filterPTWResult(PTWResult &ptw_result,
+	                                                 PageTable *page_table,
+	                                                 bool count)
 	{
-		accessedAddresses ptw_accesses;
+		accessedAddresses &ptw_accesses = get<1>(ptw_result);
+		UInt32 kept = 0; // Accesses that miss in the PWC are compacted to the front of the list
 
 		if (m_pwc_enabled)
 		{
-			accessedAddresses original_ptw_accesses = get<1>(ptw_result);
-			for (UInt32 i = 0; i < get<1>(ptw_result).size(); i++)
+			for (UInt32 i = 0; i < ptw_accesses.size(); i++)
 			{
 				bool pwc_hit = false;
 
-				int level = get<1>(original_ptw_accesses[i]);
-				IntPtr pwc_address = get<2>(original_ptw_accesses[i]);
+				int level = get<1>(ptw_accesses[i]);
+				IntPtr pwc_address = get<2>(ptw_accesses[i]);
 
 #ifdef DEBUG_MMU
 				log_file << "[MMU] Checking PWC for address: "
@@ -845,13 +845,12 @@ namespace ParametricDramDirectoryMSI
 				if (!pwc_hit)
 				{
 					// If not in PWC, we keep it in the final list (ptw_accesses) 
-					ptw_accesses.push_back(get<1>(ptw_result)[i]);
+					ptw_accesses[kept++] = ptw_accesses[i];
 				}
 			}
 		}
-		// Return an updated PTWResult with the filtered addresses
-		return PTWResult(get<0>(ptw_result), ptw_accesses,
-		                 get<2>(ptw_result), get<3>(ptw_result), get<4>(ptw_result), get<5>(ptw_result), get<6>(ptw_result));
+		// Drop the tail: only the addresses that missed in the PWC remain in the PTW result
+		ptw_accesses.erase(ptw_accesses.begin() + kept, ptw_accesses.end());
 	}
 
 	/*
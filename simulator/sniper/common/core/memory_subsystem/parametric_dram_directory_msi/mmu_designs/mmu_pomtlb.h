@@ -76,7 +76,7 @@ namespace ParametricDramDirectoryMSI
 		void instantiateTLBSubsystem();
 		void registerMMUStats();
 
-		PTWResult filterPTWResult(PTWResult ptw_result, PageTable *page_table, bool count);
+		void filterPTWResult(PTWResult &ptw_result, PageTable *page_table, bool count);
 		IntPtr performAddressTranslation(IntPtr eip, IntPtr address, bool instruction, Core::lock_signal_t lock, bool modeled, bool count);
 		PageTable *getPageTable();
 	};
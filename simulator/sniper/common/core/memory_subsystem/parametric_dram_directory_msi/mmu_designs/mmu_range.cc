@@ -562,21 +562,21 @@ namespace ParametricDramDirectoryMSI
 	 *   - If m_pwc_enabled is true, it checks each PT walk-level address. If found in PWC, we skip it.
 	 *   - This can reduce the number of memory accesses needed by the final PTW result.
 	 */
-	PTWResult RangeMMU::filterPTWResult(PTWResult ptw_result,
-										PageTable *page_table,
-										bool count)
+	void RangeMMU::filterPTWResult(PTWResult &ptw_result,
+								   PageTable *page_table,
+								   bool count)
 	{
-		accessedAddresses ptw_accesses;
+		accessedAddresses &ptw_accesses = get<1>(ptw_result);
+		UInt32 kept = 0; // Accesses that miss in the PWC are compacted to the front of the list
 
 		if (m_pwc_enabled)
 		{
-			accessedAddresses original_ptw_accesses = get<1>(ptw_result);
-			for (UInt32 i = 0; i < get<1>(ptw_result).size(); i++)
+			for (UInt32 i = 0; i < ptw_accesses.size(); i++)
 			{
 				bool pwc_hit = false;
 
-				int level = get<1>(original_ptw_accesses[i]);
-				IntPtr pwc_address = get<2>(original_ptw_accesses[i]);
+				int level = get<1>(ptw_accesses[i]);
+				IntPtr pwc_address = get<2>(ptw_accesses[i]);
 
 #ifdef DEBUG_MMU
 				log_file << "[MMU] Checking PWC for address: "
@@ -595,17 +595,15 @@ namespace ParametricDramDirectoryMSI
 				if (!pwc_hit)
 				{
 					// If not in PWC, we keep it in the final list (ptw_accesses)
-					ptw_accesses.push_back(get<1>(ptw_result)[i]);
+					ptw_accesses[kept++] = ptw_accesses[i];
 				}
 			}
 		}
-		// Return an updated PTWResult with the filtered addresses
-		return PTWResult(get<0>(ptw_result), ptw_accesses,
-						 get<2>(ptw_result), get<3>(ptw_result), get<4>(ptw_result),
-						 get<5>(ptw_result), get<6>(ptw_result));
+		// Drop the tail: only the addresses that missed in the PWC remain in the PTW result
+		ptw_accesses.erase(ptw_accesses.begin() + kept, ptw_accesses.end());
 	}
 
-	std::tuple<SubsecondTime, IntPtr, int> RangeMMU::performRangeWalk(IntPtr address, IntPtr eip, Core::lock_signal_t lock, bool modeled, bool count)
+	std::tuple<SubsecondTime, IntPtr, IntPtr> RangeMMU::performRangeWalk(IntPtr address, IntPtr eip, Core::lock_signal_t lock, bool modeled, bool count)
 	{
 
 		SubsecondTime time = shmem_perf_model->getElapsedTime(ShmemPerfModel::_USER_THREAD);
@@ -621,23 +619,19 @@ namespace ParametricDramDirectoryMSI
 			log_file << "Miss in RLB for address: " << address << std::endl;
 #endif
 			// Check if the address is in the range table
-			auto result = range_table->lookup(address);
-			if (get<0>(result) != NULL) // TreeNode* is not NULL
+			Range range;
+			m_range_walk_accesses.clear();
+			if (range_table->lookup(address, range, m_range_walk_accesses))
 			{
 				// We found the key inside the range table
 #ifdef DEBUG_MMU
 				log_file << "Key found for address: " << address << " in the range table" << std::endl;
 #endif
-				Range range;
-				range.vpn = get<0>(result)->keys[get<1>(result)].first;
-				range.bounds = get<0>(result)->keys[get<1>(result)].second;
-				range.offset = get<0>(result)->values[get<1>(result)].offset;
-
 #ifdef DEBUG_MMU
 				log_file << "VPN: " << range.vpn << " Bounds: " << range.bounds << " Offset: " << range.offset << std::endl;
 #endif
 				// Insert the entry in the RLB
-				for (auto &address : get<2>(result))
+				for (IntPtr address : m_range_walk_accesses)
 				{
 
 					translationPacket packet;
@@ -659,9 +653,9 @@ namespace ParametricDramDirectoryMSI
 #ifdef DEBUG_MMU
 				log_file << "No key found for address: " << address << " in the range table" << std::endl;
 #endif
-				return std::make_tuple(charged_range_walk_latency, -1, -1);
+				return std::make_tuple(charged_range_walk_latency, static_cast<IntPtr>(-1), static_cast<IntPtr>(-1));
 			}
-			return std::make_tuple(charged_range_walk_latency, hit_rlb.second.vpn, hit_rlb.second.offset);
+			return std::make_tuple(charged_range_walk_latency, range.vpn, range.offset);
 		}
 		else
 		{
@@ -681,7 +675,7 @@ namespace ParametricDramDirectoryMSI
 	VMA RangeMMU::findVMA(IntPtr address)
 	{
 		int app_id = core->getThread()->getAppId();
-		std::vector<VMA> vma_list = Sim()->getMimicOS()->getVMA(app_id);
+		const std::vector<VMA> &vma_list = Sim()->getMimicOS()->getVMA(app_id);
 
 		for (UInt32 i = 0; i < vma_list.size(); i++)
 		{
@@ -29,6 +29,7 @@ namespace ParametricDramDirectoryMSI
 
 	private:
 		RLB *range_lb;
+		std::vector<IntPtr> m_range_walk_accesses; // Reused by performRangeWalk() so range table walks do not allocate
         TLBHierarchy *tlb_subsystem;
 		MSHR *pt_walkers; 
 		PWC *pwc; // Only used for radix page tables
@@ -75,8 +76,8 @@ namespace ParametricDramDirectoryMSI
 
 		IntPtr performAddressTranslation(IntPtr eip, IntPtr address, bool instruction, Core::lock_signal_t lock, bool modeled, bool count);
 		void discoverVMAs();
-		PTWResult filterPTWResult(PTWResult ptw_result, PageTable *page_table, bool count);
-		std::tuple<SubsecondTime, IntPtr, int> performRangeWalk(IntPtr address, IntPtr eip, Core::lock_signal_t lock, bool modeled, bool count);
+		void filterPTWResult(PTWResult &ptw_result, PageTable *page_table, bool count);
+		std::tuple<SubsecondTime, IntPtr, IntPtr> performRangeWalk(IntPtr address, IntPtr eip, Core::lock_signal_t lock, bool modeled, bool count);
 		VMA findVMA(IntPtr address);
 	};
 } // namespace ParametricDramDirectoryMSI
\ No newline at end of file
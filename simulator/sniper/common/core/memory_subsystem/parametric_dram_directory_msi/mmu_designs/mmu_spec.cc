@@ -551,15 +551,15 @@ namespace ParametricDramDirectoryMSI
         return physical_address;
     }
 
-    PTWResult MemoryManagementUnitSpec::filterPTWResult(PTWResult ptw_result, PageTable *page_table, bool count)
+    void MemoryManagementUnitSpec::filterPTWResult(PTWResult &ptw_result, PageTable *page_table, bool count)
     {
-        accessedAddresses ptw_accesses;
+        accessedAddresses &ptw_accesses = get<1>(ptw_result);
+        UInt32 kept = 0; // Accesses that miss in the PWC are compacted to the front of the list
 
         if (m_pwc_enabled)
         {
-            accessedAddresses original_ptw_accesses = get<1>(ptw_result);
             // We need to filter based on the page walk caches
-            for (UInt32 i = 0; i < get<1>(ptw_result).size(); i++)
+            for (UInt32 i = 0; i < ptw_accesses.size(); i++)
             {
                 bool pwc_hit = false;
 
@@ -568,9 +568,9 @@ namespace ParametricDramDirectoryMSI
                 // If it is not, we need to add it to the PTW result
                 // Only check page walk caches if the level is not the first one
 
-                int level = get<1>(original_ptw_accesses[i]);
+                int level = get<1>(ptw_accesses[i]);
 
-                IntPtr pwc_address = get<2>(original_ptw_accesses[i]);
+                IntPtr pwc_address = get<2>(ptw_accesses[i]);
 #ifdef DEBUG_MMU
                 log_file << "[MMU] Checking PWC for address: " << pwc_address << " at level: " << level << std::endl;
 #endif
@@ -590,12 +590,12 @@ namespace ParametricDramDirectoryMSI
                     // The offset is the index of the entry in the frame
                     // The size of the entry is 8 bytes
                     // The physical address of the entry is: current_frame->emulated_ppn * 4096 + offset*8
-                    ptw_accesses.push_back(get<1>(ptw_result)[i]);
+                    ptw_accesses[kept++] = ptw_accesses[i];
                 }
             }
         }
 
-        return PTWResult(get<0>(ptw_result), ptw_accesses, get<2>(ptw_result), get<3>(ptw_result), get<4>(ptw_result), get<5>(ptw_result), get<6>(ptw_result));
+        ptw_accesses.erase(ptw_accesses.begin() + kept, ptw_accesses.end());
     }
 
     /*
@@ -632,9 +632,10 @@ namespace ParametricDramDirectoryMSI
         log_file_mmu << std::endl;
         log_file_mmu << "[MMU_BASE]-------------- Starting PTW for address: " << address << std::endl;
 #endif
-        auto ptw_result = page_table->initializeWalk(address, count, is_prefetch, restart_walk);
+        PTWResult ptw_result;
+        page_table->initializeWalk(address, count, ptw_result, is_prefetch, restart_walk);
         // We will filter out the re-walked addresses which anyways either hit in the PWC or are redundant
-        accessedAddresses visited_pts = get<1>(ptw_result);
+        accessedAddresses &visited_pts = get<1>(ptw_result);
 
         // for (int i = 0; i < visited_pts.size(); i++)
         // {
@@ -654,23 +655,20 @@ namespace ParametricDramDirectoryMSI
         }
 #endif
         // invoking the spec engine again to predict intra-pt dependencies
-        if (get<4>(ptw_result) && page_table->getType() == "radix")
+        if (get<4>(ptw_result) && page_table->isRadix())
             spec_engine->invokeSpecEngine(address, count, lock, eip, modeled, time_for_pt, physical_result_last_level, true);
         /*Spec code end*/
 
-        ptw_result = make_tuple(get<0>(ptw_result), visited_pts, get<2>(ptw_result), get<3>(ptw_result), get<4>(ptw_result), get<5>(ptw_result), get<6>(ptw_result));
-
         // Filter the PTW result based on the page table type
         // This filtering is necessary to remove any redundant accesses that may hit in the PWC
 
-        if (page_table->getType() == "radix")
+        if (page_table->isRadix())
         {
-            ptw_result = filterPTWResult(ptw_result, page_table, count);
+            filterPTWResult(ptw_result, page_table, count);
         }
 
 #ifdef DEBUG_MMU
         log_file_mmu << "[MMU_BASE] We accessed " << get<1>(ptw_result).size() << " addresses" << std::endl;
-        visited_pts = get<1>(ptw_result);
         for (UInt32 i = 0; i < visited_pts.size(); i++)
         {
             log_file_mmu << "[MMU_BASE] Address: " << get<2>(visited_pts[i]) << " Level: " << get<1>(visited_pts[i]) << " Table: " << get<0>(visited_pts[i]) << " Correct Translation: " << get<3>(visited_pts[i]) << std::endl;
@@ -73,7 +73,7 @@ namespace ParametricDramDirectoryMSI
         void discoverVMAs();
 
         // Filters the result of a page table walk based on given parameters.
-        PTWResult filterPTWResult(PTWResult ptw_result, PageTable *page_table, bool count);
+        void filterPTWResult(PTWResult &ptw_result, PageTable *page_table, bool count);
 
         // Performs address translation for a given instruction or data address.
         IntPtr performAddressTranslation(IntPtr eip, IntPtr address, bool instruction, Core::lock_signal_t lock, bool modeled, bool count);
@@ -15,7 +15,7 @@
 #include <fstream>
 #include <algorithm>
 
-#define DEBUG_MMU
+// #define DEBUG_MMU
 
 using namespace std;
 
@@ -910,8 +910,11 @@ namespace ParametricDramDirectoryMSI
 #endif
 			restseg = m_utopia->getRestSeg(i);
 
+			// One probe answers membership, the permission filter and the SF/TAR entries to read
+			RestSeg::Probe probe = restseg->probe(address, count, core->getId());
+
 			// Check if the address belongs to the current RestSeg region
-			if (restseg->inRestSeg(address, count, t_start, core->getId()))
+			if (probe.hit)
 			{
 #ifdef DEBUG_MMU
 				log_file << "[MMU::Utopia] Data is in RestSeg: " << i << std::endl;
@@ -921,15 +924,12 @@ namespace ParametricDramDirectoryMSI
 			}
 
 			// The permission filter check might allow skipping further tag checks
-			if (restseg->permission_filter(address, core->getId()))
-				tag_match_skip = true;
-			else
-				tag_match_skip = false;
+			tag_match_skip = probe.set_empty;
 
 #ifdef DEBUG_MMU
 			log_file << "[MMU::Utopia] Tag Match Skip: " << tag_match_skip << std::endl;
 #endif
-			UInt64 permission_filter = restseg->calculate_permission_address(address, core->getId());
+			UInt64 permission_filter = probe.permission_address;
 
 			// Check the permission cache (sf_cache)
 			UtopiaCache::where_t permcache_hitwhere;
@@ -950,7 +950,7 @@ namespace ParametricDramDirectoryMSI
 
 			if (tag_match_skip == false)
 			{
-				UInt64 tag = restseg->calculate_tag_address(address, core->getId());
+				UInt64 tag = probe.tag_address;
 
 #ifdef DEBUG_MMU
 				log_file << "[MMU::Utopia] Accessing Tag: " << tag << std::endl;
@@ -971,7 +971,7 @@ namespace ParametricDramDirectoryMSI
 			// If we discovered a hit in this RestSeg, we have the final address
 			if (restseg_hit == true)
 			{
-				final_address = restseg->calculate_physical_address(address, core->getId());
+				final_address = probe.physical_address;
 #ifdef DEBUG_MMU
 				log_file << "[MMU::Utopia] Final Address: " << final_address << std::endl;
 #endif
@@ -1019,25 +1019,24 @@ namespace ParametricDramDirectoryMSI
 	/*
 	 * This function filters the results of a page table walk result (ptw_result) through
 	 * any enabled Page Walk Caches (PWC). If an entry is found in the PWC, we can skip the
-	 * actual memory access. The filtered result is returned.
+	 * actual memory access. The result is filtered in place.
 	 */
-	PTWResult MemoryManagementUnitUtopia::filterPTWResult(PTWResult ptw_result, PageTable *page_table, bool count)
+	void MemoryManagementUnitUtopia::filterPTWResult(PTWResult &ptw_result, PageTable *page_table, bool count)
 	{
-		accessedAddresses ptw_accesses;
+		accessedAddresses &ptw_accesses = get<1>(ptw_result);
+		UInt32 kept = 0; // Accesses that miss in the PWC are compacted to the front of the list
 		bool pwc_hit = false;
 
 		if (m_pwc_enabled)
 		{
-			accessedAddresses original_ptw_accesses = get<1>(ptw_result);
-
 			// We iterate through each memory access that the PTW reported
-			for (UInt32 i = 0; i < get<1>(ptw_result).size(); i++)
+			for (UInt32 i = 0; i < ptw_accesses.size(); i++)
 			{
 				bool pwc_hit = false;
-				int level = get<1>(original_ptw_accesses[i]);
+				int level = get<1>(ptw_accesses[i]);
 				PageTableRadix *page_table_radix = dynamic_cast<PageTableRadix *>(page_table);
 				int levels = page_table_radix->getMaxLevel();
-				IntPtr pwc_address = get<2>(original_ptw_accesses[i]);
+				IntPtr pwc_address = get<2>(ptw_accesses[i]);
 
 #ifdef DEBUG_MMU
 				log_file << "[MMU] Checking PWC for address: " << pwc_address << " at level: " << level << std::endl;
@@ -1059,13 +1058,13 @@ namespace ParametricDramDirectoryMSI
 				 */
 				if (!pwc_hit)
 				{
-					ptw_accesses.push_back(get<1>(ptw_result)[i]);
+					ptw_accesses[kept++] = ptw_accesses[i];
 				}
 			}
 		}
 
-		// Return the same final PPN, page size, and walk stats, but updated with whichever addresses remain after PWC filtering.
-		return PTWResult(get<0>(ptw_result), ptw_accesses, get<2>(ptw_result), get<3>(ptw_result), get<4>(ptw_result), get<5>(ptw_result), get<6>(ptw_result));
+		// Keep the same final PPN, page size, and walk stats, but only the addresses that remain after PWC filtering.
+		ptw_accesses.erase(ptw_accesses.begin() + kept, ptw_accesses.end());
 	}
 
 	/*
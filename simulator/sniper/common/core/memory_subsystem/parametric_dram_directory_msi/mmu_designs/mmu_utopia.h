@@ -92,7 +92,7 @@ namespace ParametricDramDirectoryMSI
 		void registerMMUStats();
 		IntPtr performAddressTranslation(IntPtr eip, IntPtr address, bool instruction, Core::lock_signal_t lock, bool modeled, bool count);
 		std::tuple<int, IntPtr, SubsecondTime> RestSegWalk(IntPtr address, bool instruction, IntPtr eip, Core::lock_signal_t lock, bool modeled, bool count);
-        PTWResult filterPTWResult(PTWResult ptw_result, PageTable *page_table, bool count);
+        void filterPTWResult(PTWResult &ptw_result, PageTable *page_table, bool count);
 
 		void discoverVMAs();
 	};
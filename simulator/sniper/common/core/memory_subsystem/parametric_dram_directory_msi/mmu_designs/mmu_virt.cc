@@ -502,9 +502,9 @@ namespace ParametricDramDirectoryMSI
 		return t_end - t_start;
 	}
 
-	PTWResult MemoryManagementUnitVirt::filterPTWResult(PTWResult ptw_result, PageTable *page_table, bool count)
+	void MemoryManagementUnitVirt::filterPTWResult(PTWResult &ptw_result, PageTable *page_table, bool count)
 	{
-		return PTWResult();
+		ptw_result = PTWResult();
 	}
 	
 	/*
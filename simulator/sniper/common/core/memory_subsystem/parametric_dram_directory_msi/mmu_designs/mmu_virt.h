@@ -43,7 +43,7 @@ namespace ParametricDramDirectoryMSI
 		void instantiateTLBSubsystem();
 		void registerMMUStats();
 		void discoverVMAs();
-		PTWResult filterPTWResult(PTWResult ptw_result, PageTable *page_table, bool count);
+		void filterPTWResult(PTWResult &ptw_result, PageTable *page_table, bool count);
 
 		SubsecondTime accessCache(translationPacket packet, SubsecondTime t_start = SubsecondTime::Zero(),bool is_prefetch = false) override;
 
@@ -68,4 +68,10 @@ namespace ParametricDramDirectoryMSI
 		m_cache[cache_index]->insertSingleLine(address, NULL, &eviction, &evict_addr, &evict_block_info, NULL, now, NULL, CacheBlockInfo::block_type_t::NON_PAGE_TABLE);
 	}
 
+	void PWC::flushAll()
+	{
+		for (int i = 0; i < num_caches; i++)
+			m_cache[i]->invalidateAll();
+	}
+
 }
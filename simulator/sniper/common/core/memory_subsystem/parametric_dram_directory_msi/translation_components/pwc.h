@@ -37,6 +37,7 @@ namespace ParametricDramDirectoryMSI
 		PWC(String name, String cfgname, core_id_t core_id, UInt32 *associativities, UInt32 *entries, int num_caches, ComponentLatency _access_latency, ComponentLatency _miss_latency, bool _perfect);
 		bool lookup(IntPtr address, SubsecondTime now, bool allocate_on_miss, int level, bool count, IntPtr ppn = 0);
 		void allocate(IntPtr address, SubsecondTime now, int cache_index, IntPtr ppn);
+		void flushAll();
 		static const UInt64 HASH_PRIME = 124183;
 	};
 }
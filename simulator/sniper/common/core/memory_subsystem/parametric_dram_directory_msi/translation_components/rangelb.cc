@@ -9,23 +9,26 @@
 #include <cmath>
 #include <iostream>
 #include <utility>
+#include <algorithm>
 #include "core_manager.h"
 #include "cache_set.h"
 #include "vma.h"
 
-#define DEBUG_RLB
+// #define DEBUG_RLB
 
 RLB::RLB(Core *core, String name, ComponentLatency latency, UInt64 entries)
     : m_latency(latency),
       m_num_sets(entries),
       m_core(core),
-      m_name(name)
+      m_name(name),
+      m_use_clock(0)
 {
 
     log_file_name = "rlb.log";
     log_file_name = std::string(Sim()->getConfig()->getOutputDirectory().c_str()) + "/" + log_file_name;
     log_file.open(log_file_name);
 
+    m_entries.reserve(m_num_sets);
 
     bzero(&stats, sizeof(stats));
     registerStatsMetric(name, core->getId(), "accesses", &stats.accesses);
@@ -43,48 +46,57 @@ void RLB::insert_entry(Range new_rng)
     log_file << "Inserting entry in RLB: " << new_rng.vpn << " " << new_rng.bounds << std::endl;
 #endif
 
-    int candidate;
+    std::vector<Entry>::iterator pos = std::lower_bound(m_entries.begin(), m_entries.end(), new_rng.vpn,
+        [](const Entry &e, IntPtr vpn) { return e.range.vpn < vpn; });
 
-    candidate = rand() % m_num_sets;
-
-    while (candidate == mru)
-        candidate = rand() % m_num_sets;
+    if (pos != m_entries.end() && pos->range.vpn == new_rng.vpn)
+    {
+        // Already cached (e.g. refilled after a concurrent miss), just refresh it
+        pos->range = new_rng;
+        pos->last_use = ++m_use_clock;
+        return;
+    }
 
-    if (m_ranges.size() == m_num_sets)
-        m_ranges.erase(m_ranges.begin() + candidate);
+    if (m_entries.size() == m_num_sets)
+    {
+        std::vector<Entry>::iterator victim = std::min_element(m_entries.begin(), m_entries.end(),
+            [](const Entry &a, const Entry &b) { return a.last_use < b.last_use; });
+#ifdef DEBUG_RLB
+        log_file << "Evicting entry from RLB: " << victim->range.vpn << " " << victim->range.bounds << std::endl;
+#endif
+        if (victim < pos)
+            --pos;
+        m_entries.erase(victim);
+    }
 
-    m_ranges.push_back(new_rng);
+    m_entries.insert(pos, Entry{new_rng, ++m_use_clock});
 }
 
 std::pair<bool, Range> RLB::access(Core::mem_op_t mem_op_type, IntPtr address, bool count)
 {
-
-    int index = 0;
     if (count)
         stats.accesses++;
 #ifdef DEBUG_RLB
     log_file << "Accessing address in RLB: " << address << std::endl;
 #endif
 
-    for (std::vector<Range>::iterator it = m_ranges.begin(); it != m_ranges.end(); ++it)
-    {
+    // The only candidate is the last range that starts at or below address
+    std::vector<Entry>::iterator it = std::upper_bound(m_entries.begin(), m_entries.end(), address,
+        [](IntPtr addr, const Entry &e) { return addr < e.range.vpn; });
 
-#ifdef DEBUG_RLB
-       log_file << "VPN: " << (*it).vpn << " Bounds: " << (*it).bounds << std::endl;
-#endif
-
-        if (address >= (*it).vpn && address < (*it).bounds)
+    if (it != m_entries.begin())
+    {
+        --it;
+        if (address < it->range.bounds)
         {
             if (count)
                 stats.hits++;
-            mru = index;
+            it->last_use = ++m_use_clock;
 #ifdef DEBUG_RLB
-            log_file << "Hit in RLB" << std::endl;
+            log_file << "Hit in RLB: " << it->range.vpn << " " << it->range.bounds << std::endl;
 #endif
-            return std::make_pair(true, (*it));
+            return std::make_pair(true, it->range);
         }
-
-        index++;
     }
 
 #ifdef DEBUG_RLB
@@ -93,6 +105,6 @@ std::pair<bool, Range> RLB::access(Core::mem_op_t mem_op_type, IntPtr address, b
 
     if (count)
         stats.misses++;
-    Range miss;
+    Range miss = { 0, 0, 0 };
     return std::make_pair(false, miss);
 }
@@ -1,5 +1,6 @@
 #pragma once
 #include <vector>
+#include <fstream>
 #include "fixed_types.h"
 #include "core.h"
 #include "vma.h"
@@ -10,11 +11,19 @@ class RLB
 public:
         ComponentLatency m_latency;
         const UInt64 m_num_sets;
-        int mru;
         String repl_policy;
         Core *m_core;
         String m_name;
-        std::vector<Range> m_ranges;
+
+        // Fully associative, LRU replaced. Cached ranges never overlap, so the entries are
+        // kept sorted by start address and a lookup is a binary search.
+        struct Entry
+        {
+                Range range;
+                UInt64 last_use;
+        };
+        std::vector<Entry> m_entries;
+        UInt64 m_use_clock;
 
 
         std::ofstream log_file;
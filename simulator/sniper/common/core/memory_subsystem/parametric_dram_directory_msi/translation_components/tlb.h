@@ -69,6 +69,7 @@ namespace ParametricDramDirectoryMSI
 																								: Unified; };
 		String getName() { return m_name; };
 		Cache& getCache() { return m_cache; };
+		UInt32 flushAll() { return m_cache.invalidateAll(); };
 		int getAssoc() { return m_associativity; };
 		bool getAllocateOnMiss() { return m_allocate_miss; };
 		bool getPrefetch() { return m_prefetch; };
@@ -30,9 +30,9 @@ namespace ParametricDramDirectoryMSI
 		bool prefetch_enabled;
 		TLBHierarchy(String mmu_name, Core *core, MemoryManager *memory_manager, ShmemPerfModel *shmem_perf_model);
 		~TLBHierarchy();
-		TLBSubsystem getTLBSubsystem() { return tlbLevels; }
-		TLBSubsystem getDataPath() { return data_path; }
-		TLBSubsystem getInstructionPath() { return instruction_path; }
+		TLBSubsystem &getTLBSubsystem() { return tlbLevels; }
+		TLBSubsystem &getDataPath() { return data_path; }
+		TLBSubsystem &getInstructionPath() { return instruction_path; }
 		bool isPrefetchEnabled() { return prefetch_enabled; }
 		int getNumLevels() { return numLevels; }
 		int predictPagesize(IntPtr eip);
@@ -0,0 +1,66 @@
+#include "translation_cheetah.h"
+#include "simulator.h"
+#include "config.hpp"
+#include "hooks_manager.h"
+#include "stats.h"
+#include "log.h"
+
+namespace ParametricDramDirectoryMSI
+{
+	TranslationCheetah::TranslationCheetah(String name, String cfgname, core_id_t core_id, int page_sizes, const int *page_size_list, int pwc_levels)
+		: m_assoc_bits(Sim()->getCfg()->getInt(cfgname + "/assoc_bits")),
+		  m_min_sets_bits(Sim()->getCfg()->getInt(cfgname + "/min_sets_bits")),
+		  m_max_sets_bits(Sim()->getCfg()->getInt(cfgname + "/max_sets_bits")),
+		  m_page_size_list(page_size_list, page_size_list + page_sizes),
+		  m_tlb_streams(page_sizes),
+		  m_pwc_streams(pwc_levels)
+	{
+		LOG_ASSERT_ERROR(m_min_sets_bits <= m_max_sets_bits, "%s/min_sets_bits (%d) must be <= max_sets_bits (%d)",
+						 cfgname.c_str(), m_min_sets_bits, m_max_sets_bits);
+		// The tree of the model holds 2^max_sets_bits * 2 * (2^assoc_bits + 1) tags per stream
+		LOG_ASSERT_ERROR(m_max_sets_bits + m_assoc_bits <= 20, "%s: max_sets_bits + assoc_bits must be <= 20", cfgname.c_str());
+
+		for (int i = 0; i < page_sizes; i++)
+			initStream(m_tlb_streams[i], page_size_list[i], name + "_cheetah", "tlb_" + itostr(page_size_list[i]), core_id);
+		// Named like the PWC caches: level index 0 (the root) is PWC L<pwc_levels + 1>
+		for (int i = 0; i < pwc_levels; i++)
+			initStream(m_pwc_streams[i], PTE_SIZE_BITS, name + "_cheetah", "pwc_L" + itostr(pwc_levels + 1 - i), core_id);
+
+		Sim()->getHooksManager()->registerHook(HookType::HOOK_PRE_STAT_WRITE, hook_update, (UInt64)this, HooksManager::ORDER_NOTIFY_PRE);
+	}
+
+	TranslationCheetah::~TranslationCheetah()
+	{
+		for (Stream &stream : m_tlb_streams)
+			delete stream.model;
+		for (Stream &stream : m_pwc_streams)
+			delete stream.model;
+	}
+
+	void TranslationCheetah::initStream(Stream &stream, UInt32 line_bits, String name, String prefix, core_id_t core_id)
+	{
+		stream.model = new CheetahSACLRU(m_assoc_bits, m_max_sets_bits, m_min_sets_bits, line_bits);
+		stream.accesses = 0;
+		stream.hits.assign((m_max_sets_bits - m_min_sets_bits + 1) * (m_assoc_bits + 1), 0);
+
+		registerStatsMetric(name, core_id, prefix + "_accesses", &stream.accesses);
+		for (UInt32 sets_bits = m_min_sets_bits; sets_bits <= m_max_sets_bits; sets_bits++)
+			for (UInt32 ways_bits = 0; ways_bits <= m_assoc_bits; ways_bits++)
+				registerStatsMetric(name, core_id, prefix + "_hits_" + itostr(1 << sets_bits) + "x" + itostr(1 << ways_bits),
+									&stream.hits[(sets_bits - m_min_sets_bits) * (m_assoc_bits + 1) + ways_bits]);
+	}
+
+	void TranslationCheetah::updateStats()
+	{
+		for (std::vector<Stream> *streams : {&m_tlb_streams, &m_pwc_streams})
+		{
+			for (Stream &stream : *streams)
+			{
+				stream.accesses = stream.model->numentries();
+				for (UInt32 sets_bits = m_min_sets_bits; sets_bits <= m_max_sets_bits; sets_bits++)
+					for (UInt32 ways_bits = 0; ways_bits <= m_assoc_bits; ways_bits++)
+						stream.hits[(sets_bits - m_min_sets_bits) * (m_assoc_bits + 1) + ways_bits] = stream.model->hits(sets_bits, 1 << ways_bits);
+			}
+		}
+	}
+}
@@ -0,0 +1,76 @@
+#ifndef TRANSLATION_CHEETAH_H
+#define TRANSLATION_CHEETAH_H
+
+#include "fixed_types.h"
+#include "saclru.h"
+#include <vector>
+
+namespace ParametricDramDirectoryMSI
+{
+	/*
+	 * Single-pass design-space exploration of the translation caches, with the same Cheetah LRU
+	 * stack-distance model (Sugumar & Abraham) that CheetahManager uses for the data caches.
+	 *
+	 * Every translation feeds its virtual page into the model of its page size, and every page walk
+	 * access that reaches the PWC feeds its PTE address into the model of its level. At each stats
+	 * write, the models report how many accesses would hit in an LRU TLB/PWC of every power-of-two
+	 * number of sets in [min_sets_bits, max_sets_bits] and every power-of-two associativity up to
+	 * 2^assoc_bits, so one simulation yields the hit-rate curves of all these geometries:
+	 *
+	 *   <mmu>_cheetah.tlb_<page size bits>_accesses
+	 *   <mmu>_cheetah.tlb_<page size bits>_hits_<sets>x<ways>
+	 *   <mmu>_cheetah.pwc_L<level>_accesses, <mmu>_cheetah.pwc_L<level>_hits_<sets>x<ways>
+	 *
+	 * The models only observe the reference stream, so the simulated TLBs and PWC are unaffected.
+	 */
+	class TranslationCheetah
+	{
+	private:
+		struct Stream
+		{
+			CheetahSACLRU *model;
+			UInt64 accesses;
+			std::vector<UInt64> hits; // (sets_bits - m_min_sets_bits) * (m_assoc_bits + 1) + ways_bits
+		};
+
+		const UInt32 m_assoc_bits;
+		const UInt32 m_min_sets_bits;
+		const UInt32 m_max_sets_bits;
+
+		std::vector<int> m_page_size_list;
+		std::vector<Stream> m_tlb_streams; // one per page size, same order as m_page_size_list
+		std::vector<Stream> m_pwc_streams; // one per PWC level
+
+		static const UInt32 PTE_SIZE_BITS = 3; // the PWC caches single 8-byte entries
+
+		void initStream(Stream &stream, UInt32 line_bits, String name, String prefix, core_id_t core_id);
+
+		static SInt64 hook_update(UInt64 user, UInt64 args)
+		{ ((TranslationCheetah*)user)->updateStats(); return 0; }
+		void updateStats();
+
+	public:
+		TranslationCheetah(String name, String cfgname, core_id_t core_id, int page_sizes, const int *page_size_list, int pwc_levels);
+		~TranslationCheetah();
+
+		void accessTLB(IntPtr address, int page_size)
+		{
+			for (UInt32 i = 0; i < m_page_size_list.size(); i++)
+			{
+				if (m_page_size_list[i] == page_size)
+				{
+					m_tlb_streams[i].model->sacnmul_woarr(address);
+					return;
+				}
+			}
+		}
+
+		void accessPWC(IntPtr pte_address, int level)
+		{
+			if (level >= 0 && (UInt32)level < m_pwc_streams.size())
+				m_pwc_streams[level].model->sacnmul_woarr(pte_address);
+		}
+	};
+}
+
+#endif // TRANSLATION_CHEETAH_H
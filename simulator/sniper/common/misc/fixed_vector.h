@@ -0,0 +1,103 @@
+#ifndef FIXED_VECTOR_H
+#define FIXED_VECTOR_H
+
+#include <assert.h>
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+// Vector-like container with inline, fixed-capacity storage.
+// Intended for short-lived records on hot paths (e.g. the list of addresses touched
+// by a page table walk) where a std::vector would cost a heap allocation per use.
+// Only the used prefix is copied, so passing it around is proportional to size().
+// A record that outgrows the N inline elements moves to the heap instead of failing,
+// so N only needs to cover the common case, not the worst one.
+template <class T, unsigned int N> class FixedVector
+{
+   static_assert(std::is_trivially_destructible<T>::value, "FixedVector only holds trivially destructible types");
+
+   private:
+      unsigned int m_size;
+      unsigned int m_capacity;
+      T *m_heap;   // NULL while the elements fit in m_storage
+      alignas(T) unsigned char m_storage[N * sizeof(T)];
+
+      T* data_ptr() { return m_heap ? m_heap : reinterpret_cast<T*>(m_storage); }
+      const T* data_ptr() const { return m_heap ? m_heap : reinterpret_cast<const T*>(m_storage); }
+
+      void reserve(unsigned int capacity)
+      {
+         if (capacity <= m_capacity)
+            return;
+         T *heap = std::allocator<T>().allocate(capacity);
+         std::uninitialized_copy(begin(), end(), heap);
+         release();
+         m_heap = heap;
+         m_capacity = capacity;
+      }
+      void release()
+      {
+         if (m_heap)
+            std::allocator<T>().deallocate(m_heap, m_capacity);
+         m_heap = NULL;
+         m_capacity = N;
+      }
+      void grow() { if (m_size == m_capacity) reserve(2 * m_capacity); }
+
+   public:
+      typedef T value_type;
+      typedef T* iterator;
+      typedef const T* const_iterator;
+
+      FixedVector() : m_size(0), m_capacity(N), m_heap(NULL) {}
+      FixedVector(const FixedVector &other) : m_size(0), m_capacity(N), m_heap(NULL)
+      {
+         reserve(other.m_size);
+         std::uninitialized_copy(other.begin(), other.end(), begin());
+         m_size = other.m_size;
+      }
+      FixedVector& operator=(const FixedVector &other)
+      {
+         if (this != &other)
+         {
+            m_size = 0;
+            reserve(other.m_size);
+            std::uninitialized_copy(other.begin(), other.end(), begin());
+            m_size = other.m_size;
+         }
+         return *this;
+      }
+      ~FixedVector() { release(); }
+
+      static constexpr unsigned int inline_capacity() { return N; }
+      unsigned int size() const { return m_size; }
+      bool empty() const { return m_size == 0; }
+      bool spilled() const { return m_heap != NULL; }
+      void clear() { m_size = 0; }
+
+      void push_back(const T& t) { grow(); ::new (&data_ptr()[m_size++]) T(t); }
+      template <class... Args> void emplace_back(Args&&... args) { grow(); ::new (&data_ptr()[m_size++]) T(std::forward<Args>(args)...); }
+      void pop_back() { assert(m_size > 0); m_size--; }
+
+      iterator erase(iterator first, iterator last)
+      {
+         iterator new_end = std::move(last, end(), first);
+         m_size = new_end - begin();
+         return first;
+      }
+
+      T& operator[](unsigned int idx) { return data_ptr()[idx]; }
+      const T& operator[](unsigned int idx) const { return data_ptr()[idx]; }
+      T& at(unsigned int idx) { assert(idx < m_size); return data_ptr()[idx]; }
+      const T& at(unsigned int idx) const { assert(idx < m_size); return data_ptr()[idx]; }
+      T& front() { return data_ptr()[0]; }
+      T& back() { return data_ptr()[m_size - 1]; }
+
+      iterator begin() { return data_ptr(); }
+      iterator end() { return data_ptr() + m_size; }
+      const_iterator begin() const { return data_ptr(); }
+      const_iterator end() const { return data_ptr() + m_size; }
+};
+
+#endif // FIXED_VECTOR_H
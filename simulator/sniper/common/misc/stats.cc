@@ -3,6 +3,7 @@
 #include "hooks_manager.h"
 #include "utils.h"
 #include "itostr.h"
+#include "config.hpp"
 
 #include <math.h>
 #include <stdio.h>
@@ -40,10 +41,38 @@ UInt64 getWallclockTimeCallback(String objectName, UInt32 index, String metricNa
    return usec;
 }
 
+// Columnar dump: a header followed by 8-byte aligned records, each starting with a
+// {UInt32 type, UInt32 payload bytes} record header. All fields are little-endian.
+//   COLUMN_NAMES: UInt32 first column, UInt32 count, then per column
+//                 {UInt64 nameid, UInt32 index, UInt16 objectname length, UInt16 metricname length, names},
+//                 padded to 8 bytes. Names are written once, before the first snapshot that has the column.
+//   SNAPSHOT:     UInt64 prefixid, UInt32 number of columns, UInt32 prefix length, prefix padded to 8 bytes,
+//                 then one UInt64 per column.
+// A snapshot is a single contiguous array, so the file can be mmap'ed and read back column by column.
+// tools/stats_columnar2sqlite.py converts it into the sim.stats.sqlite3 schema.
+static const UInt64 COLUMNAR_MAGIC = 0x31544154534c4f43ULL; // "COLSTAT1"
+enum { COLUMNAR_COLUMN_NAMES = 1, COLUMNAR_SNAPSHOT = 2 };
+
+static void columnarWrite(FILE *fp, const void *data, size_t size)
+{
+   static const char padding[8] = { 0 };
+   size_t written = fwrite(data, 1, size, fp);
+   LOG_ASSERT_ERROR(written == size, "Error writing sim.stats.columnar");
+   if (size % 8)
+      fwrite(padding, 1, 8 - size % 8, fp);
+}
+
+static UInt32 columnarPadded(size_t size)
+{
+   return (size + 7) & ~7;
+}
+
 StatsManager::StatsManager()
    : m_keyid(0)
    , m_prefixnum(0)
    , m_db(NULL)
+   , m_columnar(NULL)
+   , m_columns_written(0)
 {
    init();
 
@@ -52,10 +81,11 @@ StatsManager::StatsManager()
 
 StatsManager::~StatsManager()
 {
-   for(StatsObjectList::iterator it1 = m_objects.begin(); it1 != m_objects.end(); ++it1)
-      for (StatsMetricList::iterator it2 = it1->second.begin(); it2 != it1->second.end(); ++it2)
-         for(StatsIndexList::iterator it3 = it2->second.second.begin(); it3 != it2->second.second.end(); ++it3)
-            delete it3->second;
+   for (const StatsEntry &entry : m_metrics)
+      delete entry.metric;
+
+   if (m_columnar)
+      fclose(m_columnar);
 
    if (m_db)
    {
@@ -99,6 +129,18 @@ StatsManager::init()
       }
    }
    sqlite3_exec(m_db, "END TRANSACTION", NULL, NULL, NULL);
+
+   if (Sim()->getCfg()->hasKey("general/stats_columnar") && Sim()->getCfg()->getBool("general/stats_columnar"))
+   {
+      String columnar_filename = Sim()->getConfig()->formatOutputFileName("sim.stats.columnar");
+      m_columnar = fopen(columnar_filename.c_str(), "wb");
+      LOG_ASSERT_ERROR(m_columnar, "Cannot create %s", columnar_filename.c_str());
+      // Snapshots are written whole, a large buffer keeps that to a few write() calls
+      setvbuf(m_columnar, NULL, _IOFBF, 1 << 20);
+
+      UInt64 header[2] = { COLUMNAR_MAGIC, 1 /* version */ };
+      columnarWrite(m_columnar, header, sizeof(header));
+   }
 }
 
 int
@@ -145,27 +187,91 @@ StatsManager::recordStats(String prefix)
    res = sqlite3_step(m_stmt_insert_prefix);
    LOG_ASSERT_ERROR(res == SQLITE_DONE, "Error executing SQL statement: %s", sqlite3_errmsg(m_db));
 
-   for(StatsObjectList::iterator it1 = m_objects.begin(); it1 != m_objects.end(); ++it1)
+   for (const StatsEntry &entry : m_metrics)
    {
-      for (StatsMetricList::iterator it2 = it1->second.begin(); it2 != it1->second.end(); ++it2)
+      if (!entry.metric->isDefault())
       {
-         for(StatsIndexList::iterator it3 = it2->second.second.begin(); it3 != it2->second.second.end(); ++it3)
-         {
-            if (!it3->second->isDefault())
-            {
-               sqlite3_reset(m_stmt_insert_value);
-               sqlite3_bind_int(m_stmt_insert_value, 1, prefixid);
-               sqlite3_bind_int(m_stmt_insert_value, 2, it2->second.first);   // Metric ID
-               sqlite3_bind_int(m_stmt_insert_value, 3, it3->second->index);  // Core ID
-               sqlite3_bind_int64(m_stmt_insert_value, 4, it3->second->recordMetric());
-               res = sqlite3_step(m_stmt_insert_value);
-               LOG_ASSERT_ERROR(res == SQLITE_DONE, "Error executing SQL statement: %s", sqlite3_errmsg(m_db));
-            }
-         }
+         sqlite3_reset(m_stmt_insert_value);
+         sqlite3_bind_int(m_stmt_insert_value, 1, prefixid);
+         sqlite3_bind_int(m_stmt_insert_value, 2, entry.keyid);            // Metric ID
+         sqlite3_bind_int(m_stmt_insert_value, 3, entry.metric->index);    // Core ID
+         sqlite3_bind_int64(m_stmt_insert_value, 4, entry.metric->recordMetric());
+         res = sqlite3_step(m_stmt_insert_value);
+         LOG_ASSERT_ERROR(res == SQLITE_DONE, "Error executing SQL statement: %s", sqlite3_errmsg(m_db));
       }
    }
    res = sqlite3_exec(m_db, "END TRANSACTION", NULL, NULL, NULL);
    LOG_ASSERT_ERROR(res == SQLITE_OK, "Error executing SQL statement: %s", sqlite3_errmsg(m_db));
+
+   if (m_columnar)
+      writeColumnarSnapshot(prefixid, prefix);
+}
+
+// Snapshot that only goes to the columnar dump, meant for fine-grained periodic statistics.
+// Without a columnar dump this is a regular recordStats().
+void
+StatsManager::recordSnapshot(String prefix)
+{
+   if (!m_columnar)
+   {
+      recordStats(prefix);
+      return;
+   }
+
+   Sim()->getHooksManager()->callHooks(HookType::HOOK_PRE_STAT_WRITE, (UInt64)prefix.c_str());
+
+   writeColumnarSnapshot(++m_prefixnum, prefix);
+}
+
+void
+StatsManager::writeColumnarNames()
+{
+   std::vector<char> payload;
+   UInt32 range[2] = { (UInt32)m_columns_written, (UInt32)(m_metrics.size() - m_columns_written) };
+   payload.insert(payload.end(), (char*)range, (char*)range + sizeof(range));
+
+   for (UInt64 column = m_columns_written; column < m_metrics.size(); ++column)
+   {
+      const StatsEntry &entry = m_metrics[column];
+      struct __attribute__((packed)) {
+         UInt64 nameid;
+         UInt32 index;
+         UInt16 objectname_length, metricname_length;
+      } name = { entry.keyid, entry.metric->index, (UInt16)entry.metric->objectName.length(), (UInt16)entry.metric->metricName.length() };
+      payload.insert(payload.end(), (char*)&name, (char*)&name + sizeof(name));
+      payload.insert(payload.end(), entry.metric->objectName.begin(), entry.metric->objectName.end());
+      payload.insert(payload.end(), entry.metric->metricName.begin(), entry.metric->metricName.end());
+   }
+
+   UInt32 record[2] = { COLUMNAR_COLUMN_NAMES, columnarPadded(payload.size()) };
+   columnarWrite(m_columnar, record, sizeof(record));
+   columnarWrite(m_columnar, payload.data(), payload.size());
+
+   m_columns_written = m_metrics.size();
+}
+
+void
+StatsManager::writeColumnarSnapshot(UInt64 prefixid, String prefix)
+{
+   if (m_columns_written < m_metrics.size())
+      writeColumnarNames();
+
+   // Gather all values first so the snapshot goes out as one contiguous array
+   m_snapshot.resize(m_metrics.size());
+   for (UInt64 column = 0; column < m_metrics.size(); ++column)
+      m_snapshot[column] = m_metrics[column].metric->recordMetric();
+
+   struct {
+      UInt64 prefixid;
+      UInt32 columns;
+      UInt32 prefix_length;
+   } snapshot = { prefixid, (UInt32)m_snapshot.size(), (UInt32)prefix.length() };
+
+   UInt32 record[2] = { COLUMNAR_SNAPSHOT, (UInt32)(sizeof(snapshot) + columnarPadded(prefix.length()) + m_snapshot.size() * sizeof(UInt64)) };
+   columnarWrite(m_columnar, record, sizeof(record));
+   columnarWrite(m_columnar, &snapshot, sizeof(snapshot));
+   columnarWrite(m_columnar, prefix.c_str(), prefix.length());
+   columnarWrite(m_columnar, m_snapshot.data(), m_snapshot.size() * sizeof(UInt64));
 }
 
 void
@@ -175,17 +281,20 @@ StatsManager::registerMetric(StatsMetricBase *metric)
 
    LOG_ASSERT_ERROR(m_objects[_objectName][_metricName].second.count(metric->index) == 0,
       "Duplicate statistic %s.%s[%d]", _objectName.c_str(), _metricName.c_str(), metric->index);
-   m_objects[_objectName][_metricName].second[metric->index] = metric;
+   StatsMetricWithKey &entry = m_objects[_objectName][_metricName];
+   entry.second[metric->index] = metric;
 
-   if (m_objects[_objectName][_metricName].first == 0)
+   if (entry.first == 0)
    {
-      m_objects[_objectName][_metricName].first = ++m_keyid;
+      entry.first = ++m_keyid;
       if (m_db)
       {
          // Metrics name record was already written, but a new metric was registered afterwards: write a new record
          recordMetricName(m_keyid, _objectName, _metricName);
       }
    }
+
+   m_metrics.push_back(StatsEntry{metric, entry.first});
 }
 
 StatsMetricBase *
@@ -3,7 +3,9 @@
 #include "simulator.h"
 #include "itostr.h"
 
+#include <cstdio>
 #include <cstring>
+#include <vector>
 #include <sqlite3.h>
 
 class StatsMetricBase
@@ -72,6 +74,7 @@ class StatsManager
       ~StatsManager();
       void init();
       void recordStats(String prefix);
+      void recordSnapshot(String prefix);
       void registerMetric(StatsMetricBase *metric);
       StatsMetricBase *getMetricObject(String objectName, UInt32 index, String metricName);
       void logTopology(String component, core_id_t core_id, core_id_t master_id);
@@ -88,6 +91,20 @@ class StatsManager
       sqlite3_stmt *m_stmt_insert_prefix;
       sqlite3_stmt *m_stmt_insert_value;
 
+      // Flat index of all registered metrics in registration order. This is also the column
+      // order of the columnar dump, so a column never moves once it has been written out.
+      struct StatsEntry
+      {
+         StatsMetricBase *metric;
+         UInt64 keyid;
+      };
+      std::vector<StatsEntry> m_metrics;
+
+      // Columnar dump (sim.stats.columnar), see stats.cc for the file layout
+      FILE *m_columnar;
+      UInt64 m_columns_written;
+      std::vector<UInt64> m_snapshot;
+
       // Use std::string here because String (__versa_string) does not provide a hash function for STL containers with gcc < 4.6
       typedef std::unordered_map<UInt64, StatsMetricBase *> StatsIndexList;
       typedef std::pair<UInt64, StatsIndexList> StatsMetricWithKey;
@@ -99,6 +116,8 @@ class StatsManager
       int busy_handler(int count);
 
       void recordMetricName(UInt64 keyId, std::string objectName, std::string metricName);
+      void writeColumnarNames();
+      void writeColumnarSnapshot(UInt64 prefixid, String prefix);
 };
 
 template <class T> void registerStatsMetric(String objectName, UInt32 index, String metricName, T *metric)
@@ -0,0 +1,179 @@
+#include "time_series_sink.h"
+#include "simulator.h"
+#include "config.h"
+#include "config.hpp"
+#include "log.h"
+
+#include <algorithm>
+
+Lock TimeSeriesSink::s_sinks_lock;
+std::vector<TimeSeriesSink*> TimeSeriesSink::s_sinks;
+std::map<String, UInt32> TimeSeriesSink::s_names;
+
+TimeSeriesSink* TimeSeriesSink::create(String name, const std::vector<String> &columns)
+{
+   if (!Sim()->getCfg()->getBoolDefault("general/time_series/enabled", false))
+      return NULL;
+
+   String format = Sim()->getCfg()->getString("general/time_series/format");
+   UInt64 capacity = Sim()->getCfg()->getInt("general/time_series/capacity");
+   UInt64 interval = Sim()->getCfg()->getInt("general/time_series/interval");
+   LOG_ASSERT_ERROR(format == "csv" || format == "binary", "Invalid general/time_series/format %s, expected csv or binary", format.c_str());
+   LOG_ASSERT_ERROR(capacity > 0 && interval > 0, "general/time_series/capacity and interval must be > 0");
+   bool binary = format == "binary";
+
+   ScopedLock sl(s_sinks_lock);
+
+   // Several instances may publish under one name (e.g. a buddy allocator per memory tier), number the later ones
+   UInt32 instance = s_names[name]++;
+   String filename = Sim()->getConfig()->getOutputDirectory() + "/" + name
+                   + (instance ? "." + itostr(instance) : "") + (binary ? ".bin" : ".csv");
+
+   FILE *file = fopen(filename.c_str(), binary ? "wb" : "w");
+   LOG_ASSERT_ERROR(file, "Cannot open time series file %s", filename.c_str());
+
+   if (binary)
+   {
+      header_t header = { MAGIC, (UInt32)columns.size() };
+      fwrite(&header, sizeof(header), 1, file);
+      for (const String &column : columns)
+         fprintf(file, "%s\n", column.c_str());
+   }
+   else
+   {
+      fprintf(file, "x");
+      for (const String &column : columns)
+         fprintf(file, ",%s", column.c_str());
+      fprintf(file, "\n");
+   }
+
+   TimeSeriesSink *sink = new TimeSeriesSink(file, binary, columns.size(), capacity, interval);
+   s_sinks.push_back(sink);
+   return sink;
+}
+
+void TimeSeriesSink::fini()
+{
+   ScopedLock sl(s_sinks_lock);
+   for (TimeSeriesSink *sink : s_sinks)
+      sink->close();
+}
+
+TimeSeriesSink::TimeSeriesSink(FILE *file, bool binary, UInt32 num_columns, UInt64 capacity, UInt64 interval)
+   : m_file(file)
+   , m_binary(binary)
+   , m_num_columns(num_columns)
+   , m_capacity(capacity)
+   , m_interval(interval)
+   , m_ring_x(capacity)
+   , m_ring_values(capacity * num_columns)
+   , m_head(0)
+   , m_tail(0)
+   , m_dropped(0)
+   , m_closing(false)
+{
+   m_thread = _Thread::create(this);
+   m_thread->run();
+}
+
+TimeSeriesSink::~TimeSeriesSink()
+{
+   ScopedLock sl(s_sinks_lock);
+   close();
+   s_sinks.erase(std::remove(s_sinks.begin(), s_sinks.end(), this), s_sinks.end());
+}
+
+void TimeSeriesSink::publish(UInt64 x, const double *values)
+{
+   ScopedLock sl(m_lock);
+
+   if (m_closing || m_head - m_tail == m_capacity)
+   {
+      ++m_dropped;
+      return;
+   }
+
+   UInt64 slot = m_head % m_capacity;
+   m_ring_x[slot] = x;
+   std::copy(values, values + m_num_columns, m_ring_values.data() + slot * m_num_columns);
+   ++m_head;
+
+   // Wake the writer once half the ring is in use, otherwise it picks records up on its own
+   if (m_head - m_tail == (m_capacity + 1) / 2)
+      m_cond.signal();
+}
+
+// Called with s_sinks_lock held
+void TimeSeriesSink::close()
+{
+   UInt64 dropped;
+   {
+      ScopedLock sl(m_lock);
+      if (m_closing)
+         return;
+      m_closing = true;
+      dropped = m_dropped;
+   }
+   m_cond.signal();
+   m_done.wait();
+   delete m_thread;
+   m_thread = NULL;
+
+   if (dropped)
+      fprintf(stderr, "[TimeSeriesSink] Dropped %" PRIu64 " records, consider a larger general/time_series/capacity\n", dropped);
+   fclose(m_file);
+   m_file = NULL;
+}
+
+void TimeSeriesSink::run()
+{
+   std::vector<UInt64> xs(m_capacity);
+   std::vector<double> values(m_capacity * m_num_columns);
+
+   m_lock.acquire();
+   while (true)
+   {
+      // Sleep until half the ring is in use or the series is closed, but look at least once a second
+      if (!m_closing && m_head - m_tail < (m_capacity + 1) / 2)
+         m_cond.wait(m_lock, 1000000000);
+
+      // Take everything published so far, and write it without holding the lock
+      UInt64 count = m_head - m_tail;
+      for (UInt64 i = 0; i < count; i++)
+      {
+         UInt64 slot = (m_tail + i) % m_capacity;
+         xs[i] = m_ring_x[slot];
+         const double *record = m_ring_values.data() + slot * m_num_columns;
+         std::copy(record, record + m_num_columns, values.data() + i * m_num_columns);
+      }
+      m_tail = m_head;
+      bool closing = m_closing;
+
+      m_lock.release();
+      writeRecords(xs, values, count);
+      if (closing)
+         break;
+      m_lock.acquire();
+   }
+
+   m_done.signal();
+}
+
+void TimeSeriesSink::writeRecords(const std::vector<UInt64> &xs, const std::vector<double> &values, UInt64 count)
+{
+   for (UInt64 i = 0; i < count; i++)
+   {
+      if (m_binary)
+      {
+         fwrite(&xs[i], sizeof(UInt64), 1, m_file);
+         fwrite(values.data() + i * m_num_columns, sizeof(double), m_num_columns, m_file);
+      }
+      else
+      {
+         fprintf(m_file, "%" PRIu64, xs[i]);
+         for (UInt32 c = 0; c < m_num_columns; c++)
+            fprintf(m_file, ",%g", values[i * m_num_columns + c]);
+         fprintf(m_file, "\n");
+      }
+   }
+}
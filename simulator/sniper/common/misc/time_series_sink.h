@@ -0,0 +1,82 @@
+#ifndef __TIME_SERIES_SINK_H
+#define __TIME_SERIES_SINK_H
+
+#include "fixed_types.h"
+#include "_thread.h"
+#include "lock.h"
+#include "cond.h"
+#include "semaphore.h"
+
+#include <stdio.h>
+#include <vector>
+#include <map>
+
+// Bounded, asynchronous writer for periodically sampled metrics (page table occupancy,
+// allocator fragmentation, ...)
+//
+// Each record is an x value (the publisher's event count) and one double per column.
+// publish() copies the record into a fixed-size ring and returns; a background thread
+// writes the ring out, so the simulation thread never waits for I/O and memory use does
+// not grow with the length of the run. When the writer falls behind and the ring is full,
+// new records are dropped (and counted) rather than blocking the publisher.
+//
+// Series are off unless general/time_series/enabled is set. Output goes to
+// <output_dir>/<name>.csv, or <name>.bin with general/time_series/format = binary:
+// a header_t, the column names (each terminated by '\n'), then records of one UInt64 x
+// followed by num_columns doubles.
+
+class TimeSeriesSink : public Runnable
+{
+   public:
+      struct header_t
+      {
+         UInt32 magic;
+         UInt32 num_columns;
+      };
+      static const UInt32 MAGIC = 0x31535456; // "VTS1"
+
+      // Returns NULL when time series are disabled
+      static TimeSeriesSink* create(String name, const std::vector<String> &columns);
+      // Closes all open series, called at simulation end
+      static void fini();
+
+      ~TimeSeriesSink();
+
+      // Publishers add a record every getInterval() events of their own
+      UInt64 getInterval() const { return m_interval; }
+      UInt32 getNumColumns() const { return m_num_columns; }
+
+      // values holds getNumColumns() doubles
+      void publish(UInt64 x, const double *values);
+
+   private:
+      static Lock s_sinks_lock;
+      static std::vector<TimeSeriesSink*> s_sinks;
+      static std::map<String, UInt32> s_names;   // series created per name, to keep file names unique
+
+      TimeSeriesSink(FILE *file, bool binary, UInt32 num_columns, UInt64 capacity, UInt64 interval);
+
+      void close();
+      void run();
+      void writeRecords(const std::vector<UInt64> &xs, const std::vector<double> &values, UInt64 count);
+
+      FILE *m_file;
+      const bool m_binary;
+      const UInt32 m_num_columns;
+      const UInt64 m_capacity;
+      const UInt64 m_interval;
+
+      Lock m_lock;
+      ConditionVariable m_cond;
+      std::vector<UInt64> m_ring_x;
+      std::vector<double> m_ring_values;   // m_num_columns per record
+      UInt64 m_head;                       // records published
+      UInt64 m_tail;                       // records handed to the writer
+      UInt64 m_dropped;
+      bool m_closing;
+
+      _Thread *m_thread;
+      Semaphore m_done;                    // signalled by the writer thread once everything is written
+};
+
+#endif // __TIME_SERIES_SINK_H
@@ -0,0 +1,111 @@
+#include "translation_trace.h"
+#include "simulator.h"
+#include "core_manager.h"
+#include "config.h"
+#include "log.h"
+
+TranslationTrace* TranslationTrace::g_singleton = NULL;
+
+void TranslationTrace::init()
+{
+   if constexpr (ENABLED)
+      g_singleton = new TranslationTrace(Sim()->getConfig()->getTotalCores());
+}
+
+void TranslationTrace::fini()
+{
+   if (g_singleton)
+   {
+      delete g_singleton;
+      g_singleton = NULL;
+   }
+}
+
+void TranslationTrace::record(core_id_t core, event_type_t type, SubsecondTime time, IntPtr va, UInt64 value,
+                              SubsecondTime latency, SInt8 level, UInt32 aux)
+{
+   TranslationTrace *trace = g_singleton;
+   if (!trace)
+      return;
+
+   record_t rec;
+   rec.time = time.getFS();
+   rec.va = va;
+   rec.value = value;
+   rec.latency = latency.getFS();
+   rec.aux = aux;
+   rec.core = core;
+   rec.type = type;
+   rec.level = level;
+
+   if (core >= 0 && (UInt32)core < trace->m_num_cores)
+   {
+      // Only the core's own thread records into its buffer
+      trace->append(trace->m_buffers[core], core, rec);
+   }
+   else
+   {
+      ScopedLock sl(trace->m_shared_lock);
+      trace->append(trace->m_buffers[trace->m_num_cores], UINT16_MAX, rec);
+   }
+}
+
+core_id_t TranslationTrace::currentCore()
+{
+   // MimicOS sets up its page tables before the core manager exists
+   CoreManager *core_manager = Sim()->getCoreManager();
+   return core_manager ? core_manager->getCurrentCoreID() : INVALID_CORE_ID;
+}
+
+TranslationTrace::TranslationTrace(UInt32 num_cores)
+   : m_num_cores(num_cores)
+   , m_buffers(new buffer_t[num_cores + 1])
+{
+   for (UInt32 i = 0; i <= m_num_cores; ++i)
+   {
+      m_buffers[i].records = new record_t[CHUNK_RECORDS];
+      m_buffers[i].count = 0;
+   }
+
+   String filename = Sim()->getConfig()->formatOutputFileName("translation_trace.bin");
+   m_file = fopen(filename.c_str(), "wb");
+   LOG_ASSERT_ERROR(m_file != NULL, "Cannot open translation trace file %s", filename.c_str());
+}
+
+TranslationTrace::~TranslationTrace()
+{
+   for (UInt32 i = 0; i <= m_num_cores; ++i)
+   {
+      flush(m_buffers[i], i < m_num_cores ? i : UINT16_MAX);
+      delete [] m_buffers[i].records;
+   }
+   delete [] m_buffers;
+   fclose(m_file);
+}
+
+void TranslationTrace::append(buffer_t &buffer, UInt16 core, const record_t &rec)
+{
+   buffer.records[buffer.count++] = rec;
+   if (buffer.count == CHUNK_RECORDS)
+      flush(buffer, core);
+}
+
+void TranslationTrace::flush(buffer_t &buffer, UInt16 core)
+{
+   if (buffer.count == 0)
+      return;
+
+   chunk_header_t header;
+   header.magic = MAGIC;
+   header.record_size = sizeof(record_t);
+   header.core = core;
+   header.num_records = buffer.count;
+   header.reserved = 0;
+
+   {
+      ScopedLock sl(m_file_lock);
+      fwrite(&header, sizeof(header), 1, m_file);
+      fwrite(buffer.records, sizeof(record_t), buffer.count, m_file);
+   }
+   buffer.count = 0;
+}
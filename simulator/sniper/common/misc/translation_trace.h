@@ -0,0 +1,106 @@
+#ifndef __TRANSLATION_TRACE_H
+#define __TRANSLATION_TRACE_H
+
+#include "fixed_types.h"
+#include "subsecond_time.h"
+#include "lock.h"
+
+#include <stdio.h>
+
+// Binary trace of address translation events
+//
+// Intended for investigations that would otherwise flip on the DEBUG_MMU-style text logs,
+// which slow the simulation down by an order of magnitude. Records are fixed-size and binary;
+// each core appends to its own buffer without taking a lock, and full buffers are written out
+// as one chunk to translation_trace.bin in the output directory.
+// Decode offline with tools/translation_trace.py.
+//
+// Tracing is compiled out unless the simulator is built with TRANSLATION_TRACE=1
+// (make TRANSLATION_TRACE=1): TTRACE() then expands to a discarded if constexpr branch,
+// so its arguments are never evaluated.
+
+#ifndef TRANSLATION_TRACE
+#define TRANSLATION_TRACE 0
+#endif
+
+class TranslationTrace
+{
+   public:
+      static constexpr bool ENABLED = TRANSLATION_TRACE;
+
+      // Keep in sync with EVENT_NAMES in tools/translation_trace.py
+      enum event_type_t : UInt8
+      {
+         TLB_HIT = 0,   // level: TLB level that hit, value: PPN, aux: page size
+         TLB_MISS,      // latency: TLB + page table walk latency, value: PPN, aux: page size
+         PAGE_FAULT,    // latency: page fault latency
+         PT_INSERT,     // page table update, value: PPN, aux: page size
+         PHYS_ALLOC,    // value: first physical page, aux: number of pages
+         PHYS_FREE,     // value: first physical page, aux: number of pages
+      };
+
+      struct record_t
+      {
+         UInt64 time;      // fs
+         UInt64 va;
+         UInt64 value;
+         UInt64 latency;   // fs
+         UInt32 aux;
+         UInt16 core;
+         UInt8 type;
+         SInt8 level;
+      };
+      static_assert(sizeof(record_t) == 40, "translation trace records are decoded offline, keep the layout fixed");
+
+      // Every chunk in the file starts with this header, followed by num_records records
+      struct chunk_header_t
+      {
+         UInt32 magic;
+         UInt16 record_size;
+         UInt16 core;
+         UInt32 num_records;
+         UInt32 reserved;
+      };
+      static const UInt32 MAGIC = 0x31545456; // "VTT1"
+
+      static void init();
+      static void fini();
+
+      // core may be INVALID_CORE_ID for events raised outside of a core (e.g. MimicOS boot),
+      // those go through a shared, locked buffer
+      static void record(core_id_t core, event_type_t type, SubsecondTime time, IntPtr va, UInt64 value = 0,
+                         SubsecondTime latency = SubsecondTime::Zero(), SInt8 level = -1, UInt32 aux = 0);
+
+      // Core of the calling thread, for components that are not tied to a core (allocators, page tables)
+      static core_id_t currentCore();
+
+   private:
+      static const UInt32 CHUNK_RECORDS = 64 * 1024;
+
+      struct buffer_t
+      {
+         record_t *records;
+         UInt32 count;
+      };
+
+      static TranslationTrace *g_singleton;
+
+      TranslationTrace(UInt32 num_cores);
+      ~TranslationTrace();
+
+      void append(buffer_t &buffer, UInt16 core, const record_t &rec);
+      void flush(buffer_t &buffer, UInt16 core);
+
+      const UInt32 m_num_cores;
+      buffer_t *m_buffers;     // one per core, plus a shared one at index m_num_cores
+      Lock m_shared_lock;      // protects the shared buffer
+      Lock m_file_lock;        // serializes chunk writes
+      FILE *m_file;
+};
+
+#define TTRACE(...) do { \
+      if constexpr (TranslationTrace::ENABLED) \
+         TranslationTrace::record(__VA_ARGS__); \
+   } while(0)
+
+#endif // __TRANSLATION_TRACE_H
@@ -62,6 +62,8 @@ DramPerfModelDetailed::DramPerfModelDetailed(core_id_t core_id, UInt32 cache_blo
    , m_received_request_from_the_past(0)
    , m_received_request_from_the_unknown_past(0)
    , m_received_request_from_the_present(0)
+   , m_busy_intervals(0)
+   , m_busy_intervals_max(0)
    , m_total_queueing_delay(SubsecondTime::Zero())
    , m_total_access_latency(SubsecondTime::Zero())
    , constant_time_policy(Sim()->getCfg()->getBool("perf_model/dram/ddr/constant_time_policy"))
@@ -129,6 +131,8 @@ DramPerfModelDetailed::DramPerfModelDetailed(core_id_t core_id, UInt32 cache_blo
    registerStatsMetric("dram", core_id, "received-request-from-the-past", &m_received_request_from_the_past);
    registerStatsMetric("dram", core_id, "received-request-from-the-unknown-past", &m_received_request_from_the_unknown_past);
    registerStatsMetric("dram", core_id, "received-request-from-present", &m_received_request_from_the_present);
+   registerStatsMetric("dram", core_id, "bank-busy-intervals", &m_busy_intervals);
+   registerStatsMetric("dram", core_id, "bank-busy-intervals-max", &m_busy_intervals_max);
 
    
 }
@@ -276,93 +280,146 @@ DramPerfModelDetailed::parseDeviceAddress(IntPtr address, UInt32 &channel, UInt3
 }
 
 
+void
+DramPerfModelDetailed::BusyIntervals::updateMaxEnd(UInt32 from)
+{
+   // Recompute the running maximum from `from` on; once it matches the stored value again,
+   // every later entry is unchanged as well
+   for (UInt32 i = from; i < m_nodes.size(); ++i)
+   {
+      SubsecondTime max_end = (i > m_head && m_max_end[i - 1] > m_nodes[i].end_time) ? m_max_end[i - 1] : m_nodes[i].end_time;
+      if (i > from && m_max_end[i] == max_end)
+         break;
+      m_max_end[i] = max_end;
+   }
+}
+
+void
+DramPerfModelDetailed::BusyIntervals::insert(const IntervalNode &node)
+{
+   // Reclaim the space of dropped intervals once they make up half of the vector
+   if (m_head > 0 && m_head * 2 >= m_nodes.size())
+   {
+      m_nodes.erase(m_nodes.begin(), m_nodes.begin() + m_head);
+      m_max_end.erase(m_max_end.begin(), m_max_end.begin() + m_head);
+      m_head = 0;
+   }
+
+   UInt32 pos = upperBound(node.start_time);
+   m_nodes.insert(m_nodes.begin() + pos, node);
+   m_max_end.insert(m_max_end.begin() + pos, node.end_time);
+   updateMaxEnd(pos);
+}
+
+void
+DramPerfModelDetailed::BusyIntervals::popEarliest()
+{
+   assert(!empty());
+   ++m_head;
+   if (!empty())
+      updateMaxEnd(m_head);
+}
+
+UInt32
+DramPerfModelDetailed::BusyIntervals::upperBound(SubsecondTime t) const
+{
+   return std::upper_bound(m_nodes.begin() + m_head, m_nodes.end(), t,
+                           [](SubsecondTime time, const IntervalNode &node) { return time < node.start_time; })
+          - m_nodes.begin();
+}
+
+const DramPerfModelDetailed::IntervalNode *
+DramPerfModelDetailed::BusyIntervals::findOverlap(SubsecondTime t, UInt32 last) const
+{
+   // Every interval in [m_head, last) starts at or before t, so the first one whose running
+   // maximum end reaches t is the earliest interval that contains t
+   auto it = std::lower_bound(m_max_end.begin() + m_head, m_max_end.begin() + last, t);
+   if (it == m_max_end.begin() + last)
+      return NULL;
+   return &m_nodes[it - m_max_end.begin()];
+}
+
+
 std::pair<SubsecondTime, DramPerfModelDetailed::IntervalNode>  DramPerfModelDetailed::fallsWithinInterval(UInt64 page, SubsecondTime pkt_time, IntPtr bank) {
 
-    if (m_banks[bank].m_bank_busy_intervals.empty()) {
+    const BusyIntervals &intervals = m_banks[bank].m_bank_busy_intervals;
+
+    if (intervals.empty()) {
         // No intervals, bank is immediately available
         return {pkt_time, IntervalNode()}; // Return pkt_time as the available cycle
     }
 
-    std::priority_queue<IntervalNode> temp = m_banks[bank].m_bank_busy_intervals;
-
-   IntervalNode last_interval;
+   // Intervals [begin, after) start at or before pkt_time
+   UInt32 after = intervals.upperBound(pkt_time);
 
-   last_interval.start_time = SubsecondTime::Zero();
-   last_interval.end_time = SubsecondTime::Zero();
-   last_interval.open_page = -1;
+   if (after == intervals.begin()) {
 
-    while (!temp.empty()) {
-        IntervalNode interval = temp.top();
-        temp.pop();
+      // The earliest interval starts after pkt_time
+      m_received_request_from_the_unknown_past++;
 
-        if (interval.start_time > pkt_time) {
-
-            if(last_interval.open_page == -1){
+      #ifdef DEBUG_PRINT
+         std::cout << "DRAM received request from the unknown past Counter: " << m_received_request_from_the_unknown_past << std::endl;
+         std::cout << "pkt_time: " << pkt_time.getNS() << " interval.start_time: " << intervals[after].start_time.getNS() << " interval.end_time: " << intervals[after].end_time.getNS() << "max_time: " << m_banks[bank].max_time.getNS() << std::endl;
+      #endif
 
-               m_received_request_from_the_unknown_past++;
+      IntervalNode last_interval;
+      last_interval.start_time = SubsecondTime::Zero();
+      last_interval.end_time = SubsecondTime::Zero();
+      last_interval.open_page = -1;
+      return {pkt_time, last_interval}; // Return pkt_time as the available cycle
+   }
 
-               #ifdef DEBUG_PRINT
-                  std::cout << "DRAM received request from the unknown past Counter: " << m_received_request_from_the_unknown_past << std::endl;
-                  std::cout << "pkt_time: " << pkt_time.getNS() << " interval.start_time: " << interval.start_time.getNS() << " interval.end_time: " << interval.end_time.getNS() << "max_time: " << m_banks[bank].max_time.getNS() << std::endl;
-               #endif
+   const IntervalNode *overlap = intervals.findOverlap(pkt_time, after);
+   if (overlap) {
 
+      m_received_request_from_the_past++;
 
-            }
-            else {
+      #ifdef DEBUG_PRINT
+         std::cout << "DRAM received request from the past Counter: " << m_received_request_from_the_past << std::endl;
+      #endif
 
-               m_received_request_from_the_past++;
+      SubsecondTime next_avail = overlap->end_time + SubsecondTime::NS(1); // +1 ensures availability after this interval ends
+      // Overlap found, return the next available cycle after this interval
+      return {next_avail, *overlap};
+   }
 
-               #ifdef DEBUG_PRINT
-                  std::cout << "DRAM received request from the past Counter: " << m_received_request_from_the_past << std::endl;
-               #endif
-            }
-            // Found an interval that starts after pkt_time
-            return {pkt_time, last_interval}; // Return pkt_time as the available cycle
-        }
+   // No interval contains pkt_time: the bank is free, with the page of the latest interval before it open
+   const IntervalNode &last_interval = intervals[after - 1];
 
-        if (interval.start_time <= pkt_time && interval.end_time >= pkt_time) {
+   if (after != intervals.end()) {
 
-            m_received_request_from_the_past++;
+      m_received_request_from_the_past++;
 
-            #ifdef DEBUG_PRINT
-               std::cout << "DRAM received request from the past Counter: " << m_received_request_from_the_past << std::endl;
-            #endif
-         
-            SubsecondTime next_avail = interval.end_time + SubsecondTime::NS(1); // +1 ensures availability after this interval ends
-            // Overlap found, return the next available cycle after this interval
-            return {next_avail , interval}; // +1 ensures availability after this interval ends
-        }
-        last_interval = interval;
-    }
+      #ifdef DEBUG_PRINT
+         std::cout << "DRAM received request from the past Counter: " << m_received_request_from_the_past << std::endl;
+      #endif
+   }
+   else {
 
-    // If no intervals overlap with pkt_time, bank is free
+      m_received_request_from_the_present++;
 
-    m_received_request_from_the_present++;
-   #ifdef DEBUG_PRINT
-      std::cout << "DRAM received request from the present Counter: " << m_received_request_from_the_present << std::endl;
-   #endif
+      #ifdef DEBUG_PRINT
+         std::cout << "DRAM received request from the present Counter: " << m_received_request_from_the_present << std::endl;
+      #endif
+   }
 
-    return {pkt_time, last_interval}; // Return pkt_time as the available cycle
-    
+   return {pkt_time, last_interval}; // Return pkt_time as the available cycle
 }
 
 void
 DramPerfModelDetailed::cleanupBusyIntervals( IntPtr bank){
-   m_banks[bank].m_bank_busy_intervals.pop();
+   m_banks[bank].m_bank_busy_intervals.popEarliest();
+   m_busy_intervals--;
 }
 
-void DramPerfModelDetailed::printInterval(std::priority_queue<IntervalNode> intervals){
-  
-   std::priority_queue<IntervalNode> temp = intervals;
-   while(!temp.empty()){
-      IntervalNode interval = temp.top();
-      temp.pop();
+void DramPerfModelDetailed::printInterval(const BusyIntervals &intervals){
 
-      #ifdef DEBUG_PRINT
+   #ifdef DEBUG_PRINT
+      for (UInt32 i = intervals.begin(); i < intervals.end(); ++i) {
+         const IntervalNode &interval = intervals[i];
          std::cout << "Start: " << interval.start_time.getNS() << " End: " << interval.end_time.getNS() << " Page: " << interval.open_page << std::endl;
-      #endif
-
-   }
+      }
+   #endif
 }
 
 
@@ -561,7 +618,10 @@ DramPerfModelDetailed::getAccessLatency(SubsecondTime pkt_time, UInt64 pkt_size,
    }
 
    IntervalNode node{t_avail, t_now, page};
-   bank_info.m_bank_busy_intervals.push(node);
+   bank_info.m_bank_busy_intervals.insert(node);
+   m_busy_intervals++;
+   if (bank_info.m_bank_busy_intervals.size() > m_busy_intervals_max)
+      m_busy_intervals_max = bank_info.m_bank_busy_intervals.size();
    printInterval(bank_info.m_bank_busy_intervals);
 
 
@@ -92,6 +92,38 @@ class DramPerfModelDetailed : public DramPerfModel
          }
       };
 
+      // Busy intervals of one bank, ordered by start time (FIFO among equal starts).
+      // m_max_end[i] is the latest end time among the live intervals up to i, which is monotonic,
+      // so the earliest interval overlapping a given time is found with a binary search.
+      // Intervals mostly arrive in time order, so inserting and dropping the earliest interval
+      // are amortized O(1); the prefix maxima are only patched as far as they change.
+      class BusyIntervals
+      {
+         private:
+            std::vector<IntervalNode> m_nodes;
+            std::vector<SubsecondTime> m_max_end;
+            UInt32 m_head;                      // m_nodes[0, m_head) have been dropped
+
+            void updateMaxEnd(UInt32 from);
+         public:
+            BusyIntervals() : m_head(0) {}
+
+            bool empty() const { return m_head == m_nodes.size(); }
+            UInt32 size() const { return m_nodes.size() - m_head; }
+
+            void insert(const IntervalNode &node);
+            void popEarliest();
+
+            // Index of the first interval starting after t
+            UInt32 upperBound(SubsecondTime t) const;
+            // Earliest-starting interval among [begin(), last) that contains t, or NULL
+            const IntervalNode *findOverlap(SubsecondTime t, UInt32 last) const;
+
+            UInt32 begin() const { return m_head; }
+            UInt32 end() const { return m_nodes.size(); }
+            const IntervalNode &operator[](UInt32 idx) const { return m_nodes[idx]; }
+      };
+
 
       struct BankInfo
       {
@@ -101,7 +133,7 @@ class DramPerfModelDetailed : public DramPerfModel
          SubsecondTime max_time;
          IntPtr max_page;
          page_type open_page_type;
-         std::priority_queue<IntervalNode> m_bank_busy_intervals;
+         BusyIntervals m_bank_busy_intervals;
       };
 
       std::vector<BankInfo> m_banks;
@@ -119,6 +151,9 @@ class DramPerfModelDetailed : public DramPerfModel
       UInt64 m_received_request_from_the_unknown_past;
       UInt64 m_received_request_from_the_present;
 
+      UInt64 m_busy_intervals;            // Busy intervals currently tracked, over all banks
+      UInt64 m_busy_intervals_max;        // Most busy intervals tracked by a single bank
+
 
       SubsecondTime m_total_queueing_delay;
       SubsecondTime m_total_access_latency;
@@ -132,7 +167,7 @@ class DramPerfModelDetailed : public DramPerfModel
 
       std::pair<SubsecondTime, IntervalNode>  fallsWithinInterval(UInt64 page, SubsecondTime pkt_time, IntPtr bank);
       void cleanupBusyIntervals(IntPtr bank);
-      void printInterval(std::priority_queue<IntervalNode> intervals);
+      void printInterval(const BusyIntervals &intervals);
 
    public:
       DramPerfModelDetailed(core_id_t core_id, UInt32 cache_block_size, AddressHomeLookup* address_home_lookup);
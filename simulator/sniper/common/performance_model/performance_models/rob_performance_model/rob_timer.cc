@@ -880,7 +880,7 @@ void RobTimer::execute(uint64_t& instructionsExecuted, SubsecondTime& latency)
    // Process any pending TLB shootdown requests so that other cores waiting
    // for our ACK are not blocked while we drain the ROB.  The lock-free
    // atomic check makes this essentially free on the fast path.
-   if (m_core->m_tlb_shootdown_pending.load(std::memory_order_acquire))
+   if (m_core->hasPendingTLBShootdown())
       m_core->processTLBShootdownBuffer(false);
 
    #ifdef DEBUG_PERCYCLE
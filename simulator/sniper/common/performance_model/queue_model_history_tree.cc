@@ -0,0 +1,167 @@
+#include "queue_model_history_tree.h"
+#include "simulator.h"
+#include "config.h"
+#include "log.h"
+#include "stats.h"
+#include "config.hpp"
+
+QueueModelHistoryTree::QueueModelHistoryTree(String name, UInt32 id, SubsecondTime min_processing_time):
+   m_min_processing_time(min_processing_time),
+   m_utilized_time(SubsecondTime::Zero()),
+   m_total_queue_delay(SubsecondTime::Zero()),
+   m_total_requests(0),
+   m_total_requests_using_analytical_model(0)
+{
+   UInt32 max_list_size = 0;
+   try
+   {
+      m_analytical_model_enabled = Sim()->getCfg()->getBool("queue_model/history_tree/analytical_model_enabled");
+      max_list_size = Sim()->getCfg()->getInt("queue_model/history_tree/max_list_size");
+   }
+   catch(...)
+   {
+      LOG_PRINT_ERROR("Could not read parameters from cfg");
+   }
+   LOG_ASSERT_ERROR(max_list_size >= 1, "queue_model/history_tree/max_list_size must be at least 1");
+   m_max_free_interval_list_size = max_list_size;
+   m_average_delay = MovingAverage<SubsecondTime>::createAvgType(MovingAverage<SubsecondTime>::ARITHMETIC_MEAN, max_list_size);
+
+   // Assumption: simulation time will not exceed 2^63 fs
+   SubsecondTime max_simulation_time = SubsecondTime::FS() << 63;
+   m_free_intervals.emplace(SubsecondTime::Zero(), max_simulation_time);
+
+   registerStatsMetric(name, id, "num-requests", &m_total_requests);
+   registerStatsMetric(name, id, "num-requests-analytical", &m_total_requests_using_analytical_model);
+   registerStatsMetric(name, id, "total-time-used", &m_utilized_time);
+   registerStatsMetric(name, id, "total-queue-delay", &m_total_queue_delay);
+}
+
+QueueModelHistoryTree::~QueueModelHistoryTree()
+{
+   delete m_average_delay;
+}
+
+bool
+QueueModelHistoryTree::useAnalyticalModel(SubsecondTime pkt_time, SubsecondTime processing_time) const
+{
+   // A packet that completes before the oldest interval we still remember is too old for the history
+   return m_analytical_model_enabled && ((pkt_time + processing_time) <= m_free_intervals.begin()->first);
+}
+
+SubsecondTime
+QueueModelHistoryTree::computeQueueDelay(SubsecondTime pkt_time, SubsecondTime processing_time, core_id_t requester)
+{
+   LOG_ASSERT_ERROR(m_free_intervals.size() >= 1, "Free interval map size < 1");
+
+   SubsecondTime queue_delay;
+
+   if (useAnalyticalModel(pkt_time, processing_time))
+   {
+      m_total_requests_using_analytical_model ++;
+      // Same estimate as QueueModelHistoryList: the average of recent history-based delays
+      queue_delay = m_average_delay->compute();
+   }
+   else
+   {
+      queue_delay = computeUsingHistoryTree(pkt_time, processing_time);
+      m_average_delay->update(queue_delay);
+   }
+
+   m_utilized_time += processing_time;
+
+   m_total_requests ++;
+   m_total_queue_delay += queue_delay;
+
+   return queue_delay;
+}
+
+SubsecondTime
+QueueModelHistoryTree::computeQueueDelayNoEffect(SubsecondTime pkt_time, SubsecondTime processing_time, core_id_t requester)
+{
+   LOG_ASSERT_ERROR(m_free_intervals.size() >= 1, "Free interval map size < 1");
+
+   if (useAnalyticalModel(pkt_time, processing_time))
+      return m_average_delay->compute();
+
+   SubsecondTime queue_delay;
+   findInterval(pkt_time, processing_time, queue_delay);
+   return queue_delay;
+}
+
+float
+QueueModelHistoryTree::getQueueUtilization()
+{
+   SubsecondTime total_time = m_free_intervals.rbegin()->first;
+
+   if (total_time == SubsecondTime::Zero())
+   {
+      LOG_ASSERT_ERROR(m_utilized_time == SubsecondTime::Zero(), "m_utilized_time(%s), total_time(%s)",
+            itostr(m_utilized_time).c_str(), itostr(total_time).c_str());
+      return 0;
+   }
+   else
+   {
+      return ((float) m_utilized_time.getInternalDataForced() / total_time.getInternalDataForced());
+   }
+}
+
+float
+QueueModelHistoryTree::getFracRequestsUsingAnalyticalModel()
+{
+  if (m_total_requests == 0)
+     return 0;
+  else
+     return ((float) m_total_requests_using_analytical_model / m_total_requests);
+}
+
+// Returns the free interval the packet is served in, and its queueing delay. This is the interval the
+// linear scan of QueueModelHistoryList stops at: the one containing pkt_time if the packet fits in
+// it, otherwise the first interval starting after pkt_time.
+QueueModelHistoryTree::FreeIntervalMap::iterator
+QueueModelHistoryTree::findInterval(SubsecondTime pkt_time, SubsecondTime processing_time, SubsecondTime &queue_delay)
+{
+   FreeIntervalMap::iterator it = m_free_intervals.upper_bound(pkt_time);
+
+   if (it != m_free_intervals.begin())
+   {
+      FreeIntervalMap::iterator prev = std::prev(it);
+      if ((pkt_time + processing_time) <= prev->second)
+      {
+         queue_delay = SubsecondTime::Zero();
+         return prev;
+      }
+   }
+
+   LOG_ASSERT_ERROR(it != m_free_intervals.end(), "queue delay, free interval not found for pkt_time(%s)", itostr(pkt_time).c_str());
+   // WH: as in QueueModelHistoryList, a request that does not fit before this free part is served at
+   //     its start, even if the interval is too short to hold it
+   queue_delay = it->first - pkt_time;
+   return it;
+}
+
+SubsecondTime
+QueueModelHistoryTree::computeUsingHistoryTree(SubsecondTime pkt_time, SubsecondTime processing_time)
+{
+   SubsecondTime queue_delay;
+   FreeIntervalMap::iterator it = findInterval(pkt_time, processing_time, queue_delay);
+
+   SubsecondTime start = it->first, end = it->second;
+   SubsecondTime service_start = pkt_time + queue_delay;
+   SubsecondTime service_end = service_start + processing_time;
+
+   // Split the interval around the service time, dropping fragments too small to serve anyone
+   FreeIntervalMap::iterator hint = m_free_intervals.erase(it);
+   if (service_start > start && (service_start - start) >= m_min_processing_time)
+      m_free_intervals.emplace_hint(hint, start, service_start);
+   if (end > service_end && (end - service_end) >= m_min_processing_time)
+      m_free_intervals.emplace_hint(hint, service_end, end);
+
+   if (m_free_intervals.size() > m_max_free_interval_list_size)
+   {
+      m_free_intervals.erase(m_free_intervals.begin());
+   }
+
+   LOG_PRINT("HistoryTree: pkt_time(%s), processing_time(%s), queue_delay(%s)", itostr(pkt_time).c_str(), itostr(processing_time).c_str(), itostr(queue_delay).c_str());
+
+   return queue_delay;
+}
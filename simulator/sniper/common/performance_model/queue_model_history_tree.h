@@ -0,0 +1,50 @@
+#ifndef __QUEUE_MODEL_HISTORY_TREE_H__
+#define __QUEUE_MODEL_HISTORY_TREE_H__
+
+#include <map>
+
+#include "queue_model.h"
+#include "fixed_types.h"
+#include "moving_average.h"
+
+// Variant of QueueModelHistoryList that keeps the free intervals in an ordered map keyed on
+// their start time. Finding the interval a packet lands in, and splitting it, is O(log n)
+// instead of a walk over the list, so max_list_size can be set much larger.
+class QueueModelHistoryTree : public QueueModel
+{
+public:
+   // start -> end of each free interval; intervals are disjoint
+   typedef std::map<SubsecondTime,SubsecondTime> FreeIntervalMap;
+
+   QueueModelHistoryTree(String name, UInt32 id, SubsecondTime min_processing_time);
+   ~QueueModelHistoryTree();
+
+   SubsecondTime computeQueueDelay(SubsecondTime pkt_time, SubsecondTime processing_time, core_id_t requester = INVALID_CORE_ID);
+   SubsecondTime computeQueueDelayNoEffect(SubsecondTime pkt_time, SubsecondTime processing_time, core_id_t requester = INVALID_CORE_ID);
+   float getQueueUtilization();
+   float getFracRequestsUsingAnalyticalModel();
+
+private:
+   SubsecondTime m_min_processing_time;
+   UInt32 m_max_free_interval_list_size;
+
+   FreeIntervalMap m_free_intervals;
+
+   // Tracks queue utilization
+   SubsecondTime m_utilized_time;
+   SubsecondTime m_total_queue_delay;
+   MovingAverage<SubsecondTime>* m_average_delay;
+
+   // Is analytical model used ?
+   bool m_analytical_model_enabled;
+
+   // Performance Counters
+   UInt64 m_total_requests;
+   UInt64 m_total_requests_using_analytical_model;
+
+   bool useAnalyticalModel(SubsecondTime pkt_time, SubsecondTime processing_time) const;
+   FreeIntervalMap::iterator findInterval(SubsecondTime pkt_time, SubsecondTime processing_time, SubsecondTime &queue_delay);
+   SubsecondTime computeUsingHistoryTree(SubsecondTime pkt_time, SubsecondTime processing_time);
+};
+
+#endif /* __QUEUE_MODEL_HISTORY_TREE_H__ */
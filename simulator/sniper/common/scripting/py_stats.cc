@@ -100,6 +100,24 @@ writeStats(PyObject *self, PyObject *args)
 }
 
 
+//////////
+// snapshot(): write the current set of statistics to the columnar dump only (or to sim.stats when it is disabled)
+//////////
+
+static PyObject *
+snapshotStats(PyObject *self, PyObject *args)
+{
+   const char *prefix = NULL;
+
+   if (!PyArg_ParseTuple(args, "s", &prefix))
+      return NULL;
+
+   Sim()->getStatsManager()->recordSnapshot(prefix);
+
+   Py_RETURN_NONE;
+}
+
+
 //////////
 // register(): register a callback function that returns a statistics value
 //////////
@@ -208,6 +226,7 @@ static PyMethodDef PyStatsMethods[] = {
    {"get",  getStatsValue, METH_VARARGS, "Retrieve current value of statistic (objectName, index, metricName)."},
    {"getter", getStatsGetter, METH_VARARGS, "Return object to retrieve statistics value."},
    {"write", writeStats, METH_VARARGS, "Write statistics (<prefix>, [<filename>])."},
+   {"snapshot", snapshotStats, METH_VARARGS, "Write statistics to sim.stats.columnar only (<prefix>), falls back to write() when general/stats_columnar is off."},
    {"register", registerStats, METH_VARARGS, "Register callback that defines statistics value for (objectName, index, metricName)."},
    {"register_per_thread", registerPerThread, METH_VARARGS, "Add a per-thread statistic (perthreadName) based on a named statistic (objectName, metricName)."},
    {"marker", writeMarker, METH_VARARGS, "Record a marker (coreid, threadid, arg0, arg1, [description])."},
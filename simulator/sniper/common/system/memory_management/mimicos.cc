@@ -67,6 +67,14 @@ MimicOS::MimicOS(bool _is_guest) : m_page_fault_latency(NULL, 0), tlb_flush_late
         one_app = false;
     }
 
+    // Start with room for the applications of the trace, createApplication() adds chunks for any later ones
+    int max_apps = Sim()->getCfg()->hasKey("traceinput/num_apps") ? Sim()->getCfg()->getInt("traceinput/num_apps") : 1;
+    AppDirectory *directory = new AppDirectory((std::max(max_apps, 1) + APPS_PER_CHUNK - 1) / APPS_PER_CHUNK);
+    for (AppChunk *&chunk : *directory)
+        chunk = new AppChunk();
+    m_app_directories.push_back(directory);
+    m_apps.store(directory, std::memory_order_release);
+
     if (Sim()->getCfg()->hasKey("migration/migration_enable")) {
         page_migration_handler = MigrationFactory::createMigration(mimicos_name);
         if (page_migration_handler) {
@@ -148,6 +156,17 @@ MimicOS::MimicOS(bool _is_guest) : m_page_fault_latency(NULL, 0), tlb_flush_late
 
 MimicOS::~MimicOS()
 {
+    // The latest directory holds every chunk, the older ones only share them
+    for (AppChunk *chunk : *m_apps.load())
+    {
+        if (!chunk)
+            continue;
+        for (auto &app : *chunk)
+            delete app.load();
+        delete chunk;
+    }
+    for (const AppDirectory *directory : m_app_directories)
+        delete directory;
     delete m_memory_allocator;
 }
 
@@ -594,9 +613,11 @@ void MimicOS::DMA_migrate(IntPtr move_id, subsecond_time_t finish_time, int app_
 
 void MimicOS::handle_page_fault(IntPtr address, IntPtr core_id, int frames)
 {
-    // todo: app_id = 0 only support multi-threaded simulation
-    ParametricDramDirectoryMSI::PageTable *pt = getPageTable(0);
-    std::unique_lock<std::shared_mutex> write_mutex(pt->get_lock_for_page(address));
+    // Callers pass the id of the faulting application. Only the page lock of that application's
+    // page table is taken, so faults of different applications proceed in parallel.
+    ParametricDramDirectoryMSI::PageTable *pt = getPageTable(core_id);
+    LOG_ASSERT_ERROR(pt != NULL, "Page fault for unknown application %d", (int)core_id);
+    std::unique_lock<ParametricDramDirectoryMSI::PageTableLock> write_mutex(pt->get_lock_for_page(address));
     if (pt->check_page_exist(address)) {
         // cout << "PTE of 0x" << address << " has been created" << endl;
         return;
@@ -606,7 +627,10 @@ void MimicOS::handle_page_fault(IntPtr address, IntPtr core_id, int frames)
 
 void MimicOS::createApplication(int app_id)
 {
-    if (page_tables.find(app_id) != page_tables.end())
+    std::lock_guard<std::mutex> lock(m_create_app_lock);
+
+    LOG_ASSERT_ERROR(app_id >= 0, "Invalid application id %d", app_id);
+    if (getApp(app_id) != NULL)
     {
         std::cout << "[MimicOS] Application " << app_id << " already exists" << std::endl;
         return;
@@ -614,20 +638,39 @@ void MimicOS::createApplication(int app_id)
 
     std::cout << "[MimicOS] Creating application " << app_id << " with page table type " << page_table_type << " and name " << page_table_name << std::endl;
 
+    AppState *app = new AppState();
+
     // Create a new page table for the application
-    ParametricDramDirectoryMSI::PageTable *page_table = ParametricDramDirectoryMSI::PageTableFactory::createPageTable(page_table_type, page_table_name, app_id, is_guest);
-    page_tables[app_id] = page_table;
+    app->page_table = ParametricDramDirectoryMSI::PageTableFactory::createPageTable(page_table_type, page_table_name, app_id, is_guest);
+    app->range_table = ParametricDramDirectoryMSI::RangeTableFactory::createRangeTable(range_table_type, range_table_name, app_id);
 
-    ParametricDramDirectoryMSI::RangeTable *range_table = ParametricDramDirectoryMSI::RangeTableFactory::createRangeTable(range_table_type, range_table_name, app_id);
-    range_tables[app_id] = range_table;
+    parseVMAs(app_id, app->vmas);
 
+    // Make room for the application: publish a copy of the directory that includes its chunk
+    const AppDirectory *directory = m_apps.load(std::memory_order_relaxed);
+    UInt64 chunk = app_id / APPS_PER_CHUNK;
+    if (chunk >= directory->size() || (*directory)[chunk] == NULL)
+    {
+        AppDirectory *grown = new AppDirectory(*directory);
+        if (chunk >= grown->size())
+            grown->resize(chunk + 1, NULL);
+        (*grown)[chunk] = new AppChunk();
+        m_app_directories.push_back(grown);
+        m_apps.store(grown, std::memory_order_release);
+        directory = grown;
+    }
+
+    // Publish the fully built state, readers load it without taking any lock
+    (*(*directory)[chunk])[app_id % APPS_PER_CHUNK].store(app, std::memory_order_release);
+}
+
+void MimicOS::parseVMAs(int app_id, std::vector<VMA> &vmas)
+{
     std::cout << "[MimicOS] Parsing provided VMAs for application " << app_id << std::endl;
 
     // Parse the provided VMAs from the file: /path/to/input/trace/trace.vma
     // Convert the app_id to a GNU String
 
-
-
     String app_id_str = to_string(app_id).c_str();
     
     if (!Sim()->getCfg()->hasKey("traceinput/thread_" + app_id_str))
@@ -646,8 +689,6 @@ void MimicOS::createApplication(int app_id)
         return;
     }
 
-    std::vector<VMA> vmas;
-
     std::string line;
     while (std::getline(trace, line))
     {
@@ -679,7 +720,6 @@ void MimicOS::createApplication(int app_id)
         }
     }
 
-    vm_areas[app_id] = vmas;
     std::cout << "[MimicOS] VMAs for application " << app_id << " have been parsed" << std::endl;
 
 // Print the VMAs for the application
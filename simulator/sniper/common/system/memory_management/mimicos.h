@@ -12,6 +12,7 @@
 #include <unordered_map>
 #include <mutex>
 #include <atomic>
+#include <array>
 
 #include "page_migration/memtis.h"
 
@@ -47,12 +48,38 @@ private:
     int number_of_page_sizes;
     int *page_size_list;
 
-    // Use an unordered map to store the page table for each application
-    std::unordered_map<UInt64, ParametricDramDirectoryMSI::PageTable*> page_tables;
-    std::unordered_map<UInt64, ParametricDramDirectoryMSI::RangeTable*> range_tables;
+    // Per-application OS state. An application's shard is built completely by createApplication() and
+    // then published in m_apps, after which it is only read: looking up an application (on every
+    // walk, fault and VMA check) is a single atomic load and different applications share nothing.
+    struct AppState
+    {
+        ParametricDramDirectoryMSI::PageTable *page_table;
+        ParametricDramDirectoryMSI::RangeTable *range_table;
+        std::vector<VMA> vmas; // sorted as in the trace's .vma file
+    };
 
-    // Use an unordered map to store the virtual memory areas for each application
-    std::unordered_map<UInt64, std::vector<VMA>> vm_areas;
+    // Applications can be created at any time (TraceManager adds them at runtime), so the directory grows in
+    // fixed-size chunks. A chunk never moves once allocated; growing publishes a new copy of the (small)
+    // array of chunk pointers, and the old copies are kept until the OS is destroyed since a reader may
+    // still be looking at one. Lookups therefore stay lock-free.
+    static const int APPS_PER_CHUNK = 64;
+    typedef std::array<std::atomic<AppState*>, APPS_PER_CHUNK> AppChunk; // NULL until the application is created
+    typedef std::vector<AppChunk*> AppDirectory;                          // chunk i holds app ids [i * APPS_PER_CHUNK, (i + 1) * APPS_PER_CHUNK)
+    std::atomic<const AppDirectory*> m_apps;
+    std::vector<const AppDirectory*> m_app_directories; // every directory published, freed with the OS
+    std::mutex m_create_app_lock;                       // serializes createApplication() only
+
+    AppState *getApp(int app_id) const
+    {
+        if (app_id < 0)
+            return NULL;
+        const AppDirectory *directory = m_apps.load(std::memory_order_acquire);
+        UInt64 chunk = app_id / APPS_PER_CHUNK;
+        if (chunk >= directory->size() || (*directory)[chunk] == NULL)
+            return NULL;
+        return (*(*directory)[chunk])[app_id % APPS_PER_CHUNK].load(std::memory_order_acquire);
+    }
+    void parseVMAs(int app_id, std::vector<VMA> &vmas);
 
     PageMigration *page_migration_handler;
     ComponentLatency tlb_flush_latency;
@@ -114,10 +141,16 @@ public:
 
     PhysicalMemoryAllocator *getMemoryAllocator() { return m_memory_allocator; }
 
-    ParametricDramDirectoryMSI::PageTable* getPageTable(int app_id) { return page_tables[app_id]; }
-    ParametricDramDirectoryMSI::RangeTable* getRangeTable(int app_id) { return range_tables[app_id]; }
+    ParametricDramDirectoryMSI::PageTable* getPageTable(int app_id) const { AppState *app = getApp(app_id); return app ? app->page_table : NULL; }
+    ParametricDramDirectoryMSI::RangeTable* getRangeTable(int app_id) const { AppState *app = getApp(app_id); return app ? app->range_table : NULL; }
 
-    std::vector<VMA> getVMA(int app_id) { return vm_areas[app_id]; }
+    // The VMAs never change once the application is created, so callers get a reference instead of a copy
+    const std::vector<VMA>& getVMA(int app_id) const
+    {
+        static const std::vector<VMA> no_vmas;
+        AppState *app = getApp(app_id);
+        return app ? app->vmas : no_vmas;
+    }
 
     void setPageTableType(String type) { page_table_type = type; }
     void setPageTableName(String name) { page_table_name = name; }
@@ -39,13 +39,13 @@ class VMA
         void setAllocated(bool alloc){
             allocated = alloc;
         }
-        bool isAllocated(){
+        bool isAllocated() const{
             return allocated;
         }
-        IntPtr getBase(){
+        IntPtr getBase() const{
             return vbase;
         }
-        IntPtr getEnd(){
+        IntPtr getEnd() const{
             return vend;
         }
         std::vector<Range> getPhysicalRanges(){
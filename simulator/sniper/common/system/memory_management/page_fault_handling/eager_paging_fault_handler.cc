@@ -86,7 +86,7 @@ void EagerPagingFaultHandler::handlePageFault(UInt64 address, UInt64 app_id, int
 
     // Find the VMA that contains the address
 
-    std::vector<VMA> vma_list = Sim()->getMimicOS()->getVMA(app_id);
+    const std::vector<VMA> &vma_list = Sim()->getMimicOS()->getVMA(app_id);
     VMA final_vma(0,0);
     for (UInt32 i = 0; i < vma_list.size(); i++)
     {
@@ -267,7 +267,10 @@ namespace Hemem{
         nvm_hot_list("nvm_hot"),
         dram_cold_list("dram_cold"),
         nvm_cold_list("nvm_cold"),
-        still_run(true)
+        still_run(true),
+        samples(PERF_DRAIN_BATCH),
+        cur_cool_in_dram(nullptr),
+        cur_cool_in_nvm(nullptr)
     {
         this->setName("Hemem");
     }
@@ -279,27 +282,34 @@ namespace Hemem{
 
 
     void Hemem::scan() {
-        bool perf_empty = false;
-        size_t core_number = Sim()->getCoreManager()->getCoreNum();
         while (still_run) {
-            for (int i = 0; i < core_number; ++i) {
-                PageTracer *page_tracer = Sim()->getCoreManager()->getCoreFromID(i)->getPageTracer();
-                while (true) {
-                    PerfSample page_sample = page_tracer->getPerfSample(&perf_empty);
-                    if (perf_empty) {
-                        break;
-                    }
+            scan_step();
+            usleep(PEBS_KSWAPD_INTERVAL);
+        } // while (run)
+    }
+
+    void Hemem::scan_step() {
+        size_t core_number = Sim()->getCoreManager()->getCoreNum();
+        for (int i = 0; i < core_number; ++i) {
+            PageTracer *page_tracer = Sim()->getCoreManager()->getCoreFromID(i)->getPageTracer();
+            size_t n_samples;
+            while ((n_samples = page_tracer->drain(samples)) > 0) {
+                for (size_t s = 0; s < n_samples; ++s) {
+                    const PerfSample &page_sample = samples[s];
                     // std::cout << "[Hemem] perf addr : " << reinterpret_cast<void *>(page_sample.addr) << std::endl;
-                    UInt64 addr = page_sample.addr & pages_mask[0];  // base page
-                    auto it = pages_hotness.find(addr);
-                    if (it == pages_hotness.end()) {
+                    hemem_page *page;
+                    {
+                        std::shared_lock<std::shared_mutex> lock(pages_hotness_lock);
+                        page = pages_hotness.find(page_sample.addr >> BASE_PAGE_SHIFT);  // base page
+                    }
+                    if (page == nullptr) {
                         other_pages_cnt++;
-                        usleep(PEBS_KSWAPD_INTERVAL);
+                        if (!simulated_clock)
+                            usleep(PEBS_KSWAPD_INTERVAL);
                         continue;
                         // return nullptr;
                     }
 
-                    hemem_page *page = it->second;
                     int access_index = -1;
 
                     switch (page_sample.type) {
@@ -321,7 +331,7 @@ namespace Hemem{
                     if (page->in_dram && !page->initial_in_dram) {
                         Sim()->getMimicOS()->incrementBeneficialDramAccessSamples();
                     }
-                    
+                
                     if (!page->in_dram && page->initial_in_dram) {
                         Sim()->getMimicOS()->incrementPenalizedNvmAccessSamples();
                     }
@@ -329,14 +339,14 @@ namespace Hemem{
                     if (page->accesses[READ] >= HOT_READ_THRESHOLD || page->accesses[WRITE] >= HOT_READ_THRESHOLD) {
                         // Make the page hot
                         if (!page->hot || !page->ring_present) {
-                            // std::cout << "[Hemem] "<<(void *)it->first<<" enter hot LRU" << std::endl;
+                            // std::cout << "[Hemem] "<<(void *)page->vaddr<<" enter hot LRU" << std::endl;
                             page->ring_present = true;
                             hot_ring.push_back(page);
                         }
                     } else if (page->accesses[WRITE] < HOT_WRITE_THRESHOLD && page->accesses[READ] < HOT_READ_THRESHOLD) {
                         // Make the page cold
                         if (page->hot || !page->ring_present) {
-                            // std::cout << "[Hemem] "<<(void *)it->first<<" enter cold LRU" << std::endl;
+                            // std::cout << "[Hemem] "<<(void *)page->vaddr<<" enter cold LRU" << std::endl;
                             page->ring_present = true;
                             cold_ring.push_back(page);
                         }
@@ -350,118 +360,125 @@ namespace Hemem{
                         need_cool_nvm = true;
                     }
                     hemem_pages_cnt++;
-                } // while for one core ring buffer
-            } // iterate every cores
-            usleep(PEBS_KSWAPD_INTERVAL);
-        } // while (run)
+                } // for each drained sample of one core ring buffer
+            }
+        } // iterate every cores
     }
 
 
     void Hemem::policy() {
+        cur_cool_in_dram = nullptr;
+        cur_cool_in_nvm = nullptr;
+        while (still_run && policy_step());
+    }
+
+    bool Hemem::policy_step() {
         int num_ring_reqs, tries;
         hemem_page *p;
         hemem_page *cp;
         hemem_page *np;
 
         hemem_page *page = nullptr;
-        hemem_page *cur_cool_in_dram = nullptr;
-        hemem_page *cur_cool_in_nvm = nullptr;
-
-        for (;still_run;) {
-
-            // while (!free_page_ring.empty()) {
-            //     fifo_list *list;
-            //     page = reinterpret_cast<hemem_page *>(free_page_ring.front());
-            //     if (page == nullptr) {
-            //         continue;
-            //     }
-            //
-            //     // remove page from ringbuffer
-            //     free_page_ring.pop_front();
-            //
-            //     list = page->list;
-            //     assert(list != nullptr);
-            //     updateCurrentCoolPage(&cur_cool_in_dram, &cur_cool_in_nvm, page);
-            //     page_list_remove_page(list, page);
-            //     dynamic_cast<HememAllocator*>(Sim()->getMimicOS()->getPageFaultHandler()->getAllocator())->deallocate(page, page->in_dram, 0);
-            // }
-
-            num_ring_reqs = 0;
-            while (!hot_ring.empty() && num_ring_reqs < HOT_RING_REQS_THRESHOLD) {
-                page = hot_ring.front();
-                hot_ring.pop_front();
-                updateCurrentCoolPage(&cur_cool_in_dram, &cur_cool_in_nvm, page);
-                assert(page != nullptr);
-                page->ring_present = false;
-                num_ring_reqs++;
-                // std::cout << "[Hemem] hot page in dram : " << page->in_dram <<
-                //     " dram_hot_list : " <<(page->list==&dram_hot_list) <<
-                //     " dram_cold_list : " <<(page->list==&dram_cold_list) <<
-                //     " nvm_hot_list : " <<(page->list==&nvm_hot_list) <<
-                //     " nvm_cold_list : " <<(page->list==&nvm_cold_list)
-                // << std::endl;
-                makeHot(page);
-            }
 
-            while (!cold_ring.empty() && num_ring_reqs < COLD_RING_REQS_THRESHOLD) {
-                page = cold_ring.front();
-                cold_ring.pop_front();
-                updateCurrentCoolPage(&cur_cool_in_dram, &cur_cool_in_nvm, page);
-                page->ring_present = false;
-                num_ring_reqs++;
-                makeCold(page);
-            }
+        // while (!free_page_ring.empty()) {
+        //     fifo_list *list;
+        //     page = reinterpret_cast<hemem_page *>(free_page_ring.front());
+        //     if (page == nullptr) {
+        //         continue;
+        //     }
+        //
+        //     // remove page from ringbuffer
+        //     free_page_ring.pop_front();
+        //
+        //     list = page->list;
+        //     assert(list != nullptr);
+        //     updateCurrentCoolPage(&cur_cool_in_dram, &cur_cool_in_nvm, page);
+        //     page_list_remove_page(list, page);
+        //     dynamic_cast<HememAllocator*>(Sim()->getMimicOS()->getPageFaultHandler()->getAllocator())->deallocate(page, page->in_dram, 0);
+        // }
+
+        num_ring_reqs = 0;
+        while (!hot_ring.empty() && num_ring_reqs < HOT_RING_REQS_THRESHOLD) {
+            page = hot_ring.front();
+            hot_ring.pop_front();
+            updateCurrentCoolPage(&cur_cool_in_dram, &cur_cool_in_nvm, page);
+            assert(page != nullptr);
+            page->ring_present = false;
+            num_ring_reqs++;
+            // std::cout << "[Hemem] hot page in dram : " << page->in_dram <<
+            //     " dram_hot_list : " <<(page->list==&dram_hot_list) <<
+            //     " dram_cold_list : " <<(page->list==&dram_cold_list) <<
+            //     " nvm_hot_list : " <<(page->list==&nvm_hot_list) <<
+            //     " nvm_cold_list : " <<(page->list==&nvm_cold_list)
+            // << std::endl;
+            makeHot(page);
+        }
 
-            for (UInt64 migrated_bytes = 0; migrated_bytes < PEBS_KSWAPD_MIGRATE_RATE; ) {
-                p = dequeue(&nvm_hot_list);
-                if (p == nullptr) break;
+        while (!cold_ring.empty() && num_ring_reqs < COLD_RING_REQS_THRESHOLD) {
+            page = cold_ring.front();
+            cold_ring.pop_front();
+            updateCurrentCoolPage(&cur_cool_in_dram, &cur_cool_in_nvm, page);
+            page->ring_present = false;
+            num_ring_reqs++;
+            makeCold(page);
+        }
 
-                updateCurrentCoolPage(&cur_cool_in_dram, &cur_cool_in_nvm, p);
+        for (UInt64 migrated_bytes = 0; migrated_bytes < PEBS_KSWAPD_MIGRATE_RATE; ) {
+            p = dequeue(&nvm_hot_list);
+            if (p == nullptr) break;
 
-                if ((p->accesses[WRITE] < HOT_WRITE_THRESHOLD) && p->accesses[READ] < HOT_READ_THRESHOLD) {
-                    p->hot = false;
-                    // std::cout << "[Hemem] inserted " << page->prev << " in " << __LINE__ <<std::endl;
-                    enqueue(&nvm_cold_list, p);
-                    continue;
-                }
+            updateCurrentCoolPage(&cur_cool_in_dram, &cur_cool_in_nvm, p);
 
-                // Try to promote the page. OS will handle finding a free page or swapping.
-                if (page_migrate(p, true, 0)) {
-                    enqueue(&dram_hot_list, p);
-                    migrated_bytes += pt_to_pagesize(p->pt);
+            if ((p->accesses[WRITE] < HOT_WRITE_THRESHOLD) && p->accesses[READ] < HOT_READ_THRESHOLD) {
+                p->hot = false;
+                // std::cout << "[Hemem] inserted " << page->prev << " in " << __LINE__ <<std::endl;
+                enqueue(&nvm_cold_list, p);
+                continue;
+            }
+
+            // Try to promote the page. OS will handle finding a free page or swapping.
+            if (page_migrate(p, true, 0)) {
+                enqueue(&dram_hot_list, p);
+                migrated_bytes += pt_to_pagesize(p->pt);
+            } else {
+                // Migration failed, maybe no free space. Try to make space.
+                // no free dram page, try to find a cold dram page to move down
+                cp = dequeue(&dram_cold_list);
+                if (cp == nullptr) {
+                    // all dram pages are hot, so put it back in list we got it from
+                    enqueue(&nvm_hot_list, p);
+                    goto out;
+                }
+                
+                // Demote the cold page to NVM
+                if (page_migrate(cp, false, 0)) {
+                    enqueue(&nvm_cold_list, cp);
+                    // Now that a DRAM page is freed, put `p` back and retry in the next iteration.
+                    enqueue(&nvm_hot_list, p);
                 } else {
-                    // Migration failed, maybe no free space. Try to make space.
-                    // no free dram page, try to find a cold dram page to move down
-                    cp = dequeue(&dram_cold_list);
-                    if (cp == nullptr) {
-                        // all dram pages are hot, so put it back in list we got it from
-                        enqueue(&nvm_hot_list, p);
-                        goto out;
-                    }
-                    
-                    // Demote the cold page to NVM
-                    if (page_migrate(cp, false, 0)) {
-                        enqueue(&nvm_cold_list, cp);
-                        // Now that a DRAM page is freed, put `p` back and retry in the next iteration.
-                        enqueue(&nvm_hot_list, p);
-                    } else {
-                        // Demotion also failed. Put both pages back.
-                        enqueue(&dram_cold_list, cp);
-                        enqueue(&nvm_hot_list, p);
-                    }
+                    // Demotion also failed. Put both pages back.
+                    enqueue(&dram_cold_list, cp);
+                    enqueue(&nvm_hot_list, p);
                 }
             }
-            cur_cool_in_dram = partial_cool_peek_and_move(&dram_hot_list, &dram_cold_list, true, cur_cool_in_dram);
-            cur_cool_in_nvm = partial_cool_peek_and_move(&nvm_hot_list, &nvm_cold_list, false, cur_cool_in_nvm);
         }
+        cur_cool_in_dram = partial_cool_peek_and_move(&dram_hot_list, &dram_cold_list, true, cur_cool_in_dram);
+        cur_cool_in_nvm = partial_cool_peek_and_move(&nvm_hot_list, &nvm_cold_list, false, cur_cool_in_nvm);
+        return true;
         out:
             std::cout << "[Hemem] All pages resident in dram is hot" << std::endl;
-            // return nullptr;
+            return false;
     }
 
     void Hemem::start() {
         still_run = true;
         std::cout << "[Hemem] Start daemons" << std::endl;
+        if (simulated_clock) {
+            cur_cool_in_dram = nullptr;
+            cur_cool_in_nvm = nullptr;
+            startPeriodicDaemons();
+            return;
+        }
         scan_thread_handle = std::thread(&Hemem::scan, this);
         policy_thread_handle = std::thread(&Hemem::policy, this);
         // pthread_create(&scan_thread_handle, NULL, &scan_entry, NULL);
@@ -471,6 +488,7 @@ namespace Hemem{
     void Hemem::stop() {
         std::cout << "[Hemem] Stopping background threads..." << std::endl;
         still_run = false;
+        stopPeriodicDaemons();
         if (scan_thread_handle.joinable()) {
             scan_thread_handle.join();
         }
@@ -484,7 +502,8 @@ namespace Hemem{
 
     void Hemem::page_fault(UInt64 laddr, void* ptr) {
         hemem_page *page = static_cast<hemem_page *>(ptr);
-        auto const& [it, inserted] = pages_hotness.insert({laddr, page});
+        std::unique_lock<std::shared_mutex> lock(pages_hotness_lock);
+        auto const& [slot, inserted] = pages_hotness.insert(laddr >> BASE_PAGE_SHIFT, page);
         if (inserted) {
             // std::cout << "[Hemem] 0x" << std::hex << laddr << " Inserting into hotness map" << std::endl;
             // std::cout << "[Hemem] inserted " << page->prev << std::endl;
@@ -7,7 +7,10 @@
 
 #include </usr/include/semaphore.h>
 #include <thread>
+#include <vector>
+#include <shared_mutex>
 #include "page_migration.h"
+#include "hemem_page_index.h"
 #include "fixed_types.h"
 #include <boost/circular_buffer.hpp>
 
@@ -113,16 +116,23 @@ namespace Hemem {
 
     class Hemem : public PageMigration{
     private:
-        std::map<UInt64, hemem_page*> pages_hotness;
+        PageMap pages_hotness;                  // base-page VPN -> page metadata
+        std::shared_mutex pages_hotness_lock;   // page_fault() inserts while scan() looks up
         boost::circular_buffer<hemem_page*> cold_ring, hot_ring, free_page_ring;
         fifo_list dram_hot_list, nvm_hot_list, dram_cold_list, nvm_cold_list;
         bool still_run;
         std::thread scan_thread_handle, policy_thread_handle;
+        std::vector<PerfSample> samples;                    // scan-side drain buffer
+        hemem_page *cur_cool_in_dram, *cur_cool_in_nvm;     // policy cooling cursors, kept across steps
         void makeHot(hemem_page *page);
         void makeCold(hemem_page *page);
         void scan();
         void policy();
 
+    protected:
+        void scan_step() override;
+        bool policy_step() override;
+
     public:
         Hemem();
         ~Hemem();
@@ -0,0 +1,143 @@
+//
+// Flat page-metadata containers shared by the HeMem/Memtis policies and the HeMem allocator.
+//
+
+#ifndef HEMEM_PAGE_INDEX_H
+#define HEMEM_PAGE_INDEX_H
+
+#include <cassert>
+#include <utility>
+#include <vector>
+#include "fixed_types.h"
+
+namespace Hemem {
+
+    struct hemem_page_t;
+
+    /*
+     * Open-addressing hash map from a page number (VPN or PPN) to its hemem_page_t.
+     * Linear probing over a power-of-two table of {key, page} slots, so a hit costs one
+     * cache line in the common case. Deletion uses backward shifting, there are no tombstones.
+     * Not thread safe: callers provide their own locking, as they did for std::map.
+     */
+    class PageMap {
+    private:
+        static const UInt64 EMPTY_KEY = ~0ULL;
+        struct slot_t {
+            UInt64 key;
+            hemem_page_t *page;
+        };
+        std::vector<slot_t> slots;
+        UInt64 mask;
+        UInt64 count;
+
+        static UInt64 hash(UInt64 key) {
+            return (key * 0x9E3779B97F4A7C15ULL) >> 17;
+        }
+
+        void grow() {
+            std::vector<slot_t> old_slots;
+            old_slots.swap(slots);
+            slots.assign(old_slots.size() * 2, slot_t{EMPTY_KEY, nullptr});
+            mask = slots.size() - 1;
+            for (const slot_t &s : old_slots) {
+                if (s.key == EMPTY_KEY) continue;
+                UInt64 idx = hash(s.key) & mask;
+                while (slots[idx].key != EMPTY_KEY) idx = (idx + 1) & mask;
+                slots[idx] = s;
+            }
+        }
+
+    public:
+        explicit PageMap(UInt64 initial_capacity = 4096) : count(0) {
+            UInt64 capacity = 16;
+            while (capacity < initial_capacity) capacity <<= 1;
+            slots.assign(capacity, slot_t{EMPTY_KEY, nullptr});
+            mask = capacity - 1;
+        }
+
+        UInt64 size() const { return count; }
+
+        hemem_page_t *find(UInt64 key) const {
+            for (UInt64 idx = hash(key) & mask; ; idx = (idx + 1) & mask) {
+                if (slots[idx].key == key) return slots[idx].page;
+                if (slots[idx].key == EMPTY_KEY) return nullptr;
+            }
+        }
+
+        // Like std::map::insert: returns the value slot for key and whether it was newly inserted.
+        // The slot pointer is only valid until the next insert.
+        std::pair<hemem_page_t**, bool> insert(UInt64 key, hemem_page_t *page) {
+            assert(key != EMPTY_KEY);
+            if ((count + 1) * 2 > slots.size()) grow();   // keep load factor <= 1/2
+            UInt64 idx = hash(key) & mask;
+            for (; slots[idx].key != EMPTY_KEY; idx = (idx + 1) & mask) {
+                if (slots[idx].key == key) return std::make_pair(&slots[idx].page, false);
+            }
+            slots[idx] = slot_t{key, page};
+            count++;
+            return std::make_pair(&slots[idx].page, true);
+        }
+
+        bool erase(UInt64 key) {
+            UInt64 idx = hash(key) & mask;
+            while (slots[idx].key != key) {
+                if (slots[idx].key == EMPTY_KEY) return false;
+                idx = (idx + 1) & mask;
+            }
+            // Backward-shift the rest of the probe run into the hole
+            UInt64 hole = idx;
+            for (UInt64 next = (hole + 1) & mask; slots[next].key != EMPTY_KEY; next = (next + 1) & mask) {
+                UInt64 home = hash(slots[next].key) & mask;
+                if (((next - home) & mask) >= ((next - hole) & mask)) {
+                    slots[hole] = slots[next];
+                    hole = next;
+                }
+            }
+            slots[hole] = slot_t{EMPTY_KEY, nullptr};
+            count--;
+            return true;
+        }
+    };
+
+    /*
+     * Pool of hemem_page_t records carved out of large contiguous chunks.
+     * Records are never returned to the heap while the pool lives, so pointers held by the
+     * policies stay valid; released records are recycled through a free list.
+     */
+    template <class T, UInt64 CHUNK_RECORDS = 4096>
+    class PagePool {
+    private:
+        std::vector<T*> chunks;
+        std::vector<T*> free_records;
+        UInt64 next_in_chunk;
+
+    public:
+        PagePool() : next_in_chunk(CHUNK_RECORDS) {}
+        ~PagePool() {
+            for (T *chunk : chunks) delete[] chunk;
+        }
+        PagePool(const PagePool&) = delete;
+        PagePool& operator=(const PagePool&) = delete;
+
+        T *allocate() {
+            if (!free_records.empty()) {
+                T *record = free_records.back();
+                free_records.pop_back();
+                *record = T();
+                return record;
+            }
+            if (next_in_chunk == CHUNK_RECORDS) {
+                chunks.push_back(new T[CHUNK_RECORDS]);
+                next_in_chunk = 0;
+            }
+            return &chunks.back()[next_in_chunk++];
+        }
+
+        void release(T *record) {
+            free_records.push_back(record);
+        }
+    };
+}
+
+#endif //HEMEM_PAGE_INDEX_H
@@ -39,11 +39,17 @@ namespace Hemem {
           min_age_epochs(DEFAULT_MIN_AGE_EPOCHS),
           dram_free_threshold(0),
           proactive_demotions(0),
-          direct_promotions(0)
+          direct_promotions(0),
+          samples(PERF_DRAIN_BATCH)
     {
         this->setName("Memtis");
-        std::random_device rd;
-        rng = std::mt19937(rd());
+        if (simulated_clock) {
+            // Deterministic daemons also need a reproducible victim sampling sequence
+            rng = std::mt19937(Sim()->getCfg()->hasKey("migration/seed") ? Sim()->getCfg()->getInt("migration/seed") : 0);
+        } else {
+            std::random_device rd;
+            rng = std::mt19937(rd());
+        }
         if (Sim()->getCfg()->hasKey("migration/hot_threshold")) {
             hot_threshold = Sim()->getCfg()->getInt("migration/hot_threshold");
         }
@@ -114,12 +120,12 @@ namespace Hemem {
         hemem_page_t *page = static_cast<hemem_page_t *>(ptr);
         std::unique_lock<std::shared_mutex> lock(page_list_mutex);
 
-        auto const& [it, inserted] = all_pages_map.insert({laddr, page});
+        auto const& [slot, inserted] = all_pages_map.insert(laddr >> BASE_PAGE_SHIFT, page);
 
         if (!inserted) {
             // Re-allocation: same vaddr mapped again (after free + re-mmap).
             // The old page pointer may be dangling — remove it from tracking lists.
-            hemem_page_t *old_page = it->second;
+            hemem_page_t *old_page = *slot;
 
             // Remove old pointer from dram_pages / nvm_pages to avoid use-after-free
             auto d_it = std::find(dram_pages.begin(), dram_pages.end(), old_page);
@@ -139,7 +145,7 @@ namespace Hemem {
             }
 
             // Update map entry to point to the new page
-            it->second = page;
+            *slot = page;
         }
 
         // Common initialization for both new and re-allocated pages
@@ -157,29 +163,30 @@ namespace Hemem {
     // === Scan Thread (Producer) ===
     // Iterates over hardware events (PEBS/IBS), updates counters, and identifies hot pages.
     void Memtis::scan() {
-        bool perf_empty = false;
-        size_t core_number = Sim()->getCoreManager()->getCoreNum();
-
         while (still_run) {
-            // Iterate over all cores to collect samples
-            for (int i = 0; i < core_number; ++i) {
-                PageTracer *page_tracer = Sim()->getCoreManager()->getCoreFromID(i)->getPageTracer();
+            scan_step();
+            usleep(scan_interval_us);
+        }
+    }
 
-                while (true) {
-                    PerfSample page_sample = page_tracer->getPerfSample(&perf_empty);
-                    // cout << "perf_empty = " << perf_empty << endl;
-                    if (perf_empty) break;
+    void Memtis::scan_step() {
+        size_t core_number = Sim()->getCoreManager()->getCoreNum();
+        // Iterate over all cores to collect samples
+        for (int i = 0; i < core_number; ++i) {
+            PageTracer *page_tracer = Sim()->getCoreManager()->getCoreFromID(i)->getPageTracer();
+
+            // Pull samples in batches until this core's ring is empty
+            size_t n_samples;
+            while ((n_samples = page_tracer->drain(samples)) > 0) {
+                for (size_t s = 0; s < n_samples; ++s) {
+                    const PerfSample &page_sample = samples[s];
 
-                    // Calculate Base Page address
-                    UInt64 addr = page_sample.addr & pages_mask[0];
                     hemem_page_t *page = nullptr;
                     {
                         std::shared_lock<std::shared_mutex> lock(page_list_mutex);
-                        // Fast lock-free lookup (assuming map stability)
-                        auto it = all_pages_map.find(addr);
-                        if (it == all_pages_map.end()) continue;
-
-                        page = it->second;
+                        // Lookup by base-page VPN
+                        page = all_pages_map.find(page_sample.addr >> BASE_PAGE_SHIFT);
+                        if (page == nullptr) continue;
                         // cout << "find pages = " << page->vaddr << endl;
                     }
                     // 1. Lazy Cool: Before adding new access, decay the old value based on elapsed time.
@@ -188,12 +195,12 @@ namespace Hemem {
                     // 2. Increment Unified Access Counter (Read & Write treated equally)
                     if (page_sample.type == LLC_Miss_RD || page_sample.type == LLC_Miss_ST) {
                         page->naccesses++;
-                        
+                    
                         // Track accesses to pages that have been migrated from NVM to DRAM.
                         if (page->in_dram && !page->initial_in_dram) {
                             Sim()->getMimicOS()->incrementBeneficialDramAccessSamples();
                         }
-                        
+                    
                         // Track accesses to pages that were demoted down to NVM (Penalty)
                         if (!page->in_dram && page->initial_in_dram) {
                             Sim()->getMimicOS()->incrementPenalizedNvmAccessSamples();
@@ -218,7 +225,6 @@ namespace Hemem {
                     }
                 }
             }
-            usleep(scan_interval_us);
         }
     }
 
@@ -229,185 +235,185 @@ namespace Hemem {
     void Memtis::policy() {
         while (still_run) {
             usleep(policy_interval_us);
+            policy_step();
+        }
+    }
 
-            // 1. Update Global Epoch (Tick-Tock)
-            // Implicitly, all pages are now "older" and will be decayed upon next access/sample.
-            current_epoch.fetch_add(1, std::memory_order_relaxed);
-
-            // ============================================================
-            // Phase 1: Proactive Demotion (Independent of Promotion)
-            // Sample DRAM pages, find cold ones, and demote them to NVM.
-            // This frees up DRAM space regardless of whether promotions are pending.
-            // Skip demotion during the initial warm-up phase to allow hotness
-            // profiles to stabilize before making demotion decisions.
-            // ============================================================
-            UInt64 epoch_now = current_epoch.load(std::memory_order_relaxed);
-            if (epoch_now > warmup_epochs) {
-                // Skip demotion if DRAM free pages are above the threshold
-                HememAllocator* allocator = dynamic_cast<HememAllocator*>(
-                    Sim()->getMimicOS()->getMemoryAllocator());
-                size_t dram_free = allocator ? allocator->getDramFreePages() : 0;
-
-                if (dram_free_threshold == 0 || dram_free < dram_free_threshold) {
-                    std::vector<hemem_page_t*> cold_pages;
-                    {
-                        std::shared_lock<std::shared_mutex> list_lock(page_list_mutex);
-
-                        if (!dram_pages.empty()) {
-                            // Random sample from DRAM pages
-                            std::vector<hemem_page_t*> dram_sample;
-                            size_t actual_sample = std::min(sample_size, dram_pages.size());
-                            std::uniform_int_distribution<size_t> dist(0, dram_pages.size() - 1);
-
-                            // Use a set to avoid sampling the same page twice
-                            std::set<hemem_page_t*> sampled;
-                            for (size_t i = 0; i < actual_sample; ++i) {
-                                hemem_page_t* p = dram_pages[dist(rng)];
-                                if (sampled.insert(p).second) {
-                                    dram_sample.push_back(p);
-                                }
+    bool Memtis::policy_step() {
+        // 1. Update Global Epoch (Tick-Tock)
+        // Implicitly, all pages are now "older" and will be decayed upon next access/sample.
+        current_epoch.fetch_add(1, std::memory_order_relaxed);
+
+        // ============================================================
+        // Phase 1: Proactive Demotion (Independent of Promotion)
+        // Sample DRAM pages, find cold ones, and demote them to NVM.
+        // This frees up DRAM space regardless of whether promotions are pending.
+        // Skip demotion during the initial warm-up phase to allow hotness
+        // profiles to stabilize before making demotion decisions.
+        // ============================================================
+        UInt64 epoch_now = current_epoch.load(std::memory_order_relaxed);
+        if (epoch_now > warmup_epochs) {
+            // Skip demotion if DRAM free pages are above the threshold
+            HememAllocator* allocator = dynamic_cast<HememAllocator*>(
+                Sim()->getMimicOS()->getMemoryAllocator());
+            size_t dram_free = allocator ? allocator->getDramFreePages() : 0;
+
+            if (dram_free_threshold == 0 || dram_free < dram_free_threshold) {
+                std::vector<hemem_page_t*> cold_pages;
+                {
+                    std::shared_lock<std::shared_mutex> list_lock(page_list_mutex);
+
+                    if (!dram_pages.empty()) {
+                        // Random sample from DRAM pages
+                        std::vector<hemem_page_t*> dram_sample;
+                        size_t actual_sample = std::min(sample_size, dram_pages.size());
+                        std::uniform_int_distribution<size_t> dist(0, dram_pages.size() - 1);
+
+                        // Use a set to avoid sampling the same page twice
+                        std::set<hemem_page_t*> sampled;
+                        for (size_t i = 0; i < actual_sample; ++i) {
+                            hemem_page_t* p = dram_pages[dist(rng)];
+                            if (sampled.insert(p).second) {
+                                dram_sample.push_back(p);
                             }
+                        }
 
-                            // Identify cold pages: hotness at or below cold_threshold
-                            // AND page must have lived in DRAM for at least min_age_epochs
-                            // to avoid demoting freshly-allocated pages before they have a
-                            // chance to accumulate access history.
-                            for (auto* p : dram_sample) {
-                                if (!p->migrating
-                                    && (epoch_now - p->birth_epoch) >= min_age_epochs
-                                    && get_current_hotness(p) <= cold_threshold) {
-                                    cold_pages.push_back(p);
-                                }
+                        // Identify cold pages: hotness at or below cold_threshold
+                        // AND page must have lived in DRAM for at least min_age_epochs
+                        // to avoid demoting freshly-allocated pages before they have a
+                        // chance to accumulate access history.
+                        for (auto* p : dram_sample) {
+                            if (!p->migrating
+                                && (epoch_now - p->birth_epoch) >= min_age_epochs
+                                && get_current_hotness(p) <= cold_threshold) {
+                                cold_pages.push_back(p);
                             }
+                        }
 
-                            // Sort by hotness ascending (coldest first), limit to batch_size
-                            if (cold_pages.size() > 1) {
-                                std::sort(cold_pages.begin(), cold_pages.end(),
-                                    [&](hemem_page_t* a, hemem_page_t* b) {
-                                        return get_current_hotness(a) < get_current_hotness(b);
-                                    });
-                            }
-                            size_t demote_limit = batch_size.load();
-                            if (cold_pages.size() > demote_limit) {
-                                cold_pages.resize(demote_limit);
-                            }
+                        // Sort by hotness ascending (coldest first), limit to batch_size
+                        if (cold_pages.size() > 1) {
+                            std::sort(cold_pages.begin(), cold_pages.end(),
+                                [&](hemem_page_t* a, hemem_page_t* b) {
+                                    return get_current_hotness(a) < get_current_hotness(b);
+                                });
+                        }
+                        size_t demote_limit = batch_size.load();
+                        if (cold_pages.size() > demote_limit) {
+                            cold_pages.resize(demote_limit);
                         }
                     }
+                }
 
-                    // Execute demotion
-                    if (!cold_pages.empty()) {
-                        std::vector<hemem_page_t*> empty_promote;
-                        batch_migrate(empty_promote, cold_pages);
-                        proactive_demotions += cold_pages.size();
+                // Execute demotion
+                if (!cold_pages.empty()) {
+                    std::vector<hemem_page_t*> empty_promote;
+                    batch_migrate(empty_promote, cold_pages);
+                    proactive_demotions += cold_pages.size();
 
-                        // Update global lists
-                        std::unique_lock<std::shared_mutex> list_lock(page_list_mutex);
+                    // Update global lists
+                    std::unique_lock<std::shared_mutex> list_lock(page_list_mutex);
 
-                        // Remove successfully demoted pages from dram_pages
-                        auto d_it = std::remove_if(dram_pages.begin(), dram_pages.end(),
-                            [](hemem_page_t* p) { return !p->in_dram; });
-                        dram_pages.erase(d_it, dram_pages.end());
+                    // Remove successfully demoted pages from dram_pages
+                    auto d_it = std::remove_if(dram_pages.begin(), dram_pages.end(),
+                        [](hemem_page_t* p) { return !p->in_dram; });
+                    dram_pages.erase(d_it, dram_pages.end());
 
-                        // Add demoted pages to nvm_pages
-                        for (auto* p : cold_pages) {
-                            if (!p->in_dram) nvm_pages.push_back(p);
-                            // else: migration failed, page stays in DRAM (already in dram_pages)
-                        }
+                    // Add demoted pages to nvm_pages
+                    for (auto* p : cold_pages) {
+                        if (!p->in_dram) nvm_pages.push_back(p);
+                        // else: migration failed, page stays in DRAM (already in dram_pages)
                     }
-                } // end dram_free_threshold check
-            }
+                }
+            } // end dram_free_threshold check
+        }
 
-            // ============================================================
-            // Phase 2: Promotion (Independent of Demotion)
-            // Process fast promotion queue. Only promote if DRAM has free
-            // space (freed by Phase 1 or initial allocation).
-            // Pages that cannot be promoted are re-queued for the next cycle.
-            // ============================================================
-            {
-                std::vector<hemem_page_t*> to_promote;
+        // ============================================================
+        // Phase 2: Promotion (Independent of Demotion)
+        // Process fast promotion queue. Only promote if DRAM has free
+        // space (freed by Phase 1 or initial allocation).
+        // Pages that cannot be promoted are re-queued for the next cycle.
+        // ============================================================
+        {
+            std::vector<hemem_page_t*> to_promote;
 
-                // Fetch candidates from the fast promotion queue
-                {
-                    std::lock_guard<std::mutex> q_lock(queue_mutex);
-                    if (!fast_promotion_queue.empty()) {
-                        size_t batch = batch_size.load();
-                        size_t count = std::min(batch, fast_promotion_queue.size());
-
-                        to_promote.assign(fast_promotion_queue.begin(),
-                                          fast_promotion_queue.begin() + count);
-                        fast_promotion_queue.erase(fast_promotion_queue.begin(),
-                                                   fast_promotion_queue.begin() + count);
-                    }
+            // Fetch candidates from the fast promotion queue
+            {
+                std::lock_guard<std::mutex> q_lock(queue_mutex);
+                if (!fast_promotion_queue.empty()) {
+                    size_t batch = batch_size.load();
+                    size_t count = std::min(batch, fast_promotion_queue.size());
+
+                    to_promote.assign(fast_promotion_queue.begin(),
+                                      fast_promotion_queue.begin() + count);
+                    fast_promotion_queue.erase(fast_promotion_queue.begin(),
+                                               fast_promotion_queue.begin() + count);
                 }
+            }
 
-                if (to_promote.empty()) continue; // Nothing to promote, next cycle
+            if (to_promote.empty()) return true; // Nothing to promote, next cycle
 
-                // Check available DRAM space
-                HememAllocator* allocator = dynamic_cast<HememAllocator*>(
-                    Sim()->getMimicOS()->getMemoryAllocator());
-                size_t dram_free = allocator ? allocator->getDramFreePages() : 0;
+            // Check available DRAM space
+            HememAllocator* allocator = dynamic_cast<HememAllocator*>(
+                Sim()->getMimicOS()->getMemoryAllocator());
+            size_t dram_free = allocator ? allocator->getDramFreePages() : 0;
 
-                // Split: promote only as many as free space allows
-                std::vector<hemem_page_t*> can_promote;
-                std::vector<hemem_page_t*> cannot_promote;
+            // Split: promote only as many as free space allows
+            std::vector<hemem_page_t*> can_promote;
+            std::vector<hemem_page_t*> cannot_promote;
 
-                for (size_t i = 0; i < to_promote.size(); ++i) {
-                    if (i < dram_free) {
-                        can_promote.push_back(to_promote[i]);
-                    } else {
-                        cannot_promote.push_back(to_promote[i]);
-                    }
+            for (size_t i = 0; i < to_promote.size(); ++i) {
+                if (i < dram_free) {
+                    can_promote.push_back(to_promote[i]);
+                } else {
+                    cannot_promote.push_back(to_promote[i]);
                 }
+            }
 
-                // Execute promotion
-                if (!can_promote.empty()) {
-                    direct_promotions += can_promote.size();
+            // Execute promotion
+            if (!can_promote.empty()) {
+                direct_promotions += can_promote.size();
 
-                    std::vector<hemem_page_t*> empty_demote;
-                    batch_migrate(can_promote, empty_demote);
+                std::vector<hemem_page_t*> empty_demote;
+                batch_migrate(can_promote, empty_demote);
 
-                    // Update global lists
-                    std::unique_lock<std::shared_mutex> list_lock(page_list_mutex);
-                    std::lock_guard<std::mutex> q_lock(queue_mutex);
-
-                    // Remove successfully promoted pages from nvm_pages
-                    auto n_it = std::remove_if(nvm_pages.begin(), nvm_pages.end(),
-                        [](hemem_page_t* p) { return p->in_dram; });
-                    nvm_pages.erase(n_it, nvm_pages.end());
-
-                    for (auto* p : can_promote) {
-                        if (p->in_dram) {
-                            dram_pages.push_back(p);
-                            // Reset birth_epoch so the page gets a fresh grace
-                            // period in DRAM, preventing immediate re-demotion
-                            // (ping-pong migration).
-                            p->birth_epoch = current_epoch.load(std::memory_order_relaxed);
-                        }
-                        else nvm_pages.push_back(p); // Migration failed, keep in NVM
+                // Update global lists
+                std::unique_lock<std::shared_mutex> list_lock(page_list_mutex);
+                std::lock_guard<std::mutex> q_lock(queue_mutex);
 
-                        pending_pages.erase(p);
-                        p->migrating = false;
+                // Remove successfully promoted pages from nvm_pages
+                auto n_it = std::remove_if(nvm_pages.begin(), nvm_pages.end(),
+                    [](hemem_page_t* p) { return p->in_dram; });
+                nvm_pages.erase(n_it, nvm_pages.end());
+
+                for (auto* p : can_promote) {
+                    if (p->in_dram) {
+                        dram_pages.push_back(p);
+                        // Reset birth_epoch so the page gets a fresh grace
+                        // period in DRAM, preventing immediate re-demotion
+                        // (ping-pong migration).
+                        p->birth_epoch = current_epoch.load(std::memory_order_relaxed);
                     }
-                }
+                    else nvm_pages.push_back(p); // Migration failed, keep in NVM
 
-                // Re-queue pages that couldn't be promoted (DRAM full).
-                // They will be retried in the next policy cycle after demotion frees space.
-                if (!cannot_promote.empty()) {
-                    std::lock_guard<std::mutex> q_lock(queue_mutex);
-                    fast_promotion_queue.insert(fast_promotion_queue.begin(),
-                        cannot_promote.begin(), cannot_promote.end());
+                    pending_pages.erase(p);
+                    p->migrating = false;
                 }
             }
+
+            // Re-queue pages that couldn't be promoted (DRAM full).
+            // They will be retried in the next policy cycle after demotion frees space.
+            if (!cannot_promote.empty()) {
+                std::lock_guard<std::mutex> q_lock(queue_mutex);
+                fast_promotion_queue.insert(fast_promotion_queue.begin(),
+                    cannot_promote.begin(), cannot_promote.end());
+            }
         }
+        return true;
     }
 
     hemem_page_t* Memtis::getPage(IntPtr vaddr) {
         std::shared_lock<std::shared_mutex> lock(page_list_mutex);
-        auto it = all_pages_map.find(vaddr);
-        if (it != all_pages_map.end()) {
-            return it->second;
-        }
-        return nullptr;
+        return all_pages_map.find(vaddr >> BASE_PAGE_SHIFT);
     }
 
     void Memtis::batch_migrate(const std::vector<hemem_page_t*>& to_promote,
@@ -429,6 +435,10 @@ namespace Hemem {
 
     void Memtis::start() {
         still_run = true;
+        if (simulated_clock) {
+            startPeriodicDaemons();
+            return;
+        }
         std::cout << "[Memtis] Starting background threads..." << std::endl;
         scan_thread_handle = std::thread(&Memtis::scan, this);
         policy_thread_handle = std::thread(&Memtis::policy, this);
@@ -436,6 +446,7 @@ namespace Hemem {
 
     void Memtis::stop() {
         still_run = false;
+        stopPeriodicDaemons();
         if (scan_thread_handle.joinable()) scan_thread_handle.join();
         if (policy_thread_handle.joinable()) policy_thread_handle.join();
         std::cout << "[Memtis] Stopped." << std::endl;
@@ -27,8 +27,8 @@ namespace Hemem {
         // NVM pages list: Maintained for consistency, though NVM hotness is mostly handled via Fast Path.
         std::vector<hemem_page_t*> nvm_pages;
 
-        // Fast lookup map: Maps virtual address to page metadata.
-        std::map<UInt64, hemem_page_t*> all_pages_map;
+        // Fast lookup map: Maps base-page VPN to page metadata.
+        PageMap all_pages_map;
 
         // --- Fast Path & Queue ---
 
@@ -73,11 +73,14 @@ namespace Hemem {
         UInt64 proactive_demotions;        // Counter: pages proactively demoted from DRAM
         UInt64 direct_promotions;          // Counter: pages promoted directly (DRAM had free space)
         std::mt19937 rng;                  // Random number generator for sampling
+        std::vector<PerfSample> samples;   // Scan-side drain buffer
 
         // --- Internal Functions ---
 
         void scan();   // Producer: Monitors hardware events
         void policy(); // Consumer: Makes migration decisions
+        void scan_step() override;    // One pass of scan(): drain every core's sample ring
+        bool policy_step() override;  // One epoch of policy(): demotion then promotion
 
         // Lazy Cooling: Updates the page's hotness based on the time elapsed since last access.
         // Updates page->naccesses and page->local_clock.
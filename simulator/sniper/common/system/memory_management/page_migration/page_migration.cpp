@@ -0,0 +1,61 @@
+//
+// Created by shado on 25-6-3.
+//
+
+#include "page_migration.h"
+#include "simulator.h"
+#include "hooks_manager.h"
+#include "config.hpp"
+
+PageMigration::PageMigration()
+    : simulated_clock(false),
+      scan_interval(SubsecondTime::NS(DEFAULT_DAEMON_INTERVAL_NS)),
+      policy_interval(SubsecondTime::NS(DEFAULT_DAEMON_INTERVAL_NS)),
+      next_scan_time(SubsecondTime::Zero()),
+      next_policy_time(SubsecondTime::Zero()),
+      periodic_scan_running(false),
+      periodic_policy_running(false),
+      periodic_hook_registered(false)
+{
+    if (Sim()->getCfg()->hasKey("migration/daemon_clock")) {
+        String clock = Sim()->getCfg()->getString("migration/daemon_clock");
+        LOG_ASSERT_ERROR(clock == "host" || clock == "simulated", "Unknown migration/daemon_clock %s", clock.c_str());
+        simulated_clock = (clock == "simulated");
+    }
+    if (Sim()->getCfg()->hasKey("migration/scan_interval_ns")) {
+        scan_interval = SubsecondTime::NS(Sim()->getCfg()->getInt("migration/scan_interval_ns"));
+    }
+    if (Sim()->getCfg()->hasKey("migration/policy_interval_ns")) {
+        policy_interval = SubsecondTime::NS(Sim()->getCfg()->getInt("migration/policy_interval_ns"));
+    }
+}
+
+void PageMigration::startPeriodicDaemons() {
+    periodic_scan_running = true;
+    periodic_policy_running = true;
+    next_scan_time = SubsecondTime::Zero();
+    next_policy_time = policy_interval;
+    // Hooks cannot be unregistered, so stop() only clears the running flags
+    if (!periodic_hook_registered) {
+        Sim()->getHooksManager()->registerHook(HookType::HOOK_PERIODIC, hook_periodic, (UInt64)this, HooksManager::ORDER_ACTION);
+        periodic_hook_registered = true;
+    }
+    std::cout << "[" << name << "] Daemons driven by simulated time: scan every " << scan_interval.getNS()
+              << " ns, policy every " << policy_interval.getNS() << " ns" << std::endl;
+}
+
+void PageMigration::stopPeriodicDaemons() {
+    periodic_scan_running = false;
+    periodic_policy_running = false;
+}
+
+void PageMigration::periodic(SubsecondTime current_time) {
+    if (periodic_scan_running && current_time >= next_scan_time) {
+        scan_step();
+        next_scan_time = current_time + scan_interval;
+    }
+    if (periodic_policy_running && current_time >= next_policy_time) {
+        periodic_policy_running = policy_step();
+        next_policy_time = current_time + policy_interval;
+    }
+}
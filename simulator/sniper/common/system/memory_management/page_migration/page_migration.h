@@ -7,10 +7,12 @@
 
 #include "page_tracer.h"
 #include "fixed_types.h"
+#include "subsecond_time.h"
 #include <iostream>
 #include <map>
 
-#define BASE_PAGE_SIZE (1UL << 12)
+#define BASE_PAGE_SHIFT 12
+#define BASE_PAGE_SIZE (1UL << BASE_PAGE_SHIFT)
 #define HUGE_PAGE_SIZE (1UL << 21)
 
 #define BASE_PAGE_MASK (~(BASE_PAGE_SIZE - 1))
@@ -22,16 +24,43 @@ typedef enum {
     PTE_access
 }accType;
 
+#define DEFAULT_DAEMON_INTERVAL_NS (1000000)  // 1ms of simulated time
+
 class PageMigration {
 protected:
     String name;
     UInt64 pages_mask[2] = {(BASE_PAGE_MASK), (HUGE_PAGE_MASK)};
 
+    // Daemon clock. With migration/daemon_clock = "host" (default) the scan and policy
+    // daemons are free-running threads paced with usleep(). With "simulated" they run
+    // as HOOK_PERIODIC callbacks every migration/{scan,policy}_interval_ns of simulated
+    // time, which makes migration decisions deterministic. Intervals shorter than the
+    // barrier quantum are effectively rounded up to it.
+    bool simulated_clock;
+    SubsecondTime scan_interval, policy_interval;
+    SubsecondTime next_scan_time, next_policy_time;
+    bool periodic_scan_running, periodic_policy_running;
+
+    void startPeriodicDaemons();
+    void stopPeriodicDaemons();
+
+    // One iteration of the scan / policy daemon. policy_step() returns false when the
+    // policy has nothing more to do and should not be called again.
+    virtual void scan_step() {}
+    virtual bool policy_step() { return true; }
+
+private:
+    bool periodic_hook_registered;
+    void periodic(SubsecondTime current_time);
+    static SInt64 hook_periodic(UInt64 ptr, UInt64 time)
+    { ((PageMigration*)ptr)->periodic(*(subsecond_time_t*)&time); return 0; }
+
 public:
     virtual void setBatchSize(size_t size){}
     void setName(String name) {this->name = name; }
     String getName() {return this->name; }
-    PageMigration() {}
+    PageMigration();
+    virtual ~PageMigration() {}
     virtual void page_fault(UInt64 laddr, void *ptr){}
     virtual void start() {};
     virtual void stop() {};
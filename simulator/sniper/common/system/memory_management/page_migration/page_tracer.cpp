@@ -3,29 +3,63 @@
 //
 
 #include "page_tracer.h"
+#include "stats.h"
 #include <iostream>
 
+static_assert((PERF_SAMPLE_CAPACITY & (PERF_SAMPLE_CAPACITY - 1)) == 0, "PERF_SAMPLE_CAPACITY must be a power of two");
+
+PageTracer::PageTracer(int frequency, UInt32 core_id)
+    : head(0), tail(0), perf_buffer(new PerfSample[PERF_SAMPLE_CAPACITY]), capacity_mask(PERF_SAMPLE_CAPACITY - 1),
+      frequency(frequency), counter(0), recorded_samples(0), dropped_samples(0) {
+    registerStatsMetric("page_tracer", core_id, "recorded_samples", &recorded_samples);
+    registerStatsMetric("page_tracer", core_id, "dropped_samples", &dropped_samples);
+}
+
+// Tracing disabled: no storage, every sampled access is dropped.
+PageTracer::PageTracer()
+    : head(0), tail(0), perf_buffer(nullptr), capacity_mask(0),
+      frequency(0), counter(0), recorded_samples(0), dropped_samples(0) {}
+
+PageTracer::~PageTracer() {
+    delete[] perf_buffer;
+}
+
 bool PageTracer::record(UInt64 addr, AccessType type, UInt32 id, UInt64 ip) {
     if (__glibc_likely(counter != frequency)) {
         ++counter;
         return false;
     }
-    // std::cout << "[PageTracer] addr = " << std::hex << "0x" << addr << std::endl;
-    PerfSample perf_data = {type, ip, id, addr};
-    perf_buffer.push_back(perf_data);
     counter = 0;
-    return perf_buffer.full();
+    // std::cout << "[PageTracer] addr = " << std::hex << "0x" << addr << std::endl;
+    if (__glibc_unlikely(perf_buffer == nullptr)) {
+        ++dropped_samples;
+        return true;
+    }
+
+    UInt64 h = head.load(std::memory_order_relaxed);
+    if (h - tail.load(std::memory_order_acquire) > capacity_mask) {
+        ++dropped_samples;
+        return true;
+    }
+    perf_buffer[h & capacity_mask] = {type, ip, id, addr};
+    head.store(h + 1, std::memory_order_release);
+    ++recorded_samples;
+    return (h + 1) - tail.load(std::memory_order_relaxed) > capacity_mask;
 }
 
-PerfSample PageTracer::getPerfSample(bool *is_empty) {
-    PerfSample ret;
-    if (perf_buffer.empty()) {
-        *is_empty = true;
-        ret = {};
-    } else {
-        *is_empty = false;
-        ret = perf_buffer.front();
-        perf_buffer.pop_front();
+size_t PageTracer::drain(std::span<PerfSample> out) {
+    UInt64 t = tail.load(std::memory_order_relaxed);
+    UInt64 available = head.load(std::memory_order_acquire) - t;
+    size_t n = std::min<UInt64>(available, out.size());
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = perf_buffer[(t + i) & capacity_mask];
     }
+    tail.store(t + n, std::memory_order_release);
+    return n;
+}
+
+PerfSample PageTracer::getPerfSample(bool *is_empty) {
+    PerfSample ret = {};
+    *is_empty = drain(std::span<PerfSample>(&ret, 1)) == 0;
     return ret;
 }
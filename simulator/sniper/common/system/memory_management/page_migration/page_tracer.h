@@ -4,10 +4,13 @@
 
 #ifndef PAGE_TRACER_H
 #define PAGE_TRACER_H
-#include <boost/circular_buffer.hpp>
+#include <atomic>
+#include <span>
 #include "fixed_types.h"
 
-#define PERF_SAMPLE_CAPACITY (1024*1024)
+#define PERF_SAMPLE_CAPACITY (1024*1024)   // must be a power of two
+#define PERF_SAMPLE_CACHE_LINE 64
+#define PERF_DRAIN_BATCH 4096               // samples a scan thread pulls per drain() call
 
 using namespace std;
 typedef enum {
@@ -21,19 +24,39 @@ struct PerfSample {
     UInt64 addr;
 };
 
+/*
+ * Single-producer/single-consumer sample ring.
+ * The producer is the simulation thread of the owning core (record()), the consumer is the
+ * scan thread of the active migration policy (drain()). Neither side ever blocks: when the
+ * ring is full the new sample is dropped and counted in the "dropped_samples" stat.
+ * head/tail are free-running counters on separate cache lines, so the producer and consumer
+ * only share the slots they hand over through the release/acquire pair.
+ */
 class PageTracer {
 private:
-    boost::circular_buffer<PerfSample> perf_buffer;
+    alignas(PERF_SAMPLE_CACHE_LINE) std::atomic<UInt64> head;   // next slot to write, owned by the producer
+    alignas(PERF_SAMPLE_CACHE_LINE) std::atomic<UInt64> tail;   // next slot to read, owned by the consumer
+    alignas(PERF_SAMPLE_CACHE_LINE) PerfSample *perf_buffer;
+    UInt64 capacity_mask;
     int frequency;
     int counter;
 
+    UInt64 recorded_samples;
+    UInt64 dropped_samples;
+
 public:
 
-    explicit PageTracer(int frequency):perf_buffer(PERF_SAMPLE_CAPACITY), frequency(frequency), counter(0) {};
-    PageTracer():perf_buffer(0), frequency(0), counter(0){};
-    ~PageTracer()= default;
+    PageTracer(int frequency, UInt32 core_id);
+    PageTracer();
+    ~PageTracer();
+
+    PageTracer(const PageTracer&) = delete;
+    PageTracer& operator=(const PageTracer&) = delete;
 
+    // Producer side. Returns true when the ring is full (the sample, if any, was dropped).
     bool record(UInt64 addr, AccessType type, UInt32 id, IntPtr ip);
+    // Consumer side. Copies up to out.size() pending samples into out, returns the number copied.
+    size_t drain(std::span<PerfSample> out);
     PerfSample getPerfSample(bool *is_empty);
 };
 
@@ -8,9 +8,13 @@
 #include <unordered_map>
 #include <random>
 #include "pwc.h"
+#include "fixed_vector.h"
 #include <bitset>
 #include <shared_mutex>
 #include <mutex>
+#include <atomic>
+#include <sched.h>
+#include <span>
 
 // #define DEBUG
 using namespace std;
@@ -24,11 +28,67 @@ namespace ParametricDramDirectoryMSI
 		PF_MOVING,				// Page fault happened because the page is being moved
 		PF_ACCESSIBLE			// Page fault happened because of access permissions
 	} pageFaultType;
-	typedef std::vector<tuple<int, int, IntPtr, bool>> accessedAddresses;		  // <level of page table based on page size, depth of the page table, physical address we accessed, is it the PTE that contains the correct translation?>
+	// Page table entries a single walk records without touching the heap. It covers the replayed part of a
+	// radix walk after a page fault and the usual probe/chain steps of the hashed page tables; longer walks
+	// (e.g. a degenerate hash chain) spill the record to the heap.
+	static const unsigned int PTW_MAX_ACCESSES = 256;
+
+	// The walk record lives on the caller's stack: filling it during every L2 TLB miss should not hit the heap
+	typedef FixedVector<tuple<int, int, IntPtr, bool>, PTW_MAX_ACCESSES> accessedAddresses; // <level of page table based on page size, depth of the page table, physical address we accessed, is it the PTE that contains the correct translation?>
 	typedef tuple<int, accessedAddresses, IntPtr, SubsecondTime, bool, pageFaultType, SubsecondTime> PTWResult; //<pagesize, addresses we accesses during walk, ppn, page walk cache latency (for intermediate levels), fault_happened?, reason for page fault, last DMA move finish time>
 	typedef int PageSize;
 	typedef tuple<int, accessedAddresses, IntPtr> AllocatedPage; //<pagesize, accessedAddresses, ppn>
 
+	// Fills in everything but the accessed addresses, which the page table appends to get<1>(result) while walking
+	inline void setPTWResult(PTWResult &result, int page_size, IntPtr ppn, SubsecondTime pwc_latency, bool is_pagefault, pageFaultType fault_type, SubsecondTime dma_finish)
+	{
+		get<0>(result) = page_size;
+		get<2>(result) = ppn;
+		get<3>(result) = pwc_latency;
+		get<4>(result) = is_pagefault;
+		get<5>(result) = fault_type;
+		get<6>(result) = dma_finish;
+	}
+
+	/*
+	 * Writer lock of a group of pages, paired with a sequence counter so that page table walks can
+	 * read without taking it (seqlock). Writers (page faults, deletion, migration) serialize on the
+	 * mutex and keep the counter odd while they modify entries; a walk samples the counter with
+	 * readBegin(), reads the entries, and repeats the walk if readRetry() reports a concurrent write.
+	 * The read side does no atomic read-modify-write, so walks on different cores do not bounce the
+	 * lock's cache line. Meets BasicLockable, so std::unique_lock/std::lock_guard work on it.
+	 */
+	struct alignas(64) PageTableLock
+	{
+		std::mutex m_mutex;
+		std::atomic<UInt32> m_sequence{0};
+
+		void lock()
+		{
+			m_mutex.lock();
+			m_sequence.store(m_sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+		}
+		void unlock()
+		{
+			m_sequence.store(m_sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+			m_mutex.unlock();
+		}
+
+		UInt32 readBegin() const
+		{
+			UInt32 sequence;
+			while ((sequence = m_sequence.load(std::memory_order_acquire)) & 1)
+				sched_yield();
+			return sequence;
+		}
+		bool readRetry(UInt32 sequence) const
+		{
+			std::atomic_thread_fence(std::memory_order_acquire);
+			return m_sequence.load(std::memory_order_relaxed) != sequence;
+		}
+	};
+
 	class PageTable
 	{
 
@@ -36,6 +96,7 @@ namespace ParametricDramDirectoryMSI
 		int core_id;
 		String name;
 		String type;
+		bool is_radix; // type == "radix", cached for the per-walk checks in the MMUs
 		int *m_page_size_list;
 		int m_page_sizes;
 		Core *core;
@@ -50,21 +111,24 @@ namespace ParametricDramDirectoryMSI
 			this->name = name;
 			this->is_guest = is_guest;
 			this->type = type;
+			this->is_radix = (type == "radix");
 		};
 
-		virtual PTWResult initializeWalk(IntPtr address, bool count, bool is_prefetch = false, bool restart_walk = false) = 0;
+		virtual void initializeWalk(IntPtr address, bool count, PTWResult &ptw_result, bool is_prefetch = false, bool restart_walk = false) = 0;
 		// virtual AllocatedPage handlePageFault(IntPtr address, bool count, IntPtr ppn = -1, int page_size = 12) = 0;
 		int *getPageSizes() { return m_page_size_list; };
 		int getPageSizesCount() { return m_page_sizes; };
 		virtual int getMaxLevel() { return -1; }; // This function should be overriden by the derived class (e.g., in RadixPageTable there are maximum 4 levels)
 		String getName() { return name; };
 		String getType() { return type; };
+		bool isRadix() const { return is_radix; };
 		virtual void deletePage(IntPtr address) {};
 		virtual void page_moving(IntPtr address) {};
 		virtual void move_pages(std::queue<IntPtr> source, std::queue<IntPtr> dst) {};
 		virtual void DMA_move_page(IntPtr address, IntPtr new_ppn, subsecond_time_t finish_time) {};
-		virtual int updatePageTableFrames(IntPtr address, IntPtr core_id, IntPtr ppn, int page_size, std::vector<UInt64> frames) = 0;
-		virtual std::shared_mutex& get_lock_for_page(IntPtr address) { std::shared_mutex ret; return ret; };
+		virtual int updatePageTableFrames(IntPtr address, IntPtr core_id, IntPtr ppn, int page_size, std::span<const UInt64> frames) = 0;
+		// Page tables without their own locking share one lock for all pages
+		virtual PageTableLock& get_lock_for_page(IntPtr address) { static PageTableLock lock; return lock; };
 		virtual bool check_page_exist(IntPtr address) {return true;}
 	    virtual void incrementPageFaultsOfMigration() {}
 	};
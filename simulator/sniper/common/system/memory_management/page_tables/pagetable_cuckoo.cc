@@ -10,6 +10,7 @@
 #include "physical_memory_allocator.h"
 #include "mimicos.h"
 #include "city.h"
+#include "time_series_sink.h"
 
 #include <iostream>
 #include <stdlib.h>
@@ -23,27 +24,24 @@
 #include <random>	 // for std::default_random_engine
 #include <chrono>	 // for std::chrono::system_clock
 
-#define DEBUG
+// #define DEBUG
 
 namespace ParametricDramDirectoryMSI
 {
 
 	/*
-	 * PageTableCuckoo implements a Cuckoo Hash–inspired page table.
-	 *   - Each page_size uses multiple tables/ways.
+	 * PageTableCuckoo implements an elastic cuckoo hash page table.
+	 *   - Each page size has its own set of d ways, stored as one contiguous bucket array.
 	 *   - The "tag" is derived from the VPN bits (tag = VPN >> 3).
 	 *   - The block offset is (VPN % 8).
-	 *   - Insertions may lead to evictions ("cuckooing"), and if we exceed a loadFactor,
-	 *     we try to rehash with a bigger table.
-	 *   - Non-resident entries that fail to insert are added to 'nonResidentEntries'.
+	 *   - Insertions may lead to evictions ("cuckooing"). Exceeding the loadFactor starts an
+	 *     incremental resize; a displacement chain that does not terminate grows the table at once.
 	 */
 
 	/*
 	 * Constructor:
-	 *   - Allocates multiple "tables" for each page size (e.g., ways).
-	 *   - Each table is an array of "Element" objects, where each Element can store 8 offsets.
+	 *   - Allocates the table of every page size and the physical space it occupies.
 	 *   - Allocates stat counters to track hits, page walks, evictions, and rehashes.
-	 *   - table_ppns[] keeps track of the "physical address" base for each table array.
 	 */
 	PageTableCuckoo::PageTableCuckoo(int core_id,
 									 String name,
@@ -54,6 +52,7 @@ namespace ParametricDramDirectoryMSI
 									 double rehash_threshold,
 									 float scale,
 									 int ways,
+									 int rehash_step,
 									 bool is_guest)
 		: PageTable(core_id, name, type, page_sizes, page_size_list, is_guest),
 		  m_page_table_sizes(page_table_sizes)
@@ -62,72 +61,50 @@ namespace ParametricDramDirectoryMSI
 		log_file_name = std::string(Sim()->getConfig()->getOutputDirectory().c_str()) + "/" + log_file_name;
 		log_file.open(log_file_name);
 
-		std::cout << "Page table constructor\n";
-
-		// numItems tracks how many "valid" tags are stored in each page size’s structure
-		numItems = (int *)malloc(sizeof(int) * m_page_sizes);
-		for (int i = 0; i < m_page_sizes; i++)
-		{
-			numItems[i] = 0;
-		}
-
 		std::cout << "[Cuckoo] Cuckoo has " << page_sizes << " page sizes:\n";
 		for (int i = 0; i < page_sizes; i++)
 		{
 			std::cout << "[Cuckoo] Page size " << i << " has " << page_size_list[i] << " bits\n";
 		}
 
-		// loadFactor is the maximum ratio of items / capacity before rehashing
+		// loadFactor is the maximum ratio of items / capacity before resizing
 		loadFactor = rehash_threshold;
+		m_scale = scale;			   // factor by which the table grows when resizing
+		m_ways = ways;				   // how many ways/tables per page size
+		m_rehash_step = rehash_step; // old buckets migrated per insertion while resizing
 
-		// We store arrays of Element* for each page_size, each dimension = ways
-		tables = (Element ***)malloc(sizeof(Element **) * page_sizes);
-
-		// table_ppns is a 2D array of the base physical addresses for each table
-		table_ppns = (UInt64 **)malloc(sizeof(UInt64 *) * page_sizes);
+		LOG_ASSERT_ERROR(m_ways >= 1, "Cuckoo page table needs at least one way");
+		LOG_ASSERT_ERROR(m_scale > 1, "Cuckoo page table scale must be > 1");
+		LOG_ASSERT_ERROR(m_rehash_step >= 1, "Cuckoo page table rehash_step must be >= 1");
 
-		m_scale = scale; // factor by which the table may grow if rehashing is needed
-		m_ways = ways;	 // how many ways/tables per page size
+		// The displacement chain visits the ways in a fixed pseudo-random order
+		m_way_order.resize(m_ways);
+		std::iota(m_way_order.begin(), m_way_order.end(), 0);
+		std::shuffle(m_way_order.begin(), m_way_order.end(), std::default_random_engine(463576468));
 
-		// For each page size, allocate "ways" tables, each having "m_page_table_sizes[a]" entries
+		m_tables.resize(m_page_sizes);
 		for (int a = 0; a < m_page_sizes; a++)
 		{
-			tables[a] = (Element **)malloc(sizeof(Element *) * ways);
-			table_ppns[a] = (UInt64 *)malloc(sizeof(UInt64) * ways);
-
 			std::cout << "[Cuckoo] Initializing the cuckoo tables with " << ways
 					  << " ways and " << page_table_sizes[a] << " entries\n";
 
-			for (int i = 0; i < ways; i++)
-			{
-				// Allocate an array of Elements
-				tables[a][i] = (Element *)malloc(sizeof(Element) * m_page_table_sizes[a]);
-
-				// Grab some physical address space for this table array
-				table_ppns[a][i] = getPhysicalSpace(m_page_table_sizes[a] * 64);
-				std::cout << "[Cuckoo] Table " << i << " has ppn " << table_ppns[a][i] << "\n";
-
-				// Initialize each Element to defaults
-				for (int j = 0; j < m_page_table_sizes[a]; j++)
-				{
-					tables[a][i][j] = Element();
-				}
-			}
+			makeTable(m_tables[a].cur, m_page_table_sizes[a]);
+			m_tables[a].cursor = 0;
+			m_tables[a].items = 0;
+			m_tables[a].resizing = false;
 		}
 
-		std::cout << "[Cuckoo] Cuckoo initialized\n";
-
 		cuckoo_stats.cuckoo_hits = 0;
 		cuckoo_stats.page_walks_total = 0;
 		cuckoo_stats.cuckoo_evictions = 0;
 		cuckoo_stats.rehashes = 0;
-
-		std::cout << "[Cuckoo] Registering stats with name " << name << " and core " << core_id << "\n";
+		cuckoo_stats.migrated_buckets = 0;
 
 		// Track total page walks, total evictions, total rehashes
 		registerStatsMetric(name, core_id, "ptws_total", &cuckoo_stats.page_walks_total);
 		registerStatsMetric(name, core_id, "evictions", &cuckoo_stats.cuckoo_evictions);
 		registerStatsMetric(name, core_id, "rehashes", &cuckoo_stats.rehashes);
+		registerStatsMetric(name, core_id, "migrated_buckets", &cuckoo_stats.migrated_buckets);
 
 		// For each page size, track hits at that level and number of accesses
 		cuckoo_stats.cuckoo_hits_per_level = new UInt64[page_sizes];
@@ -140,433 +117,248 @@ namespace ParametricDramDirectoryMSI
 			registerStatsMetric(name, core_id, "hit_at_level" + itostr(i), &cuckoo_stats.cuckoo_hits_per_level[i]);
 			registerStatsMetric(name, core_id, "num_accesses" + itostr(i), &cuckoo_stats.cuckoo_accesses[i]);
 		}
+
+		std::vector<String> columns;
+		for (int i = 0; i < page_sizes; i++)
+		{
+			columns.push_back("load_factor_" + itostr(m_page_size_list[i]));
+			columns.push_back("size_" + itostr(m_page_size_list[i]));
+		}
+		m_occupancy_series = TimeSeriesSink::create(name + ".occupancy." + itostr(core_id), columns);
+		m_insertions = 0;
+	}
+
+	PageTableCuckoo::~PageTableCuckoo()
+	{
+		delete m_occupancy_series;
+		delete[] m_page_table_sizes;
+		delete[] cuckoo_stats.cuckoo_accesses;
+		delete[] cuckoo_stats.cuckoo_hits_per_level;
 	}
 
 	/*
 	 * hash(...) => Hashes address with CityHash64, modded by the table size.
 	 * Used for indexing in each "way".
 	 */
-	uint64 PageTableCuckoo::hash(uint64 address, int table_size)
+	uint64 PageTableCuckoo::hash(uint64 address, UInt64 table_size)
 	{
-		uint64 result = CityHash64((const char *)&address, 8) % table_size;
-		return result;
+		return CityHash64((const char *)&address, 8) % table_size;
 	}
 
 	/*
-	 * insertElement(...):
-	 *   - Attempts to insert or update an Element in the cuckoo table for a particular page_size_index.
-	 *   - We first see if there's an existing entry with the same tag; if so, we update the offset.
-	 *   - Otherwise, we do the standard cuckoo algorithm:
-	 *       1) Attempt to place the new Element in one of the ways by computing hash(tag + way).
-	 *       2) If the position is empty, store it and return.
-	 *       3) If not, evict the existing occupant, and repeat with that occupant’s data.
-	 *       4) If we exceed a certain number of retries, we fail, moving that occupant to nonResidentEntries.
-	 *   - visitedAddresses collects the “physical addresses” we touch while trying to insert (for stats).
-	 *   - Returns <success, visitedAddresses>.
+	 * makeTable(...) => an empty table of 'size' buckets per way, with physical space for every way
+	 * (64 bytes per bucket) unless allocate_space is false.
 	 */
-	std::tuple<bool, accessedAddresses> PageTableCuckoo::insertElement(int page_size_index, Element entry, IntPtr address)
+	void PageTableCuckoo::makeTable(Table &table, UInt64 size, bool allocate_space)
 	{
-		accessedAddresses visitedAddresses;
-		int retries;
-		uint64_t pos = 0;
-		int selected_way = -1;
-
-		// Derive the tag and offset from the VPN
-		uint64_t VPN = address >> m_page_size_list[page_size_index];
-		uint64_t tag = VPN >> 3;
-		uint64_t indexInsideBlock = VPN % 8;
-
-		Element currentElement;
-		Element oldElement;
-
-		currentElement.tag = entry.tag;
-
-		// Initialize currentElement to all invalid bits except for the one offset we want to set
-		for (int i = 0; i < 8; i++)
-		{
-			currentElement.validityBits[i] = false;
-			currentElement.frames[i] = -1;
-		}
-		currentElement.validityBits[indexInsideBlock] = entry.validityBits[indexInsideBlock];
-		currentElement.frames[indexInsideBlock] = entry.frames[indexInsideBlock];
-
-		oldElement.tag = -1;
-		for (int i = 0; i < 8; i++)
-		{
-			oldElement.validityBits[i] = false;
-			oldElement.frames[i] = -1;
-		}
+		table.size = size;
+		table.buckets.assign(m_ways * size, Element());
+		table.ppns.assign(m_ways, 0);
+		if (!allocate_space)
+			return;
+		for (int i = 0; i < m_ways; i++)
+			table.ppns[i] = getPhysicalSpace(size * 64);
+	}
 
-#ifdef DEBUG
-		log_file << "[Cuckoo] Inserting element with tag " << currentElement.tag
-				 << " and index " << indexInsideBlock
-				 << " in page size " << m_page_size_list[page_size_index] << "\n";
-#endif
+	/*
+	 * cuckooInsert(...):
+	 *   - If a bucket with the element's tag already exists in one of the ways, merge the offsets into it.
+	 *   - Otherwise, walk the displacement chain: place the element at hash(tag + way) in the next way
+	 *     of m_way_order; an occupant is evicted and carried on to the following way.
+	 *   - new_bucket is set if an empty bucket got filled.
+	 *   - Returns false after MAX_CUCKOO_RETRIES displacements; 'element' then holds the bucket that is
+	 *     left without a place.
+	 */
+	bool PageTableCuckoo::cuckooInsert(Table &table, Element &element, bool &new_bucket)
+	{
+		new_bucket = false;
 
-		// Try each way to see if we can update an existing entry with the same tag
 		for (int i = 0; i < m_ways; ++i)
 		{
-			pos = hash(tag + i, m_page_table_sizes[page_size_index]);
-
-#ifdef DEBUG
-			log_file << "Checking position " << pos << " in way " << i
-					 << " for update: " << tables[page_size_index][i][pos].tag
-					 << " with validity: ";
-
-			for (int j = 0; j < 8; j++)
+			Element &bucket = table.at(i, hash(element.tag + i, table.size));
+			if (bucket.tag == element.tag)
 			{
-				log_file << tables[page_size_index][i][pos].validityBits[j] << " ";
-			}
-			log_file << "\n";
-#endif
-
-			// If we find the tag in that position but offset is not valid => just set it
-			if (tables[page_size_index][i][pos].tag == tag && !tables[page_size_index][i][pos].validityBits[indexInsideBlock])
-			{
-#ifdef DEBUG
-				log_file << "Updating translation with tag " << currentElement.tag
-						 << " in way " << i << " at position " << pos << "\n";
-#endif
-				tables[page_size_index][i][pos].frames[indexInsideBlock] = currentElement.frames[indexInsideBlock];
-				tables[page_size_index][i][pos].validityBits[indexInsideBlock] = true;
-				return std::make_tuple(true, visitedAddresses);
-			}
-			else if (tables[page_size_index][i][pos].tag == tag)
-			{
-				// Shouldn’t happen: that means offset is already valid or a conflicting overlap
-				log_file << "Error: Cuckoo should not come here P1" << std::endl;
+				for (int j = 0; j < 8; j++)
+				{
+					if (element.valid & (1 << j))
+						bucket.frames[j] = element.frames[j];
+				}
+				bucket.valid |= element.valid;
+				return true;
 			}
 		}
 
-		// If we get here, there is no matching tag => we do the eviction-based insert
-		oldElement.tag = currentElement.tag;
-		for (int i = 0; i < 8; i++)
+		for (int retry = 0; retry < MAX_CUCKOO_RETRIES; retry++)
 		{
-			oldElement.validityBits[i] = currentElement.validityBits[i];
-			oldElement.frames[i] = currentElement.frames[i];
-		}
-
-		// Generate a random permutation of ways for insertion attempts
-		std::vector<int> permutation(m_ways);
-
-		unsigned seed = 463576468;
-		int counter = 0;
-		retries = 48; // max times we’ll attempt to cuckoo
-
-		// Fill with 0..(m_ways-1) then shuffle
-		std::iota(permutation.begin(), permutation.end(), 0);
-		std::shuffle(permutation.begin(), permutation.end(), std::default_random_engine(seed));
-
-		// We’ll cycle through this permutation multiple times if needed
-		for (int i = m_ways; i < (retries + 1); ++i)
-		{
-			permutation.push_back(permutation[(i - m_ways) % m_ways]);
-		}
+			int way = m_way_order[retry % m_ways];
+			Element &bucket = table.at(way, hash(element.tag + way, table.size));
 
-		// Start with the first element in the permutation
-		int new_way = -1;
-		if (!permutation.empty())
-		{
-			new_way = permutation.front();
-			permutation.erase(permutation.begin());
-		}
-		else
-		{
-			assert(false);
-		}
-
-		selected_way = new_way;
-
-		// The main cuckoo loop: we keep evicting until we find an empty spot or run out of retries
-		while (retries)
-		{
-			currentElement.tag = oldElement.tag;
-			for (int i = 0; i < 8; i++)
+#ifdef DEBUG
+			log_file << "Trying to insert tag: " << element.tag << " in way " << way
+					 << " occupied by tag " << bucket.tag << "\n";
+#endif
+			if (bucket.tag == EMPTY_TAG)
 			{
-				currentElement.validityBits[i] = oldElement.validityBits[i];
-				currentElement.frames[i] = oldElement.frames[i];
+				bucket = element;
+				new_bucket = true;
+				return true;
 			}
 
-			pos = hash(currentElement.tag + selected_way, m_page_table_sizes[page_size_index]);
+			std::swap(bucket, element);
+			cuckoo_stats.cuckoo_evictions++;
+		}
 
-#ifdef DEBUG
-			log_file << "Trying to insert tag: " << currentElement.tag
-					 << " in position " << pos
-					 << " in way " << selected_way
-					 << " with tag " << tables[page_size_index][selected_way][pos].tag
-					 << " and validity: ";
+		return false;
+	}
 
-			for (int j = 0; j < 8; j++)
-			{
-				log_file << tables[page_size_index][selected_way][pos].validityBits[j] << " ";
-			}
-			log_file << "\n";
-#endif
+	/*
+	 * place(...) => insert a bucket into the current table of a page size. If the displacement chain
+	 * does not terminate, the table is grown at once and the homeless bucket is retried there.
+	 */
+	void PageTableCuckoo::place(int page_size_index, Element element)
+	{
+		PageSizeTables &tables = m_tables[page_size_index];
+		bool new_bucket;
 
-			// If the slot is empty, store our item and return success
-			if (tables[page_size_index][selected_way][pos].tag == static_cast<uint64_t>(-1))
-			{
-#ifdef DEBUG
-				log_file << "Inserting translation with tag " << currentElement.tag
-						 << " in way " << selected_way
-						 << " at position " << pos << "\n";
-#endif
-				tables[page_size_index][selected_way][pos].tag = currentElement.tag;
-				for (int i = 0; i < 8; i++)
-				{
-					tables[page_size_index][selected_way][pos].validityBits[i] = currentElement.validityBits[i];
-					tables[page_size_index][selected_way][pos].frames[i] = currentElement.frames[i];
-				}
+		while (!cuckooInsert(tables.cur, element, new_bucket))
+			growNow(page_size_index);
 
-				numItems[page_size_index]++;
-				visitedAddresses.push_back(make_tuple(page_size_index, counter,
-													  (uint64_t)(table_ppns[page_size_index][selected_way] + pos * 64), false));
-				return std::make_tuple(true, visitedAddresses);
-			}
-			// Otherwise, we evict the occupant => occupant becomes oldElement; occupant’s spot gets our item
-			else if (tables[page_size_index][selected_way][pos].tag != currentElement.tag)
-			{
-#ifdef DEBUG
-				log_file << "Evicting translation with tag "
-						 << tables[page_size_index][selected_way][pos].tag
-						 << " in way " << selected_way
-						 << " at position " << pos << "\n";
-#endif
-				// Save occupant
-				oldElement.tag = tables[page_size_index][selected_way][pos].tag;
-				for (int i = 0; i < 8; i++)
-				{
-					oldElement.validityBits[i] = tables[page_size_index][selected_way][pos].validityBits[i];
-					oldElement.frames[i] = tables[page_size_index][selected_way][pos].frames[i];
-				}
+		if (new_bucket)
+			tables.items++;
+	}
 
-				// Next way in the permutation
-				int new_way = -1;
-				if (!permutation.empty())
-				{
-					new_way = permutation.front();
-					permutation.erase(permutation.begin());
-				}
-				else
-				{
-					assert(false);
-				}
+	/*
+	 * startResize(...) => the current table becomes the old one and is drained incrementally into a
+	 * table m_scale times larger.
+	 */
+	void PageTableCuckoo::startResize(int page_size_index)
+	{
+		PageSizeTables &tables = m_tables[page_size_index];
+		LOG_ASSERT_ERROR(!tables.resizing, "Cuckoo resize started while one is in progress");
 
 #ifdef DEBUG
-				log_file << "Inserting translation with tag " << currentElement.tag
-						 << " in way " << selected_way
-						 << " at position " << pos << "\n";
-				log_file << "Before eviction: " << tables[page_size_index][selected_way][pos].tag;
+		log_file << "Resizing the cuckoo table for page size " << m_page_size_list[page_size_index]
+				 << " from " << tables.cur.size << " buckets per way\n";
 #endif
-				// Overwrite occupant with our item
-				tables[page_size_index][selected_way][pos].tag = currentElement.tag;
-#ifdef DEBUG
-				log_file << "After eviction: " << tables[page_size_index][selected_way][pos].tag << "\n";
-#endif
-				for (int i = 0; i < 8; i++)
-				{
-					tables[page_size_index][selected_way][pos].validityBits[i] = currentElement.validityBits[i];
-					tables[page_size_index][selected_way][pos].frames[i] = currentElement.frames[i];
-				}
+		std::swap(tables.old, tables.cur);
+		makeTable(tables.cur, tables.old.size * m_scale);
+		tables.cursor = 0;
+		tables.resizing = true;
+		m_page_table_sizes[page_size_index] = tables.cur.size;
+		cuckoo_stats.rehashes++;
+	}
 
-				visitedAddresses.push_back(make_tuple(page_size_index, counter,
-													  (uint64_t)(table_ppns[page_size_index][selected_way] + pos * 64), false));
-				selected_way = new_way;
-			}
-			else
-			{
-#ifdef DEBUG
-				log_file << "Error: Cuckoo should not come here" << std::endl;
-				log_file << "Current tag: " << currentElement.tag
-						 << " and occupant tag: "
-						 << tables[page_size_index][selected_way][pos].tag << "\n";
-#endif
-			}
+	/*
+	 * migrate(...) => move up to 'buckets' buckets of the old table into the current one. Once the
+	 * old table is drained, its memory is released.
+	 */
+	void PageTableCuckoo::migrate(int page_size_index, int buckets)
+	{
+		PageSizeTables &tables = m_tables[page_size_index];
+		UInt64 total = tables.old.buckets.size();
 
-			retries--;
-			counter++;
+		for (int i = 0; i < buckets && tables.cursor < total; i++, tables.cursor++)
+		{
+			Element &bucket = tables.old.buckets[tables.cursor];
+			if (bucket.tag == EMPTY_TAG)
+				continue;
+
+			Element element = bucket;
+			bucket.tag = EMPTY_TAG;
+			tables.items--;
+			cuckoo_stats.migrated_buckets++;
+			place(page_size_index, element);
 		}
 
-		// If we exit the while loop, we failed to place the item => push occupant to nonResidentEntries
-		if (oldElement.tag != static_cast<uint64_t>(-1))
+		if (tables.cursor == total)
 		{
-			nonResidentEntries.push_back(oldElement);
-#ifdef DEBUG
-			log_file << "Non-resident entry with tag " << oldElement.tag << " added to the list\n";
-#endif
+			std::vector<Element>().swap(tables.old.buckets);
+			tables.old.size = 0;
+			tables.resizing = false;
 		}
-
-		return std::make_tuple(false, visitedAddresses);
 	}
 
 	/*
-	 * rehash(...):
-	 *   - Attempts to increase the table size for the specified page_size_index and re-insert everything.
-	 *   - We allocate new arrays, then call insertElement(...) for all existing items.
-	 *   - If any insertion fails, we restore the old arrays. This can happen if we get repeated collisions.
-	 *   - If successful, we track a rehash count and clean up old memory.
-	 *   - Returns true if rehash is successful, false otherwise.
+	 * growNow(...) => rebuild the current table at once in a larger one, growing further until every
+	 * bucket finds a place. The attempts only use host memory: the physical space is allocated once,
+	 * for the size that worked. The unmigrated part of an old table is not touched: its buckets keep
+	 * moving into whatever table is current.
 	 */
-	bool PageTableCuckoo::rehash(int page_size_index, int newSize)
+	void PageTableCuckoo::growNow(int page_size_index)
 	{
-#ifdef DEBUG
-		log_file << "Rehashing the cuckoo table for page size " << m_page_size_list[page_size_index] << "\n";
-		log_file << "Old size: " << m_page_table_sizes[page_size_index] << "\n";
-		log_file << "Scale factor: " << m_scale << "\n";
-		log_file << "New size: " << newSize << "\n";
-#endif
-		int oldSize = m_page_table_sizes[page_size_index];
-
-		Element **temp = tables[page_size_index];
+		PageSizeTables &tables = m_tables[page_size_index];
+		UInt64 new_size = tables.cur.size * m_scale;
 
-		// Allocate new tables
-		Element **newTables = (Element **)malloc(sizeof(Element *) * m_ways);
-		for (int i = 0; i < m_ways; i++)
+		while (true)
 		{
-			newTables[i] = (Element *)malloc(sizeof(Element) * newSize);
-			for (int j = 0; j < newSize; j++)
-			{
-				newTables[i][j] = Element();
-			}
-		}
-
-		// Switch to new tables
-		tables[page_size_index] = newTables;
-
-#ifdef DEBUG
-		log_file << "We need to migrate " << numItems[page_size_index] << " elements\n";
-#endif
-		m_page_table_sizes[page_size_index] = newSize; // record the updated size
+			Table grown;
+			makeTable(grown, new_size, false);
 
-		// Migrate old data
-		for (int way = 0; way < m_ways; way++)
-		{
-			for (int pos = 0; pos < oldSize; pos++)
+			bool ok = true;
+			bool new_bucket;
+			for (const Element &bucket : tables.cur.buckets)
 			{
-				if (temp[way][pos].tag != static_cast<uint64_t>(-1))
+				if (bucket.tag == EMPTY_TAG)
+					continue;
+				Element element = bucket;
+				if (!cuckooInsert(grown, element, new_bucket))
 				{
-					// For each valid offset, re-insert the item
-					for (int i = 0; i < 8; i++)
-					{
-						if (temp[way][pos].validityBits[i])
-						{
-							uint64_t VPN = (temp[way][pos].tag << 3) + i;
-							uint64_t address = VPN << m_page_size_list[page_size_index];
-#ifdef DEBUG
-							log_file << "Migrating element with tag "
-									 << temp[way][pos].tag
-									 << " and index " << VPN % 8
-									 << " at validity " << i
-									 << " in way " << way
-									 << " at position " << pos << "\n";
-#endif
-							std::tuple<bool, accessedAddresses> result = insertElement(page_size_index, temp[way][pos], address);
-							if (get<0>(result) == false)
-							{
-								// Failure => revert changes
-								tables[page_size_index] = temp;
-								for (int i = 0; i < m_ways; i++)
-								{
-									free(newTables[i]);
-								}
-								free(newTables);
-								m_page_table_sizes[page_size_index] = oldSize;
-#ifdef DEBUG
-								log_file << "Rehash failed" << std::endl;
-#endif
-								nonResidentEntries.clear();
-								return false;
-							}
-						}
-					}
+					ok = false;
+					break;
 				}
 			}
-		}
 
-		// Next, handle the nonResidentEntries
-		std::vector<Element> tempNonResidentEntries;
-		for (UInt32 j = 0; j < nonResidentEntries.size(); j++)
-		{
-			Element entry = nonResidentEntries[j];
-			tempNonResidentEntries.push_back(entry);
-		}
-
-		// Insert them in the new tables
-		for (UInt32 j = 0; j < nonResidentEntries.size(); j++)
-		{
-			Element entry = nonResidentEntries[j];
-			for (int i = 0; i < 8; i++)
+			if (ok)
 			{
-				if (entry.validityBits[i])
-				{
-					uint64_t VPN = (entry.tag << 3) + i;
-					uint64_t address = VPN << m_page_size_list[page_size_index];
-#ifdef DEBUG
-					log_file << "Migrating non-resident element with tag " << entry.tag
-							 << " in page size " << m_page_size_list[page_size_index] << "\n";
-#endif
-					std::tuple<bool, accessedAddresses> result = insertElement(page_size_index, entry, address);
-					if (get<0>(result) == false)
-					{
-						// Failure => revert
-						tables[page_size_index] = temp;
-						for (int i = 0; i < m_ways; i++)
-						{
-							free(newTables[i]);
-						}
-						free(newTables);
-
-						m_page_table_sizes[page_size_index] = oldSize;
-#ifdef DEBUG
-						log_file << "Rehash failed" << std::endl;
-#endif
-						nonResidentEntries.clear();
-
-						// restore the prior nonResidentEntries
-						for (UInt32 j = 0; j < tempNonResidentEntries.size(); j++)
-						{
-							Element entry = tempNonResidentEntries[j];
-							nonResidentEntries.push_back(entry);
-						}
-						return false;
-					}
-				}
+				for (int i = 0; i < m_ways; i++)
+					grown.ppns[i] = getPhysicalSpace(new_size * 64);
+				std::swap(tables.cur, grown);
+				break;
 			}
-			// remove the entry from the non-resident list
-			nonResidentEntries.erase(nonResidentEntries.begin());
-		}
 
-		log_file << "Rehash successful" << std::endl;
-		// Clean up old memory
-		for (int i = 0; i < m_ways; i++)
-		{
-			free(temp[i]);
+			new_size *= m_scale;
+			log_file << "[Cuckoo] Rehash failed, trying again with new size " << new_size << "\n";
 		}
-		free(temp);
 
-		m_page_table_sizes[page_size_index] = newSize;
+		m_page_table_sizes[page_size_index] = tables.cur.size;
 		cuckoo_stats.rehashes++;
-		return true;
 	}
 
 	/*
 	 * currentLoadFactor(...) => calculates (numItems / (table_size * ways)).
-	 * If this exceeds 'loadFactor', we trigger rehash in updatePageTableFrames().
+	 * If this exceeds 'loadFactor', updatePageTableFrames() starts a resize.
 	 */
 	double PageTableCuckoo::currentLoadFactor(int page_size_index) const
 	{
-		return (double)numItems[page_size_index] / (m_page_table_sizes[page_size_index] * m_ways);
+		const PageSizeTables &tables = m_tables[page_size_index];
+		return (double)tables.items / (tables.cur.size * m_ways);
+	}
+
+	/*
+	 * publishOccupancy() => adds the load factor and the size (buckets per way) of the table
+	 * of every page size to the occupancy time series.
+	 */
+	void PageTableCuckoo::publishOccupancy()
+	{
+		std::vector<double> values;
+		for (int i = 0; i < m_page_sizes; i++)
+		{
+			values.push_back(currentLoadFactor(i));
+			values.push_back(m_tables[i].cur.size);
+		}
+		m_occupancy_series->publish(m_insertions, values.data());
 	}
 
 	/*
 	 * initializeWalk(...):
 	 *   - For each page size, compute a tag and offset from the address.
-	 *   - For each way, compute pos = hash(tag + way), and check if that slot has the correct tag & offset.
-	 *   - If found, return a PTWResult with page_size_result and the PPN.
+	 *   - For each way, probe the current table at hash(tag + way) and, during a resize, the old table
+	 *     if that way's bucket has not been migrated yet.
+	 *   - If found, fill ptw_result with page_size_result and the PPN.
 	 *   - If none match => page fault.
 	 *   - If restart_walk_after_fault is set, we handle_page_fault(...) and try again.
 	 */
-	PTWResult PageTableCuckoo::initializeWalk(IntPtr address, bool count, bool is_prefetch, bool restart_walk_after_fault)
+	void PageTableCuckoo::initializeWalk(IntPtr address, bool count, PTWResult &ptw_result, bool is_prefetch, bool restart_walk_after_fault)
 	{
 #ifdef DEBUG
 		log_file << std::endl;
@@ -575,7 +367,8 @@ namespace ParametricDramDirectoryMSI
 		if (count)
 			cuckoo_stats.page_walks_total++;
 
-		accessedAddresses visitedAddresses;
+		accessedAddresses &visitedAddresses = get<1>(ptw_result);
+		visitedAddresses.clear();
 		bool is_page_fault_in_every_page_size = false;
 		int page_size_result = -1;
 		IntPtr ppn_result = 0;
@@ -585,57 +378,41 @@ namespace ParametricDramDirectoryMSI
 		// Attempt a lookup in each page size
 		for (int i = 0; i < m_page_sizes; i++)
 		{
+			PageSizeTables &tables = m_tables[i];
 			IntPtr VPN = address >> m_page_size_list[i];
 			IntPtr tag = VPN >> 3;
-			IntPtr offset = VPN % 8;
-
-#ifdef DEBUG
-			log_file << "[Cuckoo] Doing page walk with tag " << tag
-					 << " and offset " << offset
-					 << " in page size " << m_page_size_list[i] << "\n";
-#endif
+			UInt8 offset_bit = 1 << (VPN % 8);
 
-			// For each way, compute the hash and check if we have a match
 			for (int a = 0; a < m_ways; ++a)
 			{
-				uint64_t pos = hash(tag + a, m_page_table_sizes[i]);
-
-#ifdef DEBUG
-				log_file << "[Cuckoo] Size of the table: " << m_page_table_sizes[i] << "\n";
-				log_file << "[Cuckoo] Position of the block:" << pos << "\n"
-						 << "[Cuckoo] Tag of the block: " << tables[i][a][pos].tag
-						 << " and validity: ";
-				for (int j = 0; j < 8; j++)
+				for (int t = 0; t < 2; t++)
 				{
-					log_file << tables[i][a][pos].validityBits[j] << " ";
-				}
-				log_file << "\n";
-#endif
-				// If tags and validity match => we found the PPN
-				if (tables[i][a][pos].tag == tag && tables[i][a][pos].validityBits[offset])
-				{
-					ppn_result = tables[i][a][pos].frames[offset];
-					visitedAddresses.push_back(make_tuple(i, 0, (IntPtr)(table_ppns[i][a] * 4096 + pos * 64), true));
-					page_size_result = m_page_size_list[i];
+					Table *table = &tables.cur;
+					if (t == 1)
+					{
+						if (!tables.resizing)
+							break;
+						UInt64 old_pos = hash(tag + a, tables.old.size);
+						if (isMigrated(tables, a, old_pos))
+							break;
+						table = &tables.old;
+					}
+
+					uint64_t pos = hash(tag + a, table->size);
+					const Element &bucket = table->at(a, pos);
+					bool hit = (bucket.tag == tag) && (bucket.valid & offset_bit);
 
+					visitedAddresses.push_back(make_tuple(i, 0, (IntPtr)(table->ppns[a] * 4096 + pos * 64), hit));
 					cuckoo_stats.cuckoo_accesses[i]++;
-					if (count)
+
+					if (hit)
 					{
-#ifdef DEBUG
-						log_file << "[Cuckoo] Cuckoo hit at level " << i
-								 << " with tag " << tag
-								 << " and index " << offset
-								 << " in page size " << m_page_size_list[i] << "\n";
-#endif
-						cuckoo_stats.cuckoo_hits_per_level[i]++;
+						ppn_result = bucket.frames[VPN % 8];
+						page_size_result = m_page_size_list[i];
+						if (count)
+							cuckoo_stats.cuckoo_hits_per_level[i]++;
 					}
 				}
-				else
-				{
-					// If it’s not a match, we record an access for stats
-					visitedAddresses.push_back(make_tuple(i, 0, (IntPtr)(table_ppns[i][a] * 4096 + pos * 64), false));
-					cuckoo_stats.cuckoo_accesses[i]++;
-				}
 			}
 		}
 
@@ -650,35 +427,29 @@ namespace ParametricDramDirectoryMSI
 			if (restart_walk_after_fault)
 				goto restart_walk;
 			else
-				return PTWResult(page_size_result, visitedAddresses, ppn_result, SubsecondTime::Zero(), is_page_fault_in_every_page_size, PF_DUMMY, SubsecondTime::Zero());
+			{
+				setPTWResult(ptw_result, page_size_result, ppn_result, SubsecondTime::Zero(), is_page_fault_in_every_page_size, PF_DUMMY, SubsecondTime::Zero());
+				return;
+			}
 		}
 
-		// If we found a match in some page size
-		if (page_size_result != -1)
-		{
-			// We already incremented stats above
 #ifdef DEBUG
-			log_file << "[Cuckoo] Page walk finished\n";
-			log_file << "[Cuckoo] Page size result: " << page_size_result << "\n";
-			log_file << "[Cuckoo] PPN result: " << ppn_result << "\n";
-			log_file << "[Cuckoo] Was it a pagefault? " << is_page_fault_in_every_page_size << "\n";
+		log_file << "[Cuckoo] Page walk finished\n";
+		log_file << "[Cuckoo] Page size result: " << page_size_result << "\n";
+		log_file << "[Cuckoo] PPN result: " << ppn_result << "\n";
+		log_file << "[Cuckoo] Was it a pagefault? " << is_page_fault_in_every_page_size << "\n";
 #endif
-			return PTWResult(page_size_result, visitedAddresses, ppn_result, SubsecondTime::Zero(), is_page_fault_in_every_page_size, PF_DUMMY, SubsecondTime::Zero());
-		}
-
-		// Should not reach here
-		assert(false);
-		return PTWResult(-1, visitedAddresses, -1, SubsecondTime::Zero(), is_page_fault_in_every_page_size, PF_DUMMY, SubsecondTime::Zero());
+		setPTWResult(ptw_result, page_size_result, ppn_result, SubsecondTime::Zero(), is_page_fault_in_every_page_size, PF_DUMMY, SubsecondTime::Zero());
 	}
 
 	/*
 	 * updatePageTableFrames(...):
 	 *   - Called whenever we need to map "address" -> "ppn" for a given page_size.
-	 *   - If the load factor is too high, we rehash with an increased table size.
-	 *   - Then we build an Element object from the (tag, offset, and ppn) and attempt to insert it.
-	 *   - If insertion fails, we attempt to rehash repeatedly until successful.
+	 *   - Starts a resize if the load factor is too high, and advances a running one by m_rehash_step buckets.
+	 *   - If the tag still lives in an unmigrated bucket of the old table, the translation is added there;
+	 *     otherwise it goes into the current table.
 	 */
-	int PageTableCuckoo::updatePageTableFrames(IntPtr address, IntPtr core_id, IntPtr ppn, int page_size, std::vector<UInt64> frames)
+	int PageTableCuckoo::updatePageTableFrames(IntPtr address, IntPtr core_id, IntPtr ppn, int page_size, std::span<const UInt64> frames)
 	{
 #ifdef DEBUG
 		log_file << "[Cuckoo] Updating page table frames for address "
@@ -697,82 +468,80 @@ namespace ParametricDramDirectoryMSI
 			}
 		}
 
-		// If we exceed loadFactor => rehash
-		if (currentLoadFactor(page_size_index) > loadFactor)
-		{
-			int new_size = m_page_table_sizes[page_size_index] * m_scale;
-			while (!rehash(page_size_index, new_size))
-			{
-				new_size *= m_scale;
-				log_file << "Rehash failed, trying again with new size " << new_size << "\n";
-			}
-		}
+		if (m_occupancy_series && ++m_insertions % m_occupancy_series->getInterval() == 0)
+			publishOccupancy();
+
+		PageSizeTables &tables = m_tables[page_size_index];
+
+		if (!tables.resizing && currentLoadFactor(page_size_index) > loadFactor)
+			startResize(page_size_index);
+		if (tables.resizing)
+			migrate(page_size_index, m_rehash_step);
 
-		// Build an Element with the correct tag/offset
-		Element entry;
 		uint64_t VPN = address >> m_page_size_list[page_size_index];
 		uint64_t tag = VPN >> 3;
 		uint64_t offset = VPN % 8;
 
-		entry.tag = tag;
-		entry.validityBits[offset] = true;
-		entry.frames[offset] = ppn;
-
-		int new_size = m_page_table_sizes[page_size_index];
-
-		// Attempt to insert the new Element
-		std::tuple<bool, accessedAddresses> result = insertElement(page_size_index, entry, address);
-
-		// If it fails => keep rehashing with bigger sizes until success
-		if (get<0>(result) == false)
+		if (tables.resizing)
 		{
-			new_size *= m_scale;
-			while (!rehash(page_size_index, new_size))
+			for (int a = 0; a < m_ways; ++a)
 			{
-				new_size *= m_scale;
-				log_file << "[Cuckoo] Rehash failed, trying again with new size " << new_size << "\n";
+				UInt64 old_pos = hash(tag + a, tables.old.size);
+				Element &bucket = tables.old.at(a, old_pos);
+				if (!isMigrated(tables, a, old_pos) && bucket.tag == tag)
+				{
+					bucket.frames[offset] = ppn;
+					bucket.valid |= 1 << offset;
+					return 0;
+				}
 			}
 		}
 
+		Element entry;
+		entry.tag = tag;
+		entry.valid = 1 << offset;
+		entry.frames[offset] = ppn;
+		place(page_size_index, entry);
+
 		return 0;
 	}
 
 	/*
 	 * deletePage(...):
-	 *   - Removes the offset for 'address' from the "way 0" page table (?).
-	 *   - If the occupant becomes entirely empty (no valid offsets), we set tag = -1.
-	 *   - The logic is fairly simple, scanning each way in turn for a matching tag.
+	 *   - Removes the offset for 'address' from the base page size table.
+	 *   - If the bucket becomes entirely empty (no valid offsets), we set tag = -1.
 	 */
 	void PageTableCuckoo::deletePage(IntPtr address)
 	{
-		bool found = false;
-
+		PageSizeTables &tables = m_tables[0];
 		IntPtr VPN = address >> m_page_size_list[0];
 		IntPtr tag = VPN >> 3;
 		IntPtr indexInsideBlock = VPN % 8;
 
 		for (int a = 0; a < m_ways; ++a)
 		{
-			uint64_t pos = hash(tag + a, m_page_table_sizes[0]);
-			if (tables[0][a][pos].tag == tag)
+			for (int t = 0; t < 2; t++)
 			{
-				tables[0][a][pos].validityBits[indexInsideBlock] = false;
-				tables[0][a][pos].frames[indexInsideBlock] = -1;
-
-				// If any offset remains valid, we keep the tag
-				for (int j = 0; j < 8; j++)
+				Table *table = &tables.cur;
+				if (t == 1)
 				{
-					if (tables[0][a][pos].validityBits[j])
-					{
-						found = true;
+					if (!tables.resizing || isMigrated(tables, a, hash(tag + a, tables.old.size)))
 						break;
-					}
+					table = &tables.old;
 				}
-				// If not found => occupant is fully empty
-				if (!found)
-					tables[0][a][pos].tag = -1;
 
-				break;
+				Element &bucket = table->at(a, hash(tag + a, table->size));
+				if (bucket.tag != tag)
+					continue;
+
+				bucket.valid &= ~(1 << indexInsideBlock);
+				bucket.frames[indexInsideBlock] = -1;
+				if (bucket.valid == 0)
+				{
+					bucket.tag = EMPTY_TAG;
+					tables.items--;
+				}
+				return;
 			}
 		}
 	}
@@ -781,7 +550,7 @@ namespace ParametricDramDirectoryMSI
 	 * getPhysicalSpace(...) => convenience wrapper to ask the memory allocator for
 	 * a chunk of space of size “size,” used for storing a cuckoo table array in memory.
 	 */
-	IntPtr PageTableCuckoo::getPhysicalSpace(int size)
+	IntPtr PageTableCuckoo::getPhysicalSpace(UInt64 size)
 	{
 		return Sim()->getMimicOS()->getMemoryAllocator()->handle_page_table_allocations(size);
 	}
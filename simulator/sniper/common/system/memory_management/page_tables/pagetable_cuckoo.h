@@ -7,37 +7,66 @@
 #include <fstream>
 #include <iostream>
 
+class TimeSeriesSink;
+
 namespace ParametricDramDirectoryMSI
 {
 	class PageTableCuckoo : public PageTable
 	{
 	private:
+		static const IntPtr EMPTY_TAG = ~(IntPtr)0;
+		static const int MAX_CUCKOO_RETRIES = 48;
+
+		// One bucket: the translations of 8 consecutive VPNs sharing a tag. A block offset is
+		// present when its bit is set in 'valid', so a probe is one tag compare and one bit test.
 		struct Element
 		{
 			IntPtr tag;
-			bool validityBits[8];
+			UInt8 valid;
 			IntPtr frames[8];
 
-			Element(int t = -1) : tag(t)
+			Element() : tag(EMPTY_TAG), valid(0)
 			{
 				for (int i = 0; i < 8; ++i)
-				{
-					validityBits[i] = false;
 					frames[i] = -1;
-				}
 			}
 		};
 
-		Element ***tables;
-		UInt64 **table_ppns;
+		// All ways of one table in a single contiguous array, bucket (way, pos) at way * size + pos
+		struct Table
+		{
+			UInt64 size; // buckets per way
+			std::vector<Element> buckets;
+			std::vector<UInt64> ppns; // emulated base page of every way
+
+			Element &at(int way, UInt64 pos) { return buckets[way * size + pos]; }
+		};
+
+		/*
+		 * Elastic resizing (Skarlatos et al., ASPLOS 2020): when the load factor is exceeded, the
+		 * current table becomes 'old' and a larger one takes its place. Every insertion then moves
+		 * up to m_rehash_step buckets of the old table (way-major, from 'cursor' on) into the new
+		 * one, so no single insertion pays for the whole rehash. New translations always go to
+		 * 'cur'; a lookup probes 'cur' in every way, and 'old' in the ways whose bucket has not
+		 * been migrated yet.
+		 */
+		struct PageSizeTables
+		{
+			Table cur;
+			Table old;
+			UInt64 cursor;	// buckets of 'old' below this have been migrated
+			UInt64 items;	// occupied buckets in cur plus the unmigrated part of old
+			bool resizing;
+		};
+
+		std::vector<PageSizeTables> m_tables;
+		std::vector<int> m_way_order; // way visiting order of the cuckoo displacement chain
 
-		int *numItems;
 		double loadFactor;
 		int *m_page_table_sizes;
 		int m_ways;
 		float m_scale;
-
-		std::vector<Element> nonResidentEntries;
+		int m_rehash_step;
 
 		struct
 		{
@@ -45,47 +74,40 @@ namespace ParametricDramDirectoryMSI
 			UInt64 cuckoo_hits;
 			UInt64 cuckoo_evictions;
 			UInt64 rehashes;
+			UInt64 migrated_buckets;
 			UInt64 *cuckoo_accesses;
 			UInt64 *cuckoo_hits_per_level;
 		} cuckoo_stats;
 
+		TimeSeriesSink *m_occupancy_series; // load factor and size of every table over time, NULL when disabled
+		UInt64 m_insertions;
+
 		std::ofstream log_file;
 		std::string log_file_name;
 
-		void accessTable(IntPtr address);
+		void makeTable(Table &table, UInt64 size, bool allocate_space = true);
+		bool cuckooInsert(Table &table, Element &element, bool &new_bucket);
+		void place(int page_size_index, Element element);
+		void startResize(int page_size_index);
+		void migrate(int page_size_index, int buckets);
+		void growNow(int page_size_index);
+		void publishOccupancy();
+		bool isMigrated(const PageSizeTables &tables, int way, UInt64 old_pos) const { return way * tables.old.size + old_pos < tables.cursor; }
 
 	public:
 		PageTableCuckoo(int core_id, String name, String type, int page_sizes, int *page_size_list,
-						int *page_table_sizes, double rehash_threshold, float scale, int ways, bool is_guest = false);
+						int *page_table_sizes, double rehash_threshold, float scale, int ways, int rehash_step, bool is_guest = false);
 
-		~PageTableCuckoo()
-		{
-			for (int i = 0; i < m_page_sizes; ++i)
-			{
-				for (int j = 0; j < m_ways; ++j)
-				{
-					delete[] tables[i][j];
-				}
-				delete[] tables[i];
-				delete[] table_ppns[i];
-			}
-			delete[] tables;
-			delete[] table_ppns;
-			delete[] numItems;
-			delete[] m_page_table_sizes;
-		}
+		~PageTableCuckoo();
 
-		PTWResult initializeWalk(IntPtr address, bool count, bool is_prefetch = false, bool restart_walk = false);
-		uint64 hash(uint64 key, int tableIndex);
-		std::tuple<bool, accessedAddresses> insertElement(int page_size_index, Element entry, IntPtr address);
+		void initializeWalk(IntPtr address, bool count, PTWResult &ptw_result, bool is_prefetch = false, bool restart_walk = false);
+		uint64 hash(uint64 key, UInt64 table_size);
 
-		int updatePageTableFrames(IntPtr address, IntPtr core_id, IntPtr ppn, int page_size, std::vector<UInt64> frames);
+		int updatePageTableFrames(IntPtr address, IntPtr core_id, IntPtr ppn, int page_size, std::span<const UInt64> frames);
 
-		IntPtr getPhysicalSpace(int size);
-		bool rehash(int page_size_index, int new_size);
+		IntPtr getPhysicalSpace(UInt64 size);
 		double currentLoadFactor(int page_size_index) const;
 
-		void display() const;
 		void deletePage(IntPtr address);
 	};
 }
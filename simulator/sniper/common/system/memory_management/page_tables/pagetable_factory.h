@@ -4,17 +4,19 @@
 #include "pagetable_radix.h"
 #include "pagetable_hdc.h"
 #include "pagetable_ht.h"
+#include "pagetable_robin_hood.h"
 #include "config.hpp"
 #include "mimicos.h"
+#include <climits>
 
 namespace ParametricDramDirectoryMSI
 {
 	class PageTableFactory
 	{
 	public:
-		static PageTable *createCuckooPageTable(int core_id, String name, String type, int page_sizes, int *page_size_list, int *page_table_sizes, double rehash_threshold, float scale, int ways, bool is_guest)
+		static PageTable *createCuckooPageTable(int core_id, String name, String type, int page_sizes, int *page_size_list, int *page_table_sizes, double rehash_threshold, float scale, int ways, int rehash_step, bool is_guest)
 		{
-			return new PageTableCuckoo(core_id, name, type, page_sizes, page_size_list, page_table_sizes, rehash_threshold, scale, ways, is_guest);
+			return new PageTableCuckoo(core_id, name, type, page_sizes, page_size_list, page_table_sizes, rehash_threshold, scale, ways, rehash_step, is_guest);
 		}
 
 		static PageTable *createRadixPageTable(int app_id, String name, String type, int page_sizes, int *page_size_list, int levels, int frame_size, bool is_guest)
@@ -48,9 +50,14 @@ namespace ParametricDramDirectoryMSI
 			return new PageTableHDC(core_id, name, type, page_sizes, page_size_list, page_table_size_list, is_guest);
 		}
 
-		static PageTable *createHTPageTable(int core_id, String name, String type, int page_sizes, int *page_size_list, int *page_table_size_list, bool is_guest)
+		static PageTable *createHTPageTable(int core_id, String name, String type, int page_sizes, int *page_size_list, int *page_table_size_list, int max_chain_length, bool is_guest)
 		{
-			return new PageTableHT(core_id, name, type, page_sizes, page_size_list, page_table_size_list, is_guest);
+			return new PageTableHT(core_id, name, type, page_sizes, page_size_list, page_table_size_list, max_chain_length, is_guest);
+		}
+
+		static PageTable *createRobinHoodPageTable(int core_id, String name, String type, int page_sizes, int *page_size_list, int *page_table_size_list, int max_probe_distance, float scale, bool is_guest)
+		{
+			return new PageTableRobinHood(core_id, name, type, page_sizes, page_size_list, page_table_size_list, max_probe_distance, scale, is_guest);
 		}
 
 		static PageTable *createPageTable(String type, String name, UInt64 app_id, bool is_guest = false)
@@ -66,6 +73,11 @@ namespace ParametricDramDirectoryMSI
 
 				float scale = Sim()->getCfg()->getFloat("perf_model/" + name + "/scale");
 
+				// Without rehash_step the whole old table is migrated by the insertion that starts the resize
+				int rehash_step = INT_MAX;
+				if (Sim()->getCfg()->hasKey("perf_model/" + name + "/rehash_step"))
+					rehash_step = Sim()->getCfg()->getInt("perf_model/" + name + "/rehash_step");
+
 				int *page_size_list = new int[page_sizes];
 
 				for (int i = 0; i < page_sizes; i++)
@@ -79,7 +91,7 @@ namespace ParametricDramDirectoryMSI
 				{
 					page_table_size_list[i] = Sim()->getCfg()->getIntArray("perf_model/" + name + "/page_table_size_list", i);
 				}
-				return createCuckooPageTable(app_id, name, type, page_sizes, page_size_list, page_table_size_list, rehash_threshold, scale, ways, is_guest);
+				return createCuckooPageTable(app_id, name, type, page_sizes, page_size_list, page_table_size_list, rehash_threshold, scale, ways, rehash_step, is_guest);
 			}
 
 			if (type == "radix")
@@ -143,7 +155,34 @@ namespace ParametricDramDirectoryMSI
 					page_table_size_list[i] = Sim()->getCfg()->getIntArray("perf_model/" + name + "/page_table_size_list", i);
 				}
 
-				return createHTPageTable(app_id, name, type, page_sizes, page_size_list, page_table_size_list, is_guest);
+				int max_chain_length = 0; // no limit
+				if (Sim()->getCfg()->hasKey("perf_model/" + name + "/max_chain_length"))
+					max_chain_length = Sim()->getCfg()->getInt("perf_model/" + name + "/max_chain_length");
+
+				return createHTPageTable(app_id, name, type, page_sizes, page_size_list, page_table_size_list, max_chain_length, is_guest);
+			}
+			else if (type == "robin_hood")
+			{
+
+				int page_sizes = Sim()->getCfg()->getInt("perf_model/" + name + "/page_sizes");
+				int *page_size_list = new int[page_sizes];
+
+				for (int i = 0; i < page_sizes; i++)
+				{
+					page_size_list[i] = Sim()->getCfg()->getIntArray("perf_model/" + name + "/page_size_list", i);
+				}
+
+				int *page_table_size_list = new int[page_sizes];
+
+				for (int i = 0; i < page_sizes; i++)
+				{
+					page_table_size_list[i] = Sim()->getCfg()->getIntArray("perf_model/" + name + "/page_table_size_list", i);
+				}
+
+				int max_probe_distance = Sim()->getCfg()->getInt("perf_model/" + name + "/max_probe_distance");
+				float scale = Sim()->getCfg()->getFloat("perf_model/" + name + "/scale");
+
+				return createRobinHoodPageTable(app_id, name, type, page_sizes, page_size_list, page_table_size_list, max_probe_distance, scale, is_guest);
 			}
 			else
 				assert(0 && "Invalid page table name");
@@ -13,9 +13,9 @@
 #include "simulator.h"
 #include "physical_memory_allocator.h"
 #include "mimicos.h"
+#include "time_series_sink.h"
 
 // #define DEBUG
-// #define LOG_MEAN_STD
 
 namespace ParametricDramDirectoryMSI
 {
@@ -125,31 +125,17 @@ namespace ParametricDramDirectoryMSI
 								&stats.collisions[i]);
 		}
 
-#ifdef LOG_MEAN_STD
-		// If enabled, also prepare vectors/files for logging mean and std dev. 
-		stats.std = new std::vector<double>[m_page_sizes];
-		stats.mean = new std::vector<double>[m_page_sizes];
-
-		std::string std_filename;
-		std::string mean_filename;
+		// Optionally publish the mean and standard deviation of distance_from_root as a time series
+		stats.std = new double[m_page_sizes]();
+		stats.mean = new double[m_page_sizes]();
 
+		std::vector<String> columns;
 		for (int i = 0; i < m_page_sizes; i++)
 		{
-			std_filename = "std_" + std::to_string(m_page_size_list[i]);
-			mean_filename = "mean_" + std::to_string(m_page_size_list[i]);
-
-			String prefix = Sim()->getCfg()->getString("general/output_dir");
-
-			String std_name = prefix + "/" + std_filename.c_str();
-			String mean_name = prefix + "/" + mean_filename.c_str();
-
-			std_file.push_back(std::ofstream(std_name.c_str()));
-			mean_file.push_back(std::ofstream(mean_name.c_str()));
-
-			std::cout << "Created file " << std_name << std::endl;
-			std::cout << "Created file " << mean_name << std::endl;
+			columns.push_back("mean_" + itostr(m_page_size_list[i]));
+			columns.push_back("std_" + itostr(m_page_size_list[i]));
 		}
-#endif
+		m_distance_series = TimeSeriesSink::create(name + ".distance." + itostr(core_id), columns);
 	}
 
 	/*
@@ -164,25 +150,26 @@ namespace ParametricDramDirectoryMSI
 		}
 
 		free(emulated_table_address);
+
+		delete m_distance_series;
+		delete[] stats.std;
+		delete[] stats.mean;
 	}
 
 	/*
 	 * printVectorStatistics():
-	 *   - If using LOG_MEAN_STD, we write the latest standard deviation and mean to the 
-	 *     respective files for each page size.
+	 *   - Publishes the latest mean and standard deviation of every page size to the
+	 *     distance time series; the sink writes them out in the background.
 	 */
 	void PageTableHDC::printVectorStatistics()
 	{
+		std::vector<double> values;
 		for (int i = 0; i < m_page_sizes; i++)
 		{
-			double mean = stats.mean[i].back();
-			double std = stats.std[i].back();
-
-			std_file[i] << std << std::endl;
-			mean_file[i] << mean << std::endl;
+			values.push_back(stats.mean[i]);
+			values.push_back(stats.std[i]);
 		}
-
-		return;
+		m_distance_series->publish(stats.page_faults, values.data());
 	}
 
 	/*
@@ -191,20 +178,21 @@ namespace ParametricDramDirectoryMSI
 	 *     then probe (using linear probing) in the page_tables array to find a matching tag 
 	 *     or empty slot. 
 	 *   - If none of the page sizes yields a valid translation, a page fault is raised.
-	 *   - Returns a PTWResult containing the final page size, visited addresses, PPN, 
+	 *   - Fills ptw_result with the final page size, visited addresses, PPN, 
 	 *     translation latency, and whether a page fault was encountered.
 	 */
-	PTWResult PageTableHDC::initializeWalk(IntPtr address,
-										   bool count,
-										   bool is_prefetch,
+	void PageTableHDC::initializeWalk(IntPtr address,
+									  bool count,
+									  PTWResult &ptw_result,
+									  bool is_prefetch,
 										   bool restart_walk_after_fault)
 	{
 #ifdef DEBUG
 		log_file << std::endl;
 		log_file << "[HDC] Initializing page table walk for address " << address << std::endl;
 #endif
-		accessedAddresses visited_addresses;
-		visited_addresses.reserve(50); // Reserving space for optimization, not mandatory
+		accessedAddresses &visited_addresses = get<1>(ptw_result);
+		visited_addresses.clear();
 
 		bool is_pagefault_in_every_page_size = false;
 		SubsecondTime dummy_time = SubsecondTime::Zero();
@@ -343,12 +331,16 @@ namespace ParametricDramDirectoryMSI
 			if (restart_walk_after_fault)
 				goto restart_walk;
 			else
-				return PTWResult(page_size_result, visited_addresses, ppn, SubsecondTime::Zero(), is_pagefault_in_every_page_size, PF_DUMMY, dummy_time);
+			{
+				setPTWResult(ptw_result, page_size_result, ppn, SubsecondTime::Zero(), is_pagefault_in_every_page_size, PF_DUMMY, dummy_time);
+				return;
+			}
 		}
 
 		if (page_size_result != -1)
 		{
-			return PTWResult(page_size_result, visited_addresses, ppn, SubsecondTime::Zero(), is_pagefault_in_every_page_size, PF_DUMMY, dummy_time);
+			setPTWResult(ptw_result, page_size_result, ppn, SubsecondTime::Zero(), is_pagefault_in_every_page_size, PF_DUMMY, dummy_time);
+			return;
 		}
 
 		// If we somehow get here, there's a logical inconsistency
@@ -372,7 +364,7 @@ namespace ParametricDramDirectoryMSI
 					sum += page_tables[i][j].distance_from_root;
 				}
 			}
-			stats.mean[i].push_back(sum / m_page_table_sizes[i]);
+			stats.mean[i] = sum / m_page_table_sizes[i];
 		}
 	}
 
@@ -385,10 +377,10 @@ namespace ParametricDramDirectoryMSI
 			{
 				if (page_tables[i][j].tag != static_cast<IntPtr>(-1))
 				{
-					sum += pow(page_tables[i][j].distance_from_root - stats.mean[i].back(), 2);
+					sum += pow(page_tables[i][j].distance_from_root - stats.mean[i], 2);
 				}
 			}
-			stats.std[i].push_back(sqrt(sum / m_page_table_sizes[i]));
+			stats.std[i] = sqrt(sum / m_page_table_sizes[i]);
 		}
 	}
 
@@ -403,28 +395,17 @@ namespace ParametricDramDirectoryMSI
 											IntPtr core_id,
 											IntPtr ppn,
 											int page_size,
-											std::vector<UInt64> frames)
+											std::span<const UInt64> frames)
 	{
-#ifdef LOG_MEAN_STD
-		// Every 10K page faults, recalc mean/std and log them
-		if (stats.page_faults % 10000 == 0)
+		// Every 'interval' page faults, recalc mean/std and publish them
+		stats.page_faults++;
+		if (m_distance_series && stats.page_faults % m_distance_series->getInterval() == 0)
 		{
 			calculate_mean();
 			calculate_std();
 
 			printVectorStatistics();
-
-			std::cout << "Heartbeat";
-			std::cout << " Page faults: " << stats.page_faults;
-			for (int i = 0; i < m_page_sizes; i++)
-			{
-				std::cout << " Page size: " << m_page_size_list[i];
-				std::cout << " Mean: " << stats.mean[i].back();
-				std::cout << " Standard deviation: " << stats.std[i].back();
-			}
-			std::cout << std::endl;
 		}
-#endif
 
 #ifdef DEBUG
 		log_file << "[HDC] Updating page table frames for address " 
@@ -6,6 +6,8 @@
 #include <stdint.h>
 #include <vector>
 
+class TimeSeriesSink;
+
 namespace ParametricDramDirectoryMSI
 {
 
@@ -32,12 +34,11 @@ namespace ParametricDramDirectoryMSI
 			UInt64 *num_accesses;
 			UInt64 *collisions;
 			UInt64 page_faults;
-			std::vector<double> *std;
-			std::vector<double> *mean;
+			double *std;  // latest value per page size
+			double *mean; // latest value per page size
 		} stats;
 
-		std::vector<std::ofstream> std_file;
-		std::vector<std::ofstream> mean_file;
+		TimeSeriesSink *m_distance_series; // mean/std of distance_from_root over time, NULL when disabled
 
 		std::ofstream log_file; // Log file for the page table
 		std::string log_file_name;
@@ -47,8 +48,8 @@ namespace ParametricDramDirectoryMSI
 		PageTableHDC(int core_id, String name, String type, int page_sizes, int *page_size_list, int *page_table_sizes, bool is_guest = false);
 		~PageTableHDC();
 
-		PTWResult initializeWalk(IntPtr address, bool count, bool is_prefetch = false, bool restart_walk = false);
-		int updatePageTableFrames(IntPtr address, IntPtr core_id, IntPtr ppn, int page_size, std::vector<UInt64> frames);
+		void initializeWalk(IntPtr address, bool count, PTWResult &ptw_result, bool is_prefetch = false, bool restart_walk = false);
+		int updatePageTableFrames(IntPtr address, IntPtr core_id, IntPtr ppn, int page_size, std::span<const UInt64> frames);
 		void deletePage(IntPtr address);
 
 		void printPageTable();
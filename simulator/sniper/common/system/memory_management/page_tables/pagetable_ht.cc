@@ -24,7 +24,8 @@ namespace ParametricDramDirectoryMSI
      *
      * Each level of the page table (for different page sizes) is implemented as
      * an array of `Entry` objects. A hash function is used to map (tag = VPN >> 3)
-     * into this array. Because of collisions, each Entry supports chaining.
+     * into this array. Because of collisions, each Entry supports chaining: chained
+     * entries come from a contiguous overflow area and are linked by their index in it.
      */
 
     /*
@@ -42,9 +43,10 @@ namespace ParametricDramDirectoryMSI
      * PageTableHT constructor:
      *   - Takes core_id, name, type, page_sizes, etc.
      *   - m_page_table_sizes is an array specifying the hash-table size for each page size.
-     *   - Allocates a separate hash-table array (page_tables) for each page size.
+     *   - m_max_chain_length (0 = no limit) is the chain length, home slot included, beyond which an
+     *     insertion is counted in long_chains. Chains are never cut: walk records spill to the heap.
+     *   - Allocates a separate hash table (page_tables) for each page size, with an empty overflow area.
      *   - Also allocates metrics to track usage (page_table_walks, chained, and num_accesses).
-     *   - The table_pa array is used to store the "physical address" of each page table in memory.
      */
     PageTableHT::PageTableHT(int core_id,
                              String name,
@@ -52,70 +54,51 @@ namespace ParametricDramDirectoryMSI
                              int page_sizes,
                              int *page_size_list,
                              int *page_table_sizes,
+                             int max_chain_length,
                              bool is_guest)
         : PageTable(core_id, name, type, page_sizes, page_size_list, is_guest),
-          m_page_table_sizes(page_table_sizes)
+          page_tables(page_sizes),
+          m_page_table_sizes(page_table_sizes),
+          m_max_chain_length(max_chain_length)
     {
+        LOG_ASSERT_ERROR(m_max_chain_length >= 0, "Hash table max_chain_length must be >= 0, got %d", m_max_chain_length);
+
         std::cout << std::endl;
 
         log_file_name = "pagetable_ht.log";
         log_file_name = std::string(Sim()->getConfig()->getOutputDirectory().c_str()) + "/" + log_file_name;
         log_file.open(log_file_name.c_str());
 
-        // table_pa holds the physical addresses of the page-table base for each page size.
-        table_pa = (IntPtr *)malloc(sizeof(IntPtr) * m_page_sizes);
+        // Each Entry can store data for up to 8 contiguous VPN blocks
+        Entry empty_entry;
+        empty_entry.tag = EMPTY_TAG;
+        empty_entry.valid = 0;
+        empty_entry.next = NO_ENTRY;
+        for (int k = 0; k < 8; k++)
+            empty_entry.ppn[k] = 0;
 
-        // For each page size index, create an array of Entry structures.
-        // Each Entry can store data for up to 8 contiguous VPN blocks,
-        // but collisions are chained via next_entry.
         for (int i = 0; i < m_page_sizes; i++)
         {
-            Entry *page_table = (Entry *)malloc(sizeof(Entry) * m_page_table_sizes[i]);
+            Table &table = page_tables[i];
+            table.slots.assign(m_page_table_sizes[i], empty_entry);
 
-#ifdef DEBUG
-            std::cout << "[Hash Table Chain] Page table size for page size "
-                      << m_page_size_list[i]
-                      << " is "
-                      << (m_page_table_sizes[i]) * sizeof(Entry) / 1024 / 1024 / 1024
-                      << "GB" << std::endl;
-#endif
-
-            // Use the Memory Allocator to carve out space for the page table
-            // handle_page_table_allocations(...) returns the base "emulated" physical address
-            table_pa[i] = Sim()->getMimicOS()->getMemoryAllocator()->handle_page_table_allocations((m_page_table_sizes[i]) * 64);
+            // Use the Memory Allocator to carve out space for the page table (64 bytes per entry)
+            table.base_ppn = getPhysicalSpace((UInt64)m_page_table_sizes[i] * 64);
+            table.free_list = NO_ENTRY;
 
 #ifdef DEBUG
-            std::cout << "[Hash Table Chain] Page table address for page size "
+            std::cout << "[Hash Table Chain] Page table for page size "
                       << m_page_size_list[i]
-                      << " is " << table_pa[i] << std::endl;
+                      << " has " << m_page_table_sizes[i] << " entries at ppn " << table.base_ppn << std::endl;
 #endif
-
-            // Initialize each entry in the array to default values
-            for (int j = 0; j < m_page_table_sizes[i]; j++)
-            {
-                page_table[j].tag = -1;          // Indicates empty
-                page_table[j].next_entry = NULL; // No chain initially
-
-                for (int k = 0; k < 8; k++)
-                {
-                    page_table[j].valid[k] = false;
-                    page_table[j].ppn[k] = 0; // Physical page number array is zeroed
-                }
-
-                // Each table entry also has an "emulated_physical_address",
-                // which references the hardware location of this entry (64 bytes per entry).
-                page_table[j].emulated_physical_address = (table_pa[i] + j * 64);
-            }
-
-            // Push this newly created page_table array into our page_tables vector
-            page_tables.push_back(page_table);
-
-            // Allocate memory for tracking stats for each page size
-            stats.page_table_walks = new uint64[m_page_sizes];
-            stats.chained = new uint64[m_page_sizes];
-            stats.num_accesses = new uint64[m_page_sizes];
         }
 
+        // Allocate memory for tracking stats for each page size
+        stats.page_table_walks = new uint64[m_page_sizes]();
+        stats.chained = new uint64[m_page_sizes]();
+        stats.num_accesses = new uint64[m_page_sizes]();
+        stats.long_chains = new uint64[m_page_sizes]();
+
         // Register stats metrics for each page size
         for (int i = 0; i < m_page_sizes; i++)
         {
@@ -134,6 +117,11 @@ namespace ParametricDramDirectoryMSI
                                 ("accesses_" + std::to_string(m_page_size_list[i])).c_str(),
                                 &stats.num_accesses[i]);
 
+            registerStatsMetric(name,
+                                core_id,
+                                ("long_chains_" + std::to_string(m_page_size_list[i])).c_str(),
+                                &stats.long_chains[i]);
+
             // table_chained_ is probably a duplicate stat for the same data
             registerStatsMetric(name,
                                 core_id,
@@ -144,17 +132,58 @@ namespace ParametricDramDirectoryMSI
 
     /*
      * PageTableHT destructor:
-     *   - Frees the allocated memory for each page_table array
-     *   - Also frees the table_pa array
+     *   - The tables free themselves, only the stats arrays are left
      */
     PageTableHT::~PageTableHT()
     {
-        for (int i = 0; i < m_page_sizes; i++)
+        delete[] stats.page_table_walks;
+        delete[] stats.chained;
+        delete[] stats.num_accesses;
+        delete[] stats.long_chains;
+    }
+
+    /*
+     * getPhysicalSpace(...)
+     *   - Asks the memory allocator for 'size' bytes of the kernel region, returns the first page.
+     */
+    IntPtr PageTableHT::getPhysicalSpace(UInt64 size)
+    {
+        return Sim()->getMimicOS()->getMemoryAllocator()->handle_page_table_allocations(size);
+    }
+
+    /*
+     * allocateOverflowEntry(...)
+     *   - Returns the index of an unused entry of the overflow area.
+     *   - The area grows one page (OVERFLOW_CHUNK_ENTRIES entries) at a time. Entries are only
+     *     referred to by index, so growing the host vector does not invalidate any chain.
+     */
+    UInt32 PageTableHT::allocateOverflowEntry(Table &table)
+    {
+        if (table.free_list == NO_ENTRY)
         {
-            free(page_tables[i]);
+            UInt32 first = table.overflow.size();
+            LOG_ASSERT_ERROR((UInt64)first + OVERFLOW_CHUNK_ENTRIES < NO_ENTRY, "Hash table overflow area is full");
+
+            table.overflow_ppn.push_back(getPhysicalSpace(OVERFLOW_CHUNK_ENTRIES * 64));
+            table.overflow.resize(first + OVERFLOW_CHUNK_ENTRIES);
+
+            // Thread the new entries onto the free list, lowest index first
+            for (UInt32 index = first + OVERFLOW_CHUNK_ENTRIES; index-- > first;)
+                freeOverflowEntry(table, index);
         }
 
-        free(table_pa);
+        UInt32 index = table.free_list;
+        table.free_list = table.overflow[index].next;
+        return index;
+    }
+
+    void PageTableHT::freeOverflowEntry(Table &table, UInt32 index)
+    {
+        Entry &entry = table.overflow[index];
+        entry.tag = EMPTY_TAG;
+        entry.valid = 0;
+        entry.next = table.free_list;
+        table.free_list = index;
     }
 
     /*
@@ -170,20 +199,22 @@ namespace ParametricDramDirectoryMSI
      * initializeWalk(...)
      *   - This method implements the main page-table lookup procedure for an address.
      *   - We try each page_size in m_page_size_list, compute the VPN, then the "tag" and "block_offset."
-     *   - Use hashFunction(...) to find the candidate slot in the page_tables array for this page size.
-     *   - If the matching slot is empty or invalid, we move on. If it's a chain, we follow next_entry.
+     *   - Use hashFunction(...) to find the home slot in the table for this page size, then follow
+     *     the chain through the overflow area until the tag is found or the chain ends.
+     *   - Every entry we read is recorded in visited_addresses.
      *   - If none of the page sizes yields a valid translation, we have a page fault.
      *
-     *   The function returns a PTWResult, indicating (page_size, visited_addresses, ppn, walk_latency,
+     *   The function fills ptw_result, indicating (page_size, visited_addresses, ppn, walk_latency,
      *   caused_page_fault).
      */
-    PTWResult PageTableHT::initializeWalk(IntPtr address, bool count, bool is_prefetch, bool restart_walk_after_fault)
+    void PageTableHT::initializeWalk(IntPtr address, bool count, PTWResult &ptw_result, bool is_prefetch, bool restart_walk_after_fault)
     {
 #ifdef DEBUG
         log_file << std::endl;
         log_file << "[Hash Table Chain] Initializing page table walk for address " << address << std::endl;
 #endif
-        accessedAddresses visited_addresses;
+        accessedAddresses &visited_addresses = get<1>(ptw_result);
+        visited_addresses.clear();
 
         int page_size_result = -1;
         IntPtr ppn_result = 0;
@@ -200,13 +231,15 @@ namespace ParametricDramDirectoryMSI
         // For each page size, attempt to find a match in the hash table
         for (int i = 0; i < m_page_sizes; i++)
         {
+            const Table &table = page_tables[i];
             IntPtr VPN = address >> (m_page_size_list[i]);
             IntPtr tag = VPN >> 3;         // The upper bits after removing block_offset
             IntPtr block_offset = VPN % 8; // The lower 3 bits in the VPN
             uint64_t hash_function_result = hashFunction(tag, m_page_table_sizes[i]);
 
             // Start at the hashed entry
-            Entry *current_entry = &page_tables[i][hash_function_result];
+            const Entry *current_entry = &table.slots[hash_function_result];
+            IntPtr entry_address = slotAddress(table, hash_function_result);
 
             int counter = 0; // Tracks how many chain steps we've taken
 
@@ -219,131 +252,47 @@ namespace ParametricDramDirectoryMSI
                      << " and hash function result " << hash_function_result << std::endl;
 #endif
 
-            // Continue following the chain until we find a match, find an empty entry, or run out of chain
+            // Continue following the chain until we find the tag or run out of chain
             while (true)
             {
-                if (current_entry == NULL)
-                {
-                    // This theoretically shouldn't occur unless the memory structure is malformed
-                    assert(false);
-                    break;
-                }
+                bool hit = current_entry->tag == tag && (current_entry->valid & (1 << block_offset));
+
+                visited_addresses.push_back(make_tuple(i,
+                                                       counter,
+                                                       entry_address + block_offset * 8,
+                                                       hit));
+                if (count)
+                    stats.num_accesses[i]++;
+
                 // If the entry matches the tag and the relevant offset is valid => we have a PPN
-                else if (current_entry->tag == tag && current_entry->valid[block_offset])
+                if (hit)
                 {
 #ifdef DEBUG
-                    log_file << "[Hash Table Chain] Hit with valid entry for page size "
-                             << m_page_size_list[i]
-                             << " with VPN " << VPN
-                             << " and tag " << tag
-                             << " and block offset " << block_offset
-                             << " and hash function result " << hash_function_result << std::endl;
-                    log_file << "[Hash Table Chain] PPN: " << current_entry->ppn[block_offset]
+                    log_file << "[Hash Table Chain] Hit at chain position " << counter
+                             << " with PPN: " << current_entry->ppn[block_offset]
                              << " and emulated page table physical address: "
-                             << current_entry->emulated_physical_address * 4096 + block_offset * 8 << std::endl;
+                             << entry_address + block_offset * 8 << std::endl;
 #endif
-                    visited_addresses.push_back(make_tuple(i,
-                                                           counter,
-                                                           current_entry->emulated_physical_address * 4096 + block_offset * 8,
-                                                           true));
-                    if (count)
-                        stats.num_accesses[i]++;
-
                     page_size_result = m_page_size_list[i];
                     ppn_result = current_entry->ppn[block_offset];
                     break;
                 }
                 // If the entry’s tag matches but the offset is not valid => not mapped
-                else if (current_entry->tag == tag && !current_entry->valid[block_offset])
+                // A tag appears at most once in a chain, so we are done as well at the end of the chain
+                else if (current_entry->tag == tag || current_entry->next == NO_ENTRY)
                 {
 #ifdef DEBUG
-                    log_file << "[Hash Table Chain] Hit with invalid entry for page size "
-                             << m_page_size_list[i]
-                             << " with VPN " << VPN
-                             << " and tag " << tag
-                             << " and block offset " << block_offset
-                             << " and hash function result " << hash_function_result << std::endl;
-                    log_file << "[Hash Table Chain] Validity vector: ";
-                    for (int k = 0; k < 8; k++)
-                    {
-                        log_file << current_entry->valid[k] << " ";
-                    }
-                    log_file << std::endl;
-#endif
-                    visited_addresses.push_back(make_tuple(i,
-                                                           counter,
-                                                           current_entry->emulated_physical_address * 4096 + block_offset * 8,
-                                                           false));
-                    if (count)
-                        stats.num_accesses[i]++;
-                    break;
-                }
-                // If the entry is completely empty (tag == -1), we are done searching for this page size
-                else if (current_entry->tag == static_cast<IntPtr>(-1))
-                {
-#ifdef DEBUG
-                    log_file << "[Hash Table Chain] Empty entry for page size "
-                             << m_page_size_list[i]
-                             << " with VPN " << VPN
-                             << " and tag " << tag
-                             << " and block offset " << block_offset
-                             << " and hash function result " << hash_function_result << std::endl;
-#endif
-                    visited_addresses.push_back(make_tuple(i,
-                                                           counter,
-                                                           current_entry->emulated_physical_address * 4096 + block_offset * 8,
-                                                           false));
-                    if (count)
-                        stats.num_accesses[i]++;
-
-                    // If this is not chained further, break out; otherwise, continue to the next entry
-                    if (current_entry->next_entry == NULL)
-                    {
-                        break;
-                    }
-                    else
-                    {
-                        current_entry = current_entry->next_entry;
-                        counter++;
-                    }
-                }
-                // If next_entry is not null, then we move forward in the chain
-                else if (current_entry->next_entry != NULL)
-                {
-#ifdef DEBUG
-                    log_file << "[Hash Table Chain] Chained entry for page size "
-                             << m_page_size_list[i]
-                             << " with VPN " << VPN
-                             << " and tag " << tag
-                             << " and block offset " << block_offset
-                             << " and hash function result " << hash_function_result << std::endl;
-#endif
-                    visited_addresses.push_back(make_tuple(i,
-                                                           counter,
-                                                           current_entry->emulated_physical_address * 4096 + block_offset * 8,
-                                                           false));
-                    if (count)
-                        stats.num_accesses[i]++;
-                    current_entry = current_entry->next_entry;
-                    counter++;
-                }
-                // End of chain
-                else if (current_entry->next_entry == NULL)
-                {
-#ifdef DEBUG
-                    log_file << "[Hash Table Chain] End of chain for page size "
-                             << m_page_size_list[i]
-                             << " with VPN " << VPN
-                             << " and tag " << tag
-                             << " and block offset " << block_offset
-                             << " and hash function result " << hash_function_result << std::endl;
+                    log_file << "[Hash Table Chain] Miss at chain position " << counter
+                             << " for page size " << m_page_size_list[i] << std::endl;
 #endif
                     break;
                 }
+                // Otherwise, we move forward in the chain
                 else
                 {
-                    // Fallback catch for unexpected conditions
-                    assert(false);
+                    entry_address = overflowAddress(table, current_entry->next);
+                    current_entry = &table.overflow[current_entry->next];
+                    counter++;
                 }
             }
         }
@@ -369,7 +318,10 @@ namespace ParametricDramDirectoryMSI
             if (restart_walk_after_fault)
                 goto restart_walk;
             else
-                return PTWResult(page_size_result, visited_addresses, ppn_result, SubsecondTime::Zero(), total_page_fault, PF_DUMMY, SubsecondTime::Zero());
+            {
+                setPTWResult(ptw_result, page_size_result, ppn_result, SubsecondTime::Zero(), total_page_fault, PF_DUMMY, SubsecondTime::Zero());
+                return;
+            }
         }
 
 #ifdef DEBUG
@@ -379,7 +331,7 @@ namespace ParametricDramDirectoryMSI
 #endif
 
         // Return results: (page_size_found, visited_entries, final PPN, latency=Zero, page_fault?)
-        return PTWResult(page_size_result, visited_addresses, ppn_result, SubsecondTime::Zero(), total_page_fault, PF_DUMMY, SubsecondTime::Zero());
+        setPTWResult(ptw_result, page_size_result, ppn_result, SubsecondTime::Zero(), total_page_fault, PF_DUMMY, SubsecondTime::Zero());
     }
 
     /*
@@ -400,15 +352,15 @@ namespace ParametricDramDirectoryMSI
      * updatePageTableFrames(...)
      *   - Updates or inserts a new mapping for the given (address -> ppn) at the relevant page_size.
      *   - We identify the correct hash table with page_size_index, compute a hash on (VPN >> 3),
-     *     and walk the chain. If we find a match with an unused offset, we mark it valid.
-     *     Otherwise, we allocate a new chained Entry.
+     *     and walk the chain. If we find the tag, we set the offset there.
+     *     Otherwise, we append an entry from the overflow area to the chain.
      *   - frames is not used in this function but might store intermediate steps in advanced usage.
      */
     int PageTableHT::updatePageTableFrames(IntPtr address,
                                            IntPtr core_id,
                                            IntPtr ppn,
                                            int page_size,
-                                           std::vector<UInt64> frames)
+                                           std::span<const UInt64> frames)
     {
 #ifdef DEBUG
         log_file << std::endl;
@@ -428,98 +380,95 @@ namespace ParametricDramDirectoryMSI
             }
         }
 
+        Table &table = page_tables[page_size_index];
+
         // Extract the VPN bits from the virtual address
         IntPtr VPN = address >> (m_page_size_list[page_size_index]);
         IntPtr tag = VPN >> 3;
         IntPtr block_offset = VPN % 8;
 
-        // Use the hash function to find the correct slot in the page_tables array
+        // Use the hash function to find the correct slot in the table
         uint64_t hash_function_result = hashFunction(tag, m_page_table_sizes[page_size_index]);
 
-        Entry *current_entry = &page_tables[page_size_index][hash_function_result];
-        int counter = 0;
+        Entry *current_entry = &table.slots[hash_function_result];
 
-        while (true)
+        // If the home slot is empty (tag == -1), fill it in
+        if (current_entry->tag == EMPTY_TAG)
         {
-            // If the slot is empty (tag == -1), fill it in
-            if (current_entry->tag == static_cast<IntPtr>(-1))
-            {
-                current_entry->tag = tag;
-                current_entry->ppn[block_offset] = ppn;
-
-                // Mark all offsets invalid initially, then mark the relevant offset as valid
-                for (int i = 0; i < 8; i++)
-                    current_entry->valid[i] = false;
-
-                current_entry->valid[block_offset] = true;
-                current_entry->next_entry = NULL;
+            current_entry->tag = tag;
+            current_entry->valid = 1 << block_offset;
+            current_entry->ppn[block_offset] = ppn;
 
 #ifdef DEBUG
-                log_file << "[Hash Table Chain] Inserted entry at index: "
-                         << hash_function_result
-                         << " with tag: " << tag
-                         << " at offset: " << block_offset
-                         << "with page size" << page_size << std::endl;
+            log_file << "[Hash Table Chain] Inserted entry at index: "
+                     << hash_function_result
+                     << " with tag: " << tag
+                     << " at offset: " << block_offset
+                     << " with page size " << page_size << std::endl;
 #endif
-                break;
-            }
-            // If the current entry has the same tag but the offset is not valid, we enable that offset
-            else if (current_entry->tag == tag && !current_entry->valid[block_offset])
+            return 0;
+        }
+
+        // Walk the chain, remembering the last entry (NO_ENTRY stands for the home slot)
+        UInt32 last = NO_ENTRY;
+        int chain_length = 1;
+        while (true)
+        {
+            // If the current entry has the same tag, we enable that offset
+            if (current_entry->tag == tag)
             {
-                current_entry->valid[block_offset] = true;
+                current_entry->valid |= 1 << block_offset;
                 current_entry->ppn[block_offset] = ppn;
 #ifdef DEBUG
-                log_file << "[Hash Table Chain] Updated entry at index: "
-                         << hash_function_result
-                         << " with tag: " << tag
+                log_file << "[Hash Table Chain] Updated entry with tag: " << tag
                          << " at offset: " << block_offset << std::endl;
 #endif
-                break;
+                return 0;
             }
-            // If the current entry is in use and next_entry == NULL,
-            // we allocate a new entry and chain it.
-            else if (current_entry->next_entry == NULL)
-            {
-                Entry *new_entry = (Entry *)malloc(sizeof(Entry));
-                new_entry->tag = tag;
-                new_entry->ppn[block_offset] = ppn;
+            if (current_entry->next == NO_ENTRY)
+                break;
+
+            // Move further down the chain to find a suitable slot
+            last = current_entry->next;
+            current_entry = &table.overflow[last];
+            chain_length++;
+        }
 
-                for (int i = 0; i < 8; i++)
-                    new_entry->valid[i] = false;
+        if (m_max_chain_length && chain_length >= m_max_chain_length)
+            stats.long_chains[page_size_index]++;
 
-                new_entry->valid[block_offset] = true;
-                new_entry->next_entry = NULL;
-                new_entry->emulated_physical_address = Sim()->getMimicOS()->getMemoryAllocator()->handle_fine_grained_page_table_allocations(64);
+        // The tag is not in the chain: append a new entry from the overflow area.
+        // Allocating may grow the overflow area, so current_entry is not used anymore.
+        UInt32 index = allocateOverflowEntry(table);
+        Entry &new_entry = table.overflow[index];
+        new_entry.tag = tag;
+        new_entry.valid = 1 << block_offset;
+        new_entry.ppn[block_offset] = ppn;
+        new_entry.next = NO_ENTRY;
 
-                current_entry->next_entry = new_entry;
+        if (last == NO_ENTRY)
+            table.slots[hash_function_result].next = index;
+        else
+            table.overflow[last].next = index;
 
-                // Increment the "chain" statistic
-                stats.chained[page_size_index]++;
+        // Increment the "chain" statistic
+        stats.chained[page_size_index]++;
 
 #ifdef DEBUG
-                log_file << "[Hash Table Chain] Inserted new entry at index: "
-                         << hash_function_result
-                         << " with tag: " << tag
-                         << " at offset: " << block_offset << std::endl;
-                log_file << "[Hash Table Chain] New entry emulated physical address: "
-                         << new_entry->emulated_physical_address << std::endl;
+        log_file << "[Hash Table Chain] Inserted new entry at index: "
+                 << hash_function_result
+                 << " with tag: " << tag
+                 << " at offset: " << block_offset << std::endl;
+        log_file << "[Hash Table Chain] New entry emulated physical address: "
+                 << overflowAddress(table, index) << std::endl;
 #endif
-                break;
-            }
-            else
-            {
-                // Move further down the chain to find a suitable slot
-                current_entry = current_entry->next_entry;
-                counter++;
-            }
-        }
 
         return 0;
     }
 
     /*
      * printPageTable()
-     *   - Iterates over each page table array in page_tables and prints out
+     *   - Iterates over each page table in page_tables and prints out
      *     the tag, valid bits, and PPNs for debugging or analysis.
      */
     void PageTableHT::printPageTable()
@@ -529,16 +478,14 @@ namespace ParametricDramDirectoryMSI
             cout << "Page table for page size " << m_page_size_list[i] << endl;
             for (int j = 0; j < m_page_table_sizes[i]; j++)
             {
+                const Entry &entry = page_tables[i].slots[j];
                 cout << "Entry " << j << ": " << endl;
-                cout << "Tag: " << page_tables[i][j].tag << endl;
-                cout << "Empty: " << page_tables[i][j].valid[0]
-                     << page_tables[i][j].valid[1]
-                     << page_tables[i][j].valid[2]
-                     << page_tables[i][j].valid[3] << endl;
-                cout << "PPN: " << page_tables[i][j].ppn[0]
-                     << page_tables[i][j].ppn[1]
-                     << page_tables[i][j].ppn[2]
-                     << page_tables[i][j].ppn[3] << endl;
+                cout << "Tag: " << entry.tag << endl;
+                cout << "Valid: " << std::hex << (int)entry.valid << std::dec << endl;
+                cout << "PPN: " << entry.ppn[0]
+                     << entry.ppn[1]
+                     << entry.ppn[2]
+                     << entry.ppn[3] << endl;
             }
         }
     }
@@ -547,16 +494,17 @@ namespace ParametricDramDirectoryMSI
      * deletePage(...)
      *   - Removes or invalidates the page entry for the given address in the base page table
      *     (index 0 in m_page_size_list). If after clearing the block_offset,
-     *     the entry has no valid offsets, we remove the entire entry from the chain.
+     *     the entry has no valid offsets, we remove the entire entry from the chain
+     *     and return it to the free list of the overflow area.
      */
     void PageTableHT::deletePage(IntPtr address)
     {
+        Table &table = page_tables[0];
         IntPtr VPN = address >> (m_page_size_list[0]);
         IntPtr tag = VPN >> 3;
         IntPtr block_offset = VPN % 8;
 
         uint64_t hash_function_result = hashFunction(tag, m_page_table_sizes[0]);
-        Entry *current_entry = &page_tables[0][hash_function_result];
 
 #ifdef DEBUG
         std::cout << "Deleting page at address: " << address
@@ -566,67 +514,45 @@ namespace ParametricDramDirectoryMSI
                   << " at index: " << hash_function_result << std::endl;
 #endif
 
-        while (true)
+        // link points to the 'next' field that refers to the current overflow entry
+        Entry *current_entry = &table.slots[hash_function_result];
+        UInt32 *link = NULL;
+        while (current_entry->tag != tag)
         {
-#ifdef DEBUG
-            std::cout << "Current entry tag: "
-                      << current_entry->tag
-                      << " and tag to delete: " << tag
-                      << " at offset " << block_offset << std::endl;
-#endif
-            // If the current entry has the same tag, we invalidate the block_offset
-            if (current_entry->tag == tag)
-            {
-                current_entry->valid[block_offset] = false;
-                current_entry->ppn[block_offset] = 0;
+            if (current_entry->next == NO_ENTRY)
+                return;
+            link = &current_entry->next;
+            current_entry = &table.overflow[*link];
+        }
 
-                // If all offsets are invalid, remove or repurpose the entry
-                for (int i = 0; i < 8; i++)
-                {
-                    if (current_entry->valid[i])
-                    {
-                        break; // Found a valid offset, so we keep this entry
-                    }
-                    else if (i == 7)
-                    {
-                        // If we got here, none of the offsets in this entry are valid
-                        current_entry->tag = -1;
-
-                        // If there's a chained entry behind this one, copy it forward
-                        if (current_entry->next_entry != NULL)
-                        {
-                            Entry *temp = current_entry->next_entry;
-                            current_entry->tag = temp->tag;
-                            current_entry->next_entry = temp->next_entry;
-                            current_entry->emulated_physical_address = temp->emulated_physical_address;
-                            for (int j = 0; j < 8; j++)
-                            {
-                                current_entry->ppn[j] = temp->ppn[j];
-                                current_entry->valid[j] = temp->valid[j];
-                            }
-                            free(temp);
-                        }
-                    }
-                }
-                break;
-            }
-            // If entry is empty, there is no further data to remove
-            else if (current_entry->tag == static_cast<IntPtr>(-1))
+        current_entry->valid &= ~(1 << block_offset);
+        current_entry->ppn[block_offset] = 0;
+
+        // If some offsets are still valid, we keep this entry
+        if (current_entry->valid)
+            return;
+
+        if (link == NULL)
+        {
+            // The home slot: if there's a chained entry behind this one, copy it forward
+            UInt32 next = current_entry->next;
+            if (next == NO_ENTRY)
             {
-                if (current_entry->next_entry == NULL)
-                    break;
-                else
-                    current_entry = current_entry->next_entry;
+                current_entry->tag = EMPTY_TAG;
             }
-            // If this entry doesn't match the tag, try the chain
-            else if (current_entry->tag != tag)
+            else
             {
-                if (current_entry->next_entry == NULL)
-                    break;
-                else
-                    current_entry = current_entry->next_entry;
+                *current_entry = table.overflow[next];
+                freeOverflowEntry(table, next);
             }
         }
+        else
+        {
+            // An overflow entry: unlink it from the chain
+            UInt32 index = *link;
+            *link = current_entry->next;
+            freeOverflowEntry(table, index);
+        }
     }
 
 } // namespace ParametricDramDirectoryMSI
@@ -12,43 +12,62 @@ namespace ParametricDramDirectoryMSI
 	{
 
 	private:
+		static const IntPtr EMPTY_TAG = ~(IntPtr)0;
+		static const UInt32 NO_ENTRY = ~(UInt32)0;
+		static const UInt32 OVERFLOW_CHUNK_ENTRIES = 64; // one 4KB page of 64-byte entries
+
 		struct Entry
 		{
 			IntPtr tag;
 			IntPtr ppn[8];
-			bool valid[8];
-			Entry *next_entry;
-			IntPtr emulated_physical_address;
-			int distance_from_root;
+			UInt8 valid; // one bit per block offset
+			UInt32 next; // index of the next entry of the chain in the overflow area, NO_ENTRY at the end
 		};
 
-		int extra_pages;
+		// The hash table of one page size: the home slots are indexed by the hash of the tag, collisions
+		// are chained through entries of the overflow area. Both are contiguous and linked by index,
+		// and both live in emulated memory taken from the kernel region of the allocator.
+		struct Table
+		{
+			std::vector<Entry> slots;
+			IntPtr base_ppn;
+			std::vector<Entry> overflow;
+			std::vector<IntPtr> overflow_ppn; // emulated page of every OVERFLOW_CHUNK_ENTRIES overflow entries
+			UInt32 free_list;				  // first unused overflow entry, linked through next
+		};
 
-		std::vector<Entry *> page_tables;
-		IntPtr *table_pa;
+		std::vector<Table> page_tables;
 		int *m_page_table_sizes;
+		int m_max_chain_length; // entries of a chain, home slot included, counted as long beyond it (0 = no limit)
 
 		struct Stats
 		{
 			UInt64 *page_table_walks;
 			UInt64 *chained;
 			UInt64 *num_accesses;
-			UInt64 *table_matches;
-			UInt64 first_hit;
+			UInt64 *long_chains; // insertions that grew a chain past m_max_chain_length
 		} stats;
 
 		std::ofstream log_file;
 		std::string log_file_name;
 
+		IntPtr slotAddress(const Table &table, UInt64 index) const { return table.base_ppn * 4096 + index * 64; }
+		IntPtr overflowAddress(const Table &table, UInt32 index) const
+		{
+			return table.overflow_ppn[index / OVERFLOW_CHUNK_ENTRIES] * 4096 + (index % OVERFLOW_CHUNK_ENTRIES) * 64;
+		}
+		UInt32 allocateOverflowEntry(Table &table);
+		void freeOverflowEntry(Table &table, UInt32 index);
+
 	public:
-		PageTableHT(int core_id, String name, String type, int page_sizes, int *page_size_list, int *page_table_sizes, bool is_guest = false);
+		PageTableHT(int core_id, String name, String type, int page_sizes, int *page_size_list, int *page_table_sizes, int max_chain_length, bool is_guest = false);
 		~PageTableHT();
 
 		UInt64 hashFunction(IntPtr address, int table_size);
-		IntPtr getPhysicalSpace(int size);
+		IntPtr getPhysicalSpace(UInt64 size);
 
-		PTWResult initializeWalk(IntPtr address, bool count, bool is_prefetch = false, bool restart_walk = false);
-		int updatePageTableFrames(IntPtr address, IntPtr core_id, IntPtr ppn, int page_size, std::vector<UInt64> frames);
+		void initializeWalk(IntPtr address, bool count, PTWResult &ptw_result, bool is_prefetch = false, bool restart_walk = false);
+		int updatePageTableFrames(IntPtr address, IntPtr core_id, IntPtr ppn, int page_size, std::span<const UInt64> frames);
 		void deletePage(IntPtr address);
 
 		void calculate_mean();
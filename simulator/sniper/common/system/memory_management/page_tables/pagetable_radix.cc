@@ -4,13 +4,15 @@
 #include "physical_memory_allocator.h"
 #include "mimicos.h"
 #include "site_clock.h"
+#include "translation_trace.h"
+#include "performance_model.h"
 
 // #define DEBUG
 // #define SAMPLE_DEBUG
 namespace ParametricDramDirectoryMSI
 {
 
-	std::shared_mutex &PageTableRadix::get_lock_for_page(IntPtr address) {
+	PageTableLock &PageTableRadix::get_lock_for_page(IntPtr address) {
 		IntPtr page_number = address >> 12; // For 4KB pages
 		return m_page_locks[page_number % NUM_PAGE_LOCKS];
 	}
@@ -29,9 +31,12 @@ namespace ParametricDramDirectoryMSI
 
 	PageTableRadix::PageTableRadix(int core_id, String name, String type, int page_sizes, int *page_size_list, int levels, int frame_size, bool is_guest)
 		: PageTable(core_id, name, type, page_sizes, page_size_list, is_guest),
+		  m_page_locks(NUM_PAGE_LOCKS),
+		  m_slabs(MAX_SLABS, NULL),
+		  m_num_frames(0),
+		  m_dma_finish(NUM_DMA_FINISH_SHARDS),
 		  m_frame_size(frame_size),
-		  levels(levels),
-          m_page_locks(NUM_PAGE_LOCKS)
+		  levels(levels)
 	{
 
 		log_file = std::ofstream();
@@ -57,9 +62,6 @@ namespace ParametricDramDirectoryMSI
 			registerStatsMetric(name, core_id, "page_size_discovery_" + itostr(i), &stats.page_size_discovery[i]);
 		}
 
-		root = (PTFrame *)malloc(sizeof(PTFrame));
-		root->entries = (PTEntry *)malloc(sizeof(PTEntry) * m_frame_size);
-
 		// @hsongara: Get the OS object
 		MimicOS* os;
 		if (is_guest)
@@ -67,16 +69,172 @@ namespace ParametricDramDirectoryMSI
 		else
 			os = Sim()->getMimicOS();
 
-		root->emulated_ppn = os->getMemoryAllocator()->handle_page_table_allocations(4096);
+		root = allocateFrame(os->getMemoryAllocator()->handle_page_table_allocations(4096), false);
 #ifdef DEBUG
 		log_file << "Root frame: " << root << std::endl;
 #endif
+	}
 
-		for (int i = 0; i < m_frame_size; i++)
+	PageTableRadix::~PageTableRadix()
+	{
+		for (UInt32 i = 0; i < MAX_SLABS && m_slabs[i] != NULL; i++)
 		{
-			root->entries[i].is_pte = false;
-			root->entries[i].data.next_level = NULL;
+			delete[] m_slabs[i]->entries;
+			delete m_slabs[i];
 		}
+		delete[] stats.page_size_discovery;
+	}
+
+	/**
+	 * @brief Allocates a page table frame from the slab pool and clears its entries.
+	 *
+	 * @param emulated_ppn The emulated physical page that backs the frame.
+	 * @param is_leaf_level Whether the entries of the frame are PTEs (last level of the radix tree).
+	 * @return FrameId The id of the new frame.
+	 */
+	PageTableRadix::FrameId PageTableRadix::allocateFrame(IntPtr emulated_ppn, bool is_leaf_level)
+	{
+		std::lock_guard<std::mutex> lock(m_frame_pool_lock);
+
+		FrameId frame = m_num_frames.load(std::memory_order_relaxed);
+		UInt32 slab = frame / FRAMES_PER_SLAB;
+		LOG_ASSERT_ERROR(slab < MAX_SLABS, "Radix page table ran out of frame slabs (%u frames)", frame);
+
+		if (m_slabs[slab] == NULL)
+		{
+			PTSlab *new_slab = new PTSlab;
+			new_slab->entries = new PTEntry[(UInt64)FRAMES_PER_SLAB * m_frame_size];
+			m_slabs[slab] = new_slab;
+		}
+
+		m_slabs[slab]->emulated_ppn[frame % FRAMES_PER_SLAB] = emulated_ppn;
+		std::fill_n(frameEntries(frame), m_frame_size, is_leaf_level ? PTE_LEAF : (PTEntry)0);
+
+		m_num_frames.store(frame + 1, std::memory_order_release);
+		return frame;
+	}
+
+	SubsecondTime PageTableRadix::getDMAFinish(const PTEntry *entry)
+	{
+		if (!(loadPTE(entry) & PTE_DMA))
+			return SubsecondTime::Zero();
+
+		DMAFinishShard &shard = dmaFinishShard(entry);
+		while (true)
+		{
+			UInt32 sequence = shard.lock.readBegin();
+			UInt64 finish = 0;
+			for (int slot = 0; slot < DMA_FINISH_SLOTS && !finish; slot++)
+			{
+				if (shard.entry[slot].load(std::memory_order_relaxed) == entry)
+					finish = shard.finish[slot].load(std::memory_order_relaxed);
+			}
+			bool overflow = shard.num_overflow.load(std::memory_order_relaxed) > 0;
+			if (shard.lock.readRetry(sequence))
+				continue;
+			if (finish || !overflow)
+				return SubsecondTime::FS(finish);
+			break;
+		}
+
+		// Slow path: the DMA was recorded while every slot of the shard was in use
+		std::lock_guard<PageTableLock> lock(shard.lock);
+		auto it = shard.overflow.find(entry);
+		return it == shard.overflow.end() ? SubsecondTime::Zero() : SubsecondTime::FS(it->second);
+	}
+
+	/*
+	 * reclaimDMAFinish(...) => frees the records of a shard whose finish time every core that is not idle
+	 * has passed: from then on no walk can be charged for them. Called with the shard's lock held.
+	 */
+	void PageTableRadix::reclaimDMAFinish(DMAFinishShard &shard)
+	{
+		SubsecondTime horizon = SubsecondTime::MaxTime();
+		for (UInt32 core_id = 0; core_id < Sim()->getConfig()->getApplicationCores(); core_id++)
+		{
+			Core *core = Sim()->getCoreManager()->getCoreFromID(core_id);
+			if (core && core->getState() != Core::IDLE)
+				horizon = std::min(horizon, core->getPerformanceModel()->getElapsedTime());
+		}
+
+		// The entries belong to pages whose lock we do not hold, so their PTE_DMA bit is cleared atomically.
+		// A writer of such a page may still set it again, which only costs its walks a lookup.
+		for (int slot = 0; slot < DMA_FINISH_SLOTS; slot++)
+		{
+			const PTEntry *entry = shard.entry[slot].load(std::memory_order_relaxed);
+			if (entry != NULL && SubsecondTime::FS(shard.finish[slot].load(std::memory_order_relaxed)) <= horizon)
+			{
+				__atomic_fetch_and(const_cast<PTEntry *>(entry), ~PTE_DMA, __ATOMIC_RELEASE);
+				shard.entry[slot].store(NULL, std::memory_order_relaxed);
+			}
+		}
+		for (auto it = shard.overflow.begin(); it != shard.overflow.end();)
+		{
+			if (SubsecondTime::FS(it->second) <= horizon)
+			{
+				__atomic_fetch_and(const_cast<PTEntry *>(it->first), ~PTE_DMA, __ATOMIC_RELEASE);
+				it = shard.overflow.erase(it);
+			}
+			else
+				++it;
+		}
+	}
+
+	// Called with the page's lock held
+	void PageTableRadix::setDMAFinish(PTEntry *entry, subsecond_time_t finish_time)
+	{
+		DMAFinishShard &shard = dmaFinishShard(entry);
+		std::lock_guard<PageTableLock> lock(shard.lock);
+
+		// Take the entry's own slot, or a free one once its previous record (if any) is gone
+		int target = -1;
+		for (int slot = 0; slot < DMA_FINISH_SLOTS && target < 0; slot++)
+			if (shard.entry[slot].load(std::memory_order_relaxed) == entry)
+				target = slot;
+		if (target < 0)
+		{
+			shard.overflow.erase(entry);
+			for (int attempt = 0; attempt < 2 && target < 0; attempt++)
+			{
+				// Only when every slot is taken are the finished DMAs looked for
+				if (attempt)
+					reclaimDMAFinish(shard);
+				for (int slot = 0; slot < DMA_FINISH_SLOTS && target < 0; slot++)
+					if (shard.entry[slot].load(std::memory_order_relaxed) == NULL)
+						target = slot;
+			}
+		}
+
+		UInt64 finish = SubsecondTime(finish_time).getFS();
+		if (target >= 0)
+		{
+			shard.finish[target].store(finish, std::memory_order_relaxed);
+			shard.entry[target].store(entry, std::memory_order_relaxed);
+		}
+		else
+			shard.overflow[entry] = finish;
+		shard.num_overflow.store(shard.overflow.size(), std::memory_order_relaxed);
+
+		storePTE(entry, *entry | PTE_DMA);
+	}
+
+	// Called with the page's lock held
+	void PageTableRadix::clearDMAFinish(PTEntry *entry)
+	{
+		if (!(*entry & PTE_DMA))
+			return;
+
+		DMAFinishShard &shard = dmaFinishShard(entry);
+		std::lock_guard<PageTableLock> lock(shard.lock);
+		for (int slot = 0; slot < DMA_FINISH_SLOTS; slot++)
+		{
+			if (shard.entry[slot].load(std::memory_order_relaxed) == entry)
+				shard.entry[slot].store(NULL, std::memory_order_relaxed);
+		}
+		shard.overflow.erase(entry);
+		shard.num_overflow.store(shard.overflow.size(), std::memory_order_relaxed);
+
+		storePTE(entry, *entry & ~PTE_DMA);
 	}
 
 	/**
@@ -84,11 +242,11 @@ namespace ParametricDramDirectoryMSI
 	 *
 	 * @param address The virtual address to walk.
 	 * @param count Boolean indicating if the walk should be counted in the statistics.
+	 * @param ptw_result Filled with the result of the page table walk.
 	 * @param is_prefetch Boolean indicating if this is a prefetch operation.
-	 * @return PTWResult The result of the page table walk.
 	 */
 
-	PTWResult PageTableRadix::initializeWalk(IntPtr address, bool count, bool is_prefetch, bool restart_walk_after_fault)
+	void PageTableRadix::initializeWalk(IntPtr address, bool count, PTWResult &ptw_result, bool is_prefetch, bool restart_walk_after_fault)
 	{
 
 #ifdef DEBUG
@@ -113,8 +271,9 @@ namespace ParametricDramDirectoryMSI
 		bool is_pagefault = false;
 		AllocatedPage page_fault_result; // Stores the result of the page fault handling IF a page fault occurs
 
-		accessedAddresses visited_pts; // In cases of page faults, we replay the walk but we DO NOT RESET the visited_pts as the
-									   // execution time will be dominated by the page fault latency anyways
+		accessedAddresses &visited_pts = get<1>(ptw_result); // In cases of page faults, we replay the walk but we DO NOT RESET the visited_pts as the
+															 // execution time will be dominated by the page fault latency anyways
+		visited_pts.clear();
 
 		// Time --------------------------------------------------------------------------------------------------->
 		// L2 TLB Miss -> initializeWalk -> handlePageFault() -> restart_walk (label) -> return PTW Result
@@ -123,16 +282,18 @@ namespace ParametricDramDirectoryMSI
 
 		bool fault_detected = false;
 		pageFaultType fault_type_result = PF_WITHOUT_FAULT;
-		std::shared_mutex &page_lock = get_lock_for_page(address);
+		PageTableLock &page_lock = get_lock_for_page(address);
 
-		// Acquire shared lock to protect page table traversal from concurrent
-		// modifications (page_moving, DMA_move_page, deletePage, etc.)
-		page_lock.lock_shared();
+		// The walk takes no lock: it snapshots the sequence of the page's lock shard and, before acting on
+		// what it read, checks that no writer (page_moving, DMA_move_page, deletePage, ...) got in between.
+		// Frames are never freed, so a racing walk reads stale entries at worst and is simply replayed.
+		UInt32 sequence = page_lock.readBegin();
+		size_t walk_start = visited_pts.size();
 
 		IntPtr offset = (address >> 39) & 0x1FF;
 
 		// Start the walk from the root
-		PTFrame *current_frame = root;
+		FrameId current_frame = root;
 
 #ifdef DEBUG
 		log_file << "[RADIX] Accessing PT address: " << address << " at level: " << levels << " with offset: " << offset << std::endl;
@@ -155,31 +316,38 @@ namespace ParametricDramDirectoryMSI
 #ifdef DEBUG
 			log_file << "[RADIX] Accessing PT address: " << current_frame << " at level: " << level << " with offset: " << offset << std::endl;
 #endif
-			visited_pts.push_back(std::make_tuple(i, counter, (IntPtr)(current_frame->emulated_ppn * 4096 + offset * 8), current_frame->entries[offset].is_pte && current_frame->entries[offset].data.translation.valid));
+			PTEntry *entry = &frameEntries(current_frame)[offset];
+			PTEntry pte = loadPTE(entry);
+			visited_pts.push_back(std::make_tuple(i, counter, (IntPtr)(frameEmulatedPPN(current_frame) * 4096 + offset * 8), pteIsLeaf(pte) && pteIsPresent(pte)));
 
 #ifdef DEBUG
-			log_file << "[RADIX] Pushed in visited: " << i << " " << counter << " " << (IntPtr)(current_frame->emulated_ppn * 4096 + offset * 8) << " " << (current_frame->entries[offset].is_pte && current_frame->entries[offset].data.translation.valid) << std::endl;
+			log_file << "[RADIX] Pushed in visited: " << i << " " << counter << " " << (IntPtr)(frameEmulatedPPN(current_frame) * 4096 + offset * 8) << " " << (pteIsLeaf(pte) && pteIsPresent(pte)) << std::endl;
 #endif
-			if (current_frame->entries[offset].is_pte)
+			if (pteIsLeaf(pte))
 			{
 
 				// The entry is not valid, we need to handle a page fault
-				if (current_frame->entries[offset].data.translation.valid == false)
+				if (!pteIsPresent(pte))
 				{
+					// Sampled before readRetry(), so the entry it was looked up for is still the page's leaf
+					SubsecondTime dma_finish = getDMAFinish(entry);
+					if (page_lock.readRetry(sequence))
+					{
+						visited_pts.erase(visited_pts.begin() + walk_start, visited_pts.end());
+						goto restart_walk;
+					}
 					is_pagefault = true;
 					if (count) {
 						stats.page_faults++;
 					}
 
-					if (current_frame->entries[offset].permission == MOVING) {
+					if (pte & PTE_MOVING) {
 						// This is a special page fault of moving page
 						// Note: page_faults_of_migration is counted at the MMU layer
 						// only when DMA_finish > current simulation time
-						page_lock.unlock_shared();
-						return PTWResult(page_size_result, visited_pts, ppn_result, pwc_latency, is_pagefault, PF_MOVING, current_frame->entries[offset].DMA_finish);
+						setPTWResult(ptw_result, page_size_result, ppn_result, pwc_latency, is_pagefault, PF_MOVING, dma_finish);
+						return;
 					}
-					// Release shared lock before handling page fault (may need write lock)
-					page_lock.unlock_shared();
 					if (restart_walk_after_fault)
 						os->handle_page_fault(address, core_id, getMaxLevel());
 
@@ -190,19 +358,22 @@ namespace ParametricDramDirectoryMSI
 					if (restart_walk_after_fault)
 						goto restart_walk;
 					else
-						return PTWResult(page_size_result, visited_pts, ppn_result, pwc_latency, is_pagefault, PF_PTE_PRESENT, current_frame->entries[offset].DMA_finish);
+					{
+						setPTWResult(ptw_result, page_size_result, ppn_result, pwc_latency, is_pagefault, PF_PTE_PRESENT, dma_finish);
+						return;
+					}
 				}
 				// We found the entry, we can return the result
 
 				if (count)
 					stats.page_size_discovery[level - 1]++;
 #ifdef DEBUG
-				log_file << "[RADIX] Found translation for address: " << address << " with ppn: " << current_frame->entries[offset].data.translation.ppn << " at level: " << level << " with page size: " << m_page_size_list[level - 1] << std::endl;
+				log_file << "[RADIX] Found translation for address: " << address << " with ppn: " << ptePayload(pte) << " at level: " << level << " with page size: " << m_page_size_list[level - 1] << std::endl;
 #endif
 				// @kanellok: Be careful with the return values -> always return PPN_RESULT at page size granularity
-				ppn_result = current_frame->entries[offset].data.translation.ppn;
+				ppn_result = ptePayload(pte);
 				page_size_result = m_page_size_list[level - 1]; // If we hit at level 1 (last one), we return the page_size[1-1] = page_size[0] = 4KB
-				wait_latency = current_frame->entries[offset].DMA_finish;
+				wait_latency = getDMAFinish(entry);
 				break;
 			}
 			else
@@ -212,13 +383,16 @@ namespace ParametricDramDirectoryMSI
 #endif
 				// The entry was a pointer to the next level of the page table
 				// We need to chase the pointer -> if the next level is NULL, we need to handle a page fault
-				if (current_frame->entries[offset].data.next_level == NULL)
+				if (ptePayload(pte) == 0)
 				{
 #ifdef DEBUG
 					log_file << "[RADIX] Next level is NULL, we need to allocate a new frame" << std::endl;
 #endif
-					// Release shared lock before handling page fault (may need write lock)
-					page_lock.unlock_shared();
+					if (page_lock.readRetry(sequence))
+					{
+						visited_pts.erase(visited_pts.begin() + walk_start, visited_pts.end());
+						goto restart_walk;
+					}
 					if (restart_walk_after_fault)
 						os->handle_page_fault(address, core_id, getMaxLevel());
 
@@ -232,11 +406,14 @@ namespace ParametricDramDirectoryMSI
 					if (restart_walk_after_fault)
 						goto restart_walk;
 					else
-						return PTWResult(page_size_result, visited_pts, ppn_result, pwc_latency, is_pagefault, PF_PTE_PRESENT, current_frame->entries[offset].DMA_finish);
+					{
+						setPTWResult(ptw_result, page_size_result, ppn_result, pwc_latency, is_pagefault, PF_PTE_PRESENT, SubsecondTime::Zero());
+						return;
+					}
 				}
 				else
 				{
-					current_frame = current_frame->entries[offset].data.next_level;
+					current_frame = nextLevel(pte);
 				}
 			}
 
@@ -246,8 +423,11 @@ namespace ParametricDramDirectoryMSI
 			counter++;
 		}
 
-		// Release shared lock after walk completes
-		page_lock.unlock_shared();
+		if (page_lock.readRetry(sequence))
+		{
+			visited_pts.erase(visited_pts.begin() + walk_start, visited_pts.end());
+			goto restart_walk;
+		}
 
 #ifdef DEBUG
 		log_file << "[RADIX] Finished walk for address: " << address << std::endl;
@@ -256,10 +436,10 @@ namespace ParametricDramDirectoryMSI
 		log_file << "[RADIX] --------------------------------------------" << std::endl;
 #endif
 
-		return PTWResult(page_size_result, visited_pts, ppn_result, pwc_latency, is_pagefault, PF_WITHOUT_FAULT, wait_latency);
+		setPTWResult(ptw_result, page_size_result, ppn_result, pwc_latency, is_pagefault, PF_WITHOUT_FAULT, wait_latency);
 	}
 
-	int PageTableRadix::updatePageTableFrames(IntPtr address, IntPtr core_id, IntPtr ppn, int page_size, std::vector<UInt64> frames)
+	int PageTableRadix::updatePageTableFrames(IntPtr address, IntPtr core_id, IntPtr ppn, int page_size, std::span<const UInt64> frames)
 	{
 // #ifdef DEBUG
 // 		log_file << "[RADIX] I was provided with the following frames: " << std::endl;
@@ -268,11 +448,10 @@ namespace ParametricDramDirectoryMSI
 // 			log_file << "[RADIX] Frame: " << frames[i] << std::endl;
 // 		}
 // #endif
-		PTFrame *current_frame = root;
-		PTFrame *previous_frame = NULL;
+		FrameId current_frame = root;
+		PTEntry *previous_entry = NULL; // Entry of the previous level that points to current_frame
 
 		IntPtr offset = (address >> 39) & 0x1FF;
-		IntPtr previous_offset = static_cast<IntPtr>(-1);
 
 		int level = levels;
 		int counter = 0;
@@ -282,8 +461,6 @@ namespace ParametricDramDirectoryMSI
 		log_file << "[RADIX] Updating page table frames for address: " << address << " with ppn: " << ppn << " and page size: " << page_size << std::endl;
 #endif
 
-		accessedAddresses pagefault_addresses;
-
 		// Walk the page table to the last level and update the page table frames which are not yet allocated
 		int frames_used = 0;
 
@@ -297,47 +474,43 @@ namespace ParametricDramDirectoryMSI
 			log_file << "[RADIX] Accessing: " << current_frame << " at level: " << level << " with offset: " << offset << std::endl;
 #endif
 
-			if (current_frame == NULL)
+			if (current_frame == NO_FRAME)
 			{
 #ifdef DEBUG
 				log_file << "[RADIX] Current frame is NULL, we need to allocate a new frame" << std::endl;
 
 #endif
-
-				PTFrame *new_pt_frame = new PTFrame;
+				bool is_pte = level == 1 ? true : false;
+				FrameId new_frame = allocateFrame(frames[frames_used], is_pte);
 				stats.allocated_frames++;
-
-				new_pt_frame->entries = new PTEntry[m_frame_size];
-				new_pt_frame->emulated_ppn = frames[frames_used];
 				frames_used++;
-				current_frame = new_pt_frame;
 #ifdef DEBUG
-				log_file << "[RADIX] New frame allocated: " << current_frame << " with ppn: " << frames[counter] << std::endl;
-				log_file << "[RADIX] Previous frame: " << previous_frame << " at offset" << previous_offset << " is updated with the new frame: " << current_frame << std::endl;
+				log_file << "[RADIX] New frame allocated: " << current_frame << " with ppn: " << frameEmulatedPPN(current_frame) << std::endl;
+				log_file << "[RADIX] Previous entry: " << previous_entry << " is updated with the new frame: " << current_frame << std::endl;
 
 #endif
-				previous_frame->entries[previous_offset].data.next_level = current_frame;
-
-				bool is_pte = level == 1 ? true : false;
-				for (int i = 0; i < m_frame_size; i++)
-				{
-
-					new_pt_frame->entries[i].is_pte = is_pte;
-					new_pt_frame->entries[i].data.next_level = NULL;
-				}
+				// The frame is fully initialized before it is linked, so concurrent walkers never see a partial frame.
+				// Faults on different pages hold different lock shards and may race to link the same
+				// directory entry: the loser continues below the winner's frame (its own frame stays unused).
+				PTEntry expected = loadPTE(previous_entry);
+				PTEntry desired = pteWithPayload(expected, (IntPtr)new_frame + 1);
+				if (ptePayload(expected) == 0 && __atomic_compare_exchange_n(previous_entry, &expected, desired, false, __ATOMIC_RELEASE, __ATOMIC_ACQUIRE))
+					current_frame = new_frame;
+				else
+					current_frame = nextLevel(expected);
 			}
 			else
 			{
+				PTEntry *entry = &frameEntries(current_frame)[offset];
 
 				// Allocate a new page table
-				if (page_size == 21 && level == 2)
+				if ((page_size == 21 && level == 2) || (page_size == 12 && level == 1))
 				{
 #ifdef DEBUG
 					log_file << "[RADIX] Let's update the PTE: " << current_frame << " with ppn: " << ppn << " at level: " << level << " with page size: " << page_size << std::endl;
 #endif
-					current_frame->entries[offset].data.translation.valid = true;
-					current_frame->entries[offset].data.translation.ppn = ppn;
-					current_frame->entries[offset].is_pte = true;
+					clearDMAFinish(entry);
+					storePTE(entry, pteWithPayload(PTE_LEAF | PTE_PRESENT, ppn));
 
 					// SITE: Set expiration time at page allocation
 					{
@@ -347,36 +520,17 @@ namespace ParametricDramDirectoryMSI
 						IntPtr vpn = address >> page_size;
 						setSiteExpiration(vpn, exp_time);
 					}
+					TTRACE(TranslationTrace::currentCore(), TranslationTrace::PT_INSERT, SubsecondTime::Zero(), address, ppn, SubsecondTime::Zero(), level, page_size);
 
 					break;
 				}
-				else if (page_size == 12 && level == 1)
-				{
 
-#ifdef DEBUG
-					log_file << "[RADIX] Let's update the PTE: " << current_frame << " with ppn: " << ppn << " at level: " << level << " with page size: " << page_size << std::endl;
-#endif
-					current_frame->entries[offset].data.translation.valid = true;
-					current_frame->entries[offset].data.translation.ppn = ppn;
-
-					// SITE: Set expiration time at page allocation
-					{
-						SiteLogicalClock* clk = SiteLogicalClock::getInstance();
-						UInt32 cur_time = clk->getGlobalTime();
-						UInt32 exp_time = cur_time + clk->getCurrentLease();
-						IntPtr vpn = address >> page_size;
-						setSiteExpiration(vpn, exp_time);
-					}
-
-					break;
-				}
-
-				previous_frame = current_frame;
-				current_frame = current_frame->entries[offset].data.next_level;
+				previous_entry = entry;
+				PTEntry pte = loadPTE(entry);
+				current_frame = ptePayload(pte) == 0 ? NO_FRAME : nextLevel(pte);
 #ifdef DEBUG
 				log_file << "[RADIX] Let's jump to the next level: " << current_frame << std::endl;
 #endif
-				previous_offset = offset;
 				level--;
 				counter++;
 			}
@@ -384,156 +538,101 @@ namespace ParametricDramDirectoryMSI
 		return frames_used;
 	}
 
+	/**
+	 * @brief Walks the radix tree down to the leaf entry that maps the given address.
+	 *
+	 * @param address The virtual address.
+	 * @param level Set to the level of the leaf entry (which determines the page size).
+	 * @return PTEntry* The leaf entry, or NULL if the address is not backed by a leaf.
+	 */
+	PageTableRadix::PTEntry *PageTableRadix::findLeafEntry(IntPtr address, int &level)
+	{
+		FrameId current_frame = root;
+		level = levels;
+
+		while (level > 0)
+		{
+			IntPtr offset = (address >> (48 - 9 * (levels - level + 1))) & 0x1FF;
+			PTEntry *entry = &frameEntries(current_frame)[offset];
+			PTEntry pte = loadPTE(entry);
+
+			if (pteIsLeaf(pte))
+				return entry;
+
+			// Move to the next level of the page table
+			if (ptePayload(pte) == 0) // Should not happen for an already mapped page
+				return NULL;
+			current_frame = nextLevel(pte);
+			level--;
+		}
+		return NULL;
+	}
+
 	void PageTableRadix::deletePage(IntPtr address)
 	{
-		std::unique_lock<std::shared_mutex> lock(get_lock_for_page(address));
+		std::lock_guard<PageTableLock> lock(get_lock_for_page(address));
 
 #ifdef DEBUG
 		log_file << "[RADIX] Deleting page that corresponds to address: " << address << std::endl;
 #endif
-		PTFrame *current_frame = root;
-		IntPtr offset = (address >> 39) & 0x1FF;
+		int level;
+		PTEntry *entry = findLeafEntry(address, level);
+		if (entry == NULL)
+			return;
 
-		int level = levels;
-		int counter = 0;
-
-		while (level > 0)
-		{
-			offset = (address >> (48 - 9 * (levels - level + 1))) & 0x1FF;
-
-			if (current_frame->entries[offset].is_pte)
-			{
 #ifdef DEBUG
-				log_file << "[RADIX] Found the PTE for address: " << address << " at level: " << level << " with offset: " << offset << std::endl;
+		log_file << "[RADIX] Found the PTE for address: " << address << " at level: " << level << std::endl;
 #endif
-				current_frame->entries[offset].data.translation.valid = false;
-				current_frame->entries[offset].data.translation.ppn = -1;
-
-				// SITE: Clear ETT entry when page is freed/invalidated
-				{
-					int page_size_bits = m_page_size_list[level - 1];
-					IntPtr vpn = address >> page_size_bits;
-					clearSiteETTEntry(vpn);
-				}
+		clearDMAFinish(entry);
+		storePTE(entry, pteWithPayload(*entry & ~PTE_PRESENT, 0));
 
-				break;
-			}
-			else
-			{
-				// Move to the next level of the page table
-				current_frame = current_frame->entries[offset].data.next_level;
-			}
-			level--;
-			counter++;
+		// SITE: Clear ETT entry when page is freed/invalidated
+		{
+			int page_size_bits = m_page_size_list[level - 1];
+			IntPtr vpn = address >> page_size_bits;
+			clearSiteETTEntry(vpn);
 		}
 	}
 
 	void PageTableRadix::page_moving(IntPtr address)
 	{
-		std::unique_lock<std::shared_mutex> lock(get_lock_for_page(address));
+		std::lock_guard<PageTableLock> lock(get_lock_for_page(address));
 #ifdef DEBUG
 		log_file << "[RADIX] Unmapping page that corresponds to address: " << address << std::endl;
 #endif
-		PTFrame *current_frame = root;
-		IntPtr offset = (address >> 39) & 0x1FF;
-
-		int level = levels;
-		int counter = 0;
+		int level;
+		PTEntry *entry = findLeafEntry(address, level);
+		if (entry == NULL)
+			return;
 
-		while (level > 0)
-		{
-			offset = (address >> (48 - 9 * (levels - level + 1))) & 0x1FF;
-
-			if (current_frame->entries[offset].is_pte)
-			{
 #ifdef DEBUG
-				log_file << "[RADIX] Found the PTE for address: " << address << " at level: " << level << " with offset: " << offset << std::endl;
+		log_file << "[RADIX] Found the PTE for address: " << address << " at level: " << level << std::endl;
 #endif
-				// We don't change the PPN, as the physical page should be protect.
-				current_frame->entries[offset].data.translation.valid = false;
-
-				current_frame->entries[offset].permission = MOVING;
-				break;
-			}
-			else
-			{
-				// Move to the next level of the page table
-				current_frame = current_frame->entries[offset].data.next_level;
-				if (current_frame == NULL) // Should not happen for an already mapped page
-					break;
-			}
-			level--;
-			counter++;
-		}
+		// We don't change the PPN, as the physical page should be protect.
+		storePTE(entry, (*entry & ~PTE_PRESENT) | PTE_MOVING);
 	}
 
 
 	void PageTableRadix::DMA_move_page(IntPtr address, IntPtr new_ppn, subsecond_time_t finish_time)
 	{
-		std::unique_lock<std::shared_mutex> lock(get_lock_for_page(address));
-		PTFrame *current_frame = root;
-		IntPtr offset = (address >> 39) & 0x1FF;
-
-		int level = levels;
-		int counter = 0;
-
-		while (level > 0)
-		{
-			offset = (address >> (48 - 9 * (levels - level + 1))) & 0x1FF;
-
-			if (current_frame->entries[offset].is_pte)
-			{
-				// Update PPN to the new physical page after migration
-				current_frame->entries[offset].data.translation.ppn = new_ppn;
-				current_frame->entries[offset].DMA_finish = finish_time;
-				current_frame->entries[offset].permission = READ_WRITE;
-				current_frame->entries[offset].data.translation.valid = true;
-				break;
-			}
-			else
-			{
-				// Move to the next level of the page table
-				current_frame = current_frame->entries[offset].data.next_level;
-				if (current_frame == NULL) // Should not happen for an already mapped page
-					break;
-			}
-			level--;
-			counter++;
-		}
+		std::lock_guard<PageTableLock> lock(get_lock_for_page(address));
+		int level;
+		PTEntry *entry = findLeafEntry(address, level);
+		if (entry == NULL)
+			return;
+
+		// Update PPN to the new physical page after migration
+		setDMAFinish(entry, finish_time);
+		storePTE(entry, pteWithPayload((*entry & ~PTE_MOVING) | PTE_PRESENT, new_ppn));
 	}
 
 	bool PageTableRadix::check_page_exist(IntPtr address) {
 #ifdef DEBUG
 		log_file << "[RADIX] check if the page exist that corresponds to address: " << address << std::endl;
 #endif
-		PTFrame *current_frame = root;
-		IntPtr offset = (address >> 39) & 0x1FF;
-
-		int level = levels;
-		int counter = 0;
-
-		while (level > 0)
-		{
-			offset = (address >> (48 - 9 * (levels - level + 1))) & 0x1FF;
-
-			if (current_frame->entries[offset].is_pte)
-			{
-
-				if (current_frame->entries[offset].data.translation.valid == true)
-					return true;
-				else
-					return false;
-			}
-			else
-			{
-				// Move to the next level of the page table
-				current_frame = current_frame->entries[offset].data.next_level;
-				if (current_frame == NULL) // Should not happen for an already mapped page
-					return false;
-			}
-			level--;
-			counter++;
-		}
+		int level;
+		PTEntry *entry = findLeafEntry(address, level);
+		return entry != NULL && pteIsPresent(loadPTE(entry));
 	}
 
 
@@ -4,6 +4,8 @@
 #include "site_clock.h"
 #include <shared_mutex>
 #include <unordered_map>
+#include <atomic>
+#include <mutex>
 
 namespace ParametricDramDirectoryMSI
 {
@@ -12,45 +14,80 @@ namespace ParametricDramDirectoryMSI
 	{
 
 	private:
-		struct PTFrame;
-		std::vector<std::shared_mutex> m_page_locks;
-		static const int NUM_PAGE_LOCKS = 256;
-		enum page_permission {
-			READ_WRITE,
-			MOVING
-		};
-
-		struct PTE
-		{
-			bool valid; // Valid bit
-			IntPtr ppn; // Physical page number
-		};
-
-		struct PTEntry
+		// Writers lock the shard of the 4KB page they modify; walks only read the shard's sequence counter
+		std::vector<PageTableLock> m_page_locks;
+		static const int NUM_PAGE_LOCKS = 1024;
+
+		// Packed 8-byte page table entry, laid out like the modeled hardware entry:
+		//   bit 0      : present (the translation is valid)
+		//   bit 1      : leaf (the entry is a PTE instead of a pointer to the next level)
+		//   bit 2      : moving (the page is being migrated, accesses fault until the DMA completes)
+		//   bit 3      : the entry may have a DMA finish time in m_dma_finish
+		//   bits 12-63 : PPN for leaf entries, (frame id + 1) of the next level otherwise (0 = not allocated)
+		typedef UInt64 PTEntry;
+		static const PTEntry PTE_PRESENT = 1ULL << 0;
+		static const PTEntry PTE_LEAF = 1ULL << 1;
+		static const PTEntry PTE_MOVING = 1ULL << 2;
+		static const PTEntry PTE_DMA = 1ULL << 3;
+		static const int PTE_PAYLOAD_SHIFT = 12;
+		static const PTEntry PTE_FLAGS_MASK = (1ULL << PTE_PAYLOAD_SHIFT) - 1;
+
+		static bool pteIsLeaf(PTEntry e) { return e & PTE_LEAF; }
+		static bool pteIsPresent(PTEntry e) { return e & PTE_PRESENT; }
+		static IntPtr ptePayload(PTEntry e) { return e >> PTE_PAYLOAD_SHIFT; }
+		static PTEntry pteWithPayload(PTEntry e, IntPtr payload) { return (e & PTE_FLAGS_MASK) | ((PTEntry)payload << PTE_PAYLOAD_SHIFT); }
+
+		// Entries are read by lock-free walkers while writers update them, so every access is a single
+		// 8-byte atomic access. Acquire/release orders a newly linked frame's contents before its pointer.
+		static PTEntry loadPTE(const PTEntry *e) { return __atomic_load_n(e, __ATOMIC_ACQUIRE); }
+		static void storePTE(PTEntry *e, PTEntry value) { __atomic_store_n(e, value, __ATOMIC_RELEASE); }
+
+		// Frames are carved out of large slabs instead of being malloc'ed one by one, so that
+		// the host-side page table stays dense. A frame is identified by its index in the pool.
+		typedef UInt32 FrameId;
+		static const FrameId NO_FRAME = static_cast<FrameId>(-1);
+		static const UInt32 FRAMES_PER_SLAB = 512;
+		static const UInt32 MAX_SLABS = 16384;
+
+		struct PTSlab
 		{
-			bool is_pte; // Whether the entry is a PTE or a pointer to the next level of the page table
-			page_permission permission;
-			subsecond_time_t DMA_finish;
-			union
-			{
-				PTE translation;
-				PTFrame *next_level;
-			} data; // Stores whether the entry is a PTE or a pointer to the next level of the page table
-			PTEntry() {
-				permission = READ_WRITE;
-				DMA_finish = SubsecondTime::Zero();
-			}
+			PTEntry *entries;					  // FRAMES_PER_SLAB frames of m_frame_size entries each
+			IntPtr emulated_ppn[FRAMES_PER_SLAB]; // Address of each frame in the physical memory (this is emulated)
 		};
 
-		struct PTFrame
+		std::vector<PTSlab *> m_slabs; // Sized to MAX_SLABS up front and never resized, so walkers can index it without locking
+		std::atomic<UInt32> m_num_frames;
+		std::mutex m_frame_pool_lock; // Serializes frame allocation across concurrent page faults
+
+		FrameId allocateFrame(IntPtr emulated_ppn, bool is_leaf_level);
+		PTEntry *frameEntries(FrameId frame) { return m_slabs[frame / FRAMES_PER_SLAB]->entries + (UInt64)(frame % FRAMES_PER_SLAB) * m_frame_size; }
+		IntPtr frameEmulatedPPN(FrameId frame) { return m_slabs[frame / FRAMES_PER_SLAB]->emulated_ppn[frame % FRAMES_PER_SLAB]; }
+		FrameId nextLevel(PTEntry e) { return (FrameId)ptePayload(e) - 1; }
+		PTEntry *findLeafEntry(IntPtr address, int &level);
+
+		// DMA finish times are only needed while pages migrate, so they live in a side table keyed by the leaf
+		// entry (every 4KB address under a large page shares it). Each shard has a few slots that walks read
+		// under the shard's sequence counter, and an overflow map behind its lock for when every slot holds a
+		// DMA that some core may still have to wait for. A record is only dropped once all cores are past its
+		// finish time, so the table holds the migrations in flight rather than every migration of the run.
+		static const int NUM_DMA_FINISH_SHARDS = 1024;
+		static const int DMA_FINISH_SLOTS = 4;
+		struct DMAFinishShard
 		{
-			PTEntry *entries;	 // 512 entries, 4KB page table frames
-			IntPtr emulated_ppn; // Address of the frame in the physical memory (this is emulated)
+			PageTableLock lock;										  // writers hold it, readers check its sequence
+			std::atomic<const PTEntry *> entry[DMA_FINISH_SLOTS]; // NULL for a free slot
+			std::atomic<UInt64> finish[DMA_FINISH_SLOTS];		  // in fs
+			std::atomic<UInt32> num_overflow{0};
+			std::unordered_map<const PTEntry *, UInt64> overflow;
 		};
-
-		typedef struct PTFrame PT;
-
-		PT *root;		  // Root of the radix tree
+		std::vector<DMAFinishShard> m_dma_finish;
+		DMAFinishShard &dmaFinishShard(const PTEntry *entry) { return m_dma_finish[((uintptr_t)entry / sizeof(PTEntry)) % NUM_DMA_FINISH_SHARDS]; }
+		SubsecondTime getDMAFinish(const PTEntry *entry);
+		void setDMAFinish(PTEntry *entry, subsecond_time_t finish_time);
+		void clearDMAFinish(PTEntry *entry);
+		void reclaimDMAFinish(DMAFinishShard &shard);
+
+		FrameId root;	  // Root of the radix tree
 		int m_frame_size; // Size of the frame in bytes
 		int levels;		  // Number of levels in the radix tree
 
@@ -72,15 +109,16 @@ namespace ParametricDramDirectoryMSI
 
 	public:
 		PageTableRadix(int core_id, String name, String type, int page_sizes, int *page_size_list, int levels, int frame_size, bool is_guest = false);
-		PTWResult initializeWalk(IntPtr address, bool count, bool is_prefetch = false, bool restart_walk = false);
-		int updatePageTableFrames(IntPtr address, IntPtr core_id, IntPtr ppn, int page_size, std::vector<UInt64> frames);
+		~PageTableRadix();
+		void initializeWalk(IntPtr address, bool count, PTWResult &ptw_result, bool is_prefetch = false, bool restart_walk = false);
+		int updatePageTableFrames(IntPtr address, IntPtr core_id, IntPtr ppn, int page_size, std::span<const UInt64> frames);
 		void deletePage(IntPtr address);
 		void page_moving(IntPtr address) override;
 		void DMA_move_page(IntPtr address, IntPtr new_ppn, subsecond_time_t finish_time) override;
 		IntPtr getPhysicalSpace(int size);
 		String getType() { return "radix"; };
 		int getMaxLevel() { return levels; };
-		std::shared_mutex& get_lock_for_page(IntPtr address) override;
+		PageTableLock& get_lock_for_page(IntPtr address) override;
 		bool check_page_exist(IntPtr address) override;
 		void incrementPageFaultsOfMigration() override { stats.page_faults_of_migration++; }
 
@@ -99,31 +137,15 @@ namespace ParametricDramDirectoryMSI
 		};
 
 		/**
-		 * @brief Get (or create with defaults) the SITE ETT entry for a given VPN.
+		 * @brief Get the SITE ETT entry for a given VPN (a default entry if there is none).
 		 * Returns a copy to avoid dangling reference under concurrent access.
-		 * Uses shared_lock for read path, upgrades to unique_lock only on miss.
 		 */
 		SiteETTEntry getSiteETTEntry(IntPtr vpn)
 		{
-			// Fast path: read-only lookup under shared lock
-			{
-				std::shared_lock<std::shared_mutex> rlock(site_ett_mutex);
-				auto it = site_ett.find(vpn);
-				if (it != site_ett.end()) {
-					return it->second;
-				}
-			}
-			// Slow path: insert default entry under exclusive lock
-			{
-				std::unique_lock<std::shared_mutex> wlock(site_ett_mutex);
-				// Double-check after acquiring write lock
-				auto it = site_ett.find(vpn);
-				if (it != site_ett.end()) {
-					return it->second;
-				}
-				site_ett[vpn] = SiteETTEntry();
-				return site_ett[vpn];
-			}
+			SiteETTShard &shard = getSiteETTShard(vpn);
+			std::shared_lock<std::shared_mutex> rlock(shard.mutex);
+			auto it = shard.entries.find(vpn);
+			return it == shard.entries.end() ? SiteETTEntry() : it->second;
 		}
 
 		/**
@@ -132,8 +154,9 @@ namespace ParametricDramDirectoryMSI
 		 */
 		void setSiteExpiration(IntPtr vpn, UInt32 expiration)
 		{
-			std::unique_lock<std::shared_mutex> wlock(site_ett_mutex);
-			site_ett[vpn].expiration_time = expiration;
+			SiteETTShard &shard = getSiteETTShard(vpn);
+			std::unique_lock<std::shared_mutex> wlock(shard.mutex);
+			shard.entries[vpn].expiration_time = expiration;
 		}
 
 		/**
@@ -142,12 +165,22 @@ namespace ParametricDramDirectoryMSI
 		 */
 		void clearSiteETTEntry(IntPtr vpn)
 		{
-			std::unique_lock<std::shared_mutex> wlock(site_ett_mutex);
-			site_ett.erase(vpn);
+			SiteETTShard &shard = getSiteETTShard(vpn);
+			std::unique_lock<std::shared_mutex> wlock(shard.mutex);
+			shard.entries.erase(vpn);
 		}
 
 	private:
-		std::unordered_map<IntPtr, SiteETTEntry> site_ett; // SITE ETT mapping: VPN -> ETT entry
-		mutable std::shared_mutex site_ett_mutex;          // Protects site_ett from concurrent access
+		// SITE ETT mapping VPN -> ETT entry, split in shards by VPN so that allocations and shootdowns
+		// on different pages do not contend on one lock. Each shard sits on its own cache line(s).
+		struct alignas(64) SiteETTShard
+		{
+			std::shared_mutex mutex;
+			std::unordered_map<IntPtr, SiteETTEntry> entries;
+		};
+		static const int NUM_SITE_ETT_SHARDS = 64;
+		SiteETTShard m_site_ett[NUM_SITE_ETT_SHARDS];
+
+		SiteETTShard &getSiteETTShard(IntPtr vpn) { return m_site_ett[(vpn ^ (vpn >> 6)) % NUM_SITE_ETT_SHARDS]; }
 	};
 }
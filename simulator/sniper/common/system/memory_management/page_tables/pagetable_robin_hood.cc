@@ -0,0 +1,334 @@
+#include "pagetable.h"
+#include "pagetable_robin_hood.h"
+#include "simulator.h"
+#include "config.hpp"
+#include "physical_memory_allocator.h"
+#include "mimicos.h"
+#include "stats.h"
+
+#include <iostream>
+#include <algorithm>
+
+// #define DEBUG
+
+namespace ParametricDramDirectoryMSI
+{
+	PageTableRobinHood::PageTableRobinHood(int core_id, String name, String type, int page_sizes, int *page_size_list, int *page_table_sizes,
+										   int max_probe_distance, float scale, bool is_guest)
+		: PageTable(core_id, name, type, page_sizes, page_size_list, is_guest),
+		  m_tables(page_sizes),
+		  m_page_table_sizes(page_table_sizes),
+		  m_max_probe_distance(max_probe_distance),
+		  m_scale(scale)
+	{
+		LOG_ASSERT_ERROR(m_max_probe_distance >= 0 && m_max_probe_distance < 255, "Robin Hood max_probe_distance must be in [0, 254], got %d", m_max_probe_distance);
+		// A walk probes every page size, keep its record within the inline capacity
+		LOG_ASSERT_ERROR((UInt64)m_page_sizes * (m_max_probe_distance + 1) <= PTW_MAX_ACCESSES,
+						 "Robin Hood max_probe_distance %d is too large for %d page sizes: a walk may read more than %u buckets",
+						 m_max_probe_distance, m_page_sizes, PTW_MAX_ACCESSES);
+		LOG_ASSERT_ERROR(m_scale > 1, "Robin Hood scale must be > 1, got %f", m_scale);
+
+		log_file_name = std::string(name.c_str()) + ".pagetable.log." + std::to_string(core_id);
+		log_file_name = std::string(Sim()->getConfig()->getOutputDirectory().c_str()) + "/" + log_file_name;
+		log_file.open(log_file_name.c_str());
+
+		for (int i = 0; i < m_page_sizes; i++)
+		{
+			makeTable(m_tables[i], m_page_table_sizes[i]);
+			std::cout << "[Robin Hood] Page table for page size " << m_page_size_list[i] << " has " << m_page_table_sizes[i]
+					  << " buckets (" << m_page_table_sizes[i] * 64 / 1024 << " KB), max probe distance " << m_max_probe_distance << std::endl;
+		}
+
+		stats.page_faults = 0;
+		stats.displacements = 0;
+		stats.backward_shifts = 0;
+		stats.rehashes = 0;
+		stats.page_table_walks = new UInt64[m_page_sizes]();
+		stats.num_accesses = new UInt64[m_page_sizes]();
+		stats.collisions = new UInt64[m_page_sizes]();
+		stats.max_distance = new UInt64[m_page_sizes]();
+
+		registerStatsMetric(name, core_id, "page_faults", &stats.page_faults);
+		registerStatsMetric(name, core_id, "displacements", &stats.displacements);
+		registerStatsMetric(name, core_id, "backward_shifts", &stats.backward_shifts);
+		registerStatsMetric(name, core_id, "rehashes", &stats.rehashes);
+		for (int i = 0; i < m_page_sizes; i++)
+		{
+			registerStatsMetric(name, core_id, "page_table_walks_" + itostr(m_page_size_list[i]), &stats.page_table_walks[i]);
+			registerStatsMetric(name, core_id, "accesses_" + itostr(m_page_size_list[i]), &stats.num_accesses[i]);
+			registerStatsMetric(name, core_id, "collisions_" + itostr(m_page_size_list[i]), &stats.collisions[i]);
+			registerStatsMetric(name, core_id, "max_probe_distance_" + itostr(m_page_size_list[i]), &stats.max_distance[i]);
+		}
+	}
+
+	PageTableRobinHood::~PageTableRobinHood()
+	{
+		delete[] m_page_table_sizes;
+		delete[] stats.page_table_walks;
+		delete[] stats.num_accesses;
+		delete[] stats.collisions;
+		delete[] stats.max_distance;
+	}
+
+	/*
+	 * makeTable(...) => an empty table of 'size' buckets, backed by size * 64 bytes of emulated physical memory.
+	 */
+	void PageTableRobinHood::makeTable(Table &table, UInt64 size)
+	{
+		MimicOS *os = is_guest ? Sim()->getMimicOS_VM() : Sim()->getMimicOS();
+		table.buckets.assign(size, Bucket());
+		table.base_ppn = os->getMemoryAllocator()->handle_page_table_allocations(size * 64);
+	}
+
+	/*
+	 * insert(...):
+	 *   - Walks the probe sequence of 'bucket' starting at its current distance. A bucket with the same
+	 *     tag absorbs the new translations. A bucket that is closer to its home slot than the one being
+	 *     inserted is displaced: it takes the place of 'bucket' and the walk continues with it.
+	 *   - Returns false if the bucket in hand would end up more than m_max_probe_distance slots from its
+	 *     home. The table then still holds every other bucket, and 'bucket' holds the one left over.
+	 */
+	bool PageTableRobinHood::insert(int page_size_index, Bucket &bucket)
+	{
+		Table &table = m_tables[page_size_index];
+		UInt64 size = table.buckets.size();
+		UInt64 index = (hashFunction(bucket.tag, size) + bucket.distance) % size;
+
+		while (true)
+		{
+			Bucket &slot = table.buckets[index];
+			if (slot.empty())
+			{
+				slot = bucket;
+				stats.max_distance[page_size_index] = std::max(stats.max_distance[page_size_index], (UInt64)slot.distance);
+				return true;
+			}
+			if (slot.tag == bucket.tag)
+			{
+				for (int offset = 0; offset < 8; offset++)
+				{
+					if (bucket.valid & (1 << offset))
+						slot.ppn[offset] = bucket.ppn[offset];
+				}
+				slot.valid |= bucket.valid;
+				return true;
+			}
+			if (slot.distance < bucket.distance)
+			{
+				std::swap(slot, bucket);
+				stats.displacements++;
+				stats.max_distance[page_size_index] = std::max(stats.max_distance[page_size_index], (UInt64)slot.distance);
+			}
+			if (bucket.distance == m_max_probe_distance)
+				return false;
+			bucket.distance++;
+			index = (index + 1) % size;
+		}
+	}
+
+	/*
+	 * grow(...) => rehashes the table of one page size into a table that is m_scale times larger (repeatedly,
+	 * if a bucket still does not fit within the probe distance bound). The old emulated space is not reused.
+	 */
+	void PageTableRobinHood::grow(int page_size_index, Bucket &leftover)
+	{
+		Table &table = m_tables[page_size_index];
+		std::vector<Bucket> pending;
+		pending.swap(table.buckets);
+		pending.push_back(leftover);
+
+		UInt64 size = pending.size() - 1;
+		while (true)
+		{
+			size = std::max((UInt64)(size * m_scale), size + 1);
+			makeTable(table, size);
+			stats.rehashes++;
+
+#ifdef DEBUG
+			log_file << "[Robin Hood] Growing table of page size " << m_page_size_list[page_size_index] << " to " << size << " buckets" << std::endl;
+#endif
+			UInt64 i = 0;
+			for (; i < pending.size(); i++)
+			{
+				if (pending[i].empty())
+					continue;
+				Bucket bucket = pending[i];
+				bucket.distance = 0;
+				if (!insert(page_size_index, bucket))
+				{
+					// Start over with a larger table: everything placed so far, the left over bucket and the rest
+					std::vector<Bucket> retry;
+					for (const Bucket &placed : table.buckets)
+						if (!placed.empty())
+							retry.push_back(placed);
+					retry.push_back(bucket);
+					retry.insert(retry.end(), pending.begin() + i + 1, pending.end());
+					pending.swap(retry);
+					break;
+				}
+			}
+			if (i == pending.size())
+				return;
+		}
+	}
+
+	/*
+	 * initializeWalk(...):
+	 *   - Probes the table of every page size, from the home slot of the tag on. Each probe reads one
+	 *     64-byte bucket. The probe stops at the bucket with the tag, at an empty slot, or at a bucket
+	 *     that is closer to its home than the probe distance (the tag would have displaced it).
+	 *   - If none of the page sizes maps the address, a page fault is raised.
+	 */
+	void PageTableRobinHood::initializeWalk(IntPtr address, bool count, PTWResult &ptw_result, bool is_prefetch, bool restart_walk_after_fault)
+	{
+#ifdef DEBUG
+		log_file << std::endl;
+		log_file << "[Robin Hood] Starting page walk for address " << address << std::endl;
+#endif
+		accessedAddresses &visited_addresses = get<1>(ptw_result);
+		visited_addresses.clear();
+
+		if (count)
+		{
+			for (int i = 0; i < m_page_sizes; i++)
+				stats.page_table_walks[i]++;
+		}
+
+		bool is_pagefault = false;
+
+	restart_walk:;
+
+		int page_size_result = -1;
+		IntPtr ppn = 0;
+
+		for (int i = 0; i < m_page_sizes; i++)
+		{
+			const Table &table = m_tables[i];
+			UInt64 size = table.buckets.size();
+			IntPtr VPN = address >> m_page_size_list[i];
+			IntPtr tag = VPN >> 3;
+			int block_offset = VPN % 8;
+
+			UInt64 index = hashFunction(tag, size);
+			for (int distance = 0; distance <= m_max_probe_distance; distance++)
+			{
+				const Bucket &bucket = table.buckets[index];
+				bool found = bucket.tag == tag;
+				bool hit = found && (bucket.valid & (1 << block_offset));
+
+				visited_addresses.emplace_back(make_tuple(i, distance, bucketAddress(table, index), hit));
+				if (count)
+					stats.num_accesses[i]++;
+
+				if (hit)
+				{
+					ppn = bucket.ppn[block_offset];
+					page_size_result = m_page_size_list[i];
+				}
+				if (found || bucket.empty() || bucket.distance < distance)
+					break;
+
+				if (count)
+					stats.collisions[i]++;
+				index = (index + 1) % size;
+			}
+		}
+
+		if (page_size_result == -1)
+		{
+#ifdef DEBUG
+			log_file << "[Robin Hood] Page fault in every page size" << std::endl;
+#endif
+			is_pagefault = true;
+			if (count)
+				stats.page_faults++;
+
+			if (restart_walk_after_fault)
+			{
+				Sim()->getMimicOS()->handle_page_fault(address, core_id, 0);
+				goto restart_walk;
+			}
+		}
+
+		setPTWResult(ptw_result, page_size_result, ppn, SubsecondTime::Zero(), is_pagefault, PF_DUMMY, SubsecondTime::Zero());
+	}
+
+	/*
+	 * updatePageTableFrames(...) => maps 'address' to 'ppn' in the table of 'page_size'. The table
+	 * lives in a preallocated area, so no page table frames are used.
+	 */
+	int PageTableRobinHood::updatePageTableFrames(IntPtr address, IntPtr core_id, IntPtr ppn, int page_size, std::span<const UInt64> frames)
+	{
+		int page_size_index = 0;
+		for (int i = 0; i < m_page_sizes; i++)
+		{
+			if (m_page_size_list[i] == page_size)
+			{
+				page_size_index = i;
+				break;
+			}
+		}
+
+#ifdef DEBUG
+		log_file << "[Robin Hood] Mapping address " << address << " to ppn " << ppn << " with page size " << page_size << std::endl;
+#endif
+		IntPtr VPN = address >> m_page_size_list[page_size_index];
+		int block_offset = VPN % 8;
+
+		Bucket bucket;
+		bucket.tag = VPN >> 3;
+		bucket.valid = 1 << block_offset;
+		bucket.ppn[block_offset] = ppn;
+
+		if (!insert(page_size_index, bucket))
+			grow(page_size_index, bucket);
+
+		return 0;
+	}
+
+	/*
+	 * deletePage(...) => invalidates the translation of 'address'. Once a bucket holds no valid
+	 * translation, the following buckets of its probe run move back by one slot.
+	 */
+	void PageTableRobinHood::deletePage(IntPtr address)
+	{
+		for (int i = 0; i < m_page_sizes; i++)
+		{
+			Table &table = m_tables[i];
+			UInt64 size = table.buckets.size();
+			IntPtr VPN = address >> m_page_size_list[i];
+			IntPtr tag = VPN >> 3;
+			int block_offset = VPN % 8;
+
+			UInt64 index = hashFunction(tag, size);
+			for (int distance = 0; distance <= m_max_probe_distance; distance++)
+			{
+				Bucket &bucket = table.buckets[index];
+				if (bucket.empty() || bucket.distance < distance)
+					break;
+				if (bucket.tag != tag)
+				{
+					index = (index + 1) % size;
+					continue;
+				}
+
+				if (!(bucket.valid & (1 << block_offset)))
+					break;
+				bucket.valid &= ~(1 << block_offset);
+				if (bucket.valid == 0)
+				{
+					UInt64 hole = index;
+					for (UInt64 next = (hole + 1) % size; !table.buckets[next].empty() && table.buckets[next].distance > 0; next = (next + 1) % size)
+					{
+						table.buckets[hole] = table.buckets[next];
+						table.buckets[hole].distance--;
+						hole = next;
+						stats.backward_shifts++;
+					}
+					table.buckets[hole] = Bucket();
+				}
+				return;
+			}
+		}
+	}
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include "subsecond_time.h"
+#include "fixed_types.h"
+#include "city.h"
+#include <stdint.h>
+#include <vector>
+#include <fstream>
+
+namespace ParametricDramDirectoryMSI
+{
+	/*
+	 * Hash Don't Cache page table (see PageTableHDC) with Robin Hood open addressing.
+	 *
+	 * Every 64-byte bucket holds the translations of 8 consecutive VPNs sharing a tag, and every
+	 * bucket remembers its distance from its home slot. On insertion a bucket that is closer to its
+	 * home than the one being inserted gives up its slot, which keeps all distances short and
+	 * similar. A lookup stops at the first slot whose bucket is closer to its home than the probe
+	 * distance, so a walk never visits more than max_probe_distance + 1 buckets. An insertion that
+	 * would exceed that bound grows the table (by 'scale') instead. Deletion shifts the rest of the
+	 * probe run back by one slot, so there are no tombstones.
+	 */
+	class PageTableRobinHood : public PageTable
+	{
+	private:
+		static const IntPtr EMPTY_TAG = ~(IntPtr)0;
+
+		struct Bucket
+		{
+			IntPtr tag;
+			UInt8 valid;	// one bit per block offset
+			UInt8 distance; // slots away from hash(tag)
+			IntPtr ppn[8];
+
+			Bucket() : tag(EMPTY_TAG), valid(0), distance(0) {}
+			bool empty() const { return tag == EMPTY_TAG; }
+		};
+
+		struct Table
+		{
+			std::vector<Bucket> buckets;
+			IntPtr base_ppn; // emulated physical page of the first bucket, buckets are 64 bytes apart
+		};
+		std::vector<Table> m_tables; // one per page size
+
+		int *m_page_table_sizes;
+		int m_max_probe_distance;
+		float m_scale;
+
+		struct
+		{
+			UInt64 page_faults;
+			UInt64 displacements; // buckets moved away from their slot by an insertion
+			UInt64 backward_shifts; // buckets moved back by a deletion
+			UInt64 rehashes;
+			UInt64 *page_table_walks;
+			UInt64 *num_accesses;
+			UInt64 *collisions;
+			UInt64 *max_distance;
+		} stats;
+
+		std::ofstream log_file;
+		std::string log_file_name;
+
+		UInt64 hashFunction(IntPtr tag, UInt64 table_size) const { return CityHash64((const char *)&tag, 8) % table_size; }
+		IntPtr bucketAddress(const Table &table, UInt64 index) const { return table.base_ppn * 4096 + index * 64; }
+
+		void makeTable(Table &table, UInt64 size);
+		bool insert(int page_size_index, Bucket &bucket);
+		void grow(int page_size_index, Bucket &leftover);
+
+	public:
+		PageTableRobinHood(int core_id, String name, String type, int page_sizes, int *page_size_list, int *page_table_sizes,
+						   int max_probe_distance, float scale, bool is_guest = false);
+		~PageTableRobinHood();
+
+		void initializeWalk(IntPtr address, bool count, PTWResult &ptw_result, bool is_prefetch = false, bool restart_walk = false);
+		int updatePageTableFrames(IntPtr address, IntPtr core_id, IntPtr ppn, int page_size, std::span<const UInt64> frames);
+		void deletePage(IntPtr address);
+	};
+}
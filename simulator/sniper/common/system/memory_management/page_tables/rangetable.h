@@ -7,6 +7,7 @@
 #include "fixed_types.h"
 #include "stats.h"
 #include "simulator.h"
+#include "vma.h"
 #include <tuple>
 
 using namespace std;
@@ -22,8 +23,10 @@ namespace ParametricDramDirectoryMSI
     {
 
      public:
-        
-        std::pair<uint64_t, uint64_t> *keys;
+        // All per-key arrays share one 64-byte aligned block. The range ends come first
+        // since they are what a search scans, followed by the starts, values and children.
+        IntPtr *ends;
+        IntPtr *starts;
         RangeEntry *values;
         int t;
         TreeNode **C;
@@ -31,12 +34,15 @@ namespace ParametricDramDirectoryMSI
         bool leaf;
         IntPtr emulated_ppn;
         TreeNode(int temp, bool bool_leaf);
+        ~TreeNode();
 
         void insertNonFull(std::pair<uint64_t, uint64_t> k, RangeEntry value);
         void splitChild(int i, TreeNode *y);
         void traverse();
 
-        std::pair<TreeNode*,int> search(IntPtr address, std::vector<IntPtr> &accessedAddresses);
+        std::pair<uint64_t, uint64_t> key(int i) const { return std::make_pair(starts[i], ends[i]); }
+        void setKey(int i, std::pair<uint64_t, uint64_t> k) { starts[i] = k.first; ends[i] = k.second; }
+        void moveKey(int to, const TreeNode *from, int i) { starts[to] = from->starts[i]; ends[to] = from->ends[i]; values[to] = from->values[i]; }
 
         friend class RangeTableBtree;
     };
@@ -61,7 +67,9 @@ namespace ParametricDramDirectoryMSI
             registerStatsMetric(name, app_id, "accesses", &rt_stats.accesses);
         }
         virtual void insert(std::pair<uint64_t, uint64_t> key, RangeEntry value) = 0;
-        virtual std::tuple<TreeNode *, int, std::vector<IntPtr>> lookup(uint64_t address) = 0;
+        // Returns true and fills range if address is covered. The (emulated) addresses of the
+        // entries the walk touched are appended to accessed, which the caller reuses across walks.
+        virtual bool lookup(IntPtr address, Range &range, std::vector<IntPtr> &accessed) = 0;
         ~RangeTable(){};
     };
 
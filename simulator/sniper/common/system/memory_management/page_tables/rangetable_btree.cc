@@ -5,9 +5,9 @@
 #include "rangetable.h"
 #include "rangetable_btree.h"
 #include <tuple>
+#include <cstdlib>
 #include "simulator.h"
 #include "mimicos.h"
-#include <tuple>
 //#define DEBUG
 
 using namespace std;
@@ -30,14 +30,28 @@ namespace ParametricDramDirectoryMSI
         t = t1;
         leaf = leaf1;
 
-        keys = new std::pair<uint64_t, uint64_t>[2 * t - 1];
-        values = new RangeEntry[2 * t - 1];
-        C = new TreeNode *[2 * t];
+        size_t max_keys = 2 * t - 1;
+        size_t bytes = max_keys * (2 * sizeof(IntPtr) + sizeof(RangeEntry)) + 2 * t * sizeof(TreeNode *);
+        char *block = static_cast<char *>(aligned_alloc(64, (bytes + 63) & ~size_t(63)));
+        ends = reinterpret_cast<IntPtr *>(block);
+        starts = ends + max_keys;
+        values = reinterpret_cast<RangeEntry *>(starts + max_keys);
+        C = reinterpret_cast<TreeNode **>(values + max_keys);
         emulated_ppn = Sim()->getMimicOS()->getMemoryAllocator()->handle_page_table_allocations(4096);
 
         n = 0;
     }
 
+    TreeNode::~TreeNode()
+    {
+        if (!leaf)
+        {
+            for (int i = 0; i <= n; i++)
+                delete C[i];
+        }
+        free(ends);
+    }
+
     void TreeNode::traverse()
     {
         int i;
@@ -51,22 +65,34 @@ namespace ParametricDramDirectoryMSI
             C[i]->traverse();
     }
 
-    std::pair<TreeNode*,int> TreeNode::search(IntPtr k, std::vector<IntPtr> &accessedAddresses)
+    bool RangeTableBtree::lookup(IntPtr k, Range &range, std::vector<IntPtr> &accessed)
     {
-        int i = 0;
-        while (i < n && k > keys[i].second)
+        TreeNode *node = root;
+        while (node != NULL)
         {
-            accessedAddresses.push_back(emulated_ppn*4096 + i * 24);
-            i++;
-        }
+            // Every key that is skipped costs one access to the node's emulated frame.
+            // Ranges are half-open, so a range ending at k is skipped as well.
+            int i = 0;
+            while (i < node->n && k >= node->ends[i])
+            {
+                accessed.push_back(node->emulated_ppn * 4096 + i * 24);
+                i++;
+            }
 
-        if (keys[i].first <= k && keys[i].second > k)
-            return std::make_pair(this, i);
+            if (i < node->n && node->starts[i] <= k)
+            {
+                range.vpn = node->starts[i];
+                range.bounds = node->ends[i];
+                range.offset = node->values[i].offset;
+                return true;
+            }
 
-        if (leaf == true)
-            return std::make_pair(static_cast<ParametricDramDirectoryMSI::TreeNode*>(NULL), 0);
+            if (node->leaf)
+                return false;
 
-        return C[i]->search(k, accessedAddresses);
+            node = node->C[i];
+        }
+        return false;
     }
 
     void RangeTableBtree::insert(std::pair<uint64_t, uint64_t> k, RangeEntry value)
@@ -74,7 +100,7 @@ namespace ParametricDramDirectoryMSI
         if (root == NULL)
         {
             root = new TreeNode(t, true);
-            root->keys[0] = k;
+            root->setKey(0, k);
             root->values[0] = value;   // Store RangeEntry for the first insertion
             root->n = 1;
 #ifdef DEBUG
@@ -95,7 +121,7 @@ namespace ParametricDramDirectoryMSI
                 s->splitChild(0, root);
 
                 int i = 0;
-                if (s->keys[0] < k)
+                if (s->key(0) < k)
                     i++;
                 s->C[i]->insertNonFull(k, value);
 
@@ -112,27 +138,26 @@ namespace ParametricDramDirectoryMSI
 
         if (leaf == true)
         {
-            while (i >= 0 && keys[i] > k)
+            while (i >= 0 && key(i) > k)
             {
-                keys[i + 1] = keys[i];
-                values[i + 1] = values[i];
+                moveKey(i + 1, this, i);
                 i--;
             }
 
-            keys[i + 1] = k;
+            setKey(i + 1, k);
             values[i + 1] = value;
             n = n + 1;
         }
         else
         {
-            while (i >= 0 && keys[i] > k)
+            while (i >= 0 && key(i) > k)
                 i--;
 
             if (C[i + 1]->n == 2 * t - 1)
             {
                 splitChild(i + 1, C[i + 1]);
 
-                if (keys[i + 1] < k)
+                if (key(i + 1) < k)
                     i++;
             }
             C[i + 1]->insertNonFull(k, value);
@@ -144,10 +169,8 @@ namespace ParametricDramDirectoryMSI
         TreeNode *z = new TreeNode(y->t, y->leaf);
         z->n = t - 1;
 
-        for (int j = 0; j < t - 1; j++){
-            z->keys[j] = y->keys[j + t];
-            z->values[j] = y->values[j + t];
-        }
+        for (int j = 0; j < t - 1; j++)
+            z->moveKey(j, y, j + t);
 
         if (y->leaf == false)
         {
@@ -161,13 +184,10 @@ namespace ParametricDramDirectoryMSI
 
         C[i + 1] = z;
 
-        for (int j = n - 1; j >= i; j--){
-            keys[j + 1] = keys[j];
-            values[j + 1] = values[j];
-        }
+        for (int j = n - 1; j >= i; j--)
+            moveKey(j + 1, this, j);
 
-        keys[i] = y->keys[t - 1];
-        values[i] = y->values[t - 1];
+        moveKey(i, y, t - 1);
         
         n = n + 1;
     }
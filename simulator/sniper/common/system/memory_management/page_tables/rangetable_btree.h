@@ -19,7 +19,6 @@ namespace ParametricDramDirectoryMSI
     {
         TreeNode *root;
         int t;
-        std::vector<IntPtr> accessedAddresses;
 
         std::string log_file_name;
         std::ofstream log_file;
@@ -40,18 +39,7 @@ namespace ParametricDramDirectoryMSI
                 root->traverse();
         }
 
-        std::tuple<TreeNode *, int, std::vector<IntPtr>> lookup(IntPtr address)
-        {
-            accessedAddresses = std::vector<IntPtr>();
-            if (root == NULL){
-                return std::make_tuple(root,0, accessedAddresses);
-            }
-            else
-            {
-                auto result = root->search(address, accessedAddresses);
-                return std::make_tuple(get<0>(result),get<1>(result),accessedAddresses);
-            }
-        }
+        bool lookup(IntPtr address, Range &range, std::vector<IntPtr> &accessed);
 
         void insert(std::pair<uint64_t, uint64_t> key, RangeEntry value);
     };
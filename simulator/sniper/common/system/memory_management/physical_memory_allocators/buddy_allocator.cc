@@ -1,5 +1,7 @@
 #include "buddy_allocator.h"
 #include "fixed_types.h"
+#include "translation_trace.h"
+#include "time_series_sink.h"
 #include <vector>
 #include <tuple>
 #include <string>
@@ -15,6 +17,64 @@
 
 using namespace std;
 
+void BuddyBitmap::init(UInt64 num_blocks)
+{
+	m_num_blocks = num_blocks;
+	m_levels.clear();
+	UInt64 words = (num_blocks + 63) / 64;
+	do
+	{
+		words = std::max<UInt64>(words, 1);
+		m_levels.push_back(std::vector<UInt64>(words, 0));
+		words = (words + 63) / 64;
+	} while (m_levels.back().size() > 1);
+}
+
+bool BuddyBitmap::test(UInt64 idx) const
+{
+	if (idx >= m_num_blocks)
+		return false;
+	return (m_levels[0][idx / 64] >> (idx % 64)) & 1;
+}
+
+void BuddyBitmap::set(UInt64 idx)
+{
+	assert(idx < m_num_blocks);
+	for (auto &level : m_levels)
+	{
+		bool was_empty = (level[idx / 64] == 0);
+		level[idx / 64] |= (1ULL << (idx % 64));
+		if (!was_empty)
+			break;
+		idx /= 64;
+	}
+}
+
+void BuddyBitmap::clear(UInt64 idx)
+{
+	assert(idx < m_num_blocks);
+	for (auto &level : m_levels)
+	{
+		level[idx / 64] &= ~(1ULL << (idx % 64));
+		if (level[idx / 64] != 0)
+			break;
+		idx /= 64;
+	}
+}
+
+UInt64 BuddyBitmap::findFirst() const
+{
+	UInt64 idx = 0;
+	for (int l = m_levels.size() - 1; l >= 0; l--)
+	{
+		UInt64 word = m_levels[l][idx];
+		assert(word != 0);
+		idx = idx * 64 + __builtin_ctzll(word);
+	}
+	return idx;
+}
+
+
 Buddy::Buddy(int memory_size, int max_order, int kernel_size, String frag_type) :
 m_memory_size(memory_size),  m_max_order(max_order), m_kernel_size(kernel_size),  m_frag_type(frag_type)
 
@@ -27,11 +87,6 @@ m_memory_size(memory_size),  m_max_order(max_order), m_kernel_size(kernel_size),
 	log_file << std::endl;
 #endif
 
-	for (int i = 0; i < m_max_order + 1; i++)
-	{
-		std::vector<std::tuple<UInt64, UInt64, bool, UInt64>> vec; // Block start, Block end
-		free_list.push_back(vec);
-	}
 	// Set the fragmentation function based on the frag_type
 	if (frag_type == "contiguity")
 	{
@@ -49,12 +104,7 @@ m_memory_size(memory_size),  m_max_order(max_order), m_kernel_size(kernel_size),
 
 	std::cout << "[Buddy] Memory Size in MB: " << m_memory_size << std::endl;
 
-
-	UInt64 pages_in_block = static_cast<UInt64>(pow(2, m_max_order)); // start with max
-
-	UInt64 current_order = m_max_order;
-
-	// Initialize the free list with all the pages in memory
+	// Initialize the free lists with all the pages in memory
 	// We need to subtract the kernel size from the total memory size
 	UInt64 total_mem_in_pages = m_memory_size * 1024 / 4 - m_kernel_size * 1024 / 4;
 
@@ -62,9 +112,12 @@ m_memory_size(memory_size),  m_max_order(max_order), m_kernel_size(kernel_size),
 
 	m_free_pages = m_total_pages;
 
-	UInt64 available_mem_in_pages = total_mem_in_pages;
+	m_base_page = m_kernel_size * 1024 / 4;
 
-	UInt64 current_free = m_kernel_size * 1024 / 4;
+	free_map.resize(m_max_order + 1);
+	free_blocks.assign(m_max_order + 1, 0);
+	for (int order = 0; order <= m_max_order; order++)
+		free_map[order].init((m_total_pages + (1ULL << order) - 1) >> order);
 
 
 	std::cout << "[Buddy] 4KB pages in memory: " << total_mem_in_pages << std::endl;
@@ -72,28 +125,80 @@ m_memory_size(memory_size),  m_max_order(max_order), m_kernel_size(kernel_size),
 	std::cout << "[Buddy] 1GB pages in memory: " << total_mem_in_pages / 512 / 512 << std::endl;
 
 
-	// Initialize the free list with all the pages in memory
-	while (current_free < static_cast<UInt64>(m_memory_size * 1024 / 4))
+	// Carve memory greedily into the largest blocks that fit, so every block is naturally aligned
+	UInt64 current_free = 0;
+	for (int order = m_max_order; order >= 0; order--)
 	{
-		while (available_mem_in_pages >= pages_in_block)
+		while (m_total_pages - current_free >= (1ULL << order))
 		{
 #ifdef DEBUG_BUDDY
-			log_file << "[Buddy] Adding block of size " << pages_in_block << " at address " << current_free << std::endl; 
+			log_file << "[Buddy] Adding block of size " << (1ULL << order) << " at address " << m_base_page + current_free << std::endl; 
 #endif
-			free_list[current_order].push_back(std::make_tuple(current_free, current_free + pages_in_block - 1, false, -1));
-			current_free += pages_in_block;
-			available_mem_in_pages -= pages_in_block;
+			insertBlock(current_free, order);
+			current_free += (1ULL << order);
 		}
-#ifdef DEBUG_BUDDY_BUDDY_SIMPLE_THP
-		log_file << "[Buddy] Order " << current_order << " has " << free_list[current_order].size() << " blocks" << std::endl;
-#endif
-		current_order--;
-		pages_in_block = static_cast<UInt64>(pow(2, current_order));
 	}
 #ifdef DEBUG_BUDDY
 	log_file << "[Buddy] Initialization done" << std::endl;
 #endif
 
+	m_fragmentation_series = TimeSeriesSink::create("buddy.fragmentation", { "free_page_ratio", "average_size_ratio", "large_page_ratio" });
+	m_series_events = 0;
+
+}
+
+int Buddy::orderOfPages(UInt64 pages)
+{
+	// ceil(log2(pages)), with 0 and 1 page both mapping to order 0
+	return pages <= 1 ? 0 : 64 - __builtin_clzll(pages - 1);
+}
+
+void Buddy::insertBlock(UInt64 offset, int order)
+{
+	assert((offset & ((1ULL << order) - 1)) == 0);
+	free_map[order].set(offset >> order);
+	free_blocks[order]++;
+}
+
+void Buddy::removeBlock(UInt64 offset, int order)
+{
+	assert(free_map[order].test(offset >> order));
+	free_map[order].clear(offset >> order);
+	free_blocks[order]--;
+}
+
+/**
+ * @brief Remove the lowest free block of @p order and split it down to @p target_order.
+ *
+ * The upper halves produced by the split go back to the free lists of the intermediate orders.
+ * @return The offset (relative to m_base_page) of the block of target_order.
+ */
+UInt64 Buddy::takeBlock(int order, int target_order)
+{
+	UInt64 offset = free_map[order].findFirst() << order;
+	removeBlock(offset, order);
+
+	while (order > target_order)
+	{
+		order--;
+		insertBlock(offset + (1ULL << order), order);
+	}
+	m_free_pages -= (1ULL << target_order);
+	publishFragmentation();
+	return offset;
+}
+
+/**
+ * @brief Every 'interval' allocations and frees, publish the free memory and both fragmentation
+ * metrics to the fragmentation time series (if enabled).
+ */
+void Buddy::publishFragmentation()
+{
+	if (!m_fragmentation_series || ++m_series_events % m_fragmentation_series->getInterval() != 0)
+		return;
+
+	double values[] = { (double)m_free_pages / m_total_pages, getAverageSizeRatio(), getLargePageRatio() };
+	m_fragmentation_series->publish(m_series_events, values);
 }
 
 /**
@@ -115,13 +220,9 @@ void Buddy::fragmentMemory(double target_fragmentation)
 
 	std::cout << "[BUDDY] Fragmenting memory to achieve target fragmentation: " << target_fragmentation << std::endl;
 
-	std::vector<UInt64> used_pages;
 	unsigned seed = 12345;
 	std::mt19937 gen(seed);
 
-	std::uniform_int_distribution<UInt64> dist(0, m_max_order - 4);
-
-
 	double current_fragmentation = (this->*frag_fun)();
 
 #ifdef DEBUG_BUDDY
@@ -134,28 +235,24 @@ void Buddy::fragmentMemory(double target_fragmentation)
 
 		for (int i = m_max_order; i >= 9; i--)
 		{
-			if (free_list[i].size() > 0)
+			if (free_blocks[i] > 0)
 			{
-				std::tuple<UInt64, UInt64, bool, UInt64> temp = free_list[i][0];
-				free_list[i].erase(free_list[i].begin());
+				UInt64 start = free_map[i].findFirst() << i;
+				removeBlock(start, i);
 
-				UInt64 start = get<0>(temp);
-				UInt64 end = get<1>(temp);
-				UInt64 size = end - start + 1;
-				// generate a random order between 8 and m_max_order-3, add seed
+				// generate a random order between 8 and i-1
 				std::uniform_int_distribution<UInt64> dist(8, i - 1);
 
-				UInt64 random_order = dist(gen);
-				UInt64 chunk = size / std::pow(2, random_order);
-				UInt64 pages_in_block = pow(2, random_order);
+				int random_order = dist(gen);
+				UInt64 chunk = 1ULL << (i - random_order);
+				UInt64 pages_in_block = 1ULL << random_order;
 
 				// Essentially, we are splitting the large page into smaller pages
-				// and adding them to the free list
+				// and adding them to the free lists without coalescing them again.
 				// This way we are increasing the fragmentation without actually allocating memory which is very useful for testing and evaluation
 				for (UInt64 j = 0; j < chunk; j++)
 				{
-					free_list[random_order].push_back(std::make_tuple(start + j * pages_in_block, start + (j + 1) * pages_in_block - 1, false, -1));
-					assert(get<0>(free_list[random_order].back()) == (start + j * pages_in_block));
+					insertBlock(start + j * pages_in_block, random_order);
 				}
 				break;
 			}
@@ -175,59 +272,31 @@ void Buddy::fragmentMemory(double target_fragmentation)
 UInt64 Buddy::allocate(UInt64 bytes, UInt64 address, UInt64 core_id)
 {
 
-	int ind = ceil(log2(bytes / 4096));
+	int ind = orderOfPages(bytes / 4096);
 	int i;
 
 	for (i = ind; i <= m_max_order; i++)
 	{
-		if (free_list[i].size() != 0)
+		if (free_blocks[i] != 0)
 			break;
 	}
-	if (i == m_max_order + 1)
+	if (i > m_max_order)
 	{
 #ifdef DEBUG_BUDDY
 		log_file << "[Buddy] No free page inside memory" << std::endl;
 #endif
 		return static_cast<UInt64>(-1);
 	}
-	else
-	{
-		std::tuple<UInt64, UInt64, bool, UInt64> temp;
 
 #ifdef DEBUG_BUDDY
-		log_file << "[Buddy] Found free page in order " << i << std::endl;
+	log_file << "[Buddy] Found free page in order " << i << std::endl;
 #endif
-		temp = free_list[i].back();
-		free_list[i].pop_back();
-		i--;
-
-
-		// Split the block into smaller blocks until we reach the desired size
-
-		while (i >= ind)
-		{
-
-			std::tuple<UInt64, UInt64, bool, UInt64> pair1, pair2;
-
-			pair1 = std::make_tuple(get<0>(temp), get<0>(temp) + (get<1>(temp) - get<0>(temp)) / 2, false, -1);
-			pair2 = std::make_tuple(get<0>(temp) + (get<1>(temp) - get<0>(temp)) / 2 + 1, get<1>(temp), false, -1);
-
-			assert((get<1>(pair2) - get<0>(pair2) + 1) == pow(2, i));
-
-			free_list[i].push_back(pair1);
-			free_list[i].push_back(pair2);
-			temp = free_list[i].back();
-			free_list[i].pop_back();
-			i--;
-		}
+	UInt64 page = m_base_page + takeBlock(i, ind);
 #ifdef DEBUG_BUDDY
-		log_file << "[Buddy] Allocated " << bytes << " bytes at address " << get<0>(temp) << std::endl;
+	log_file << "[Buddy] Allocated " << bytes << " bytes at address " << page << std::endl;
 #endif
-		m_free_pages -= pow(2, ind);
-		return get<0>(temp);
-	}
-	assert(false);
-	return static_cast<UInt64>(-1);
+	TTRACE(TranslationTrace::currentCore(), TranslationTrace::PHYS_ALLOC, SubsecondTime::Zero(), address, page, SubsecondTime::Zero(), ind, 1U << ind);
+	return page;
 
 }
 
@@ -235,11 +304,9 @@ UInt64 Buddy::allocate(UInt64 bytes, UInt64 address, UInt64 core_id)
 std::pair<IntPtr,int> Buddy::allocate_contiguous(UInt64 size, UInt64 app_id)
 {
 
-	int ind = ceil(log2(size / 4096));
+	int ind = orderOfPages(size / 4096);
 	int i;
 
-	int largest_order = -1;
-
 #ifdef DEBUG_BUDDY
 	log_file << "[Buddy] Allocating " << size << " bytes for app " << app_id << std::endl;
 	log_file << "[Buddy] Requested order: " << ind << std::endl;
@@ -247,25 +314,19 @@ std::pair<IntPtr,int> Buddy::allocate_contiguous(UInt64 size, UInt64 app_id)
 	// Search for high order blocks first
 	for (i = ind; i <= m_max_order; i++)
 	{
-		if (free_list[i].size() != 0)
+		if (free_blocks[i] != 0)
 			break;
-
 	}
 
-	if (i == m_max_order + 1)
+	if (i > m_max_order)
 	{
 #ifdef DEBUG_BUDDY
 		log_file << "[Buddy] I can't provide such a large contiguous memory" << std::endl;
 #endif
 		// Provide the largest contiguous memory available
-
-		for (i=0; i <= m_max_order; i++)
-		{
-			if (free_list[i].size() >0)
-			{
-				largest_order = i;
-			}
-		}
+		int largest_order = std::min(ind, m_max_order + 1) - 1;
+		while (largest_order >= 0 && free_blocks[largest_order] == 0)
+			largest_order--;
 
 		if (largest_order == -1)
 		{
@@ -274,150 +335,55 @@ std::pair<IntPtr,int> Buddy::allocate_contiguous(UInt64 size, UInt64 app_id)
 #endif
 			return std::make_pair((UInt64)-1, -1);
 		}
-		else
-		{
-#ifdef DEBUG_BUDDY
-			log_file << "[Buddy] Found free block in order " << largest_order << std::endl;
-#endif
-			std::tuple<UInt64, UInt64, bool, UInt64> temp = free_list[largest_order].back();
-			free_list[largest_order].pop_back();
-			m_free_pages -= pow(2, largest_order);
-			return std::make_pair(get<0>(temp), get<1>(temp) - get<0>(temp) + 1);
-
-		}
-
-	}
-	else
-	{
-		std::tuple<UInt64, UInt64, bool, UInt64> temp;
-		std::vector<std::tuple<UInt64, UInt64, bool, UInt64>> temp_list;
 
 #ifdef DEBUG_BUDDY
-		log_file << "[Buddy] Found free block in high order " << i << " and requested order is: " << ind << std::endl;
+		log_file << "[Buddy] Found free block in order " << largest_order << std::endl;
 #endif
-		temp = free_list[i].back();
-		free_list[i].pop_back();
-
-		i--;
-
-		// Split the block into smaller blocks until we reach the desired size
-#ifdef DEBUG_BUDDY
-		log_file << "[Buddy] Splitting block into smaller blocks" << std::endl;
-#endif
-
-		while (i >= ind)
-		{
-
-			std::tuple<UInt64, UInt64, bool, UInt64> pair1, pair2;
-
-#ifdef DEBUG_BUDDY
-			log_file << "[Buddy] Splitting block into smaller blocks of order " << i << std::endl;
-			log_file << "[Buddy] Block start: " << get<0>(temp) << " Block end: " << get<1>(temp) << std::endl;
-#endif
-
-			pair1 = std::make_tuple(get<0>(temp), get<0>(temp) + (get<1>(temp) - get<0>(temp)) / 2, false, -1);
-			pair2 = std::make_tuple(get<0>(temp) + (get<1>(temp) - get<0>(temp)) / 2 + 1, get<1>(temp), false, -1);
-
-			assert((get<1>(pair2) - get<0>(pair2) + 1) == pow(2, i));
-
-			free_list[i].push_back(pair1);
-			free_list[i].push_back(pair2);
-			temp = free_list[i].back();
-			free_list[i].pop_back();
-			i--;
-		}
+		UInt64 start = m_base_page + takeBlock(largest_order, largest_order);
+		TTRACE(TranslationTrace::currentCore(), TranslationTrace::PHYS_ALLOC, SubsecondTime::Zero(), 0, start, SubsecondTime::Zero(), largest_order, 1U << largest_order);
+		return std::make_pair(start, 1 << largest_order);
+	}
 
 #ifdef DEBUG_BUDDY
-		log_file << "[Buddy] Allocated " << size << " bytes at address " << get<0>(temp) << std::endl;
+	log_file << "[Buddy] Found free block in high order " << i << " and requested order is: " << ind << std::endl;
 #endif
-
-		m_free_pages -= pow(2, ind);
+	UInt64 start = m_base_page + takeBlock(i, ind);
 
 #ifdef DEBUG_BUDDY
-		log_file << "[Buddy] Updated m_free_pages = " << m_free_pages << std::endl;
-		log_file << "[Buddy] Returning address: " << get<0>(temp) << " and size: " << get<1>(temp) - get<0>(temp) + 1 << std::endl;
+	log_file << "[Buddy] Updated m_free_pages = " << m_free_pages << std::endl;
+	log_file << "[Buddy] Returning address: " << start << " and size: " << (1 << ind) << std::endl;
 #endif
+	TTRACE(TranslationTrace::currentCore(), TranslationTrace::PHYS_ALLOC, SubsecondTime::Zero(), 0, start, SubsecondTime::Zero(), ind, 1U << ind);
 
-		return std::make_pair(get<0>(temp), get<1>(temp) - get<0>(temp) + 1);
-		 
-	}
+	return std::make_pair(start, 1 << ind);
 
 }
 
 std::tuple<UInt64, UInt64, bool, UInt64> Buddy::reserve_2mb_page(UInt64 address, UInt64 core_id)
 {
-	
-	// check if there is a 2MB region available
-#ifdef DEBUG_BUDDY
-	log_file << "DEBUG_BUDDY: Checking for 2MB region in free_list[9]" << std::endl;
-#endif
+	const int two_mb_order = 9;
 
-	if (free_list[9].size() > 0)
+	// Find the smallest block that can hold a 2MB region
+	for (int i = two_mb_order; i <= m_max_order; i++)
 	{
-
+		if (free_blocks[i] > 0)
+		{
 #ifdef DEBUG_BUDDY
-	log_file << "DEBUG_BUDDY: 2MB region available in free_list[9]" << std::endl;
+			log_file << "DEBUG_BUDDY: Region available in order " << i << std::endl;
 #endif
-		// get the 2MB region
-		std::tuple<UInt64, UInt64, bool, UInt64> temp = free_list[9].back();
-		free_list[9].pop_back();
-
+			UInt64 start = m_base_page + takeBlock(i, two_mb_order);
 #ifdef DEBUG_BUDDY
-	log_file << "DEBUG_BUDDY: Retrieved and removed 2MB region from free_list[9]" << std::endl;
+			log_file << "DEBUG_BUDDY: Returning 2MB region from 4KB start page: " << start << " and end page: " << start + 511 << std::endl;
 #endif
-
-		return temp;
+			TTRACE(TranslationTrace::currentCore(), TranslationTrace::PHYS_ALLOC, SubsecondTime::Zero(), address, start, SubsecondTime::Zero(), two_mb_order, 1U << two_mb_order);
+			return std::make_tuple(start, start + (1ULL << two_mb_order) - 1, false, -1);
+		}
 	}
-	else {
 
 #ifdef DEBUG_BUDDY
-	log_file << "DEBUG_BUDDY: No 2MB region available in free_list[9], checking higher orders" << std::endl;
+	log_file << "DEBUG_BUDDY: No region available, returning nullptr" << std::endl;
 #endif
 
-		for (int i = 10; i <= m_max_order; i++)
-		{
-			if (free_list[i].size() > 0)
-			{
-
-#ifdef DEBUG_BUDDY
-			log_file << "DEBUG_BUDDY: Region available in free_list[" << i << "]" << std::endl;
-#endif
-				std::tuple<UInt64, UInt64, bool, UInt64> temp = free_list[i].front();
-				free_list[i].erase(free_list[i].begin());
-				UInt64 start = get<0>(temp);
-				UInt64 end = get<1>(temp);
-				UInt64 size = end - start + 1;
-				UInt64 chunk = size / 512;
-				UInt64 pages_in_block = pow(2, 9);
-
-		#ifdef DEBUG_BUDDY
-				log_file << "DEBUG_BUDDY: Splitting region from free_list[" << i << "] into 2MB chunks" << std::endl;
-		#endif
-
-				for (UInt64 j = 0; j < chunk; j++)
-				{
-					free_list[9].push_back(std::make_tuple(start + j * pages_in_block, start + (j + 1) * pages_in_block - 1, false, -1));
-					assert(get<0>(free_list[9].back()) == (start + j * pages_in_block));
-		#ifdef DEBUG_BUDDY
-					log_file << "DEBUG_BUDDY: Added 2MB chunk to free_list[9], start = " << (start + j * pages_in_block) << std::endl;
-		#endif
-				}
-				temp = free_list[9].back();
-				free_list[9].pop_back();
-		#ifdef DEBUG_BUDDY
-				log_file << "DEBUG_BUDDY: Retrieved and removed 2MB region from free_list[9] after splitting" << std::endl;
-				log_file << "DEBUG_BUDDY: Returning 2MB region from 4KB start page: " << get<0>(temp) << " and end page: " << get<1>(temp) << std::endl;
-		#endif
-
-				return temp;
-			}
-		}
-	}
-
-	#ifdef DEBUG_BUDDY
-		log_file << "DEBUG_BUDDY: No region available, returning nullptr" << std::endl;
-	#endif
-
 	return std::make_tuple(-1, 0, false, 0);
 
 }
@@ -425,83 +391,65 @@ std::tuple<UInt64, UInt64, bool, UInt64> Buddy::reserve_2mb_page(UInt64 address,
 
 void Buddy::free(UInt64 start, UInt64 end)
 {
-	int order = ceil(log2((end - start + 1)));
-	int i = order;
-
-	#ifdef DEBUG_BUDDY
-		log_file << "Debug: Calculated order = " << order << std::endl;
-	#endif
+	assert(start >= m_base_page && end >= start);
+	int order = orderOfPages(end - start + 1);
+	UInt64 offset = start - m_base_page;
 
-	std::tuple<UInt64, UInt64, bool, UInt64> temp = std::make_tuple(start, end, false, -1);
-
-	#ifdef DEBUG_BUDDY
-		log_file << "Debug: Created tuple with start = " << start << " and end = " << end << std::endl;
-	#endif
-
-	free_list[i].push_back(temp);
+#ifdef DEBUG_BUDDY
+	log_file << "Debug: Freeing block start = " << start << " end = " << end << " order = " << order << std::endl;
+#endif
 
-	#ifdef DEBUG_BUDDY
-		log_file << "Debug: Pushed tuple to free_list[" << i << "]" << std::endl;
-	#endif
+	assert(!free_map[order].test(offset >> order) && "Buddy: double free");
+	TTRACE(TranslationTrace::currentCore(), TranslationTrace::PHYS_FREE, SubsecondTime::Zero(), 0, start, SubsecondTime::Zero(), order, (UInt32)(end - start + 1));
+	m_free_pages += (1ULL << order);
 
-	m_free_pages += pow(2, i);
+	// Merge with the buddy as long as it is free at the same order
+	while (order < m_max_order)
+	{
+		UInt64 buddy = offset ^ (1ULL << order);
+		if (!free_map[order].test(buddy >> order))
+			break;
+		removeBlock(buddy, order);
+		offset &= ~(1ULL << order);
+		order++;
+	}
+	insertBlock(offset, order);
+	publishFragmentation();
 
-	#ifdef DEBUG_BUDDY
-		log_file << "Debug: Updated m_free_pages = " << m_free_pages << std::endl;
-	#endif
+#ifdef DEBUG_BUDDY
+	log_file << "Debug: Inserted block at order " << order << ", m_free_pages = " << m_free_pages << std::endl;
+#endif
 }
 
 
 double Buddy::getAverageSizeRatio()
 {
-	std::vector<UInt64> blockSizes;
-
-	// Collect sizes of all free blocks
-	for (const auto &list : free_list)
-	{
-		for (const auto &block : list)
-		{
-			// check if the block is contiguous
-			blockSizes.push_back(get<1>(block) - get<0>(block) + 1);
-		}
-	}
-
-	// Sort block sizes in descending order
-	std::sort(blockSizes.rbegin(), blockSizes.rend());
-
-	// Calculate average of top 50 blocks
+	// Calculate average of top 50 blocks; the largest blocks are the ones of the highest orders
 	UInt64 totalSize = 0;
-	int count = 0;
-	for (auto size : blockSizes)
+	UInt64 count = 0;
+	for (int order = m_max_order; order >= 0 && count < 50; order--)
 	{
-		totalSize += size;
-		count++;
-		if (count == 50)
-			break;
+		UInt64 taken = std::min<UInt64>(free_blocks[order], 50 - count);
+		totalSize += taken << order;
+		count += taken;
 	}
 
 	double averageSize = (count > 0) ? (double)totalSize / count : 0.0;
-	return averageSize / pow(2, m_max_order - 3);
+	return averageSize / (double)(1ULL << (m_max_order - 3));
 }
 
 double Buddy::getLargePageRatio()
 {
-	int numberOfLargePages = 0;
+	UInt64 numberOfLargePages = 0;
 
-	// Collect number of 2MB pages based on the free list
-	for (const auto &list : free_list)
+	// Collect number of 2MB pages based on the free lists
+	for (int order = 9; order <= m_max_order; order++)
 	{
-		for (const auto &block : list)
-		{
-			if ((get<1>(block) - get<0>(block) + 1) >= 512)
-			{
-				numberOfLargePages += (get<1>(block) - get<0>(block) + 1) / 512;
-			}
-		}
+		numberOfLargePages += free_blocks[order] << (order - 9);
 	}
 
 	// calculate the ratio of available large pages to the total number of 2MB pages
 	double largePageRatio = (double)numberOfLargePages / (m_total_pages / 512);
 	m_frag_factor = largePageRatio;
 	return largePageRatio;
-}
\ No newline at end of file
+}
@@ -8,6 +8,34 @@
 #include "fixed_types.h"
 #include "vma.h"
 
+class TimeSeriesSink;
+
+/*
+ * Free-block bitmap of a single buddy order: bit i is set when block i (2^order pages) is free.
+ * Each level above the first has one bit per non-empty word of the level below, so finding
+ * the first free block touches one word per level instead of scanning the whole bitmap.
+ */
+class BuddyBitmap{
+
+public:
+    void init(UInt64 num_blocks);
+    bool test(UInt64 idx) const;
+    void set(UInt64 idx);
+    void clear(UInt64 idx);
+    UInt64 findFirst() const;           // Only valid when at least one bit is set
+
+private:
+    UInt64 m_num_blocks;
+    std::vector<std::vector<UInt64>> m_levels; // m_levels[0] is the block bitmap, back() is a single word
+};
+
+/*
+ * Binary buddy allocator over the physical pages after the kernel region.
+ * Block offsets are relative to the first non-kernel page, so a block of order k is always
+ * aligned to 2^k pages and its buddy is found with a single XOR. Every order keeps a
+ * BuddyBitmap and a free-block count; allocate/free/reserve are O(max_order) and the
+ * fragmentation metrics are computed from the counts alone.
+ */
 class Buddy{
 
 public:
@@ -36,11 +64,22 @@ private:
 
     UInt64 m_total_pages;
     UInt64 m_free_pages;
+    UInt64 m_base_page;                 // First page managed by the allocator (right after the kernel)
     std::ofstream log_file;
     std::string log_file_name;
 
-    std::vector<std::vector<std::tuple<UInt64, UInt64, bool, UInt64>>> free_list;
+    std::vector<BuddyBitmap> free_map;  // Indexed by order
+    std::vector<UInt64> free_blocks;    // Number of free blocks per order
 
     double (Buddy::*frag_fun)();
 
-};
\ No newline at end of file
+    TimeSeriesSink *m_fragmentation_series;  // free memory and fragmentation over time, NULL when disabled
+    UInt64 m_series_events;                  // allocations and frees
+
+    static int orderOfPages(UInt64 pages);
+    void insertBlock(UInt64 offset, int order);
+    void removeBlock(UInt64 offset, int order);
+    UInt64 takeBlock(int order, int target_order);
+    void publishFragmentation();
+
+};
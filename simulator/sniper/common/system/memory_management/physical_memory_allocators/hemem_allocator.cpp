@@ -88,19 +88,15 @@ HememAllocator::HememAllocator(String name, UInt64 dram_size, UInt64 nvm_size,
 HememAllocator::~HememAllocator() {
     delete dram_buddy;
     delete nvm_buddy;
-    for (auto& pair : m_active_pages) {
-        delete pair.second;
-    }
-    m_active_pages.clear();
+    // hemem_page records are owned by m_page_pool
 }
 
 // phy_addr here is a PAGE NUMBER (PPN)
 Hemem::hemem_page* HememAllocator::create_active_page(UInt64 phy_addr, bool is_dram) {
-    auto it = m_active_pages.find(phy_addr);
-    if (it != m_active_pages.end()) {
-        Hemem::hemem_page* p = it->second;
+    Hemem::hemem_page* p = m_active_pages.find(phy_addr);
+    if (p != nullptr) {
         if (p->phy_addr != phy_addr) {
-            m_active_pages.erase(it);
+            m_active_pages.erase(phy_addr);
         } else {
             p->present = true;
             p->in_dram = is_dram;
@@ -110,7 +106,7 @@ Hemem::hemem_page* HememAllocator::create_active_page(UInt64 phy_addr, bool is_d
         }
     }
 
-    Hemem::hemem_page *p = new Hemem::hemem_page();
+    p = m_page_pool.allocate();
     p->phy_addr = phy_addr;       // PAGE NUMBER, not byte address
     p->present = true;
     p->in_dram = is_dram;
@@ -119,15 +115,15 @@ Hemem::hemem_page* HememAllocator::create_active_page(UInt64 phy_addr, bool is_d
     p->migrating = false;
     p->pt = Hemem::pagesize_to_pt(PAGE_SIZE);
 
-    m_active_pages[phy_addr] = p;
+    m_active_pages.insert(phy_addr, p);
     return p;
 }
 
 void HememAllocator::destroy_active_page(UInt64 phy_addr) {
-    auto it = m_active_pages.find(phy_addr);
-    if (it != m_active_pages.end()) {
-        delete it->second;
-        m_active_pages.erase(it);
+    Hemem::hemem_page* p = m_active_pages.find(phy_addr);
+    if (p != nullptr) {
+        m_active_pages.erase(phy_addr);
+        m_page_pool.release(p);
     }
 }
 
@@ -37,7 +37,8 @@ private:
     int m_preferred_node = 0; // 0 means dram
     Buddy *dram_buddy;
     Buddy *nvm_buddy;
-    std::unordered_map<UInt64, Hemem::hemem_page*> m_active_pages;
+    Hemem::PageMap m_active_pages;                  // PPN -> page metadata
+    Hemem::PagePool<Hemem::hemem_page> m_page_pool; // Backing storage for all hemem_page records
     // Hemem::fifo_list dram_free_list;
     // Hemem::fifo_list nvm_free_list;
     int page_size = 4096;
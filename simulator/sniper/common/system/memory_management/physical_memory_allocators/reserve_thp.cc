@@ -150,7 +150,7 @@ bool ReservationTHPAllocator::demote_page()
 		if (std::get<1>(two_mb_map[region_2MB])[j])
 			continue;
 
-		buddy_allocator->free(region_begin + j, region_begin + (j + 1));
+		buddy_allocator->free(region_begin + j, region_begin + j);
 	}
 
 #ifdef DEBUG_RESERVATION_THP
@@ -15,12 +15,12 @@
 
 
 
-#define DEBUG
+// #define DEBUG
 
 /*
  * The RestSeg class represents a "segment" of memory with a specialized mapping strategy.
- * It utilizes an internal cache structure (m_RestSeg_cache) to track which addresses (pages)
- * are part of this segment. 
+ * Membership is tracked in a flat, set-associative array that mirrors the hardware
+ * structure: every way holds the tag of the resident page packed with its owner.
  * 
  * - Each RestSeg has a certain size (in MB), page_size (in bits), associativity, 
  *   replacement policy, and hashing scheme.
@@ -35,12 +35,12 @@
  * @param _size Size of the RestSeg in megabytes.
  * @param _page_size Page size used by the RestSeg (log2 of the actual page size in bytes).
  * @param _assoc Associativity of the RestSeg (number of ways).
- * @param _repl Replacement policy used by the RestSeg (e.g., LRU).
+ * @param _repl Replacement policy used by the RestSeg ("lru" or "srrip").
  * @param _hash Hashing scheme used for address mapping.
  * 
  * This constructor initializes the RestSeg object by setting up its configuration parameters,
- * creating necessary internal data structures, and allocating memory for permission filters
- * and tag arrays. It also registers various statistics metrics for tracking performance.
+ * sizing the way array and computing the footprint of the permission filters and tag arrays.
+ * It also registers various statistics metrics for tracking performance.
  */
 
 RestSeg::RestSeg(int _id, int _size, int _page_size, int _assoc, String _repl, String _hash)
@@ -50,22 +50,26 @@ RestSeg::RestSeg(int _id, int _size, int _page_size, int _assoc, String _repl, S
     assoc(_assoc),
     hash(_hash),
     repl(_repl),
+    m_RestSeg_base(0),
     m_RestSeg_conflicts(0),
     m_RestSeg_accesses(0),
-    m_RestSeg_hits(0)
+    m_RestSeg_hits(0),
+    m_allocations(0),
+    m_pagefaults(0),
+    m_valid_ways(0)
 {
   // Create a log file for this particular RestSeg, using the ID as a unique suffix.
   log_file_name = "RestSeg.log." + std::to_string(id);
   log_file_name = std::string(Sim()->getConfig()->getOutputDirectory().c_str()) + "/" + log_file_name;
   log_file.open(log_file_name.c_str());
 
-  // This Lock object protects shared data (e.g., the internal cache) from concurrency issues.
-  RestSeg_lock = new Lock();
-
   // num_sets = number of sets for this "cache-like" data structure
   // k_MEGA is presumably 1,048,576. We convert the size from MB and divide by (#ways * page_size).
   //  (1 << page_size) is the page size in bytes.
-  num_sets = k_MEGA * size / (assoc * (1 << page_size)); // Number of sets in the RestSeg
+  num_sets = k_MEGA * size / (assoc * (1L << page_size)); // Number of sets in the RestSeg
+
+  LOG_ASSERT_ERROR(assoc > 0 && assoc <= 256, "RestSeg %d: associativity %u not supported", id, assoc);
+  LOG_ASSERT_ERROR(num_sets > 0, "RestSeg %d: %lld MB is too small for %u ways of %d-bit pages", id, size, assoc, page_size);
 
 #ifdef DEBUG
   std::cout << std::endl;
@@ -74,70 +78,69 @@ RestSeg::RestSeg(int _id, int _size, int _page_size, int _assoc, String _repl, S
             << " - assoc: " << assoc << std::endl;
 #endif
 
-  /*
-   * m_RestSeg_cache is the core structure that tracks which addresses belong to this RestSeg.
-   *  - The "cache_block_size" is the page size (1 << page_size).
-   *  - "repl" is the replacement policy (e.g., LRU), "hash" is the address-hashing scheme.
-   */
-  m_RestSeg_cache = new Cache(
-    ("RestSeg_cache_" + std::to_string(id)).c_str(),  // Name for the cache
-    "perf_model/utopia/RestSeg",                      // Config key
-    0,                                                // Core ID (0 used here, but not always critical)
-    num_sets,                                         // Number of sets
-    assoc,                                            // Associativity
-    (1L << page_size),                                // Line size (in bytes)
-    repl,
-    CacheBase::PR_L1_CACHE,
-    CacheBase::parseAddressHash(hash)
-  );
+  // Only the set index/tag split of a cache is needed; the ways themselves live in m_ways
+  m_indexing = new CacheBase(("RestSeg_cache_" + std::to_string(id)).c_str(), num_sets, assoc, (1L << page_size),
+                             CacheBase::parseAddressHash(hash));
+
+  m_ways.assign((UInt64)num_sets * assoc, 0);
+  m_repl_state.assign((UInt64)num_sets * assoc, 0);
+
+  if (repl == "lru")
+  {
+    m_repl_policy = REPL_LRU;
+    m_rrip_max = m_rrip_insert = 0;
+    // Ways start out in age order, so the first fills use way 0, 1, ...
+    for (UInt64 set_index = 0; set_index < (UInt64)num_sets; set_index++)
+      for (UInt32 i = 0; i < assoc; i++)
+        m_repl_state[set_index * assoc + i] = i;
+  }
+  else if (repl == "srrip")
+  {
+    m_repl_policy = REPL_SRRIP;
+    UInt32 rrip_numbits = Sim()->getCfg()->getIntArray("perf_model/utopia/RestSeg/srrip/bits", 0);
+    LOG_ASSERT_ERROR(rrip_numbits > 0 && rrip_numbits <= 8, "RestSeg %d: invalid srrip/bits %u", id, rrip_numbits);
+    m_rrip_max = (1 << rrip_numbits) - 1;
+    m_rrip_insert = m_rrip_max - 1;
+    std::fill(m_repl_state.begin(), m_repl_state.end(), m_rrip_insert);
+    m_repl_pointer.assign(num_sets, 0);
+  }
+  else
+  {
+    LOG_PRINT_ERROR("RestSeg %d: unsupported replacement policy %s (use lru or srrip)", id, repl.c_str());
+  }
 
   // filter_size is used by the permission filter to track ownership bits
   filter_size = log2(assoc) + 1;
 
   // In the simplified model, 48 bits for addresses are assumed (x86-64 canonical). 
-  // Subtract page_size and log2(num_sets), then convert to bytes. This is for TAR calculations.
-  tag_size = (48 - page_size - ceil(log2(num_sets))) / 8;
+  // Subtract page_size and log2(num_sets), then round up to bytes. This is for TAR calculations.
+  tag_size = (48 - page_size - (int)ceil(log2(num_sets)) + 7) / 8;
 
-  // TAR_size => total amount of memory for the Tag Array at all sets/ways
-  TAR_size = tag_size * (num_sets * assoc) / 8;
+  // TAR_size => total amount of memory for the Tag Array at all sets/ways (bytes)
+  TAR_size = (UInt64)tag_size * num_sets * assoc;
 
-  // SF_size => total amount of memory for the permission filter data structure
-  SF_size = (num_sets * filter_size) / 8;
+  // SF_size => total amount of memory for the permission filter data structure (bytes)
+  SF_size = ((UInt64)num_sets * filter_size + 7) / 8;
 
   int core_num = Config::getSingleton()->getTotalCores();
 
   /*
-   * For each core, allocate space for:
-   *   - permissions: the "permission filter" data structure
-   *   - tags: the Tag Array
-   * 
-   * We store these base addresses in the 'permissions' and 'tags' vectors. 
-   * Each core has its own region representing the "process" or "address space".
+   * Each core has its own permission filter and tag array, representing the "process"
+   * or "address space". Their emulated physical location is assigned by the allocator
+   * through set_metadata_base().
    */
-  for (int i = 0; i < core_num; i++)
-  {
-#ifdef DEBUG
-    std::cout << "[RestSeg:ID-" << i << "] "
-              << "SF Size (KB): " << SF_size / 1024 << std::endl;
+  permissions.assign(core_num, 0);
+  tags.assign(core_num, 0);
 
-    std::cout << "[RestSeg-ID-" << i << "]"
-              << " TAR entry size: " << tag_size << std::endl;
-
-    std::cout << "[RestSeg-ID-" << i << "] "
-              << "TAR Size (KB): " << TAR_size / 1024 << std::endl;
+#ifdef DEBUG
+  std::cout << "[RestSeg-ID-" << id << "] "
+            << "SF Size (KB): " << SF_size / 1024 << std::endl;
+  std::cout << "[RestSeg-ID-" << id << "]"
+            << " TAR entry size: " << tag_size << std::endl;
+  std::cout << "[RestSeg-ID-" << id << "] "
+            << "TAR Size (KB): " << TAR_size / 1024 << std::endl;
 #endif
 
-    // Allocate memory for "permission filter"
-    char *RestSeg_per_base = (char *)malloc((num_sets * log2(assoc)) / 8);
-
-    // Allocate memory for "tag array"
-    char *RestSeg_tags_base = (char *)malloc(num_sets * (tag_size / 8));  
-
-    // Store the addresses in the relevant vectors so they can be retrieved later
-    permissions.push_back((IntPtr)RestSeg_per_base);
-    tags.push_back((IntPtr)RestSeg_tags_base);
-  }
-
   // Register some statistics that we will track: conflicts, hits, accesses, and allocations
   registerStatsMetric(("RestSeg_" + std::to_string(id)).c_str(), 0, "allocation_conflicts", &m_RestSeg_conflicts);
   registerStatsMetric(("RestSeg_" + std::to_string(id)).c_str(), 0, "hits", &m_RestSeg_hits);
@@ -145,35 +148,135 @@ RestSeg::RestSeg(int _id, int _size, int _page_size, int _assoc, String _repl, S
   registerStatsMetric(("RestSeg_" + std::to_string(id)).c_str(), 0, "allocations", &m_allocations);
 }
 
+void RestSeg::set_metadata_base(int core_id, IntPtr permissions_base, IntPtr tags_base)
+{
+  permissions[core_id] = permissions_base;
+  tags[core_id] = tags_base;
+}
+
 /*
- * inRestSeg(...) checks whether a given address belongs to this RestSeg,
- * specifically for a particular app_id. The address is broken down into
- * set and tag via m_RestSeg_cache->splitAddress(). We then see if any valid
- * block in that set has a matching tag and the matching 'owner' (core_id + 1).
- *
- * Returns true if the address is found (with the correct owner), false otherwise.
+ * findWay(...) returns the way in the set that holds 'tag' for core_id, or -1.
  */
+SInt32 RestSeg::findWay(UInt32 set_index, IntPtr tag, int core_id) const
+{
+  const UInt64 *set = getSet(set_index);
+  const UInt64 entry = packEntry(tag, core_id);
+  for (UInt32 i = 0; i < assoc; i++)
+  {
+    if (set[i] == entry)
+      return i;
+  }
+  return -1;
+}
+
+/*
+ * getReplacementWay(...) picks the way to fill in a set: the first invalid way if there
+ * is one, otherwise the victim chosen by the replacement policy. This follows
+ * CacheSetLRU and CacheSetSRRIP so the choice matches the cache-based model.
+ */
+UInt32 RestSeg::getReplacementWay(UInt32 set_index)
+{
+  const UInt64 *set = getSet(set_index);
+  UInt8 *state = &m_repl_state[(UInt64)set_index * assoc];
+
+  for (UInt32 i = 0; i < assoc; i++)
+  {
+    if (set[i] == 0)
+    {
+      if (m_repl_policy == REPL_SRRIP)
+        state[i] = m_rrip_insert;
+      else
+        updateReplacement(set_index, i);
+      return i;
+    }
+  }
+
+  if (m_repl_policy == REPL_LRU)
+  {
+    UInt32 index = 0;
+    for (UInt32 i = 1; i < assoc; i++)
+    {
+      if (state[i] > state[index])
+        index = i;
+    }
+    updateReplacement(set_index, index);
+    return index;
+  }
+
+  // SRRIP: the first way predicted "distant" from the replacement pointer on; age the set until there is one
+  UInt8 &pointer = m_repl_pointer[set_index];
+  for (UInt32 j = 0; j <= m_rrip_max; j++)
+  {
+    for (UInt32 i = 0; i < assoc; i++)
+    {
+      UInt32 index = pointer;
+      pointer = (pointer + 1) % assoc;
+      if (state[index] >= m_rrip_max)
+      {
+        state[index] = m_rrip_insert;
+        return index;
+      }
+    }
+    for (UInt32 i = 0; i < assoc; i++)
+    {
+      if (state[i] < m_rrip_max)
+        state[i]++;
+    }
+  }
+
+  LOG_PRINT_ERROR("RestSeg %d: error finding replacement way", id);
+}
+
+void RestSeg::updateReplacement(UInt32 set_index, UInt32 way)
+{
+  UInt8 *state = &m_repl_state[(UInt64)set_index * assoc];
+
+  if (m_repl_policy == REPL_SRRIP)
+  {
+    if (state[way] > 0)
+      state[way]--;
+    return;
+  }
+
+  // LRU: move way to MRU, everything younger than it ages by one
+  for (UInt32 i = 0; i < assoc; i++)
+  {
+    if (state[i] < state[way])
+      state[i]++;
+  }
+  state[way] = 0;
+}
+
 /**
- * @brief Checks if a given address is within the RestSeg cache and optionally counts statistics.
+ * @brief Looks up an address for a core and returns everything a RestSeg walk needs.
  *
- * This function checks if a given address is present in the RestSeg cache and whether it belongs to the correct core.
- * It also optionally increments access and hit statistics.
+ * One pass over the set answers membership, the permission filter, and the TAR/SF
+ * entries the walker reads, under a single acquisition of the RestSeg lock.
  *
- * @param address The address to check within the RestSeg cache.
- * @param count A boolean flag indicating whether to count statistics for this lookup.
- * @param now The current time, used for cache access timing.
+ * @param address The address to look up.
+ * @param count Whether to count statistics for this lookup.
  * @param core_id The ID of the core making the request.
- * @return True if the address is owned by the correct core, false otherwise.
+ * @return The probe result; physical_address is only valid on a hit.
  */
-bool RestSeg::inRestSeg(IntPtr address, bool count, SubsecondTime now, int core_id)
+RestSeg::Probe RestSeg::probe(IntPtr address, bool count, int core_id)
 {
-#ifdef DEBUG
-  log_file << std::endl;
-  log_file << "--------------------------------" << std::endl;
-#endif
+  IntPtr tag;
+  UInt32 set_index;
+  m_indexing->splitAddress(address, tag, set_index);
+
+  Probe result;
+  result.hit = false;
+  result.set_empty = true;
+  result.permission_address = permissions[core_id] + ((UInt64)set_index * filter_size) / 8;
+  result.tag_address = tags[core_id] + (UInt64)set_index * assoc * tag_size;
+  result.physical_address = static_cast<IntPtr>(-1);
+
+  const UInt64 owner = (UInt64)(core_id + 1);
+  SInt32 way = -1;
+  SInt32 tag_way = -1;
 
-  // Lock ensures thread-safety when checking or modifying the cache structure
-  RestSeg_lock->acquire();
+  // Lock ensures thread-safety when checking or modifying the way array
+  RestSeg_lock.acquire();
 
   // If we are counting stats for this lookup, increment the number of accesses
   if (count)
@@ -185,177 +288,132 @@ bool RestSeg::inRestSeg(IntPtr address, bool count, SubsecondTime now, int core_
     track_utilization();
   }
 
-  // We do a "Cache::LOAD" lookup in m_RestSeg_cache to see if it’s present at all
-  bool hit = m_RestSeg_cache->accessSingleLine(address, Cache::LOAD, NULL, 0, now, true);
-
-  // Break down the address into its cache tag and set index
-  IntPtr tag;
-  UInt32 set_index;
-  m_RestSeg_cache->splitAddress(address, tag, set_index);
-
-  bool owner_hit = false; // This specifically checks whether the block belongs to the correct app
-
-#ifdef DEBUG
-  log_file << "Checking if address: " << address << " is in RestSeg" << std::endl;
-  log_file << "Tag: " << tag << std::endl;
-  log_file << "Set index: " << set_index << std::endl;
-#endif
+  const UInt64 *set = getSet(set_index);
+  for (UInt32 i = 0; i < assoc; i++)
+  {
+    if (entryOwner(set[i]) != owner)
+      continue;
+    result.set_empty = false;
+    if (entryTag(set[i]) == tag)
+    {
+      way = i;
+      break;
+    }
+  }
 
-  // We search within the set for a block with matching tag *and* matching owner
-  for (UInt32 i = 0; i < m_RestSeg_cache->getCacheSet(set_index)->getAssociativity(); i++)
+  // Like the former cache lookup, the replacement state follows the first way with a matching tag, whoever owns it
+  for (UInt32 i = 0; i < assoc; i++)
   {
-    if ((m_RestSeg_cache->peekBlock(set_index, i)->getTag() == tag) &&
-        (m_RestSeg_cache->peekBlock(set_index, i)->getOwner() == (UInt64)(core_id + 1)))
+    if (set[i] != 0 && entryTag(set[i]) == tag)
     {
-#ifdef DEBUG
-      log_file << "It is probably inside way: " << i << std::endl;
-#endif
-      // For usage stats, we might increment a reuse counter
-      m_RestSeg_cache->peekBlock(set_index, i)->increaseReuse();
-      owner_hit = true;
+      tag_way = i;
       break;
     }
   }
+  if (tag_way >= 0)
+    updateReplacement(set_index, tag_way);
+
+  if (way >= 0)
+  {
+    result.hit = true;
+    result.tag_address = tags[core_id] + ((UInt64)set_index * assoc + way) * tag_size;
+
+    // The final physical frame (in 4KB units) is offset by the page size factor
+    int factor = 1 << (page_size - 12);
+    result.physical_address = m_RestSeg_base + ((UInt64)set_index * assoc + way) * factor;
+
+    if (count)
+      m_RestSeg_hits++;
+  }
+
+  RestSeg_lock.release();
 
 #ifdef DEBUG
-  log_file << "Owner hit: " << owner_hit << std::endl;
-  log_file << "RestSeg hit: " << hit << std::endl;
+  log_file << "Probe address: " << address << " tag: " << tag << " set: " << set_index
+           << " way: " << way << " set_empty: " << result.set_empty << std::endl;
 #endif
 
-  // If we're counting stats and the correct owner was found, increment hits
-  if (count && owner_hit)
-    m_RestSeg_hits++;
-
-  RestSeg_lock->release();
+  return result;
+}
 
-  // The final returned value is specifically "did the correct core own this address"?
-  return (owner_hit);
+/*
+ * inRestSeg(...) checks whether a given address belongs to this RestSeg,
+ * specifically for a particular app_id: some way in the address' set has a
+ * matching tag and the matching 'owner' (core_id + 1).
+ */
+bool RestSeg::inRestSeg(IntPtr address, bool count, SubsecondTime now, int core_id)
+{
+  return probe(address, count, core_id).hit;
 }
 
 /*
  * Given an address, returns the "permission address" used by the permission filter
  * (SF). This address is effectively an offset into the permission array for 
  * a particular core (based on set_index).
- *
- * The RestSeg_cache is used only to get the set_index from the address;
- * filter_size * set_index indicates which location in 'permissions[core_id]' 
- * we should read or write.
- */
-/**
- * @brief Calculates the permission address for a given memory address and core ID.
- *
- * This function computes the permission address by splitting the input address
- * into a tag and set index, and then using the set index to determine the offset
- * within the permissions array for the specified core.
- *
- * @param address The memory address for which the permission address is to be calculated.
- * @param core_id The ID of the core for which the permission address is to be calculated.
- * @return The calculated permission address as an IntPtr.
  */
 IntPtr RestSeg::calculate_permission_address(IntPtr address, int core_id)
 {
   IntPtr tag;
   UInt32 set_index;
-  m_RestSeg_cache->splitAddress(address, tag, set_index);
+  m_indexing->splitAddress(address, tag, set_index);
 
-#ifdef DEBUG
-  log_file << std::endl;
-  log_file << "--------------------------------" << std::endl;
-  log_file << "Calculating permission address for address: " << address << std::endl;
-  log_file << "Accessing permission " << permissions[core_id] + (set_index * filter_size) / 8 << std::endl;
-  log_file << "Permissions base: " << permissions[core_id] << std::endl;
-  log_file << "Set index: " << set_index << std::endl;
-  log_file << "Filter size: " << filter_size << std::endl;
-  log_file << "--------------------------------" << std::endl;
-#endif
-
-  // Return the pointer-like offset for this set
-  return (IntPtr)(permissions[core_id] + (set_index * filter_size) / 8);
+  return (IntPtr)(permissions[core_id] + ((UInt64)set_index * filter_size) / 8);
 }
 
 /*
  * Similar to calculate_permission_address, but for the Tag Array (TAR).
- * We again derive set_index from the address, then find which way in the set 
- * is correct. We then compute an offset (set_index * assoc + i) * tag_size 
- * into the 'tags[core_id]' array.
+ * We compute an offset (set_index * assoc + way) * tag_size into the
+ * 'tags[core_id]' array.
  *
  * Returns 0 if we did not find the address/owner combination in the set.
  */
-/**
- * @brief Calculate the tag address for a given memory address and core ID.
- *
- * This function calculates the tag address for a given memory address and core ID
- * by checking each way in the cache set for a matching tag and owner. If a match
- * is found, it returns the calculated tag address. If no match is found, it returns 0.
- *
- * @param address The memory address for which the tag address is to be calculated.
- * @param core_id The ID of the core requesting the tag address.
- * @return The calculated tag address if a match is found, otherwise 0.
- */
 IntPtr RestSeg::calculate_tag_address(IntPtr address, int core_id)
 {
   IntPtr tag;
   UInt32 set_index;
-  m_RestSeg_cache->splitAddress(address, tag, set_index);
+  m_indexing->splitAddress(address, tag, set_index);
 
-  // Check each way for a matching tag and owner
-  for (UInt32 i = 0; i < m_RestSeg_cache->getCacheSet(set_index)->getAssociativity(); i++)
-  {
-    if ((m_RestSeg_cache->peekBlock(set_index, i)->getTag() == tag) &&
-        (m_RestSeg_cache->peekBlock(set_index, i)->getOwner() == (UInt64)(core_id + 1)))
-    {
-#ifdef DEBUG
-      log_file << std::endl;
-      log_file << "--------------------------------" << std::endl;
-      log_file << "Calculating tag address for address: " << address << std::endl;
-      log_file << "Accessing tag " << tags[core_id] + (set_index * assoc + i) * tag_size << std::endl;
-      log_file << "Tag base: " << tags[core_id] << std::endl;
-      log_file << "Set index: " << set_index << std::endl;
-      log_file << "Tag size: " << tag_size << std::endl;
-      log_file << "--------------------------------" << std::endl;
-#endif
-      return (IntPtr)(tags[core_id] + (set_index * assoc + i) * tag_size);
-    }
-  }
-  // Not found => 0
-  return 0;
+  SInt32 way = findWay(set_index, tag, core_id);
+  if (way < 0)
+    return 0;
+  return (IntPtr)(tags[core_id] + ((UInt64)set_index * assoc + way) * tag_size);
 }
 
 /*
  * permission_filter(...) checks if a particular set for 'address' is empty
- * of valid blocks (or at least empty of blocks owned by this core). If yes,
- * we can skip certain steps (like a tag match) as an optimization.
+ * of blocks owned by this core. If yes, we can skip certain steps (like a
+ * tag match) as an optimization.
  *
  * Returns true if the set is empty, false otherwise.
  */
 bool RestSeg::permission_filter(IntPtr address, int core_id)
 {
-  RestSeg_lock->acquire();
-
   IntPtr tag;
   UInt32 set_index;
   bool set_is_empty = true;
 
-  m_RestSeg_cache->splitAddress(address, tag, set_index);
+  m_indexing->splitAddress(address, tag, set_index);
+
+  RestSeg_lock.acquire();
 
-  // If any valid block in the set is owned by this core, then it's not empty
-  for (UInt32 i = 0; i < m_RestSeg_cache->getCacheSet(set_index)->getAssociativity(); i++)
+  const UInt64 *set = getSet(set_index);
+  for (UInt32 i = 0; i < assoc; i++)
   {
-    if (m_RestSeg_cache->getCacheSet(set_index)->peekBlock(i)->isValid() &&
-        m_RestSeg_cache->getCacheSet(set_index)->peekBlock(i)->getOwner() == (UInt64)(core_id + 1))
+    if (entryOwner(set[i]) == (UInt64)(core_id + 1))
     {
       set_is_empty = false;
+      break;
     }
   }
 
-  RestSeg_lock->release();
+  RestSeg_lock.release();
   return set_is_empty;
 }
 
 /*
- * allocate(...) inserts 'address' into the RestSeg cache if there is capacity.
+ * allocate(...) inserts 'address' into the RestSeg if there is capacity.
  * If forced == true, we attempt insertion regardless of capacity. 
- * If a line must be evicted, we return the evicted address so that 
+ * If a way must be evicted, we return the evicted address so that 
  * the caller can handle it (e.g., place it in the FlexSeg).
  *
  * Returns a tuple: 
@@ -365,97 +423,61 @@ bool RestSeg::permission_filter(IntPtr address, int core_id)
  */
 std::tuple<bool, bool, IntPtr> RestSeg::allocate(IntPtr address, SubsecondTime now, int core_id, bool forced)
 {
-#ifdef DEBUG
-  log_file << std::endl;
-  log_file << "---------------------------" << std::endl;
-#endif
-
-  RestSeg_lock->acquire();
-
   IntPtr tag;
   UInt32 set_index;
-  bool eviction;
-  IntPtr evict_addr;
-  CacheBlockInfo evict_block_info;
+  m_indexing->splitAddress(address, tag, set_index);
+
+  LOG_ASSERT_ERROR(entryTag(tag << OWNER_BITS) == tag, "RestSeg %d: tag %lx does not fit a way entry", id, tag);
+  LOG_ASSERT_ERROR((UInt64)(core_id + 1) <= OWNER_MASK, "RestSeg %d: core %d does not fit a way entry", id, core_id);
 
 #ifdef DEBUG
   log_file << "Allocating address: " << address 
-           << " in RestSeg with page size: " << page_size << std::endl;
+           << " in RestSeg with page size: " << page_size
+           << " set_index: " << set_index << " tag: " << tag << std::endl;
 #endif
 
+  RestSeg_lock.acquire();
+
   // Track how many allocations we've made
   m_allocations++;
 
-  // Determine the set index and tag for the address
-  m_RestSeg_cache->splitAddress(address, tag, set_index);
-
-#ifdef DEBUG
-  log_file << "Checking if all ways are occupied" << std::endl;
-#endif
   // We first check if the set has a free way, unless forced == true
+  const UInt64 *set = getSet(set_index);
   bool all_ways_occupied = true;
-  for (UInt32 i = 0; i < m_RestSeg_cache->getCacheSet(set_index)->getAssociativity(); i++)
+  for (UInt32 i = 0; i < assoc; i++)
   {
-    if (!m_RestSeg_cache->peekBlock(set_index, i)->isValid())
+    if (set[i] == 0)
     {
       all_ways_occupied = false;
       break;
     }
   }
 
-#ifdef DEBUG
-  log_file << "All ways are occupied: " << all_ways_occupied << std::endl;
-#endif
-
-  // If there is a free way or if forced is true, we can insert the line
-  if (!all_ways_occupied || forced)
-  {
-    m_RestSeg_cache->insertSingleLine(address, NULL, &eviction, &evict_addr, &evict_block_info, NULL, now);
-  }
-  else
+  if (all_ways_occupied && !forced)
   {
 #ifdef DEBUG
     log_file << "All ways are occupied, we cannot allocate the address" << std::endl;
 #endif
-    RestSeg_lock->release();
+    RestSeg_lock.release();
     return (std::make_tuple(false, false, static_cast<IntPtr>(-1)));
   }
 
-#ifdef DEBUG
-  log_file << "Adding address with set_index: " << set_index 
-           << " and tag: " << tag << std::endl;
-#endif
-
-  /*
-   * After insertion, we iterate over the set again to find which way we just inserted.
-   * We set the "owner" field to (core_id + 1) so that inRestSeg(...) checks can
-   * confirm ownership.
-   */
-  for (UInt32 i = 0; i < m_RestSeg_cache->getCacheSet(set_index)->getAssociativity(); i++)
-  {
-    if (m_RestSeg_cache->peekBlock(set_index, i)->getTag() == tag &&
-        m_RestSeg_cache->peekBlock(set_index, i)->getOwner() == 0)
-    {
-#ifdef DEBUG
-      log_file << "Found where we inserted the block: in way " << i << std::endl;
-#endif
-      m_RestSeg_cache->peekBlock(set_index, i)->setOwner(core_id + 1);
-      break;
-    }
-  }
-
-#ifdef DEBUG
-  log_file << " Caused eviction?: " << eviction << std::endl;
-#endif
+  UInt32 way = getReplacementWay(set_index);
+  UInt64 &entry = m_ways[(UInt64)set_index * assoc + way];
 
-  // If an eviction occurred, increment the conflict counter
+  bool eviction = (entry != 0);
+  IntPtr evict_addr = eviction ? (entryTag(entry) << page_size) : static_cast<IntPtr>(-1);
   if (eviction)
     m_RestSeg_conflicts++;
+  else
+    m_valid_ways++;
+
+  entry = packEntry(tag, core_id);
 
-  RestSeg_lock->release();
+  RestSeg_lock.release();
 
 #ifdef DEBUG
-  log_file << "---------------------------" << std::endl;
+  log_file << "Inserted in way " << way << ", caused eviction?: " << eviction << std::endl;
 #endif
 
   // Return (success, eviction, evicted_address)
@@ -474,61 +496,27 @@ IntPtr RestSeg::calculate_physical_address(IntPtr address, int core_id)
 {
   IntPtr tag;
   UInt32 set_index;
-  m_RestSeg_cache->splitAddress(address, tag, set_index);
+  m_indexing->splitAddress(address, tag, set_index);
 
-  // Search for a matching block
-  for (UInt32 i = 0; i < m_RestSeg_cache->getCacheSet(set_index)->getAssociativity(); i++)
-  {
-    if (m_RestSeg_cache->peekBlock(set_index, i)->getTag() == tag &&
-        m_RestSeg_cache->getCacheSet(set_index)->peekBlock(i)->getOwner() == (UInt64)(core_id + 1))
-    {
-      // base_page_size = 4KB
-      int base_page_size = 12; // bits
-      int factor = pow(2, page_size - base_page_size);
+  SInt32 way = findWay(set_index, tag, core_id);
+  if (way < 0)
+    return static_cast<IntPtr>(-1);
 
-#ifdef DEBUG
-      log_file << "---------------------------" << std::endl;
-      log_file << "Finalized RSW for address: " << address << std::endl;
-      log_file << "Calculating physical address for address: " << address << std::endl;
-      log_file << "Set index: " << set_index << std::endl;
-      log_file << "Tag: " << tag << std::endl;
-      log_file << "RestSeg base: " << m_RestSeg_base << std::endl;
-      log_file << "RestSeg page size: " << page_size << std::endl;
-      log_file << "RestSeg assoc: " << assoc << std::endl;
-      log_file << "RestSeg way: " << i << std::endl;
-      log_file << "Physical page (4KB) granularity: " 
-               << (IntPtr)(m_RestSeg_base + (set_index * assoc + i) * factor)
-               << std::endl;
-      log_file << "---------------------------" << std::endl;
-#endif
+  // base_page_size = 4KB
+  int base_page_size = 12; // bits
+  int factor = 1 << (page_size - base_page_size);
 
-      // The final physical frame (in 4KB units) is offset by factor
-      return (IntPtr)(m_RestSeg_base + (set_index * assoc + i) * factor);
-    }
-  }
-
-  // Not found
-  return static_cast<IntPtr>(-1);
+  // The final physical frame (in 4KB units) is offset by factor
+  return (IntPtr)(m_RestSeg_base + ((UInt64)set_index * assoc + way) * factor);
 }
 
 /*
- * track_utilization() counts how many valid blocks exist in the entire RestSeg cache
- * and pushes that count into the 'utilization' vector. 
+ * track_utilization() pushes the number of valid ways in the RestSeg into the
+ * 'utilization' vector. Ways are never invalidated, so a running count suffices.
  */
 void RestSeg::track_utilization()
 {
-  int accum = 0;
-
-  for (uint32_t set_index = 0; set_index < m_RestSeg_cache->getNumSets(); ++set_index)
-  {
-    for (uint32_t i = 0; i < m_RestSeg_cache->getCacheSet(set_index)->getAssociativity(); i++)
-    {
-      if (m_RestSeg_cache->getCacheSet(set_index)->peekBlock(i)->isValid())
-        accum += 1;
-    }
-  }
-
-  utilization.push_back(accum);
+  utilization.push_back(m_valid_ways);
 }
 
 /*
@@ -590,6 +578,15 @@ Utopia::Utopia(String name, int memory_size, int max_order, int kernel_size, Str
     // Set the base physical address for this RestSeg so we know where it begins
     RestSeg_object->set_base(handle_page_table_allocations(RestSeg_object->getSize() * 1024 * 1024));
 
+    // Place each core's permission filter and tag array in the kernel region as well, so the
+    // RestSeg walk reads them from real (emulated) physical addresses
+    for (int core_id = 0; core_id < (int)Config::getSingleton()->getTotalCores(); core_id++)
+    {
+      IntPtr permissions_base = handle_fine_grained_page_table_allocations((RestSeg_object->getPermissionFilterBytes() + 63) & ~63ULL);
+      IntPtr tags_base = handle_fine_grained_page_table_allocations((RestSeg_object->getTagArrayBytes() + 63) & ~63ULL);
+      RestSeg_object->set_metadata_base(core_id, permissions_base, tags_base);
+    }
+
     RestSeg_vector.push_back(RestSeg_object);
   }
 
@@ -650,10 +647,11 @@ std::pair<UInt64, UInt64> Utopia::allocate(UInt64 size, UInt64 address, UInt64 c
 #ifdef DEBUG
         log_file << "Evicted address: " << std::get<2>(allocation_result) << std::endl;
 #endif
-        auto ppn_flexseg = buddy_allocator->allocate(size, std::get<2>(allocation_result), core_id);
-
 #ifdef DEBUG
+        auto ppn_flexseg = buddy_allocator->allocate(size, std::get<2>(allocation_result), core_id);
         log_file << "Evicted address allocated in the FlexSeg: " << ppn_flexseg << std::endl;
+#else
+        buddy_allocator->allocate(size, std::get<2>(allocation_result), core_id);
 #endif
       }
 
@@ -783,9 +781,9 @@ Utopia::~Utopia()
 }
 
 /*
- * RestSeg destructor: deletes the internal RestSeg cache structure.
+ * RestSeg destructor: deletes the set indexing helper.
  */
 RestSeg::~RestSeg()
 {
-  delete m_RestSeg_cache;
+  delete m_indexing;
 }
@@ -15,6 +15,7 @@
 #include "hash_map_set.h"
 #include "physical_memory_allocator.h"
 #include "buddy_allocator.h"
+#include "lock.h"
 
 
 using namespace std;
@@ -25,6 +26,23 @@ class RestSeg
 
         // @kanellok: Add Replacement Policy in a RestSeg
 private:
+        /*
+         * RestSeg state is kept the way the hardware lays it out: one flat array with an
+         * entry per way, indexed by set_index * assoc + way. Each entry packs the tag of the
+         * resident page with its owner (core_id + 1) in the low OWNER_BITS; an entry of 0 is
+         * an invalid way, since owners start at 1. Replacement state is a byte per way
+         * (SRRIP re-reference prediction or LRU age) plus, for SRRIP, a replacement pointer
+         * per set.
+         */
+        static const UInt32 OWNER_BITS = 16;
+        static const UInt64 OWNER_MASK = (1ULL << OWNER_BITS) - 1;
+
+        enum repl_policy_t
+        {
+                REPL_LRU,
+                REPL_SRRIP
+        };
+
         int id;
         long long int size;
         int page_size; // RestSeg can be 4KB, 2MB, 1GB
@@ -32,8 +50,8 @@ private:
         String hash;
         String repl;
         int num_sets;
-        int TAR_size;
-        int SF_size;
+        UInt64 TAR_size;
+        UInt64 SF_size;
         int filter_size;
         int tag_size;
 
@@ -42,11 +60,15 @@ private:
         UInt64 m_RestSeg_conflicts,
             m_RestSeg_accesses, m_RestSeg_hits, m_allocations, m_pagefaults;
 
-        std::unordered_map<IntPtr, bool> vpn_container; // container to check if vpn is inside RestSeg
-
-        IntPtr RestSeg_tags_base; // Used to perform mem access
-        IntPtr RestSeg_permissions_base;
+        CacheBase *m_indexing;              // set index/tag split, honours the configured address hash
+        std::vector<UInt64> m_ways;         // num_sets * assoc packed (tag, owner) entries
+        std::vector<UInt8> m_repl_state;    // num_sets * assoc
+        std::vector<UInt8> m_repl_pointer;  // num_sets, SRRIP only
+        repl_policy_t m_repl_policy;
+        UInt8 m_rrip_max, m_rrip_insert;
+        UInt64 m_valid_ways;
 
+        // Emulated physical base of the permission filter (SF) and tag array (TAR) of each core
         std::vector<IntPtr> permissions;
         std::vector<IntPtr> tags;
 
@@ -55,26 +77,42 @@ private:
         std::ofstream log_file;
         std::string log_file_name;
 
+        static UInt64 packEntry(IntPtr tag, int core_id) { return (tag << OWNER_BITS) | (UInt64)(core_id + 1); }
+        static IntPtr entryTag(UInt64 entry) { return entry >> OWNER_BITS; }
+        static UInt64 entryOwner(UInt64 entry) { return entry & OWNER_MASK; }
+
+        const UInt64 *getSet(UInt32 set_index) const { return &m_ways[(UInt64)set_index * assoc]; }
+        SInt32 findWay(UInt32 set_index, IntPtr tag, int core_id) const;
+        UInt32 getReplacementWay(UInt32 set_index);
+        void updateReplacement(UInt32 set_index, UInt32 way);
+
 public:
+        struct Probe
+        {
+                bool hit;                  // the address is resident and owned by core_id
+                bool set_empty;            // no way in the set is owned by core_id (permission filter)
+                IntPtr permission_address; // SF entry of the set
+                IntPtr tag_address;        // TAR entry of the matching way, or of the set's first way on a miss
+                IntPtr physical_address;   // 4KB frame number, valid on a hit
+        };
+
         std::vector<int> utilization;
-        Cache *m_RestSeg_cache;
-        Lock *RestSeg_lock; // We need to lock RestSeg every time we read/modify
+        Lock RestSeg_lock; // We need to lock RestSeg every time we read/modify
 
         RestSeg(int id, int size, int page_size, int assoc, String repl, String hash_function);
         ~RestSeg();
 
 
+        Probe probe(IntPtr address, bool count, int core_id);
         bool inRestSeg(IntPtr address, bool count, SubsecondTime now, int core_id);
         std::tuple<bool,bool,IntPtr> allocate(IntPtr address, SubsecondTime now, int core_id, bool forced=false);
         bool permission_filter(IntPtr address, int core_id);
 
         int getSize() { return size; }
-        std::unordered_map<IntPtr, bool> getVpnContainer() { return vpn_container; }
         int getPageSize() { return page_size; }
         int getAssoc() { return assoc; }
-        std::vector<IntPtr> getPermissionsVector() { return permissions; }
-        IntPtr getPermissions() { return RestSeg_permissions_base; }
-        IntPtr getTags() { return RestSeg_tags_base; }
+        UInt64 getPermissionFilterBytes() const { return SF_size; }
+        UInt64 getTagArrayBytes() const { return TAR_size; }
 
         IntPtr calculate_permission_address(IntPtr address, int core_id);
         IntPtr calculate_tag_address(IntPtr address, int core_id);
@@ -82,6 +120,7 @@ public:
         void track_utilization();
 
         void set_base(IntPtr base) { m_RestSeg_base = base; }
+        void set_metadata_base(int core_id, IntPtr permissions_base, IntPtr tags_base);
 };
 
 class Utopia : public PhysicalMemoryAllocator
@@ -27,6 +27,8 @@
 #include "instruction_tracer.h"
 #include "memory_tracker.h"
 #include "circular_log.h"
+#include "translation_trace.h"
+#include "time_series_sink.h"
 #include "mimicos.h"
 #include <sstream>
 #include "thread.h"
@@ -141,6 +143,8 @@ void Simulator::start()
 	else
 		m_trace_manager = NULL;
 
+	TranslationTrace::init();
+
 	m_mimicos = new MimicOS(false); // Create a new VirtuOS object for the host OS
 
 	virtualized_system = Sim()->getCfg()->getBool("general/virtualized_environment");
@@ -239,6 +243,9 @@ Simulator::~Simulator()
 
 	m_transport->barrier();
 
+	TranslationTrace::fini();
+	TimeSeriesSink::fini();
+
 	if (m_rtn_tracer)
 	{
 		delete m_rtn_tracer;
@@ -0,0 +1,43 @@
+#include "decoded_instruction_cache.h"
+#include "simulator.h"
+
+#include <mutex>
+
+DecodedInstructionCache::~DecodedInstructionCache()
+{
+   for(UInt32 i = 0; i < NUM_SHARDS; ++i)
+      for(auto it = m_shards[i].entries.begin(); it != m_shards[i].entries.end(); ++it)
+         delete it->second;
+}
+
+const dl::DecodedInst* DecodedInstructionCache::get(const Sift::Instruction &inst, dl::DecoderFactory *factory)
+{
+   Key key = {};
+   key.addr = inst.sinst->addr;
+   key.size = inst.sinst->size;
+   key.isa = inst.isa;
+   memcpy(key.data, inst.sinst->data, key.size);
+
+   size_t hash = KeyHash()(key);
+   Shard &shard = m_shards[(hash >> 32) % NUM_SHARDS];
+
+   {
+      std::shared_lock<std::shared_mutex> lock(shard.lock);
+      auto it = shard.entries.find(key);
+      if (it != shard.entries.end())
+         return it->second;
+   }
+
+   std::unique_lock<std::shared_mutex> lock(shard.lock);
+   auto result = shard.entries.emplace(key, (const dl::DecodedInst*)NULL);
+   if (result.second)
+   {
+      // Decoded instructions keep pointing to their encoding bytes. Use the copy in the table's key,
+      // the StaticInstruction of the Sift reader goes away with the thread that read it first.
+      const Key &stored = result.first->first;
+      dl::DecodedInst *dec_inst = factory->CreateInstruction(Sim()->getDecoder(), stored.data, stored.size, stored.addr);
+      Sim()->getDecoder()->decode(dec_inst, (dl::dl_isa)inst.isa);
+      result.first->second = dec_inst;
+   }
+   return result.first->second;
+}
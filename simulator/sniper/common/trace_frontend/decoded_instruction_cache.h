@@ -0,0 +1,65 @@
+#ifndef __DECODED_INSTRUCTION_CACHE_H
+#define __DECODED_INSTRUCTION_CACHE_H
+
+#include "fixed_types.h"
+#include "sift_reader.h"
+
+#include <decoder.h>
+
+#include <cstring>
+#include <shared_mutex>
+#include <unordered_map>
+
+// Process-wide cache of decoded static instructions, shared by all TraceThreads.
+// An instruction is identified by its address, ISA and encoding bytes, so copies of the same
+// binary replayed by different threads share one decoded instruction, while different binaries
+// that happen to use the same address do not alias. Decoded instructions are never evicted and
+// live until the end of the simulation, so the returned pointers stay valid.
+// The table is split in shards with a reader-writer lock each: after warmup nearly all accesses
+// are lookups, which only take the shard's lock in shared mode. TraceThread keeps a small
+// direct-mapped front cache in front of this, so most dynamic instructions never get here.
+class DecodedInstructionCache
+{
+   private:
+      struct Key
+      {
+         uint64_t addr;
+         uint8_t size;
+         uint8_t isa;
+         uint8_t data[16];
+
+         bool operator==(const Key &other) const
+         {
+            return addr == other.addr && size == other.size && isa == other.isa && memcmp(data, other.data, size) == 0;
+         }
+      };
+
+      struct KeyHash
+      {
+         size_t operator()(const Key &key) const
+         {
+            uint64_t hash = key.addr * 0x9E3779B97F4A7C15ULL;
+            for(uint8_t i = 0; i < key.size; ++i)
+               hash = (hash ^ key.data[i]) * 0x100000001B3ULL;
+            return hash ^ (hash >> 29);
+         }
+      };
+
+      struct alignas(64) Shard
+      {
+         std::shared_mutex lock;
+         std::unordered_map<Key, const dl::DecodedInst*, KeyHash> entries;
+      };
+
+      static const UInt32 NUM_SHARDS = 64;
+      Shard m_shards[NUM_SHARDS];
+
+   public:
+      ~DecodedInstructionCache();
+
+      // Returns the decoded instruction for inst, decoding it (using factory) if no thread has done so yet.
+      // Decoding happens under the shard's exclusive lock, so every instruction is decoded only once.
+      const dl::DecodedInst* get(const Sift::Instruction &inst, dl::DecoderFactory *factory);
+};
+
+#endif // __DECODED_INSTRUCTION_CACHE_H
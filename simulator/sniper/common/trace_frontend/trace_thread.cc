@@ -26,6 +26,7 @@
 #include <x86_decoder.h>  // TODO remove when the decode function in microop perf model is adapted
 
 int TraceThread::m_isa = 0;
+DecodedInstructionCache TraceThread::s_decoded_cache;
 
 TraceThread::TraceThread(Thread *thread, SubsecondTime time_start, String tracefile, String responsefile, app_id_t app_id, bool cleanup)
    : m__thread(NULL)
@@ -78,6 +79,9 @@ TraceThread::TraceThread(Thread *thread, SubsecondTime time_start, String tracef
       }
    }
 
+   for(UInt32 i = 0; i < DECODED_FRONT_SIZE; ++i)
+      m_decoded_front[i] = DecodedEntry{ IntPtr(-1), NULL, NULL };
+
    thread->setVa2paFunc(_va2pa, (UInt64)this);
    
 }
@@ -90,10 +94,6 @@ TraceThread::~TraceThread()
       unlink(m_tracefile.c_str());
       unlink(m_responsefile.c_str());
    }
-   for(std::unordered_map<IntPtr, const dl::DecodedInst *>::iterator i = m_decoder_cache.begin() ; i != m_decoder_cache.end() ; ++i)
-   {
-      delete (*i).second;
-   }
 }
 
 UInt64 TraceThread::va2pa(UInt64 va, bool *noMapping)
@@ -375,15 +375,28 @@ SubsecondTime TraceThread::getCurrentTime() const
    return m_thread->getCore()->getPerformanceModel()->getElapsedTime();
 }
 
-Instruction* TraceThread::decode(Sift::Instruction &inst)
+const TraceThread::DecodedEntry& TraceThread::getDecoded(Sift::Instruction &inst, bool need_instruction)
 {
+   IntPtr addr = inst.sinst->addr;
+   DecodedEntry &front = m_decoded_front[(addr ^ (addr >> 12)) % DECODED_FRONT_SIZE];
+   if (front.addr == addr && (front.instruction || !need_instruction))
+      return front;
+
+   auto result = m_icache.emplace(addr, DecodedEntry{ addr, NULL, NULL });
+   DecodedEntry &entry = result.first->second;
+   if (result.second)
+      entry.decoded = s_decoded_cache.get(inst, m_factory);
+   if (need_instruction && entry.instruction == NULL)
+      entry.instruction = decode(inst, *entry.decoded);
+
+   front = entry;
+   return front;
+}
 
-   //printf("PC: %lx Size: %d num_addresses=%d is_branch=%d\n", inst.sinst->addr, inst.sinst->size, inst.num_addresses, inst.is_branch);
-   if (m_decoder_cache.count(inst.sinst->addr) == 0)
-      m_decoder_cache[inst.sinst->addr] = staticDecode(inst);
-   
-   const dl::DecodedInst& dec_inst = *(m_decoder_cache[inst.sinst->addr]);
+Instruction* TraceThread::decode(Sift::Instruction &inst, const dl::DecodedInst &dec_inst)
+{
 
+   //printf("PC: %lx Size: %d num_addresses=%d is_branch=%d\n", inst.sinst->addr, inst.sinst->size, inst.num_addresses, inst.is_branch);
    OperandList list;
 
    // Ignore memory-referencing operands in NOP instructions
@@ -509,20 +522,9 @@ void TraceThread::handleCacheOnlyFunc(uint8_t icount, Sift::CacheOnlyType type,
    }
 }
 
-const dl::DecodedInst* TraceThread::staticDecode(Sift::Instruction &inst)
-{
-   dl::DecodedInst *dec_inst = m_factory->CreateInstruction(Sim()->getDecoder(), inst.sinst->data, 
-                                                            inst.sinst->size, inst.sinst->addr);
-   Sim()->getDecoder()->decode(dec_inst, (dl::dl_isa)inst.isa);
-   return dec_inst;
-}
-
 void TraceThread::handleInstructionWarmup(Sift::Instruction &inst, Sift::Instruction &next_inst, Core *core, bool do_icache_warmup, UInt64 icache_warmup_addr, UInt64 icache_warmup_size)
 {
-   if (m_decoder_cache.count(inst.sinst->addr) == 0)
-      m_decoder_cache[inst.sinst->addr] = staticDecode(inst);
-   
-   const dl::DecodedInst &dec_inst = *(m_decoder_cache[inst.sinst->addr]);
+   const dl::DecodedInst &dec_inst = *getDecoded(inst, false).decoded;
 
    // Warmup instruction caches
 
@@ -631,12 +633,9 @@ void TraceThread::handleInstructionDetailed(Sift::Instruction &inst, Sift::Instr
 
    // Set up instruction
 
-   if (m_icache.count(inst.sinst->addr) == 0)
-      m_icache[inst.sinst->addr] = decode(inst);
-   // Here get the decoder instruction without checking, because we must have it for sure
-   const dl::DecodedInst &dec_inst = *(m_decoder_cache[inst.sinst->addr]);
-
-   Instruction *ins = m_icache[inst.sinst->addr];
+   const DecodedEntry &entry = getDecoded(inst, true);
+   const dl::DecodedInst &dec_inst = *entry.decoded;
+   Instruction *ins = entry.instruction;
    DynamicInstruction *dynins = prfmdl->createDynamicInstruction(ins, va2pa(inst.sinst->addr));
 
    // Add dynamic instruction info
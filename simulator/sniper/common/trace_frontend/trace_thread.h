@@ -8,6 +8,7 @@
 #include "sift_reader.h"
 #include "operand.h"
 #include "semaphore.h"
+#include "decoded_instruction_cache.h"
 
 #include <decoder.h>
 
@@ -59,11 +60,23 @@ class TraceThread : public Runnable
       bool m_appid_from_coreid;
       uint8_t m_address_randomization_table[256];
       bool m_stop;
-      std::unordered_map<IntPtr, Instruction *> m_icache;
-      //std::unordered_map<IntPtr, const xed_decoded_inst_t *> m_decoder_cache;  // TODO convert to DecoderLib
       //static bool xed_initialized;  // TODO convert to DecoderLib
       //xed_state_t m_xed_state_init;  // TODO convert to DecoderLib
-      std::unordered_map<IntPtr, const dl::DecodedInst *> m_decoder_cache;  // TODO convert to DecoderLib
+
+      // Decoded form of a static instruction: the decoder's view (shared by all threads, see
+      // DecodedInstructionCache) and this thread's Instruction (NULL until first executed in detailed mode)
+      struct DecodedEntry
+      {
+         IntPtr addr;
+         const dl::DecodedInst *decoded;
+         Instruction *instruction;
+      };
+      static DecodedInstructionCache s_decoded_cache;
+      std::unordered_map<IntPtr, DecodedEntry> m_icache;
+      // Direct-mapped front of m_icache, so that the common case is a single array probe per instruction
+      static const UInt32 DECODED_FRONT_SIZE = 4096;
+      DecodedEntry m_decoded_front[DECODED_FRONT_SIZE];
+      const DecodedEntry& getDecoded(Sift::Instruction &inst, bool need_instruction);
       UInt64 m_bbv_base;
       UInt64 m_bbv_count;
       UInt64 m_bbv_last;
@@ -121,7 +134,7 @@ class TraceThread : public Runnable
 
 
 
-      Instruction* decode(Sift::Instruction &inst);
+      Instruction* decode(Sift::Instruction &inst, const dl::DecodedInst &dec_inst);
       void handleInstructionWarmup(Sift::Instruction &inst, Sift::Instruction &next_inst, Core *core, bool do_icache_warmup, UInt64 icache_warmup_addr, UInt64 icache_warmup_size);
       void handleInstructionDetailed(Sift::Instruction &inst, Sift::Instruction &next_inst, PerformanceModel *prfmdl);
       //void addDetailedMemoryInfo(DynamicInstruction *dynins, Sift::Instruction &inst, const xed_decoded_inst_t &xed_inst, uint32_t mem_idx, Operand::Direction op_type, bool is_pretetch, PerformanceModel *prfmdl);
@@ -133,7 +146,6 @@ class TraceThread : public Runnable
       //static dl::Decoder *m_decoder;
       dl::DecoderFactory *m_factory;  // we need a factory here to be able to create instructions of any kind
       //const xed_decoded_inst_t* staticDecode(Sift::Instruction &inst);
-      const dl::DecodedInst* staticDecode(Sift::Instruction &inst);
 
       long long *m_papi_counters;
       bool m_virtuos_app;
@@ -4,6 +4,7 @@ periodic-stats.py
 Periodically write out all statistics
 1st argument is the interval size in nanoseconds (default is 1e9 = 1 second of simulated time)
 2rd argument, if present will limit the number of snapshots and dynamically remove itermediate data
+With general/stats_columnar enabled, snapshots go to sim.stats.columnar only and are never thinned out
 """
 
 import sim
@@ -17,6 +18,9 @@ class PeriodicStats:
     self.interval = int(interval * sim.util.Time.NS)
     self.next_interval = float('inf')
     self.in_roi = False
+    self.columnar = sim.config.get_bool('general/stats_columnar')
+    if self.columnar:
+      self.max_snapshots = 0
     sim.util.Every(self.interval, self.periodic, roi_only = True)
 
   def hook_roi_begin(self):
@@ -37,7 +41,10 @@ class PeriodicStats:
 
     if time >= self.next_interval:
       self.num_snapshots += 1
-      sim.stats.write('periodic-%d' % (self.num_snapshots * self.interval))
+      if self.columnar:
+        sim.stats.snapshot('periodic-%d' % (self.num_snapshots * self.interval))
+      else:
+        sim.stats.write('periodic-%d' % (self.num_snapshots * self.interval))
       self.next_interval += self.interval
 
 sim.util.register(PeriodicStats())
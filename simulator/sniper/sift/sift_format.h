@@ -18,6 +18,14 @@
 # define SIFT_USE_ZLIB 1
 #endif
 
+// The block-compressed trace reader inflates on a helper thread, which PinCRT does not support.
+// The recorder only needs the writer side.
+#if SIFT_USE_ZLIB && !defined(PIN_CRT)
+# define SIFT_USE_BLOCK_READER 1
+#else
+# define SIFT_USE_BLOCK_READER 0
+#endif
+
 namespace Sift
 {
 
@@ -42,8 +50,39 @@ namespace Sift
       ArchIA32 = 2,
       IcacheVariable = 4,
       PhysicalAddress = 8,
+      CompressionBlocks = 16,
    } Option;
 
+   // CompressionBlocks container
+   //
+   // After the Header, the trace is a sequence of blocks: a BlockHeader followed by compressed_size
+   // bytes of zlib data that inflate independently of any other block. After the last block comes
+   // an index (one BlockIndexEntry per block) and a BlockTrailer, so readers can locate any block
+   // without inflating the ones before it. A trace whose recorder was killed has no index; the
+   // blocks can still be found by walking their headers.
+
+   const uint32_t BlockIndexMagic = 0x58444e49; // "INDX"
+   const uint32_t BLOCK_SIZE = 1024 * 1024;     //< Uncompressed bytes per block (the last one may be shorter)
+
+   typedef struct
+   {
+      uint32_t compressed_size;
+      uint32_t uncompressed_size;
+   } __attribute__ ((__packed__)) BlockHeader;
+
+   typedef struct
+   {
+      uint64_t file_offset;            //< Offset of the BlockHeader in the file
+      uint64_t uncompressed_offset;    //< Offset of the block's first byte in the uncompressed stream
+   } __attribute__ ((__packed__)) BlockIndexEntry;
+
+   typedef struct
+   {
+      uint64_t index_offset;           //< Offset of the first BlockIndexEntry in the file
+      uint64_t num_blocks;
+      uint32_t magic;
+   } __attribute__ ((__packed__)) BlockTrailer;
+
    typedef union
    {
       // Simple format for common instructions
@@ -41,6 +41,8 @@ Sift::Reader::Reader(const char *filename, const char *response_filename, uint32
    , handleRoutineAnnounceFunc(NULL)
    , handleRoutineArg(NULL)   
    , filesize(0)
+   , inputstream(NULL)
+   , m_block_input(NULL)
    , last_address(0)
    , icache()
    , m_id(id)
@@ -106,6 +108,28 @@ bool Sift::Reader::initStream()
       std::cerr << "[SIFT:" << m_id << "] Invalid header size\n";
    }
 
+#if SIFT_USE_BLOCK_READER
+   if (hdr.options & CompressionBlocks)
+   {
+      // Blocks are read straight from a memory mapping of the file, by offset
+      delete input;
+      inputstream = NULL;
+      m_block_input = new izblockstream(m_filename, sizeof(hdr));
+      input = m_block_input;
+      if (input->fail())
+      {
+         std::cerr << "[SIFT:" << m_id << "] Cannot map " << m_filename << ", block-compressed traces must be regular files\n";
+         return false;
+      }
+      hdr.options &= ~CompressionBlocks;
+   }
+#else
+   if (hdr.options & CompressionBlocks)
+   {
+      std::cerr << "[SIFT:" << m_id << "] Error: Block compression requested, but disabled at compile time.\n";
+   }
+#endif
+
 #if SIFT_USE_ZLIB
    if (hdr.options & CompressionZlib)
    {
@@ -681,15 +705,19 @@ const Sift::StaticInstruction* Sift::Reader::getStaticInstruction(uint64_t addr,
    {
       sinst = m_last_sinst->next;
    }
-   else if (scache.count(addr))
-   {
-      sinst = scache[addr];
-      assert(sinst->size == size);
-   }
    else
    {
-      sinst = staticInfoInstruction(addr, size);
-      scache[addr] = sinst;
+      auto it = scache.find(addr);
+      if (it != scache.end())
+      {
+         sinst = it->second;
+         assert(sinst->size == size);
+      }
+      else
+      {
+         sinst = staticInfoInstruction(addr, size);
+         scache[addr] = sinst;
+      }
    }
 
    if (m_last_sinst && m_last_sinst->next == NULL)
@@ -768,6 +796,10 @@ void Sift::Reader::sendSimpleResponse(RecOtherType type, void *data, uint32_t si
 
 uint64_t Sift::Reader::getPosition()
 {
+#if SIFT_USE_BLOCK_READER
+   if (m_block_input)
+      return m_block_input->getFileOffset();
+#endif
    if (inputstream)
       return inputstream->tellg();
    else
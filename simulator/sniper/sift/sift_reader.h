@@ -10,6 +10,7 @@
 
 class vistream;
 class vostream;
+class izblockstream;
 
 namespace Sift
 {
@@ -78,6 +79,7 @@ namespace Sift
          void *handleRoutineArg;
          uint64_t filesize;
          std::ifstream *inputstream;
+         izblockstream *m_block_input;  //< Same object as input for block-compressed traces, else NULL
 
          char *m_filename;
          char *m_response_filename;
@@ -39,7 +39,7 @@ __sift_assert_fail(__const char *__assertion, __const char *__file,
 }
 
 
-Sift::Writer::Writer(const char *filename, GetCodeFunc getCodeFunc, bool useCompression, const char *response_filename, uint32_t id, bool arch32, bool requires_icache_per_insn, bool send_va2pa_mapping, GetCodeFunc2 getCodeFunc2, void* getCodeFunc2Data)
+Sift::Writer::Writer(const char *filename, GetCodeFunc getCodeFunc, bool useCompression, const char *response_filename, uint32_t id, bool arch32, bool requires_icache_per_insn, bool send_va2pa_mapping, GetCodeFunc2 getCodeFunc2, void* getCodeFunc2Data, bool useBlockCompression)
    : response(NULL)
    , getCodeFunc(getCodeFunc)
    , getCodeFunc2(getCodeFunc2)
@@ -64,8 +64,9 @@ Sift::Writer::Writer(const char *filename, GetCodeFunc getCodeFunc, bool useComp
 
    uint64_t options = 0;
 #if SIFT_USE_ZLIB
+   // Block compression produces independently inflatable, indexed blocks; it needs a regular file
    if (useCompression)
-      options |= CompressionZlib;
+      options |= useBlockCompression ? CompressionBlocks : CompressionZlib;
 #else
    if (useCompression) {
       std::cerr << "[SIFT:" << m_id << "] Warning: Compression disabled, ignoring request.\n";
@@ -103,6 +104,8 @@ Sift::Writer::Writer(const char *filename, GetCodeFunc getCodeFunc, bool useComp
 
    if (options & CompressionZlib)
       output = new ozstream(output);
+   else if (options & CompressionBlocks)
+      output = new ozblockstream(output, sizeof(hdr));
 }
 
 // Modified from http://stackoverflow.com/questions/2203159/is-there-a-c-equivalent-to-getcwd
@@ -24,6 +24,24 @@ void ozstream::doCompress(bool finish)
 {
 }
 
+ozblockstream::ozblockstream(vostream *output, uint64_t data_offset)
+   : output(output)
+{
+   assert(false);
+}
+
+ozblockstream::~ozblockstream()
+{
+}
+
+void ozblockstream::write(const char* s, std::streamsize n)
+{
+}
+
+void ozblockstream::writeBlock()
+{
+}
+
 izstream::izstream(vistream *input)
    : input(input)
    , m_eof(false)
@@ -161,8 +179,373 @@ int izstream::peek()
    return peek_value;
 }
 
+ozblockstream::ozblockstream(vostream *output, uint64_t data_offset)
+   : output(output)
+   , file_offset(data_offset)
+   , uncompressed_offset(0)
+{
+   buffer.reserve(Sift::BLOCK_SIZE);
+   compressed.resize(compressBound(Sift::BLOCK_SIZE));
+}
+
+ozblockstream::~ozblockstream()
+{
+   if (!buffer.empty())
+      writeBlock();
+
+   Sift::BlockTrailer trailer = { file_offset, index.size(), Sift::BlockIndexMagic };
+   if (!index.empty())
+      output->write(reinterpret_cast<const char*>(index.data()), index.size() * sizeof(Sift::BlockIndexEntry));
+   output->write(reinterpret_cast<const char*>(&trailer), sizeof(trailer));
+   output->flush();
+   delete output;
+}
+
+void ozblockstream::write(const char* s, std::streamsize n)
+{
+   while (n > 0)
+   {
+      size_t count = std::min<size_t>(n, Sift::BLOCK_SIZE - buffer.size());
+      buffer.insert(buffer.end(), s, s + count);
+      s += count;
+      n -= count;
+      if (buffer.size() == Sift::BLOCK_SIZE)
+         writeBlock();
+   }
+}
+
+void ozblockstream::writeBlock()
+{
+   uLongf size = compressed.size();
+   int ret = compress2((Bytef*)compressed.data(), &size, (const Bytef*)buffer.data(), buffer.size(), level);
+   assert(ret == Z_OK);
+
+   Sift::BlockHeader hdr = { (uint32_t)size, (uint32_t)buffer.size() };
+   Sift::BlockIndexEntry entry = { file_offset, uncompressed_offset };
+   index.push_back(entry);
+
+   output->write(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
+   output->write(compressed.data(), size);
+
+   file_offset += sizeof(hdr) + size;
+   uncompressed_offset += buffer.size();
+   buffer.clear();
+}
+
 #endif /*SIFT_USE_ZLIB*/
 
+#if SIFT_USE_BLOCK_READER
+
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+izblockstream::izblockstream(const char *filename, uint64_t data_offset)
+   : m_fd(-1)
+   , m_map(NULL)
+   , m_map_size(0)
+   , m_inflated(0)
+   , m_consumed(0)
+   , m_generation(0)
+   , m_bad_block(UINT64_MAX)
+   , m_stop(false)
+   , m_thread_running(false)
+   , m_have_block(false)
+   , m_cur(NULL)
+   , m_cur_left(0)
+   , m_fail(false)
+   , m_eof(false)
+   , peek_valid(false)
+{
+   pthread_mutex_init(&m_lock, NULL);
+   pthread_cond_init(&m_cond, NULL);
+
+   struct stat st;
+   m_fd = open(filename, O_RDONLY);
+   if (m_fd < 0 || fstat(m_fd, &st) != 0 || !S_ISREG(st.st_mode))
+   {
+      m_fail = true;
+      return;
+   }
+
+   m_map_size = st.st_size;
+   if (m_map_size > 0)
+   {
+      void *map = mmap(NULL, m_map_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+      if (map == MAP_FAILED)
+      {
+         m_map_size = 0;
+         m_fail = true;
+         return;
+      }
+      madvise(map, m_map_size, MADV_SEQUENTIAL);
+      m_map = (const char*)map;
+   }
+
+   if (!loadIndex(data_offset))
+      scanBlocks(data_offset);
+
+   uint32_t max_block_size = 0;
+   for (const block_t &block : m_blocks)
+      max_block_size = std::max(max_block_size, block.uncompressed_size);
+   for (uint64_t i = 0; i < NUM_SLOTS; ++i)
+      m_slots[i].resize(max_block_size);
+
+   int ret = pthread_create(&m_thread, NULL, inflateThreadFunc, this);
+   assert(ret == 0);
+   m_thread_running = true;
+}
+
+izblockstream::~izblockstream()
+{
+   pthread_mutex_lock(&m_lock);
+   m_stop = true;
+   pthread_cond_broadcast(&m_cond);
+   pthread_mutex_unlock(&m_lock);
+   if (m_thread_running)
+      pthread_join(m_thread, NULL);
+   pthread_cond_destroy(&m_cond);
+   pthread_mutex_destroy(&m_lock);
+
+   if (m_map)
+      munmap((void*)m_map, m_map_size);
+   if (m_fd >= 0)
+      close(m_fd);
+}
+
+bool izblockstream::loadIndex(uint64_t data_offset)
+{
+   Sift::BlockTrailer trailer;
+   if (m_map_size < data_offset + sizeof(trailer))
+      return false;
+   memcpy(&trailer, m_map + m_map_size - sizeof(trailer), sizeof(trailer));
+
+   if (trailer.magic != Sift::BlockIndexMagic
+       || trailer.index_offset < data_offset
+       || trailer.num_blocks > (m_map_size - trailer.index_offset) / sizeof(Sift::BlockIndexEntry)
+       || trailer.index_offset + trailer.num_blocks * sizeof(Sift::BlockIndexEntry) + sizeof(trailer) != m_map_size)
+      return false;
+
+   std::vector<block_t> blocks;
+   blocks.reserve(trailer.num_blocks);
+   for (uint64_t i = 0; i < trailer.num_blocks; ++i)
+   {
+      Sift::BlockIndexEntry entry;
+      Sift::BlockHeader hdr;
+      memcpy(&entry, m_map + trailer.index_offset + i * sizeof(entry), sizeof(entry));
+      if (entry.file_offset < data_offset || entry.file_offset + sizeof(hdr) > trailer.index_offset)
+         return false;
+      memcpy(&hdr, m_map + entry.file_offset, sizeof(hdr));
+      if (entry.file_offset + sizeof(hdr) + hdr.compressed_size > trailer.index_offset)
+         return false;
+
+      block_t block = { entry.file_offset, entry.uncompressed_offset, hdr.compressed_size, hdr.uncompressed_size };
+      blocks.push_back(block);
+   }
+
+   m_blocks.swap(blocks);
+   return true;
+}
+
+bool izblockstream::scanBlocks(uint64_t data_offset)
+{
+   // No (valid) index, e.g. the recorder did not shut down cleanly: walk the block headers
+   uint64_t offset = data_offset;
+   uint64_t uncompressed_offset = 0;
+   Sift::BlockHeader hdr;
+
+   while (offset + sizeof(hdr) <= m_map_size)
+   {
+      memcpy(&hdr, m_map + offset, sizeof(hdr));
+      if (hdr.compressed_size == 0 || offset + sizeof(hdr) + hdr.compressed_size > m_map_size)
+         break; // Truncated last block
+
+      block_t block = { offset, uncompressed_offset, hdr.compressed_size, hdr.uncompressed_size };
+      m_blocks.push_back(block);
+
+      offset += sizeof(hdr) + hdr.compressed_size;
+      uncompressed_offset += hdr.uncompressed_size;
+   }
+
+   return !m_blocks.empty();
+}
+
+void* izblockstream::inflateThreadFunc(void *arg)
+{
+   ((izblockstream*)arg)->inflateThread();
+   return NULL;
+}
+
+void izblockstream::inflateThread()
+{
+   pthread_mutex_lock(&m_lock);
+   while (true)
+   {
+      while (!m_stop && !(m_inflated < m_blocks.size() && m_inflated < m_consumed + NUM_SLOTS))
+         pthread_cond_wait(&m_cond, &m_lock);
+      if (m_stop)
+         break;
+
+      uint64_t block_idx = m_inflated;
+      uint64_t generation = m_generation;
+      pthread_mutex_unlock(&m_lock);
+
+      // The slot is not visible to the consumer until m_inflated moves past it
+      const block_t &block = m_blocks[block_idx];
+      std::vector<char> &slot = m_slots[block_idx % NUM_SLOTS];
+      uLongf size = slot.size();
+      int ret = uncompress((Bytef*)slot.data(), &size, (const Bytef*)(m_map + block.file_offset + sizeof(Sift::BlockHeader)), block.compressed_size);
+
+      pthread_mutex_lock(&m_lock);
+      if (generation != m_generation)
+         continue; // seek() moved the stream while we were inflating
+
+      if ((ret != Z_OK || size != block.uncompressed_size) && m_bad_block == UINT64_MAX)
+         m_bad_block = block_idx;
+      ++m_inflated;
+      pthread_cond_broadcast(&m_cond);
+   }
+   pthread_mutex_unlock(&m_lock);
+}
+
+bool izblockstream::nextBlock()
+{
+   bool ok = true;
+
+   pthread_mutex_lock(&m_lock);
+   if (m_have_block)
+   {
+      // Hand the slot of the finished block back to the helper thread
+      ++m_consumed;
+      m_have_block = false;
+      pthread_cond_broadcast(&m_cond);
+   }
+
+   if (m_consumed >= m_blocks.size())
+   {
+      m_eof = true;
+      ok = false;
+   }
+   else
+   {
+      while (m_inflated <= m_consumed)
+         pthread_cond_wait(&m_cond, &m_lock);
+
+      if (m_consumed >= m_bad_block)
+      {
+         std::cerr << "[SIFT] Error: cannot inflate block " << m_bad_block << std::endl;
+         ok = false;
+      }
+      else
+      {
+         m_have_block = true;
+         m_cur = m_slots[m_consumed % NUM_SLOTS].data();
+         m_cur_left = m_blocks[m_consumed].uncompressed_size;
+      }
+   }
+   pthread_mutex_unlock(&m_lock);
+
+   return ok;
+}
+
+void izblockstream::read(char* s, std::streamsize n)
+{
+   if (peek_valid)
+   {
+      s[0] = peek_value;
+      peek_valid = false;
+      ++s;
+      --n;
+   }
+
+   while (n > 0)
+   {
+      if (m_cur_left == 0)
+      {
+         if (!nextBlock())
+         {
+            m_fail = true;
+            return;
+         }
+         continue;
+      }
+
+      uint64_t count = std::min<uint64_t>(n, m_cur_left);
+      memcpy(s, m_cur, count);
+      s += count;
+      n -= count;
+      m_cur += count;
+      m_cur_left -= count;
+   }
+}
+
+int izblockstream::peek()
+{
+   if (peek_valid == true)
+      return peek_value;
+
+   read(&peek_value, 1);
+   peek_valid = true;
+
+   return peek_value;
+}
+
+bool izblockstream::seek(uint64_t uncompressed_offset)
+{
+   if (m_blocks.empty())
+      return false;
+   const block_t &last = m_blocks.back();
+   if (uncompressed_offset > last.uncompressed_offset + last.uncompressed_size)
+      return false;
+
+   // Last block that starts at or before the target offset
+   uint64_t lo = 0, hi = m_blocks.size();
+   while (hi - lo > 1)
+   {
+      uint64_t mid = (lo + hi) / 2;
+      if (m_blocks[mid].uncompressed_offset <= uncompressed_offset)
+         lo = mid;
+      else
+         hi = mid;
+   }
+
+   pthread_mutex_lock(&m_lock);
+   ++m_generation;
+   m_consumed = lo;
+   m_inflated = lo;
+   m_bad_block = UINT64_MAX;
+   m_have_block = false;
+   pthread_cond_broadcast(&m_cond);
+   pthread_mutex_unlock(&m_lock);
+
+   peek_valid = false;
+   m_eof = false;
+   m_fail = false;
+   m_cur_left = 0;
+   if (!nextBlock())
+   {
+      m_fail = true;
+      return false;
+   }
+
+   uint64_t skip = uncompressed_offset - m_blocks[lo].uncompressed_offset;
+   m_cur += skip;
+   m_cur_left -= skip;
+   return true;
+}
+
+uint64_t izblockstream::getFileOffset()
+{
+   if (m_consumed >= m_blocks.size())
+      return m_map_size;
+   return m_blocks[m_consumed].file_offset;
+}
+
+#endif /*SIFT_USE_BLOCK_READER*/
+
 #include <cstdio>
 cvifstream::cvifstream(const char * filename, std::ios_base::openmode mode)
 {
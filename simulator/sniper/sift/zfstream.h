@@ -6,6 +6,11 @@
 #include <ostream>
 #include <istream>
 #include <fstream>
+#include <vector>
+
+#if SIFT_USE_BLOCK_READER
+# include <pthread.h>
+#endif
 
 #if SIFT_USE_ZLIB
 # include <zlib.h>
@@ -66,6 +71,31 @@ class ozstream : public vostream
 
 
 
+// Writes the CompressionBlocks container (see sift_format.h): data is cut into BLOCK_SIZE blocks
+// that are compressed independently, and the block index is appended when the stream is closed.
+class ozblockstream : public vostream
+{
+   private:
+      vostream *output;
+      uint64_t file_offset;            // Where the next block header will be written
+      uint64_t uncompressed_offset;
+      std::vector<char> buffer;
+      std::vector<char> compressed;
+      std::vector<Sift::BlockIndexEntry> index;
+      static const int level = 9;
+      void writeBlock();
+   public:
+      ozblockstream(vostream *output, uint64_t data_offset);
+      virtual ~ozblockstream();
+      virtual void write(const char* s, std::streamsize n);
+      virtual void flush()
+         { output->flush(); }
+      virtual bool fail()
+         { return output->fail(); }
+      virtual bool is_open()
+         { return output->is_open(); }
+};
+
 class vistream
 {
    public:
@@ -130,4 +160,65 @@ class izstream : public vistream
       virtual bool fail() const { return m_fail; }
 };
 
+#if SIFT_USE_BLOCK_READER
+// Reads the CompressionBlocks container. The file is mapped into memory and a helper thread
+// inflates the next few blocks ahead of the consumer, so read() only copies out of an already
+// inflated block. seek() jumps to any uncompressed offset through the block index.
+class izblockstream : public vistream
+{
+   private:
+      struct block_t
+      {
+         uint64_t file_offset;
+         uint64_t uncompressed_offset;
+         uint32_t compressed_size;
+         uint32_t uncompressed_size;
+      };
+
+      static const uint64_t NUM_SLOTS = 4;   // Blocks inflated ahead of the consumer
+
+      int m_fd;
+      const char *m_map;
+      uint64_t m_map_size;
+      std::vector<block_t> m_blocks;
+      std::vector<char> m_slots[NUM_SLOTS];  // Block b is inflated into m_slots[b % NUM_SLOTS]
+
+      // Shared with the helper thread, protected by m_lock
+      pthread_mutex_t m_lock;
+      pthread_cond_t m_cond;
+      uint64_t m_inflated;                   // Blocks [m_consumed, m_inflated) are ready
+      uint64_t m_consumed;                   // Block the consumer is reading
+      uint64_t m_generation;                 // Bumped by seek() to discard inflates in flight
+      uint64_t m_bad_block;                  // First block that failed to inflate
+      bool m_stop;
+      bool m_thread_running;
+      pthread_t m_thread;
+
+      // Consumer state
+      bool m_have_block;                     // m_cur points into the slot of block m_consumed
+      const char *m_cur;
+      uint64_t m_cur_left;
+      bool m_fail;
+      bool m_eof;
+      char peek_value;
+      bool peek_valid;
+
+      bool loadIndex(uint64_t data_offset);
+      bool scanBlocks(uint64_t data_offset);
+      bool nextBlock();
+      void inflateThread();
+      static void* inflateThreadFunc(void *arg);
+   public:
+      izblockstream(const char *filename, uint64_t data_offset);
+      virtual ~izblockstream();
+      virtual void read(char* s, std::streamsize n);
+      virtual int peek();
+      virtual bool eof() const { return m_eof; }
+      virtual bool fail() const { return m_fail; }
+      bool seek(uint64_t uncompressed_offset);
+      uint64_t getFileOffset();              // File offset of the block being consumed
+      uint64_t getNumBlocks() const { return m_blocks.size(); }
+};
+#endif
+
 #endif // __ZFSTREAM_H
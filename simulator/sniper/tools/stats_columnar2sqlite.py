@@ -0,0 +1,137 @@
+#!/usr/bin/env python3
+
+# Convert the columnar statistics dump (sim.stats.columnar, written when general/stats_columnar = true)
+# into the sim.stats.sqlite3 schema, see StatsManager in common/misc/stats.cc for the file layout
+
+import sys, os, getopt, mmap, struct, sqlite3
+
+MAGIC = 0x31544154534c4f43             # "COLSTAT1"
+FILE_HEADER = struct.Struct('<QQ')      # magic, version
+RECORD_HEADER = struct.Struct('<II')    # type, payload bytes
+NAMES_HEADER = struct.Struct('<II')     # first column, count
+NAME = struct.Struct('<QIHH')           # nameid, index, objectname length, metricname length
+SNAPSHOT = struct.Struct('<QII')        # prefixid, columns, prefix length
+
+RECORD_COLUMN_NAMES = 1
+RECORD_SNAPSHOT = 2
+
+# Keep in sync with db_create_stmts in common/misc/stats.cc
+CREATE_STMTS = [
+  'CREATE TABLE `names` (nameid INTEGER, objectname TEXT, metricname TEXT);',
+  'CREATE TABLE `prefixes` (prefixid INTEGER, prefixname TEXT);',
+  'CREATE TABLE `values` (prefixid INTEGER, nameid INTEGER, core INTEGER, value INTEGER);',
+  'CREATE INDEX `idx_prefix_name` ON `prefixes`(`prefixname`);',
+  'CREATE INDEX `idx_value_prefix` ON `values`(`prefixid`);',
+  'CREATE TABLE `topology` (componentname TEXT, coreid INTEGER, masterid INTEGER);',
+  'CREATE TABLE `event` (event INTEGER, time INTEGER, core INTEGER, thread INTEGER, value0 INTEGER, value1 INTEGER, description TEXT);',
+]
+
+def usage():
+  print('Usage:', sys.argv[0], '[-h (help)] [-o <output (default: sim.stats.columnar.sqlite3)> | --merge] [-d <resultsdir (default: .)> | <columnarfile>]')
+  print('  --merge: add the snapshots that are not in <resultsdir>/sim.stats.sqlite3 yet to that database')
+
+def padded(size):
+  return (size + 7) & ~7
+
+def read_records(filename):
+  """Yield ('names', [(nameid, index, objectname, metricname), ...]) and ('snapshot', prefixid, prefix, values) tuples."""
+  with open(filename, 'rb') as fp:
+    if os.fstat(fp.fileno()).st_size < FILE_HEADER.size:
+      sys.stderr.write('%s: empty or truncated file\n' % filename)
+      return
+    data = mmap.mmap(fp.fileno(), 0, access = mmap.ACCESS_READ)
+    magic, version = FILE_HEADER.unpack_from(data, 0)
+    if magic != MAGIC or version != 1:
+      sys.stderr.write('%s: not a columnar statistics file (magic %#x, version %d)\n' % (filename, magic, version))
+      return
+    offset = FILE_HEADER.size
+    while offset + RECORD_HEADER.size <= len(data):
+      rtype, length = RECORD_HEADER.unpack_from(data, offset)
+      offset += RECORD_HEADER.size
+      if offset + length > len(data):
+        sys.stderr.write('%s: truncated record at offset %d\n' % (filename, offset))
+        return
+      if rtype == RECORD_COLUMN_NAMES:
+        _, count = NAMES_HEADER.unpack_from(data, offset)
+        pos = offset + NAMES_HEADER.size
+        names = []
+        for _ in range(count):
+          nameid, index, objlen, metlen = NAME.unpack_from(data, pos)
+          pos += NAME.size
+          objectname = data[pos:pos+objlen].decode()
+          metricname = data[pos+objlen:pos+objlen+metlen].decode()
+          pos += objlen + metlen
+          names.append((nameid, index, objectname, metricname))
+        yield ('names', names)
+      elif rtype == RECORD_SNAPSHOT:
+        prefixid, columns, prefixlen = SNAPSHOT.unpack_from(data, offset)
+        pos = offset + SNAPSHOT.size
+        prefix = data[pos:pos+prefixlen].decode()
+        pos += padded(prefixlen)
+        values = struct.unpack_from('<%dQ' % columns, data, pos)
+        yield ('snapshot', prefixid, prefix, values)
+      else:
+        sys.stderr.write('%s: unknown record type %d at offset %d, skipping\n' % (filename, rtype, offset))
+      offset += length
+
+def convert(filename, db, merge = False):
+  existing = set(row[0] for row in db.execute('SELECT prefixid FROM `prefixes`')) if merge else set()
+  known_names = set(row[0] for row in db.execute('SELECT nameid FROM `names`'))
+  columns = []
+  num_snapshots = 0
+  for record in read_records(filename):
+    if record[0] == 'names':
+      for nameid, index, objectname, metricname in record[1]:
+        columns.append((nameid, index))
+        if nameid not in known_names:
+          db.execute('INSERT INTO `names` (nameid, objectname, metricname) VALUES (?, ?, ?)', (nameid, objectname, metricname))
+          known_names.add(nameid)
+    else:
+      _, prefixid, prefix, values = record
+      if prefixid in existing:
+        continue
+      db.execute('INSERT INTO `prefixes` (prefixid, prefixname) VALUES (?, ?)', (prefixid, prefix))
+      # Like StatsManager::recordStats, leave out metrics that are still zero
+      db.executemany('INSERT INTO `values` (prefixid, nameid, core, value) VALUES (?, ?, ?, ?)',
+        ((prefixid, nameid, index, value) for (nameid, index), value in zip(columns, values) if value))
+      num_snapshots += 1
+  db.commit()
+  return num_snapshots
+
+if __name__ == '__main__':
+  resultsdir = '.'
+  output = None
+  merge = False
+
+  try:
+    opts, args = getopt.getopt(sys.argv[1:], 'hd:o:', [ 'merge' ])
+  except getopt.GetoptError as e:
+    print(e)
+    usage()
+    sys.exit(1)
+  for o, a in opts:
+    if o == '-h':
+      usage()
+      sys.exit()
+    if o == '-d':
+      resultsdir = a
+    if o == '-o':
+      output = a
+    if o == '--merge':
+      merge = True
+
+  filename = args[0] if args else os.path.join(resultsdir, 'sim.stats.columnar')
+  if merge:
+    output = os.path.join(os.path.dirname(filename), 'sim.stats.sqlite3')
+    db = sqlite3.connect(output)
+  else:
+    output = output or os.path.join(os.path.dirname(filename), 'sim.stats.columnar.sqlite3')
+    if os.path.exists(output):
+      os.unlink(output)
+    db = sqlite3.connect(output)
+    for stmt in CREATE_STMTS:
+      db.execute(stmt)
+
+  num_snapshots = convert(filename, db, merge)
+  db.close()
+  print('Wrote %d snapshots to %s' % (num_snapshots, output))
@@ -0,0 +1,113 @@
+#!/usr/bin/env python3
+
+# Decoder for the binary address translation trace (translation_trace.bin) written by
+# simulators built with TRANSLATION_TRACE=1, see common/misc/translation_trace.h
+
+import sys, os, getopt, struct, collections
+
+MAGIC = 0x31545456
+HEADER = struct.Struct('<IHHII')       # magic, record_size, core, num_records, reserved
+RECORD = struct.Struct('<QQQQIHBb')    # time, va, value, latency, aux, core, type, level
+NO_CORE = 0xffff
+
+# Keep in sync with TranslationTrace::event_type_t
+EVENT_NAMES = [ 'tlb-hit', 'tlb-miss', 'page-fault', 'pt-insert', 'phys-alloc', 'phys-free' ]
+
+def usage():
+  print('Usage:', sys.argv[0], '[-h (help)] [-c <core>] [-e <event>[,<event>...]] [--csv | --summary] [-d <resultsdir (default: .)> | <tracefile>]')
+  print('Events:', ', '.join(EVENT_NAMES))
+
+def read_records(filename):
+  with open(filename, 'rb') as fp:
+    while True:
+      header = fp.read(HEADER.size)
+      if not header:
+        return
+      if len(header) < HEADER.size:
+        sys.stderr.write('%s: truncated chunk header\n' % filename)
+        return
+      magic, record_size, core, num_records, _ = HEADER.unpack(header)
+      if magic != MAGIC or record_size != RECORD.size:
+        sys.stderr.write('%s: bad chunk header (magic %#x, record size %d)\n' % (filename, magic, record_size))
+        return
+      data = fp.read(record_size * num_records)
+      if len(data) < record_size * num_records:
+        sys.stderr.write('%s: truncated chunk\n' % filename)
+        num_records = len(data) // record_size
+      for rec in RECORD.iter_unpack(data[:record_size * num_records]):
+        yield rec
+
+def event_name(event):
+  return EVENT_NAMES[event] if event < len(EVENT_NAMES) else 'event-%d' % event
+
+def core_name(core):
+  return '-' if core == NO_CORE else str(core)
+
+
+resultsdir = '.'
+tracefile = None
+core_filter = None
+event_filter = None
+do_csv = False
+do_summary = False
+
+try:
+  opts, args = getopt.getopt(sys.argv[1:], "hd:c:e:", [ 'csv', 'summary' ])
+except getopt.GetoptError as e:
+  print(e)
+  usage()
+  sys.exit(1)
+for o, a in opts:
+  if o == '-h':
+    usage()
+    sys.exit()
+  if o == '-d':
+    resultsdir = a
+  if o == '-c':
+    core_filter = int(a)
+  if o == '-e':
+    event_filter = set()
+    for name in a.split(','):
+      if name not in EVENT_NAMES:
+        sys.stderr.write('Unknown event %s\n' % name)
+        usage()
+        sys.exit(1)
+      event_filter.add(EVENT_NAMES.index(name))
+  if o == '--csv':
+    do_csv = True
+  if o == '--summary':
+    do_summary = True
+
+if args:
+  tracefile = args[0]
+else:
+  tracefile = os.path.join(resultsdir, 'translation_trace.bin')
+
+if not os.path.exists(tracefile):
+  sys.stderr.write('Cannot find %s, was the simulator built with TRANSLATION_TRACE=1?\n' % tracefile)
+  sys.exit(1)
+
+counts = collections.Counter()
+latency = collections.Counter()
+
+if do_csv:
+  print('time_fs,core,event,va,value,latency_fs,level,aux')
+
+for time, va, value, lat, aux, core, event, level in read_records(tracefile):
+  if core_filter is not None and core != core_filter:
+    continue
+  if event_filter is not None and event not in event_filter:
+    continue
+  if do_summary:
+    counts[(core, event)] += 1
+    latency[(core, event)] += lat
+  elif do_csv:
+    print('%d,%s,%s,%#x,%#x,%d,%d,%d' % (time, core_name(core), event_name(event), va, value, lat, level, aux))
+  else:
+    print('%16.3f ns  core %-3s %-10s va %#014x value %#x latency %.3f ns level %d aux %d' % (time / 1e6, core_name(core), event_name(event), va, value, lat / 1e6, level, aux))
+
+if do_summary:
+  print('%-5s %-10s %12s %16s' % ('core', 'event', 'count', 'avg latency ns'))
+  for (core, event) in sorted(counts):
+    n = counts[(core, event)]
+    print('%-5s %-10s %12d %16.3f' % (core_name(core), event_name(event), n, latency[(core, event)] / n / 1e6))